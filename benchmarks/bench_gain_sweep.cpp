@@ -0,0 +1,71 @@
+#include <iostream>
+#include <thread>
+#include "gain_sweep.hpp"
+#include "time_meas.hpp"
+
+// Throughput of runGainSweep against the number of worker threads:
+//   ./bin/bench_gain_sweep [configurations]
+// Runs the same Monte Carlo sweep with 1, 2, 4, ... threads up to the core count.
+
+int main(int argc, char** argv) {
+    int count = 16384;
+    try {
+        if (argc > 1) count = std::stoi(argv[1]);
+    } catch (const std::exception&) {
+        count = 0;
+    }
+    if (count <= 0) {
+        std::cerr << "Invalid configuration count: " << argv[1] << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [configurations]" << std::endl;
+        return -1;
+    }
+
+    SweepSpace space;
+    space.kp = {1.0f, 200.0f};
+    space.kd = {0.1f, 30.0f};
+    space.drag = {0.0f, 1.0f};
+    space.thrust = {20.0f, 200.0f};
+    space.mass = {0.5f, 3.0f};
+    std::vector<GainParameters> configurations = sampleParameters(space, count, 42);
+
+    SweepScenario scenario;
+    scenario.waypoints = {{0.0f, 10.0f, 0.0f}, {20.0f, 10.0f, 0.0f}, {20.0f, 10.0f, 20.0f}, {0.0f, 10.0f, 20.0f}};
+    const double steps_per_configuration = scenario.waypoints.size() * scenario.leg_duration / scenario.dt;
+
+    int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    std::cout << "Configurations: " << count << " | Steps per configuration: " << steps_per_configuration << std::endl;
+
+    double single_thread_rate = 0.0;
+    std::vector<SweepMetrics> reference;
+    for (int threads : thread_counts) {
+        auto start_time = get_current_time_fenced();
+        std::vector<SweepMetrics> results = runGainSweep(configurations, scenario, threads);
+        double seconds = static_cast<double>(to_mcs(get_current_time_fenced() - start_time)) / 1e6;
+
+        // Every thread count must produce the same metrics
+        bool identical = true;
+        if (reference.empty()) {
+            reference = results;
+        } else {
+            for (size_t i = 0; i < results.size() && identical; ++i) {
+                identical = results[i].settling_time == reference[i].settling_time &&
+                            results[i].final_error == reference[i].final_error;
+            }
+        }
+
+        double rate = count / seconds;
+        if (single_thread_rate == 0.0) single_thread_rate = rate;
+        std::cout << "Threads: " << threads
+                  << " | Time: " << seconds * 1000.0 << " ms"
+                  << " | Configurations/s: " << rate
+                  << " | M drone-steps/s: " << rate * steps_per_configuration / 1e6
+                  << " | Speedup: " << rate / single_thread_rate
+                  << (identical ? "" : " | RESULTS DIFFER") << std::endl;
+    }
+
+    return 0;
+}
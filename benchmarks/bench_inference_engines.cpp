@@ -0,0 +1,144 @@
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include "depth_estimation.hpp"
+
+// Compare the available inference engines on the same frames:
+//   ./bin/bench_inference_engines [model] [iterations] [video]
+// model: midas_small (default), midas_hybrid or depth_anything_v2.
+// Frames come from the video if given, otherwise from the test images in media.
+// Afterwards the tiled depth inference of the pipeline is timed for 1 to 4 tiles per side.
+
+struct EngineCase {
+    std::string label;
+    DepthEngineConfig config;
+};
+
+static std::vector<cv::Mat> loadFrames(int argc, char** argv) {
+    std::vector<cv::Mat> frames;
+    if (argc > 3) {
+        cv::VideoCapture video(getContentPath(argv[3]));
+        cv::Mat frame;
+        while (frames.size() < 16 && video.read(frame)) frames.push_back(frame.clone());
+    } else {
+        for (int i = 1; i <= 4; ++i) {
+            cv::Mat image = cv::imread(getContentPath("test_image_" + std::to_string(i) + ".png"));
+            if (!image.empty()) frames.push_back(image);
+        }
+    }
+    return frames;
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+int main(int argc, char** argv) {
+    DepthModel model = DepthModel::MIDAS_SMALL;
+    if (argc > 1 && !parseDepthModel(argv[1], model)) {
+        std::cerr << "Unknown model: " << argv[1] << std::endl;
+        return -1;
+    }
+    int iterations = 50;
+    try {
+        if (argc > 2) iterations = std::stoi(argv[2]);
+    } catch (const std::exception&) {
+        iterations = 0;
+    }
+    if (iterations <= 0) {
+        std::cerr << "Invalid iteration count: " << argv[2] << std::endl;
+        return -1;
+    }
+
+    std::vector<cv::Mat> frames = loadFrames(argc, argv);
+    if (frames.empty()) {
+        std::cerr << "Could not load any frames!" << std::endl;
+        return -1;
+    }
+
+    std::vector<EngineCase> cases;
+    cases.push_back({"opencv-dnn (default/cpu)", {InferenceBackend::OPENCV_DNN, model,
+                                                   cv::dnn::DNN_BACKEND_DEFAULT, cv::dnn::DNN_TARGET_CPU}});
+    cases.push_back({"opencv-dnn (opencv/cpu)", {InferenceBackend::OPENCV_DNN, model,
+                                                  cv::dnn::DNN_BACKEND_OPENCV, cv::dnn::DNN_TARGET_CPU}});
+#ifdef WITH_ONNXRUNTIME
+    cases.push_back({"onnxruntime (cpu)", {InferenceBackend::ONNX_RUNTIME, model}});
+#endif
+#ifdef WITH_OPENVINO
+    cases.push_back({"openvino (cpu)", {InferenceBackend::OPENVINO, model}});
+#endif
+
+    const ModelDescriptor& descriptor = getModelDescriptor(model);
+    std::cout << "Model: " << descriptor.name << " | Input: " << descriptor.input_size
+              << " | Frames: " << frames.size() << " | Iterations: " << iterations << std::endl;
+
+    cv::Mat reference;   // Output of the first engine, to check the others agree
+    for (auto& engine_case : cases) {
+        auto engine = createInferenceEngine(engine_case.config);
+        if (!engine) {
+            std::cout << engine_case.label << ": not available" << std::endl;
+            continue;
+        }
+
+        // Warm-up (graph compilation, allocations)
+        for (const auto& frame : frames) runDepthModel(*engine, descriptor, frame);
+
+        std::vector<double> times_ms;
+        times_ms.reserve(iterations);
+        for (int i = 0; i < iterations; ++i) {
+            const cv::Mat& frame = frames[i % frames.size()];
+            auto start_time = get_current_time_fenced();
+            runDepthModel(*engine, descriptor, frame);
+            auto end_time = get_current_time_fenced();
+            times_ms.push_back(static_cast<double>(to_mcs(end_time - start_time)) / 1000.0);
+        }
+
+        cv::Mat depth = runDepthModel(*engine, descriptor, frames[0]);
+        cv::normalize(depth, depth, 0, 1, cv::NORM_MINMAX);
+        double max_diff = 0.0;
+        if (reference.empty()) {
+            reference = depth;
+        } else {
+            max_diff = cv::norm(depth, reference, cv::NORM_INF);
+        }
+
+        double mean = std::accumulate(times_ms.begin(), times_ms.end(), 0.0) / static_cast<double>(times_ms.size());
+        std::cout << engine_case.label << " [" << engine->name() << "]"
+                  << " | Mean: " << mean << " ms"
+                  << " | Median: " << percentile(times_ms, 0.5) << " ms"
+                  << " | P95: " << percentile(times_ms, 0.95) << " ms"
+                  << " | FPS: " << 1000.0 / mean
+                  << " | Max diff vs first: " << max_diff << std::endl;
+    }
+
+    // Tiled inference as the pipeline runs it: latency against tiles per side
+    FramePyramid pyramid;
+    for (int tiles = 1; tiles <= 4; ++tiles) {
+        DepthEngineConfig config;
+        config.model = model;
+        config.tiles = tiles;
+        setDepthEngineConfig(config);
+
+        auto runTiled = [&](const cv::Mat& frame) {
+            pyramid.update(frame);
+            return depth_estimation(pyramid, cv::Rect(cv::Point(0, 0), frame.size()));
+        };
+        for (const auto& frame : frames) runTiled(frame);   // Loads the engines of the tile jobs
+
+        std::vector<double> times_ms;
+        for (int i = 0; i < iterations; ++i) {
+            auto start_time = get_current_time_fenced();
+            runTiled(frames[i % frames.size()]);
+            auto end_time = get_current_time_fenced();
+            times_ms.push_back(static_cast<double>(to_mcs(end_time - start_time)) / 1000.0);
+        }
+        std::cout << "tiled " << tiles << "x" << tiles << " (" << (tiles > 1 ? tiles * tiles + 1 : 1)
+                  << " inferences, " << cv::getNumThreads() << " threads)"
+                  << " | Median: " << percentile(times_ms, 0.5) << " ms"
+                  << " | P95: " << percentile(times_ms, 0.95) << " ms" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,561 @@
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include "depth_estimation.hpp"
+#include "feature_detector.hpp"
+#include "camera_model.hpp"
+#include "kalman.hpp"
+#include "drone_dynamics.hpp"
+#include "time_meas.hpp"
+
+// Microbenchmarks of the vision and dynamics kernels on seeded synthetic inputs:
+//   ./bin/bench_kernels [--kernels=nms,knn_eps,...] [--keypoints=100,1000,...] [--frames=480p,1080p,WxH,...]
+//                       [--tracks=10,100,...] [--seed=S] [--min-time=s] [--max-iteration-ms=ms] [--threads=N]
+//                       [--output=bench_kernels.json] [--baseline=previous.json] [--threshold=1.25]
+// Every kernel runs over its input sizes; a size is skipped when its iteration time, extrapolated
+// from the smaller sizes, exceeds --max-iteration-ms (the clustering kernels are quadratic).
+// The results are written as JSON with one result object per line. With --baseline the medians
+// are compared to a previous run, and the exit code is -1 if a kernel got slower than --threshold.
+
+struct KernelCase {
+    std::function<void()> setup;    // Untimed, before every iteration (may be empty)
+    std::function<double()> run;    // Timed; the result feeds the checksum
+};
+
+struct Kernel {
+    std::string name;
+    std::string unit;               // What the size counts
+    std::vector<long long> sizes;
+    std::function<KernelCase(long long size, unsigned seed)> make;
+};
+
+struct BenchResult {
+    std::string kernel, unit, label;
+    long long size = 0;
+    bool skipped = false;
+    int iterations = 0;
+    double mean_ns = 0, median_ns = 0, min_ns = 0, p90_ns = 0, max_ns = 0;
+    double scaling_exponent = NAN;  // d log(time) / d log(size) against the previous size
+    double checksum = 0;            // Of the first iteration; the same for the same seed
+};
+
+struct BenchOptions {
+    double min_time_s = 0.2;
+    double max_iteration_ms = 5000.0;
+    int min_iterations = 3;
+    int max_iterations = 100000;
+};
+
+static const std::map<std::string, cv::Size> FRAME_SIZES = {
+        {"480p", {640, 480}}, {"720p", {1280, 720}}, {"1080p", {1920, 1080}}, {"4k", {3840, 2160}}};
+
+// Frame sizes are passed to the kernels as width * 65536 + height
+static long long encodeFrameSize(const cv::Size& size) {
+    return static_cast<long long>(size.width) * 65536 + size.height;
+}
+
+static cv::Size decodeFrameSize(long long size) {
+    return {static_cast<int>(size / 65536), static_cast<int>(size % 65536)};
+}
+
+// Items processed per iteration, for throughput and scaling
+static double itemCount(const std::string& unit, long long size) {
+    return unit == "pixels" ? static_cast<double>(decodeFrameSize(size).area()) : static_cast<double>(size);
+}
+
+// ------ Synthetic inputs ------
+
+// FAST-like keypoints in a 1080p frame: 70% in blobs of ~140 points (textured obstacles), 30% uniform
+static std::vector<cv::KeyPoint> syntheticKeypoints(long long count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x_dist(0.0f, 1920.0f), y_dist(0.0f, 1080.0f), response(1.0f, 100.0f);
+    std::normal_distribution<float> spread(0.0f, 15.0f);
+
+    long long blob_count = std::max(4LL, count / 200);
+    std::vector<cv::Point2f> centers;
+    for (long long i = 0; i < blob_count; ++i) centers.emplace_back(x_dist(rng), y_dist(rng));
+
+    std::vector<cv::KeyPoint> keypoints;
+    keypoints.reserve(count);
+    for (long long i = 0; i < count; ++i) {
+        cv::Point2f point;
+        if (i % 10 < 7) {
+            const cv::Point2f& center = centers[i % blob_count];
+            point = {center.x + spread(rng), center.y + spread(rng)};
+        } else {
+            point = {x_dist(rng), y_dist(rng)};
+        }
+        keypoints.emplace_back(point, 7.0f, -1.0f, response(rng));
+    }
+    return keypoints;
+}
+
+static std::vector<cv::Point2f> syntheticPoints(long long count, unsigned seed) {
+    std::vector<cv::Point2f> points;
+    cv::KeyPoint::convert(syntheticKeypoints(count, seed), points);
+    return points;
+}
+
+// Smooth relative inverse depth at MiDaS small resolution
+static cv::Mat syntheticModelOutput(unsigned seed) {
+    cv::Mat coarse(16, 16, CV_32F), raw;
+    cv::RNG rng(seed);
+    rng.fill(coarse, cv::RNG::UNIFORM, 0.0f, 1000.0f);
+    cv::resize(coarse, raw, cv::Size(256, 256), 0, 0, cv::INTER_CUBIC);
+    return raw;
+}
+
+// Wide-angle lens calibrated at 1080p (strong barrel distortion)
+static CameraCalibration syntheticCalibration() {
+    CameraCalibration calibration;
+    calibration.camera_matrix = cv::Matx33d(1000, 0, 960, 0, 1000, 540, 0, 0, 1);
+    calibration.distortion = {-0.3, 0.1, 0.001, -0.001, -0.02};
+    calibration.image_size = cv::Size(1920, 1080);
+    return calibration;
+}
+
+// ------ Kernels ------
+
+static std::vector<Kernel> buildKernels(const std::vector<long long>& keypoint_counts,
+                                        const std::vector<long long>& frame_sizes,
+                                        const std::vector<long long>& track_counts) {
+    std::vector<Kernel> kernels;
+
+    kernels.push_back({"nms", "keypoints", keypoint_counts, [](long long size, unsigned seed) {
+        auto input = std::make_shared<std::vector<cv::KeyPoint>>(syntheticKeypoints(size, seed));
+        auto keypoints = std::make_shared<std::vector<cv::KeyPoint>>();
+        return KernelCase{[=] { *keypoints = *input; },
+                          [=] { applyNMS(*keypoints); return static_cast<double>(keypoints->size()); }};
+    }});
+
+    kernels.push_back({"knn_eps", "keypoints", keypoint_counts, [](long long size, unsigned seed) {
+        auto points = std::make_shared<std::vector<cv::Point2f>>(syntheticPoints(size, seed));
+        return KernelCase{{}, [=] { return static_cast<double>(determineEps(calculateKnnDistances(*points))); }};
+    }});
+
+    kernels.push_back({"cluster", "keypoints", keypoint_counts, [](long long size, unsigned seed) {
+        auto points = std::make_shared<std::vector<cv::Point2f>>(syntheticPoints(size, seed));
+        // eps for an average of 4 neighbours at uniform density; the kNN estimate is quadratic itself
+        float eps = std::sqrt(4.0f * 1920.0f * 1080.0f / (static_cast<float>(CV_PI) * static_cast<float>(size)));
+        auto clusters = std::make_shared<ClusterSet>();
+        return KernelCase{{}, [=] {
+            clusterPoints(*points, eps, 4, *clusters);
+            return static_cast<double>(clusters->points.size() + clusters->count());
+        }};
+    }});
+
+    // Undistortion of the keypoints only, against undistorting the whole frame with cv::remap
+    kernels.push_back({"undistort_points", "keypoints", keypoint_counts, [](long long size, unsigned seed) {
+        auto points = std::make_shared<std::vector<cv::Point2f>>(syntheticPoints(size, seed));
+        auto camera = std::make_shared<CameraModel>();
+        camera->configure(syntheticCalibration(), cv::Size(1920, 1080));
+        return KernelCase{{}, [=] {
+            double sum = 0;
+            for (const auto& point : *points) sum += camera->undistort(point).x;
+            return sum;
+        }};
+    }});
+
+    kernels.push_back({"undistort_frame", "pixels", frame_sizes, [](long long size, unsigned seed) {
+        cv::Size frame_size = decodeFrameSize(size);
+        auto frame = std::make_shared<cv::Mat>(frame_size, CV_8UC3);
+        cv::RNG rng(seed);
+        rng.fill(*frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+        CameraCalibration calibration = syntheticCalibration();
+        cv::Matx33d camera_matrix = calibration.camera_matrix;
+        for (int col = 0; col < 3; ++col) {
+            camera_matrix(0, col) *= static_cast<double>(frame_size.width) / calibration.image_size.width;
+            camera_matrix(1, col) *= static_cast<double>(frame_size.height) / calibration.image_size.height;
+        }
+        auto map_x = std::make_shared<cv::Mat>(), map_y = std::make_shared<cv::Mat>();
+        cv::initUndistortRectifyMap(camera_matrix, calibration.distortion, cv::noArray(), camera_matrix, frame_size,
+                                    CV_16SC2, *map_x, *map_y);
+        auto undistorted = std::make_shared<cv::Mat>();
+        return KernelCase{{}, [=] {
+            cv::remap(*frame, *undistorted, *map_x, *map_y, cv::INTER_LINEAR);
+            return static_cast<double>(undistorted->at<cv::Vec3b>(undistorted->rows / 2, undistorted->cols / 2)[0]);
+        }};
+    }});
+
+    kernels.push_back({"median_depth", "pixels", frame_sizes, [](long long size, unsigned seed) {
+        auto depth = std::make_shared<cv::Mat>(decodeFrameSize(size), CV_32F);
+        cv::RNG rng(seed);
+        rng.fill(*depth, cv::RNG::UNIFORM, 0.0f, 8.0f);
+        return KernelCase{{}, [=] { return static_cast<double>(getMedianDepth(*depth)); }};
+    }});
+
+    // Frame views shared by the stages: gray for FAST/BRIEF, the flow pyramid and the depth model input
+    kernels.push_back({"frame_views", "pixels", frame_sizes, [](long long size, unsigned seed) {
+        auto frame = std::make_shared<cv::Mat>(decodeFrameSize(size), CV_8UC3);
+        cv::RNG rng(seed);
+        rng.fill(*frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+        auto pyramid = std::make_shared<FramePyramid>();
+        auto blob = std::make_shared<cv::Mat>();
+        const ModelDescriptor& model = getModelDescriptor(DepthModel::MIDAS_SMALL);
+        return KernelCase{{}, [=, &model] {
+            pyramid->update(*frame);
+            double checksum = cv::sum(pyramid->gray())[0] + static_cast<double>(pyramid->grayPyramid().size());
+            preprocessResizedInput(pyramid->resized(cv::Rect(cv::Point(0, 0), frame->size()), model.input_size),
+                                   model, *blob);
+            return checksum + static_cast<double>(blob->ptr<float>()[0]);
+        }};
+    }});
+
+    kernels.push_back({"depth_postprocess", "pixels", frame_sizes, [](long long size, unsigned seed) {
+        auto raw = std::make_shared<cv::Mat>(syntheticModelOutput(seed));
+        auto filtered = std::make_shared<cv::Mat>();
+        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE();
+        clahe->setClipLimit(4.0);
+        cv::Size frame_size = decodeFrameSize(size);
+        return KernelCase{{}, [=] {
+            filterDepthMap(colorizeDepth(*raw, frame_size), *clahe, *filtered);
+            return cv::sum(*filtered)[0];
+        }};
+    }});
+
+    // One predict + update of every track per iteration, as processFrame does per frame
+    auto filterKernel = [](auto filter_tag) {
+        using Filter = decltype(filter_tag);
+        return [](long long size, unsigned seed) {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> position(0.0f, 1920.0f);
+            std::normal_distribution<float> noise(0.0f, 2.0f);
+            auto filters = std::make_shared<std::vector<Filter>>();
+            auto measurements = std::make_shared<std::vector<cv::Point2f>>();
+            for (long long i = 0; i < size; ++i) {
+                float x = position(rng), y = position(rng);
+                filters->emplace_back(x, y);
+                measurements->emplace_back(x + noise(rng), y + noise(rng));
+            }
+            return KernelCase{{}, [=] {
+                double sum = 0;
+                for (size_t i = 0; i < filters->size(); ++i) {
+                    Filter& filter = (*filters)[i];
+                    filter.predict(1.0f / 30);
+                    filter.update((*measurements)[i].x, (*measurements)[i].y);
+                    sum += filter.state(0);
+                }
+                return sum;
+            }};
+        };
+    };
+    kernels.push_back({"kalman", "tracks", track_counts, filterKernel(KalmanFilter())});
+    kernels.push_back({"ekf", "tracks", track_counts, filterKernel(ExtendedKalmanFilter())});
+
+    kernels.push_back({"simulate_step", "drones", track_counts, [](long long size, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+        auto states = std::make_shared<std::vector<DroneState>>(size);
+        auto targets = std::make_shared<std::vector<Vector3>>(size);
+        for (long long i = 0; i < size; ++i) {
+            (*states)[i] = {{coordinate(rng), coordinate(rng), coordinate(rng)}, {0.0f, 0.0f, 0.0f}};
+            (*targets)[i] = {coordinate(rng), coordinate(rng), coordinate(rng)};
+        }
+        return KernelCase{{}, [=] {
+            double sum = 0;
+            for (size_t i = 0; i < states->size(); ++i) {
+                DroneState& state = (*states)[i];
+                SimulateStep(&state, &(*targets)[i], 0.02f, 100.0f, 1.0f, 0.1f, 20.0f, 8.0f, &state);
+                sum += state.pos.x;
+            }
+            return sum;
+        }};
+    }});
+
+    return kernels;
+}
+
+// ------ Measurement ------
+
+static BenchResult measure(const Kernel& kernel, long long size, unsigned seed, const BenchOptions& options) {
+    BenchResult result;
+    result.kernel = kernel.name;
+    result.unit = kernel.unit;
+    result.size = size;
+
+    // Independent of the kernel selection: every case derives its inputs from the seed and the size
+    KernelCase bench_case = kernel.make(size, seed ^ static_cast<unsigned>(size * 2654435761ULL));
+
+    std::vector<double> times_ns;
+    double total_ns = 0;
+    while (times_ns.size() < static_cast<size_t>(options.max_iterations) &&
+           (times_ns.size() < static_cast<size_t>(options.min_iterations) || total_ns < options.min_time_s * 1e9)) {
+        if (bench_case.setup) bench_case.setup();
+        auto start_time = get_current_time_fenced();
+        double value = bench_case.run();
+        auto elapsed_ns = static_cast<double>(to_ns(get_current_time_fenced() - start_time));
+
+        if (times_ns.empty()) result.checksum = value;
+        times_ns.push_back(elapsed_ns);
+        total_ns += elapsed_ns;
+
+        // Slow sizes get a single iteration
+        if (elapsed_ns > options.max_iteration_ms * 1e6) break;
+    }
+
+    std::vector<double> sorted = times_ns;
+    std::sort(sorted.begin(), sorted.end());
+    result.iterations = static_cast<int>(sorted.size());
+    result.mean_ns = total_ns / static_cast<double>(sorted.size());
+    result.median_ns = sorted[sorted.size() / 2];
+    result.min_ns = sorted.front();
+    result.p90_ns = sorted[static_cast<size_t>(0.9 * static_cast<double>(sorted.size() - 1))];
+    result.max_ns = sorted.back();
+    return result;
+}
+
+// ------ Output ------
+
+static std::string sizeLabel(const Kernel& kernel, long long size) {
+    if (kernel.unit != "pixels") return std::to_string(size);
+    cv::Size frame_size = decodeFrameSize(size);
+    for (const auto& [name, known] : FRAME_SIZES) {
+        if (known == frame_size) return name;
+    }
+    return std::to_string(frame_size.width) + "x" + std::to_string(frame_size.height);
+}
+
+static std::string jsonNumber(double value) {
+    if (!std::isfinite(value)) return "null";
+    std::ostringstream text;
+    text << std::setprecision(10) << value;
+    return text.str();
+}
+
+static std::string toJson(const BenchResult& result) {
+    std::ostringstream json;
+    json << "{\"kernel\": \"" << result.kernel << "\", \"unit\": \"" << result.unit << "\", \"label\": \""
+         << result.label << "\", \"size\": " << result.size;
+    if (result.skipped) {
+        json << ", \"skipped\": true}";
+        return json.str();
+    }
+    double items = itemCount(result.unit, result.size);
+    json << ", \"iterations\": " << result.iterations
+         << ", \"mean_ns\": " << jsonNumber(result.mean_ns)
+         << ", \"median_ns\": " << jsonNumber(result.median_ns)
+         << ", \"min_ns\": " << jsonNumber(result.min_ns)
+         << ", \"p90_ns\": " << jsonNumber(result.p90_ns)
+         << ", \"max_ns\": " << jsonNumber(result.max_ns)
+         << ", \"items_per_s\": " << jsonNumber(items / result.median_ns * 1e9)
+         << ", \"scaling_exponent\": " << jsonNumber(result.scaling_exponent)
+         << ", \"checksum\": " << jsonNumber(result.checksum) << "}";
+    return json.str();
+}
+
+static bool writeJson(const std::string& path, const std::vector<BenchResult>& results, unsigned seed,
+                      const BenchOptions& options) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    file << "{\n  \"benchmark\": \"bench_kernels\",\n  \"seed\": " << seed
+         << ",\n  \"min_time_s\": " << options.min_time_s
+         << ",\n  \"opencv_threads\": " << cv::getNumThreads() << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        file << "    " << toJson(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return true;
+}
+
+// Value of a field in a one-line JSON object written by toJson
+static std::string jsonField(const std::string& line, const std::string& field) {
+    std::string key = "\"" + field + "\": ";
+    size_t start = line.find(key);
+    if (start == std::string::npos) return "";
+    start += key.size();
+    if (line[start] == '"') {
+        size_t end = line.find('"', start + 1);
+        return line.substr(start + 1, end - start - 1);
+    }
+    size_t end = line.find_first_of(",}", start);
+    return line.substr(start, end - start);
+}
+
+// Median times of a previous run by "kernel/size"
+static bool loadBaseline(const std::string& path, std::map<std::string, double>& medians) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string median = jsonField(line, "median_ns");
+        if (median.empty() || median == "null") continue;
+        medians[jsonField(line, "kernel") + "/" + jsonField(line, "size")] = std::stod(median);
+    }
+    return true;
+}
+
+static bool parseList(const std::string& text, const std::function<bool(const std::string&)>& add) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || !add(item)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<long long> keypoint_counts = {100, 300, 1000, 3000, 10000, 30000, 100000};
+    std::vector<long long> frame_sizes;
+    for (const char* name : {"480p", "720p", "1080p", "4k"}) frame_sizes.push_back(encodeFrameSize(FRAME_SIZES.at(name)));
+    std::vector<long long> track_counts = {10, 100, 1000, 10000};
+    std::vector<std::string> selected;
+
+    BenchOptions options;
+    unsigned seed = 42;
+    int num_threads = -1;
+    double threshold = 1.25;
+    std::string output_path = "bench_kernels.json", baseline_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+        auto addCount = [](std::vector<long long>& list) {
+            list.clear();
+            return [target = &list](const std::string& item) {
+                target->push_back(std::stoll(item));
+                return target->back() > 0;
+            };
+        };
+
+        bool ok = true;
+        try {
+            if (hasOption("--kernels=")) {
+                ok = parseList(value("--kernels="), [&](const std::string& name) {
+                    selected.push_back(name);
+                    return true;
+                });
+            }
+            else if (hasOption("--keypoints=")) ok = parseList(value("--keypoints="), addCount(keypoint_counts));
+            else if (hasOption("--tracks=")) ok = parseList(value("--tracks="), addCount(track_counts));
+            else if (hasOption("--frames=")) {
+                frame_sizes.clear();
+                ok = parseList(value("--frames="), [&](const std::string& name) {
+                    auto known = FRAME_SIZES.find(name);
+                    cv::Size size;
+                    if (known != FRAME_SIZES.end()) {
+                        size = known->second;
+                    } else {
+                        size_t x = name.find('x');
+                        if (x == std::string::npos) return false;
+                        size = {std::stoi(name.substr(0, x)), std::stoi(name.substr(x + 1))};
+                    }
+                    frame_sizes.push_back(encodeFrameSize(size));
+                    return size.width > 0 && size.height > 0 && size.height < 65536;
+                });
+            }
+            else if (hasOption("--seed=")) seed = static_cast<unsigned>(std::stoul(value("--seed=")));
+            else if (hasOption("--min-time=")) options.min_time_s = std::stod(value("--min-time="));
+            else if (hasOption("--max-iteration-ms=")) options.max_iteration_ms = std::stod(value("--max-iteration-ms="));
+            else if (hasOption("--threads=")) num_threads = std::stoi(value("--threads="));
+            else if (hasOption("--output=")) output_path = value("--output=");
+            else if (hasOption("--baseline=")) baseline_path = value("--baseline=");
+            else if (hasOption("--threshold=")) threshold = std::stod(value("--threshold="));
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if (num_threads >= 0) cv::setNumThreads(num_threads);
+
+    std::map<std::string, double> baseline;
+    if (!baseline_path.empty() && !loadBaseline(baseline_path, baseline)) return -1;
+
+    std::vector<Kernel> kernels = buildKernels(keypoint_counts, frame_sizes, track_counts);
+    for (const auto& name : selected) {
+        if (std::none_of(kernels.begin(), kernels.end(), [&](const Kernel& k) { return k.name == name; })) {
+            std::cerr << "Unknown kernel: " << name << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << "Seed: " << seed << " | Min time per case: " << options.min_time_s << " s | OpenCV threads: "
+              << cv::getNumThreads() << std::endl;
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (const auto& kernel : kernels) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), kernel.name) == selected.end()) continue;
+
+        std::vector<long long> sizes = kernel.sizes;
+        std::sort(sizes.begin(), sizes.end(), [&](long long a, long long b) {
+            return itemCount(kernel.unit, a) < itemCount(kernel.unit, b);
+        });
+
+        const BenchResult* previous = nullptr;
+        double exponent = 1.0;      // Assumed until two sizes are measured
+        for (long long size : sizes) {
+            double items = itemCount(kernel.unit, size);
+
+            BenchResult result;
+            if (previous) {
+                double predicted_ms = previous->median_ns / 1e6 *
+                                      std::pow(items / itemCount(kernel.unit, previous->size), exponent);
+                result.skipped = previous->skipped || predicted_ms > options.max_iteration_ms;
+            }
+
+            if (result.skipped) {
+                result.kernel = kernel.name;
+                result.unit = kernel.unit;
+                result.size = size;
+            } else {
+                result = measure(kernel, size, seed, options);
+                if (previous) {
+                    result.scaling_exponent = std::log(result.median_ns / previous->median_ns) /
+                                              std::log(items / itemCount(kernel.unit, previous->size));
+                    exponent = std::max(1.0, result.scaling_exponent);
+                }
+            }
+            result.label = sizeLabel(kernel, size);
+
+            std::cout << kernel.name << " | " << result.label << " " << kernel.unit;
+            if (result.skipped) {
+                std::cout << " | skipped (over " << options.max_iteration_ms << " ms per iteration)" << std::endl;
+            } else {
+                std::cout << " | median " << result.median_ns / 1e6 << " ms | p90 " << result.p90_ns / 1e6
+                          << " ms | " << items / result.median_ns * 1e9 << " " << kernel.unit << "/s";
+                if (std::isfinite(result.scaling_exponent)) std::cout << " | exponent " << result.scaling_exponent;
+
+                auto reference = baseline.find(kernel.name + "/" + std::to_string(size));
+                if (reference != baseline.end()) {
+                    double ratio = result.median_ns / reference->second;
+                    std::cout << " | " << ratio << "x baseline";
+                    if (ratio > threshold) {
+                        std::cout << " REGRESSION";
+                        regressions++;
+                    }
+                }
+                std::cout << std::endl;
+            }
+
+            results.push_back(result);
+            previous = &results.back();
+        }
+    }
+
+    if (!writeJson(output_path, results, seed, options)) return -1;
+    std::cout << "Results saved to " << output_path << std::endl;
+
+    if (regressions > 0) {
+        std::cout << regressions << " case(s) slower than " << threshold << "x the baseline" << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <tuple>
+#include "golden_results.hpp"
+
+// Search thread layouts for the lowest end-to-end frame latency:
+//   ./bin/bench_thread_layout [video] [--frames=N] [--warmup=N] [--layout=...]... [--io-load]
+//                             [--engine=...] [--model=...] [--depth-tiles=N]
+// Without --layout the candidates come from the available cores: depth inference on the first k
+// cores, the pipeline thread on the next core or sharing the depth cores, and I/O on the last core.
+// The unpinned default is always included. Every layout processes the same in-memory frames at fixed
+// quality. --io-load adds a thread on the I/O cores that JPEG-encodes frames like the image server's
+// recorder. Layouts are ranked by p99 frame latency, since the spikes are what hurts, and the best
+// one is printed as a --thread-layout option.
+
+struct LayoutResult {
+    ThreadLayout layout;
+    LatencySummary latency;
+};
+
+static std::vector<cv::Mat> loadFrames(const std::string& video_path, int count) {
+    std::vector<cv::Mat> frames;
+    std::unique_ptr<FrameSource> source = openFrameSource(video_path);
+    BorrowedFrame frame;
+    while (source && static_cast<int>(frames.size()) < count && source->read(frame)) {
+        frames.push_back(frame.image.clone());
+    }
+    return frames;
+}
+
+static std::vector<ThreadLayout> candidateLayouts(const std::vector<int>& cores) {
+    std::vector<ThreadLayout> layouts(1);   // Unpinned
+    int count = static_cast<int>(cores.size());
+    int io = count >= 4 ? 1 : 0;
+    for (int depth = 1; depth + io <= count; ++depth) {
+        // Powers of two and the largest size keep the search short on many-core machines
+        bool largest = depth + io == count || depth + io + 1 == count;
+        if (!largest && (depth & (depth - 1)) != 0) continue;
+
+        ThreadLayout layout;
+        layout.depth.assign(cores.begin(), cores.begin() + depth);
+        if (io) layout.io.assign(cores.end() - 1, cores.end());
+
+        // Pipeline thread on the depth cores, where it also takes part in OpenCV DNN's work
+        layout.pipeline = layout.depth;
+        layouts.push_back(layout);
+
+        // Pipeline thread on its own core
+        if (depth + io + 1 <= count) {
+            layout.pipeline.assign(cores.begin() + depth, cores.begin() + depth + 1);
+            layouts.push_back(layout);
+        }
+    }
+    return layouts;
+}
+
+static LatencySummary runLayout(const ThreadLayout& layout, const DepthEngineConfig& depth_config,
+                                const std::vector<cv::Mat>& frames, int warmup, bool io_load) {
+    setThreadLayout(layout);
+    setDepthEngineConfig(depth_config);   // Reloads the engines with threads on the depth cores
+    enterThreadRole(ThreadRole::PIPELINE);
+
+    std::atomic<bool> running{true};
+    std::thread io_thread;
+    if (io_load) {
+        io_thread = std::thread([&] {
+            enterThreadRole(ThreadRole::IO);
+            std::vector<uchar> jpeg;
+            for (size_t i = 0; running; ++i) cv::imencode(".jpg", frames[i % frames.size()], jpeg);
+        });
+    }
+
+    PipelineContext context;
+    context.quality.display = false;
+    std::vector<FrameResult> results;
+    cv::Mat frame;
+    for (int i = 0; i < warmup + static_cast<int>(frames.size()); ++i) {
+        frames[i % frames.size()].copyTo(frame);   // processFrame draws onto the frame
+        FrameResult result;
+        result.frame_index = i;
+        processFrame(context, frame, result);
+        if (i >= warmup) results.push_back(std::move(result));
+    }
+
+    running = false;
+    if (io_thread.joinable()) io_thread.join();
+    return summarizeLatency(results);
+}
+
+int main(int argc, char** argv) {
+    std::string video_path = getContentPath("helicopter.mp4");
+    int frame_count = 120, warmup = 10;
+    bool io_load = false;
+    std::vector<ThreadLayout> layouts;
+    DepthEngineConfig depth_config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (arg == "--io-load") io_load = true;
+            else if (hasOption("--frames=")) frame_count = std::stoi(value("--frames="));
+            else if (hasOption("--warmup=")) warmup = std::stoi(value("--warmup="));
+            else if (hasOption("--layout=")) {
+                ThreadLayout layout;
+                ok = parseThreadLayout(value("--layout="), layout);
+                layouts.push_back(layout);
+            }
+            else if (hasOption("--engine=")) ok = parseInferenceBackend(value("--engine="), depth_config.backend);
+            else if (hasOption("--model=")) ok = parseDepthModel(value("--model="), depth_config.model);
+            else if (hasOption("--depth-tiles=")) depth_config.tiles = std::stoi(value("--depth-tiles="));
+            else if (!hasOption("--")) {
+                video_path = fs::exists(arg) || arg.find(':') != std::string::npos ? arg : getContentPath(arg);
+            }
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<cv::Mat> frames = loadFrames(video_path, frame_count);
+    if (frames.empty()) {
+        std::cerr << "Error: Could not read frames from " << video_path << std::endl;
+        return -1;
+    }
+    if (layouts.empty()) layouts = candidateLayouts(processCores());
+
+    std::cout << "Frames: " << frames.size() << " | Cores: " << formatCoreList(processCores())
+              << " | Layouts: " << layouts.size() << (io_load ? " | I/O load" : "") << std::endl;
+
+    std::vector<LayoutResult> results;
+    for (const auto& layout : layouts) {
+        LatencySummary latency = runLayout(layout, depth_config, frames, warmup, io_load);
+        const LatencyPercentiles& frame_latency = latency.stages[STAGE_COUNT];
+        std::cout << "  " << std::left << std::setw(40) << formatThreadLayout(layout) << std::right << std::fixed
+                  << std::setprecision(2) << " p50 " << frame_latency.p50 / 1000.0 << " ms | p99 "
+                  << frame_latency.p99 / 1000.0 << " ms | max " << frame_latency.max / 1000.0 << " ms" << std::endl;
+        results.push_back({layout, latency});
+    }
+
+    // Spikes decide, the median breaks ties
+    std::sort(results.begin(), results.end(), [](const LayoutResult& a, const LayoutResult& b) {
+        const LatencyPercentiles& first = a.latency.stages[STAGE_COUNT];
+        const LatencyPercentiles& second = b.latency.stages[STAGE_COUNT];
+        return std::tie(first.p99, first.p50) < std::tie(second.p99, second.p50);
+    });
+
+    std::cout << "Ranking by p99 frame latency [ms]:" << std::endl;
+    std::cout << "  " << std::left << std::setw(40) << "layout" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "depth p50" << std::endl;
+    for (const auto& result : results) {
+        const LatencyPercentiles& frame_latency = result.latency.stages[STAGE_COUNT];
+        std::cout << "  " << std::setw(40) << formatThreadLayout(result.layout) << std::setw(10)
+                  << frame_latency.p50 / 1000.0 << std::setw(10) << frame_latency.p90 / 1000.0 << std::setw(10)
+                  << frame_latency.p99 / 1000.0 << std::setw(10) << result.latency.stages[STAGE_DEPTH].p50 / 1000.0
+                  << std::endl;
+    }
+    std::cout << "Best: --thread-layout=\"" << formatThreadLayout(results.front().layout) << "\"" << std::endl;
+
+    // Leave the process unpinned
+    setThreadLayout(ThreadLayout());
+    return 0;
+}
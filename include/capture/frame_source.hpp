@@ -0,0 +1,264 @@
+#ifndef DRONE_NAVIGATION_FRAME_SOURCE_HPP
+#define DRONE_NAVIGATION_FRAME_SOURCE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "frame_shm.h"
+
+class FrameSource;
+
+/**
+ * Frame lent by a FrameSource. `image` points into the source's buffers (a pool
+ * buffer, a V4L2 mmap buffer or a shared-memory slot) and stays valid until the
+ * frame is released or destroyed; the buffer then goes back to the source.
+ * The buffer may be shared with a producer or a driver, so the image is read-only:
+ * copy it before drawing on it. Sources must outlive their frames.
+ */
+class BorrowedFrame {
+public:
+    BorrowedFrame() = default;
+    ~BorrowedFrame() { release(); }
+
+    BorrowedFrame(const BorrowedFrame&) = delete;
+    BorrowedFrame& operator=(const BorrowedFrame&) = delete;
+    BorrowedFrame(BorrowedFrame&& other) noexcept;
+    BorrowedFrame& operator=(BorrowedFrame&& other) noexcept;
+
+    // Return the buffer to the source, `image` becomes empty
+    void release();
+
+    [[nodiscard]] bool empty() const { return image.empty(); }
+
+    cv::Mat image;              // BGR (CV_8UC3) view of the source buffer
+    uint64_t sequence = 0;      // Frame number of the source; gaps mean dropped frames
+    int64_t timestamp_ns = 0;   // Capture time: CLOCK_MONOTONIC for live sources, media time for files
+
+private:
+    friend class FrameSource;
+    FrameSource* source = nullptr;
+    int token = -1;             // Identifies the source buffer, defined by the source
+};
+
+/**
+ * Source of camera frames for the pipeline. read() lends the next frame out of the
+ * source's own buffers, so no frame is copied between the source and the pipeline.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    [[nodiscard]] virtual bool isOpened() const = 0;
+
+    /**
+     * Borrow the next frame, blocking until one is available. A frame still held in
+     * `frame` is released first.
+     *
+     * @param frame Output frame.
+     * @return false at the end of the stream or on errors.
+     */
+    virtual bool read(BorrowedFrame& frame) = 0;
+
+    // Nominal frame rate, 0 if unknown
+    [[nodiscard]] virtual double fps() const = 0;
+
+    // Live sources deliver frames at the capture rate, files as fast as they are read
+    [[nodiscard]] virtual bool isLive() const = 0;
+
+    [[nodiscard]] virtual cv::Size frameSize() const = 0;
+
+protected:
+    friend class BorrowedFrame;
+
+    // Called once for every lent frame when it is released, possibly from another thread
+    virtual void recycle(int token) = 0;
+
+    void lend(BorrowedFrame& frame, const cv::Mat& image, int token, uint64_t sequence, int64_t timestamp_ns);
+};
+
+/**
+ * Reusable frame buffers of a source. A buffer is allocated the first time all others
+ * are borrowed, and keeps its allocation while the frame size stays the same.
+ */
+class FramePool {
+public:
+    // Index of a free buffer, marked as in use
+    int acquire();
+
+    cv::Mat& buffer(int index) { return buffers[index]; }
+
+    void release(int index);
+
+private:
+    std::mutex mutex;
+    std::vector<cv::Mat> buffers;
+    std::vector<char> in_use;
+};
+
+// Video file or camera decoded by cv::VideoCapture into pooled buffers
+class VideoCaptureSource : public FrameSource {
+public:
+    explicit VideoCaptureSource(const std::string& path);
+    explicit VideoCaptureSource(int device);
+
+    [[nodiscard]] bool isOpened() const override { return capture.isOpened(); }
+    bool read(BorrowedFrame& frame) override;
+    [[nodiscard]] double fps() const override;
+    [[nodiscard]] bool isLive() const override { return live; }
+    [[nodiscard]] cv::Size frameSize() const override;
+
+protected:
+    void recycle(int token) override { pool.release(token); }
+
+private:
+    cv::VideoCapture capture;
+    FramePool pool;
+    bool live;                  // Camera: timestamps from the monotonic clock instead of the media position
+    uint64_t next_sequence = 0;
+};
+
+// Sorted image files of a directory (png, jpg, bmp, tiff), decoded into pooled buffers
+class ImageDirectorySource : public FrameSource {
+public:
+    /**
+     * @param directory Directory with the frames, read in file name order.
+     * @param fps Frame rate used for the timestamps.
+     */
+    explicit ImageDirectorySource(const std::string& directory, double fps = 30.0);
+
+    [[nodiscard]] bool isOpened() const override { return !files.empty(); }
+    bool read(BorrowedFrame& frame) override;
+    [[nodiscard]] double fps() const override { return frame_rate; }
+    [[nodiscard]] bool isLive() const override { return false; }
+    [[nodiscard]] cv::Size frameSize() const override { return first_size; }
+
+protected:
+    void recycle(int token) override { pool.release(token); }
+
+private:
+    std::vector<std::string> files;
+    size_t next_file = 0;
+    double frame_rate;
+    cv::Size first_size;
+    FramePool pool;
+};
+
+#ifdef __linux__
+/**
+ * V4L2 camera with memory-mapped driver buffers. BGR24 frames are lent straight from
+ * the mmap buffers and queued back to the driver on release; YUYV and MJPEG frames
+ * are converted into pooled buffers and the driver buffer is requeued immediately.
+ */
+class V4L2Source : public FrameSource {
+public:
+    /**
+     * @param device Device node, e.g. /dev/video0.
+     * @param size Requested frame size, the driver may pick the closest one.
+     * @param fps Requested frame rate, 0 = driver default.
+     */
+    explicit V4L2Source(const std::string& device, cv::Size size = cv::Size(640, 480), double fps = 30.0);
+    ~V4L2Source() override;
+
+    [[nodiscard]] bool isOpened() const override { return fd >= 0; }
+    bool read(BorrowedFrame& frame) override;
+    [[nodiscard]] double fps() const override { return frame_rate; }
+    [[nodiscard]] bool isLive() const override { return true; }
+    [[nodiscard]] cv::Size frameSize() const override { return size; }
+
+protected:
+    void recycle(int token) override;
+
+private:
+    struct MappedBuffer {
+        void* data = nullptr;
+        size_t length = 0;
+    };
+
+    void close();
+
+    int fd = -1;
+    uint32_t pixel_format = 0;
+    cv::Size size;
+    size_t bytes_per_line = 0;
+    double frame_rate = 0.0;
+    std::vector<MappedBuffer> buffers;
+    FramePool pool;
+    std::mutex queue_mutex;     // recycle() may run on another thread
+};
+#endif
+
+/**
+ * Consumer of the shared-memory frame ring (frame_shm.h). BGR24 slots are lent in
+ * place and handed back to the producer on release; RGB24 slots are converted into
+ * pooled buffers and handed back immediately. A restarted producer creates a new
+ * ring under the same name; read() maps it while it waits for a frame, as soon as
+ * no slot of the old ring is lent, and continues with the new ring's oldest frame.
+ */
+class SharedMemorySource : public FrameSource {
+public:
+    /**
+     * @param name POSIX shared-memory name of the ring.
+     * @param timeout_ms read() gives up after this long without a new frame.
+     * @param latest_only Skip to the newest published frame instead of reading every frame.
+     */
+    explicit SharedMemorySource(const std::string& name = FRAME_SHM_DEFAULT_NAME, int timeout_ms = 5000,
+                                bool latest_only = true);
+    ~SharedMemorySource() override;
+
+    [[nodiscard]] bool isOpened() const override { return header != nullptr; }
+    bool read(BorrowedFrame& frame) override;
+    [[nodiscard]] double fps() const override { return 0.0; }
+    [[nodiscard]] bool isLive() const override { return true; }
+    [[nodiscard]] cv::Size frameSize() const override;
+
+    // Frames the producer dropped because the pipeline held every slot
+    [[nodiscard]] uint64_t producerDrops() const;
+
+    // Frames skipped by latest_only
+    [[nodiscard]] uint64_t skippedFrames() const { return skipped; }
+
+protected:
+    void recycle(int token) override;
+
+private:
+    // Mark slot `index` as released and give the released prefix back to the producer
+    void releaseSlot(uint64_t index);
+
+    // Use a freshly mapped ring and start at its oldest frame
+    void attach(FrameShmHeader* ring, size_t ring_size, uint64_t ring_inode);
+
+    // Switch to the ring of a restarted producer; true if the ring changed
+    bool remapIfRestarted();
+
+    std::string name;
+    uint64_t inode = 0;         // Identifies the mapped object, a restarted producer creates a new one
+    size_t size = 0;
+    FrameShmHeader* header = nullptr;
+    uint8_t* slots = nullptr;
+    int timeout_ms;
+    bool latest_only;
+    uint64_t next_index = 0;    // Next frame to read
+    uint64_t skipped = 0;
+    std::vector<char> released; // Per slot, released out of order
+    int lent = 0;               // Slots currently lent as frames
+    FramePool pool;
+    std::mutex release_mutex;
+};
+
+/**
+ * Open a frame source from a URI:
+ *   shm:[/name]          shared-memory ring (default FRAME_SHM_DEFAULT_NAME)
+ *   v4l2:/dev/videoN     V4L2 camera (Linux), /dev/videoN works as well
+ *   camera:N             camera N, V4L2 on Linux and cv::VideoCapture elsewhere
+ *   <directory>          image sequence
+ *   <file>               video file
+ *
+ * @param uri Source description.
+ * @return Opened source, nullptr if it could not be opened.
+ */
+std::unique_ptr<FrameSource> openFrameSource(const std::string& uri);
+
+#endif //DRONE_NAVIGATION_FRAME_SOURCE_HPP
@@ -7,15 +7,99 @@
 #include <numeric>
 #include "time_meas.hpp"
 #include "path_utils.hpp"
+#include "inference_engine.hpp"
+#include "frame_pyramid.hpp"
 
 /**
- * Perform monocular depth estimation.
+ * Select the inference engine and depth model used by depth_estimation().
+ * Engines are shared by all threads through a pool: every inference leases one, and a
+ * new engine is only loaded while all others are in use, so the pool holds as many
+ * engines as inferences ran at the same time. Calls pick up a new configuration on
+ * their next inference, and engines of the previous one are dropped.
+ *
+ * @param config Engine selection.
+ */
+void setDepthEngineConfig(const DepthEngineConfig& config);
+
+DepthEngineConfig getDepthEngineConfig();
+
+/**
+ * Run a depth model on a frame without any post-processing.
+ *
+ * @param engine Inference engine.
+ * @param model Descriptor of the model loaded by the engine.
+ * @param frame Input frame from the camera.
+ * @return Relative inverse depth at model resolution (CV_32F).
+ */
+cv::Mat runDepthModel(InferenceEngine& engine, const ModelDescriptor& model, const cv::Mat& frame);
+
+/**
+ * Perform monocular depth estimation with the configured engine and model.
  *
  * @param frame Input frame from the camera.
  * @return Depth map of the input frame.
  */
 cv::Mat depth_estimation(cv::Mat frame);
 
+/**
+ * Depth estimation of a frame region, taking the model input from the frame's shared
+ * pyramid instead of resizing the frame again. With more than one tile per side configured,
+ * the region is also split into overlapping tiles at model resolution, which run in parallel
+ * together with the whole-region pass and are blended into a higher-resolution map (see
+ * blendDepthTiles()). The jobs lease engines from the shared pool, so a pipeline loads at most
+ * N * N + 1 engines however many worker threads OpenCV runs.
+ *
+ * @param pyramid Images of the current frame.
+ * @param region Region in frame coordinates.
+ * @return Depth map of the region, same format as depth_estimation().
+ */
+cv::Mat depth_estimation(FramePyramid& pyramid, const cv::Rect& region);
+
+/**
+ * Split a region into overlapping tiles for tiled depth inference.
+ *
+ * @param size Region size.
+ * @param tiles_per_side Tiles along each axis.
+ * @return Row-major tiles in region coordinates, covering the whole region.
+ */
+std::vector<cv::Rect> depthTiles(const cv::Size& size, int tiles_per_side);
+
+/**
+ * Blend tile depth maps into one seamless map. Each tile is aligned to the whole-region
+ * depth with a least-squares scale and shift (the model output is only relative), then the
+ * tiles are feathered with linear weights across their overlaps.
+ *
+ * @param coarse Relative inverse depth of the whole region (CV_32F, any resolution).
+ * @param tiles Tiles in region coordinates, as returned by depthTiles().
+ * @param tile_depths Relative inverse depth of each tile (CV_32F, any resolution).
+ * @param region_size Region size.
+ * @param output_size Size of the blended map.
+ * @return Blended relative inverse depth (CV_32F).
+ */
+cv::Mat blendDepthTiles(const cv::Mat& coarse, const std::vector<cv::Rect>& tiles,
+                        const std::vector<cv::Mat>& tile_depths, const cv::Size& region_size,
+                        const cv::Size& output_size);
+
+/**
+ * Post-process a raw model output into the depth map returned by depth_estimation():
+ * min-max normalisation, resize to the frame and INFERNO colour map.
+ *
+ * @param raw_depth Relative inverse depth at model resolution (CV_32F).
+ * @param frame_size Size of the camera frame.
+ * @return Colour-mapped depth map (CV_8UC3).
+ */
+cv::Mat colorizeDepth(const cv::Mat& raw_depth, const cv::Size& frame_size);
+
+/**
+ * Filter a colour-mapped depth map for keypoint filtering: grayscale, CLAHE to enhance
+ * local contrast, bilateral filter to reduce noise while preserving edges.
+ *
+ * @param colored_depth Depth map from depth_estimation() (CV_8UC3).
+ * @param clahe Contrast-limited histogram equalization.
+ * @param filtered Output depth (CV_32F, larger is closer); may be a view into a larger map.
+ */
+void filterDepthMap(const cv::Mat& colored_depth, cv::CLAHE& clahe, cv::Mat& filtered);
+
 /**
  * Extract contours from a frame.
  *
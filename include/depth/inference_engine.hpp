@@ -0,0 +1,127 @@
+#ifndef DRONE_NAVIGATION_INFERENCE_ENGINE_HPP
+#define DRONE_NAVIGATION_INFERENCE_ENGINE_HPP
+
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+
+// Supported depth models
+enum class DepthModel {
+    MIDAS_SMALL,         // MiDaS v2.1 small
+    MIDAS_HYBRID,        // MiDaS v3 DPT hybrid
+    DEPTH_ANYTHING_V2    // Depth-Anything v2 ViT-S
+};
+
+// Inference engines, ONNX Runtime and OpenVINO are optional at build time
+enum class InferenceBackend {
+    OPENCV_DNN,
+    ONNX_RUNTIME,
+    OPENVINO
+};
+
+// Layout of the model output tensor
+enum class OutputLayout {
+    NHW,     // [1, H, W]
+    NCHW     // [1, 1, H, W]
+};
+
+// Everything needed to feed a depth model and read its output
+struct ModelDescriptor {
+    const char* name;
+    const char* file;          // ONNX file in the models directory
+    cv::Size input_size;
+    cv::Scalar mean;           // Per-channel mean (RGB) of the [0, 1] scaled input
+    cv::Scalar std;            // Per-channel standard deviation (RGB)
+    bool swap_rb;              // Model expects RGB input
+    OutputLayout output_layout;
+};
+
+/**
+ * Get the descriptor of a depth model.
+ *
+ * @param model Depth model.
+ * @return Input size, normalization and output layout of the model.
+ */
+const ModelDescriptor& getModelDescriptor(DepthModel model);
+
+/**
+ * Inference engine running one depth model.
+ * Engines are not thread-safe; use one instance per thread.
+ */
+class InferenceEngine {
+public:
+    virtual ~InferenceEngine() = default;
+
+    [[nodiscard]] virtual const char* name() const = 0;
+
+    /**
+     * Run the model.
+     *
+     * @param blob Preprocessed NCHW float blob.
+     * @return Raw output tensor of the model.
+     */
+    virtual cv::Mat infer(const cv::Mat& blob) = 0;
+};
+
+// Engine selection, chosen at runtime
+struct DepthEngineConfig {
+    InferenceBackend backend = InferenceBackend::OPENCV_DNN;
+    DepthModel model = DepthModel::MIDAS_SMALL;
+    int dnn_backend = cv::dnn::DNN_BACKEND_DEFAULT;   // OpenCV DNN only
+    int dnn_target = cv::dnn::DNN_TARGET_CPU;         // OpenCV DNN only
+    int num_threads = 0;                              // ONNX Runtime / OpenVINO, 0 = library default
+    int tiles = 1;                                    // Depth tiles per side, 1 = whole frame only
+};
+
+/**
+ * Create an inference engine for the configured backend and model.
+ *
+ * @param config Engine selection.
+ * @return The engine, or nullptr if the backend is not built in or the model can't be loaded.
+ */
+std::unique_ptr<InferenceEngine> createInferenceEngine(const DepthEngineConfig& config);
+
+/**
+ * Convert a BGR frame into the normalized NCHW blob expected by the model.
+ *
+ * @param frame Input frame from the camera.
+ * @param model Model descriptor.
+ * @return Input blob.
+ */
+cv::Mat preprocessDepthInput(const cv::Mat& frame, const ModelDescriptor& model);
+
+/**
+ * Fill the input blob from a frame already resized to the model input size, e.g. the
+ * resized view of a FramePyramid. The blob keeps its allocation between calls.
+ *
+ * @param resized BGR image (CV_8UC3) of size model.input_size.
+ * @param model Model descriptor.
+ * @param blob Output NCHW blob, (re)allocated only if its shape changes.
+ */
+void preprocessResizedInput(const cv::Mat& resized, const ModelDescriptor& model, cv::Mat& blob);
+
+/**
+ * View the model output as a 2D depth map.
+ *
+ * @param output Raw output tensor of the model.
+ * @param model Model descriptor.
+ * @return H x W CV_32F relative inverse depth (shares data with `output`).
+ */
+cv::Mat extractDepth(const cv::Mat& output, const ModelDescriptor& model);
+
+// Parse names used on the command line, return false on unknown names
+bool parseInferenceBackend(const std::string& name, InferenceBackend& backend);
+bool parseDepthModel(const std::string& name, DepthModel& model);
+bool parseDnnTarget(const std::string& name, int& dnn_target);
+bool parseDnnBackend(const std::string& name, int& dnn_backend);
+
+#ifdef WITH_ONNXRUNTIME
+std::unique_ptr<InferenceEngine> createOnnxRuntimeEngine(const std::string& model_path, int num_threads);
+#endif
+
+#ifdef WITH_OPENVINO
+std::unique_ptr<InferenceEngine> createOpenVinoEngine(const std::string& model_path, int num_threads);
+#endif
+
+#endif //DRONE_NAVIGATION_INFERENCE_ENGINE_HPP
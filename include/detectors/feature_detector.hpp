@@ -18,14 +18,67 @@
 void applyNMS(std::vector<cv::KeyPoint>& keypoints, float overlap_threshold = 0.05f);
 
 /**
- * Cluster points using a simple DBSCAN-like algorithm.
+ * Apply Non-Maximum Suppression (NMS) to keypoints and their descriptors.
+ *
+ * @param keypoints Keypoints to be filtered.
+ * @param descriptors Descriptors, one row per keypoint; rows of removed keypoints are dropped.
+ * @param overlap_threshold Overlap threshold for NMS.
+ */
+void applyNMS(std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors, float overlap_threshold = 0.05f);
+
+// Per-cluster statistics, gathered in one pass over the cluster's points
+struct ClusterStats {
+    cv::Point2f centroid;
+    cv::Rect bbox;              // Same box as cv::boundingRect over the points
+    cv::Matx22f covariance;     // Population covariance of the points [px^2]
+    int point_count = 0;
+    float depth_median = 0.0f;  // Depth statistics, 0 if no depths were given
+    float depth_min = 0.0f;
+    float depth_max = 0.0f;
+};
+
+/**
+ * Flat cluster representation. Every input point carries one label; the clustered points are
+ * stored grouped by cluster in a single buffer, cluster c owning [offsets[c], offsets[c + 1]).
+ * Reusing one instance across frames keeps the buffers allocated.
+ */
+struct ClusterSet {
+    std::vector<int> labels;            // Per input point: cluster index, -1 = noise
+    std::vector<int> offsets;           // count() + 1 entries into points
+    std::vector<cv::Point2f> points;    // Clustered points grouped by cluster
+    std::vector<int> indices;           // Input index of each grouped point
+    std::vector<float> depths;          // Depth of each grouped point, empty without depths
+    std::vector<ClusterStats> stats;    // Per cluster
+    std::vector<float> depth_scratch;   // Reused by computeClusterStats for the depth medians
+
+    [[nodiscard]] int count() const { return offsets.empty() ? 0 : static_cast<int>(offsets.size()) - 1; }
+    [[nodiscard]] int size(int cluster) const { return offsets[cluster + 1] - offsets[cluster]; }
+    [[nodiscard]] const cv::Point2f* begin(int cluster) const { return points.data() + offsets[cluster]; }
+    [[nodiscard]] const cv::Point2f* end(int cluster) const { return points.data() + offsets[cluster + 1]; }
+
+    void clear();
+};
+
+/**
+ * Cluster points with DBSCAN. Each point belongs to at most one cluster: core points expand
+ * their cluster, border points join the first cluster that reaches them.
  *
  * @param points Points to be clustered.
  * @param eps Distance threshold for clustering.
- * @param minPts Minimum number of points to form a cluster.
- * @return A vector of clusters, where each cluster is a vector of points.
+ * @param minPts Minimum number of points (including itself) in the neighbourhood of a core point.
+ * @param clusters Labels, grouped points and per-cluster statistics; previous contents are replaced.
+ * @param depths Optional depth per input point for the depth statistics, empty to skip them.
+ */
+void clusterPoints(const std::vector<cv::Point2f>& points, float eps, int minPts, ClusterSet& clusters,
+                   const std::vector<float>& depths = {});
+
+/**
+ * Recompute the per-cluster statistics of a clustered set in one pass over its points.
+ * Called by clusterPoints; exposed for sets whose points or depths were edited afterwards.
+ *
+ * @param clusters Clustered set; stats is filled.
  */
-std::vector<std::vector<cv::Point2f>> clusterPoints(const std::vector<cv::Point2f>& points, float eps, int minPts);
+void computeClusterStats(ClusterSet& clusters);
 
 /**
  * Calculate k-th nearest neighbor distance (used to estimate `eps`).
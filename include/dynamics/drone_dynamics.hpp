@@ -0,0 +1,96 @@
+#ifndef DRONE_NAVIGATION_DRONE_DYNAMICS_HPP
+#define DRONE_NAVIGATION_DRONE_DYNAMICS_HPP
+
+#ifdef _WIN32
+  #define DLL_EXPORT extern "C" __declspec(dllexport)
+#else
+  #define DLL_EXPORT extern "C"
+#endif
+
+// Layouts shared with DroneSimulatorInterop.cs, keep them in sync.
+
+struct Vector3 {
+    float x;
+    float y;
+    float z;
+};
+
+struct DroneState {
+    Vector3 pos;  // Position in meters.
+    Vector3 vel;  // Velocity in m/s.
+};
+
+//-------------------------
+// Exposed function: SimulateStep
+// Uses RK4 integration to update the drone state over one time step dt.
+// Inputs:
+//   currentState - pointer to current DroneState (position and velocity)
+//   target       - pointer to the target position vector
+//   dt           - time step (seconds)
+//   thrust       - maximum thrust [N] (from physicsConfig.thrust)
+//   mass         - mass [kg] (from physicsConfig.mass)
+//   drag         - linear drag (from physicsConfig.drag)
+//   kp           - proportional gain (e.g., for position control or altitude hold)
+//   kd           - derivative gain (e.g., for position control or altitude hold)
+// Output:
+//   newState - pointer where the updated DroneState will be stored.
+DLL_EXPORT void SimulateStep(DroneState* currentState, const Vector3* target, float dt,
+                             float thrust, float mass, float drag, float kp, float kd,
+                             DroneState* newState);
+
+// Step statistics returned by the multi-step integrators
+struct IntegrationStats {
+    int acceptedSteps;
+    int rejectedSteps;          // Adaptive integration only
+    int derivativeEvaluations;
+    float minStep;              // Smallest accepted step (seconds)
+    float maxStep;              // Largest accepted step (seconds)
+};
+
+//-------------------------
+// Exposed function: SimulateSubsteps
+// Advances a state by `duration` seconds with `substeps` fixed RK4 steps, all in
+// native code. Parameters as in SimulateStep; `stats` may be null.
+DLL_EXPORT void SimulateSubsteps(DroneState* currentState, const Vector3* target, float duration, int substeps,
+                                 float thrust, float mass, float drag, float kp, float kd,
+                                 DroneState* newState, IntegrationStats* stats);
+
+//-------------------------
+// Exposed function: SimulateAdaptive
+// Advances a state by `duration` seconds with an adaptive Dormand-Prince RK45
+// integrator. The step size is controlled so that the local error of every
+// component stays below tolerance * (1 + |value|). Takes few large steps on
+// smooth segments and small ones where stiff PD gains or the thrust clamp need them.
+// Inputs:
+//   tolerance    - error tolerance per step (float state: use >= 1e-6)
+//   initialStep  - first step to try (seconds), 0 = choose automatically
+//   other        - as in SimulateStep; `stats` may be null
+// Returns 1 on success, 0 if the step limit was hit before reaching `duration`
+// (newState then holds the state reached so far).
+DLL_EXPORT int SimulateAdaptive(DroneState* currentState, const Vector3* target, float duration,
+                                float tolerance, float initialStep,
+                                float thrust, float mass, float drag, float kp, float kd,
+                                DroneState* newState, IntegrationStats* stats);
+
+//-------------------------
+// Exposed function: SimulateSwarmStep
+// Advances `count` drones by one RK4 step in a single call. All buffers are
+// struct-of-arrays with `count` elements; positions and velocities are updated
+// in place. Produces the same results as calling SimulateStep for every drone.
+// Inputs:
+//   count                  - number of drones
+//   posX/Y/Z, velX/Y/Z     - drone states, updated in place
+//   targetX/Y/Z            - target position of every drone
+//   thrust, mass, drag,
+//   kp, kd                 - per-drone parameters (see SimulateStep)
+//   dt                     - time step (seconds)
+//   numThreads             - worker threads, 0 = all cores (small swarms always run on the caller)
+DLL_EXPORT void SimulateSwarmStep(int count,
+                                  float* posX, float* posY, float* posZ,
+                                  float* velX, float* velY, float* velZ,
+                                  const float* targetX, const float* targetY, const float* targetZ,
+                                  const float* thrust, const float* mass, const float* drag,
+                                  const float* kp, const float* kd,
+                                  float dt, int numThreads);
+
+#endif //DRONE_NAVIGATION_DRONE_DYNAMICS_HPP
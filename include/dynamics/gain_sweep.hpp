@@ -0,0 +1,121 @@
+#ifndef DRONE_NAVIGATION_GAIN_SWEEP_HPP
+#define DRONE_NAVIGATION_GAIN_SWEEP_HPP
+
+#include <string>
+#include <vector>
+#include "drone_dynamics.hpp"
+
+/**
+ * Values of one controller parameter: `steps` evenly spaced values from min to max
+ * for a grid sweep, or a uniform distribution over [min, max] for Monte Carlo sampling.
+ */
+struct ParameterRange {
+    float min;
+    float max;
+    int steps = 1;
+};
+
+/**
+ * Parameters of one simulated drone (see SimulateStep).
+ */
+struct GainParameters {
+    float kp;
+    float kd;
+    float drag;
+    float thrust;
+    float mass;
+};
+
+/**
+ * Search space of a sweep. The defaults are the DroneSimulatorInterop inspector values.
+ */
+struct SweepSpace {
+    ParameterRange kp{10.0f, 10.0f};
+    ParameterRange kd{2.0f, 2.0f};
+    ParameterRange drag{0.1f, 0.1f};
+    ParameterRange thrust{100.0f, 100.0f};
+    ParameterRange mass{1.0f, 1.0f};
+};
+
+/**
+ * Flight every configuration is scored on: the drone starts at rest at `start` and
+ * is commanded to every waypoint in turn for `leg_duration` seconds.
+ */
+struct SweepScenario {
+    Vector3 start{0.0f, 0.0f, 0.0f};
+    std::vector<Vector3> waypoints;
+    float dt = 0.02f;                 // Integration step, as in DroneSimulatorInterop
+    float leg_duration = 10.0f;       // Seconds spent on each waypoint
+    float settle_tolerance = 0.5f;    // Distance at which a waypoint counts as reached
+};
+
+/**
+ * Score of one configuration.
+ */
+struct SweepMetrics {
+    GainParameters params;
+    float settling_time;    // Sum over legs of the time until the drone stays within the tolerance
+    float overshoot;        // Largest distance travelled past a waypoint along the leg direction
+    float path_length;      // Total distance flown
+    float final_error;      // Distance to the last waypoint at the end of the flight
+    bool settled;           // Every leg ended within the tolerance
+};
+
+/**
+ * Build the full grid (cartesian product) of the parameter ranges.
+ *
+ * @param space Parameter ranges.
+ * @return Every combination, kp varying slowest.
+ */
+std::vector<GainParameters> buildParameterGrid(const SweepSpace& space);
+
+/**
+ * Draw Monte Carlo samples, every parameter uniformly from its [min, max] range.
+ *
+ * @param space Parameter ranges (steps are ignored).
+ * @param samples Number of configurations to draw.
+ * @param seed Random seed, the same seed gives the same samples.
+ * @return Sampled configurations.
+ */
+std::vector<GainParameters> sampleParameters(const SweepSpace& space, int samples, unsigned seed);
+
+/**
+ * Simulate every configuration over the scenario and score it. Configurations are
+ * processed in batches with SimulateSwarmStep, batches are spread over worker threads.
+ *
+ * @param configurations Parameters to evaluate.
+ * @param scenario Flight to simulate.
+ * @param num_threads Worker threads, 0 = all cores.
+ * @return Metrics in the order of the configurations.
+ */
+std::vector<SweepMetrics> runGainSweep(const std::vector<GainParameters>& configurations,
+                                       const SweepScenario& scenario, int num_threads = 0);
+
+/**
+ * Order results from best to worst: settled configurations first, then by settling
+ * time, overshoot and final error.
+ *
+ * @param results Metrics to sort in place.
+ */
+void rankSweepResults(std::vector<SweepMetrics>& results);
+
+/**
+ * Write results as CSV, one row per configuration.
+ *
+ * @param path Output file.
+ * @param results Metrics to write.
+ * @return True if the file was written.
+ */
+bool writeSweepCsv(const std::string& path, const std::vector<SweepMetrics>& results);
+
+/**
+ * Read waypoints, one "x,y,z" per line (the TargetSender format). Empty lines and
+ * lines starting with '#' are skipped.
+ *
+ * @param path Waypoint file.
+ * @param waypoints Output waypoints.
+ * @return True if the file was read and every line parsed.
+ */
+bool loadWaypoints(const std::string& path, std::vector<Vector3>& waypoints);
+
+#endif //DRONE_NAVIGATION_GAIN_SWEEP_HPP
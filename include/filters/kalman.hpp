@@ -21,6 +21,7 @@ struct KalmanFilter {
     // Methods
     void predict(float dt);
     void update(float x, float y);
+    void warp(const cv::Point2f& position, const cv::Matx22f& jacobian);
     [[nodiscard]] cv::Point2f getPredictedPosition() const;
 };
 
@@ -39,6 +40,7 @@ struct ExtendedKalmanFilter {
     // Methods
     void predict(float dt);
     void update(float x, float y);
+    void warp(const cv::Point2f& position, const cv::Matx22f& jacobian);
     [[nodiscard]] cv::Point2f getPredictedPosition() const;
 };
 
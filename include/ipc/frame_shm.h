@@ -0,0 +1,92 @@
+#ifndef DRONE_NAVIGATION_FRAME_SHM_H
+#define DRONE_NAVIGATION_FRAME_SHM_H
+
+/*
+ * Shared-memory ring of raw camera frames, filled by a local producer
+ * (simulator, camera daemon) and read by the pipeline without copies.
+ *
+ * Single producer, single consumer. The producer writes frame n into slot
+ * n % capacity and publishes it by advancing write_index. The consumer lends
+ * slots to the pipeline in place and advances read_index once they are
+ * released, so the producer never overwrites a frame that is still in use:
+ * when all slots are taken it drops the new frame and counts it in `dropped`.
+ *
+ * This header is C-compatible.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_SHM_MAGIC 0x46524D45u     /* "FRME" */
+#define FRAME_SHM_VERSION 1u
+#define FRAME_SHM_DEFAULT_NAME "/drone_navigation_frames"
+#define FRAME_SHM_DEFAULT_CAPACITY 4u
+
+/* Packed 8-bit, 3 channels, `stride` bytes per row */
+#define FRAME_SHM_BGR24 1u              /* Lent to the pipeline without conversion */
+#define FRAME_SHM_RGB24 2u              /* Converted to BGR by the consumer */
+
+/* Slot payload offset and slot strides are multiples of this */
+#define FRAME_SHM_ALIGNMENT 64u
+
+typedef struct {
+    uint64_t sequence;      /* Frame number assigned by the producer, starts at 0 */
+    int64_t timestamp_ns;   /* CLOCK_MONOTONIC capture time */
+    uint64_t reserved[6];   /* Pixels start on their own cache line */
+} FrameSlotHeader;
+
+typedef struct {
+    uint32_t magic;         /* Written last by the producer once the region is ready */
+    uint32_t version;
+    uint32_t capacity;      /* Number of slots */
+    uint32_t pixel_format;  /* FRAME_SHM_BGR24 or FRAME_SHM_RGB24 */
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;        /* Bytes per pixel row */
+    uint32_t slot_size;     /* Bytes per slot: FrameSlotHeader and pixels, aligned */
+    uint64_t write_index;   /* Frames published so far (producer) */
+    uint64_t read_index;    /* Frames released so far (consumer) */
+    uint64_t dropped;       /* Frames the producer dropped because no slot was free */
+    uint64_t reserved[3];
+    /* capacity slots of slot_size bytes follow */
+} FrameShmHeader;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FrameWriter FrameWriter;
+
+/*
+ * Create (or recreate) the shared-memory ring.
+ * Returns NULL if the object could not be created or the format is unknown.
+ */
+FrameWriter* frame_writer_open(const char* name, uint32_t width, uint32_t height,
+                               uint32_t pixel_format, uint32_t capacity);
+
+/* Unmap and unlink the ring */
+void frame_writer_close(FrameWriter* writer);
+
+/*
+ * Pixels of the next free slot (`stride` bytes per row, see frame_writer_stride),
+ * to be filled in place and then published. Returns NULL and counts a dropped
+ * frame when the consumer still holds every slot.
+ */
+uint8_t* frame_writer_acquire(FrameWriter* writer);
+
+/* Publish the slot returned by the last frame_writer_acquire() */
+void frame_writer_publish(FrameWriter* writer, int64_t timestamp_ns);
+
+/*
+ * Copy one frame into the ring and publish it.
+ * Returns 1 when the frame was published, 0 when it was dropped.
+ */
+int frame_writer_write(FrameWriter* writer, const uint8_t* pixels, size_t src_stride, int64_t timestamp_ns);
+
+uint32_t frame_writer_stride(const FrameWriter* writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRONE_NAVIGATION_FRAME_SHM_H */
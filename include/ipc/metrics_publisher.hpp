@@ -0,0 +1,65 @@
+#ifndef DRONE_NAVIGATION_METRICS_PUBLISHER_HPP
+#define DRONE_NAVIGATION_METRICS_PUBLISHER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "metrics_shm.h"
+#include "pipeline_metrics.hpp"
+
+/**
+ * Single producer of the shared-memory metrics snapshot (see metrics_shm.h).
+ * Snapshots are taken from the pipeline's atomics on the publisher's own thread,
+ * so the pipeline threads never wait for it.
+ */
+class MetricsPublisher {
+public:
+    MetricsPublisher() = default;
+    ~MetricsPublisher();
+
+    MetricsPublisher(const MetricsPublisher&) = delete;
+    MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+
+    /**
+     * Create (or recreate) the shared-memory object.
+     *
+     * @param name POSIX shared-memory name, starting with '/'.
+     * @return true on success.
+     */
+    bool open(const std::string& name = METRICS_SHM_DEFAULT_NAME);
+
+    // Stop the publishing thread, unmap and unlink the shared-memory object
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return header != nullptr; }
+
+    /**
+     * Write one snapshot of the metrics.
+     *
+     * @param metrics Metrics to copy.
+     */
+    void publish(const PipelineMetrics& metrics);
+
+    /**
+     * Publish the process metrics periodically on an I/O thread until close().
+     *
+     * @param interval_ms Time between snapshots.
+     */
+    void start(int interval_ms = 100);
+
+private:
+    void publishLoop(int interval_ms);
+
+    std::string shm_name;
+    size_t size = 0;
+    MetricsShmHeader* header = nullptr;
+    uint64_t snapshot_count = 0;
+
+    std::thread thread;
+    std::mutex stop_mutex;
+    std::condition_variable stop_requested;
+    bool stopping = false;
+};
+
+#endif //DRONE_NAVIGATION_METRICS_PUBLISHER_HPP
@@ -0,0 +1,91 @@
+#ifndef DRONE_NAVIGATION_METRICS_SHM_H
+#define DRONE_NAVIGATION_METRICS_SHM_H
+
+/*
+ * Shared-memory layout and reader API for pipeline health snapshots.
+ *
+ * The pipeline process periodically copies its metrics into a single snapshot
+ * under a sequence lock: the sequence is odd while the snapshot is being
+ * written and even once it is complete. Readers retry until they copy a
+ * snapshot with the same even sequence before and after; the writer never
+ * waits for readers.
+ *
+ * This header is C-compatible.
+ */
+
+#include <stdint.h>
+
+#define METRICS_SHM_MAGIC 0x4D545243u   /* "MTRC" */
+#define METRICS_SHM_VERSION 1u
+#define METRICS_SHM_DEFAULT_NAME "/drone_navigation_metrics"
+#define METRICS_SHM_HISTOGRAM_BUCKETS 13
+#define METRICS_SHM_MAX_STAGES 8
+
+/* Latency histogram, buckets are not cumulative */
+typedef struct {
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t buckets[METRICS_SHM_HISTOGRAM_BUCKETS];    /* Last bucket: above the largest bound */
+} MetricsHistogram;
+
+typedef struct {
+    uint64_t snapshot_seq;      /* Snapshots written so far */
+    int64_t timestamp_ns;       /* CLOCK_MONOTONIC time of the snapshot */
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t frames_dropped;
+    uint64_t depth_inferences;
+    double frame_queue;
+    double record_queue;
+    double keypoints;           /* Last processed frame */
+    double filtered_keypoints;
+    double clusters;
+    double tracks;
+    double changed_fraction;
+    uint32_t stage_count;       /* Valid entries of stage_latency */
+    uint32_t reserved;
+    MetricsHistogram frame_latency;
+    MetricsHistogram depth_latency;
+    MetricsHistogram stage_latency[METRICS_SHM_MAX_STAGES];
+} MetricsSnapshot;
+
+typedef struct {
+    uint32_t magic;             /* Written last by the producer once the region is ready */
+    uint32_t version;
+    uint32_t snapshot_size;     /* sizeof(MetricsSnapshot), guards against layout mismatch */
+    uint32_t reserved0;
+    uint64_t bucket_bounds_us[METRICS_SHM_HISTOGRAM_BUCKETS - 1];
+    char stage_names[METRICS_SHM_MAX_STAGES][16];
+    uint64_t sequence;          /* Sequence lock, see above */
+    uint64_t reserved[7];       /* Keep the snapshot off the sequence's cache line */
+    MetricsSnapshot snapshot;
+} MetricsShmHeader;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MetricsReader MetricsReader;
+
+/* Map the shared-memory object. Returns NULL if it does not exist or is not ready. */
+MetricsReader* metrics_reader_open(const char* name);
+
+void metrics_reader_close(MetricsReader* reader);
+
+/*
+ * Copy the latest snapshot. Returns 1 on success, 0 when nothing was published yet and -1
+ * when no consistent snapshot could be read (the writer died while publishing).
+ */
+int metrics_reader_read(MetricsReader* reader, MetricsSnapshot* out);
+
+/* Name of stage i < stage_count, e.g. "depth" */
+const char* metrics_reader_stage_name(const MetricsReader* reader, uint32_t stage);
+
+/* Upper bound of histogram bucket i < METRICS_SHM_HISTOGRAM_BUCKETS - 1 [us] */
+uint64_t metrics_reader_bucket_bound(const MetricsReader* reader, uint32_t bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRONE_NAVIGATION_METRICS_SHM_H */
@@ -0,0 +1,51 @@
+#ifndef DRONE_NAVIGATION_OBSTACLE_PUBLISHER_HPP
+#define DRONE_NAVIGATION_OBSTACLE_PUBLISHER_HPP
+
+#include <string>
+#include "obstacle_shm.h"
+#include "video_processor.hpp"
+
+/**
+ * Single producer of the shared-memory obstacle ring (see obstacle_shm.h).
+ * Publishing is wait-free: it copies one frame into the next slot and never
+ * waits for consumers.
+ */
+class ObstaclePublisher {
+public:
+    ObstaclePublisher() = default;
+    ~ObstaclePublisher();
+
+    ObstaclePublisher(const ObstaclePublisher&) = delete;
+    ObstaclePublisher& operator=(const ObstaclePublisher&) = delete;
+
+    /**
+     * Create (or recreate) the shared-memory object.
+     *
+     * @param name POSIX shared-memory name, starting with '/'.
+     * @param capacity Number of frames kept in the ring.
+     * @return true on success.
+     */
+    bool open(const std::string& name = OBSTACLE_SHM_DEFAULT_NAME,
+              uint32_t capacity = OBSTACLE_SHM_DEFAULT_CAPACITY);
+
+    // Unmap and unlink the shared-memory object
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return header != nullptr; }
+
+    /**
+     * Publish the obstacles of one processed frame.
+     * Only the first OBSTACLE_SHM_MAX_OBSTACLES obstacles are published.
+     *
+     * @param result Per-frame pipeline results.
+     */
+    void publish(const FrameResult& result);
+
+private:
+    std::string shm_name;
+    size_t size = 0;
+    ObstacleShmHeader* header = nullptr;
+    ObstacleSlot* slots = nullptr;
+};
+
+#endif //DRONE_NAVIGATION_OBSTACLE_PUBLISHER_HPP
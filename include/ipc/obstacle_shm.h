@@ -0,0 +1,89 @@
+#ifndef DRONE_NAVIGATION_OBSTACLE_SHM_H
+#define DRONE_NAVIGATION_OBSTACLE_SHM_H
+
+/*
+ * Shared-memory layout and reader API for per-frame obstacle records.
+ *
+ * The pipeline is the single producer; any number of local consumers map the
+ * same POSIX shared-memory object read-only. Frame n is written to slot
+ * n % capacity under a per-slot sequence lock: the slot sequence is odd while
+ * the slot is being written and equals 2 * (n + 1) once frame n is complete.
+ * Consumers never block the producer; a consumer that falls more than
+ * `capacity` frames behind skips ahead and reports the dropped frames.
+ * A restarted producer creates a new object under the same name; readers
+ * without new frames notice within 100 ms and read the new run from its start.
+ *
+ * This header is C-compatible.
+ */
+
+#include <stdint.h>
+
+#define OBSTACLE_SHM_MAGIC 0x4F425354u   /* "OBST" */
+#define OBSTACLE_SHM_VERSION 1u
+#define OBSTACLE_SHM_DEFAULT_NAME "/drone_navigation_obstacles"
+#define OBSTACLE_SHM_DEFAULT_CAPACITY 64u
+#define OBSTACLE_SHM_MAX_OBSTACLES 32
+
+/* One tracked obstacle cluster */
+typedef struct {
+    int32_t track_id;
+    int32_t point_count;    /* Keypoints in the cluster */
+    float x, y;             /* Cluster centroid [px] */
+    float vx, vy;           /* Filter velocity estimate [px/s] */
+    float depth_median;     /* Depth statistics over the cluster keypoints */
+    float depth_min;
+    float depth_max;
+    float reserved;
+} ObstacleRecord;
+
+/* All obstacles of one processed frame */
+typedef struct {
+    uint64_t frame_seq;     /* Frame index in the pipeline */
+    int64_t timestamp_ns;   /* CLOCK_MONOTONIC time the frame was published */
+    float median_depth;     /* Median depth of the whole frame */
+    uint32_t obstacle_count;
+    ObstacleRecord obstacles[OBSTACLE_SHM_MAX_OBSTACLES];
+} ObstacleFrame;
+
+typedef struct {
+    uint64_t sequence;      /* Sequence lock, see above */
+    uint64_t reserved[7];   /* Keep frames on their own cache lines */
+    ObstacleFrame frame;
+} ObstacleSlot;
+
+typedef struct {
+    uint32_t magic;         /* Written last by the producer once the region is ready */
+    uint32_t version;
+    uint32_t capacity;      /* Number of slots */
+    uint32_t slot_size;     /* sizeof(ObstacleSlot), guards against layout mismatch */
+    uint64_t write_index;   /* Number of frames published so far */
+    uint64_t reserved[5];
+    /* ObstacleSlot slots[capacity] follow */
+} ObstacleShmHeader;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ObstacleReader ObstacleReader;
+
+/* Map the shared-memory object. Returns NULL if it does not exist or is not ready. */
+ObstacleReader* obstacle_reader_open(const char* name);
+
+void obstacle_reader_close(ObstacleReader* reader);
+
+/*
+ * Read the next unread frame.
+ * Returns 1 when a frame was copied to `out`, 0 when there is no new frame yet.
+ * `dropped` (optional) receives the number of frames skipped because the reader fell behind.
+ */
+int obstacle_reader_next(ObstacleReader* reader, ObstacleFrame* out, uint64_t* dropped);
+
+/* Read the most recent frame. Returns 1 on success, 0 when nothing was published yet. */
+int obstacle_reader_latest(ObstacleReader* reader, ObstacleFrame* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRONE_NAVIGATION_OBSTACLE_SHM_H */
@@ -0,0 +1,191 @@
+#ifndef DRONE_NAVIGATION_TARGET_CONNECTION_HPP
+#define DRONE_NAVIGATION_TARGET_CONNECTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+    typedef SOCKET target_socket_t;
+    #define TARGET_INVALID_SOCKET INVALID_SOCKET
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    typedef int target_socket_t;
+    #define TARGET_INVALID_SOCKET (-1)
+#endif
+#include "target_protocol.h"
+
+// Socket helpers shared by TargetSender and TargetReceiver. Frames are sent in host byte
+// order, which matches the little-endian wire format on every platform we target.
+
+inline bool targetSocketStartup() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+    return true;
+#endif
+}
+
+inline void targetSocketCleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+inline void closeTargetSocket(target_socket_t sock) {
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+// Monotonic clock used for frame timestamps [us]
+inline uint64_t targetClockMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// First sequence number of a sender session. Random, so that the first frame of a new session
+// is not mistaken for a retransmission of the previous session's last frame.
+inline uint32_t randomTargetSequence() {
+    std::random_device device;
+    return static_cast<uint32_t>(device());
+}
+
+// Small frames are latency-critical, disable Nagle's algorithm
+inline void setTargetNoDelay(target_socket_t sock) {
+    int flag = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag));
+}
+
+/**
+ * Open a persistent connection to a target receiver.
+ *
+ * @param host IPv4 address of the receiver.
+ * @param port TCP port of the receiver.
+ * @return Connected socket, or TARGET_INVALID_SOCKET on failure.
+ */
+inline target_socket_t connectTarget(const std::string& host, int port) {
+    target_socket_t sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == TARGET_INVALID_SOCKET) return TARGET_INVALID_SOCKET;
+
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(static_cast<uint16_t>(port));
+    serverAddr.sin_addr.s_addr = inet_addr(host.c_str());
+
+    if (connect(sock, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+        closeTargetSocket(sock);
+        return TARGET_INVALID_SOCKET;
+    }
+    setTargetNoDelay(sock);
+    return sock;
+}
+
+/**
+ * Listen for target senders on all interfaces.
+ *
+ * @param port TCP port to listen on.
+ * @return Listening socket, or TARGET_INVALID_SOCKET on failure.
+ */
+inline target_socket_t listenTarget(int port) {
+    target_socket_t sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == TARGET_INVALID_SOCKET) return TARGET_INVALID_SOCKET;
+
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(sock, 4) < 0) {
+        closeTargetSocket(sock);
+        return TARGET_INVALID_SOCKET;
+    }
+    return sock;
+}
+
+inline bool sendAll(target_socket_t sock, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        int sent = send(sock, bytes, static_cast<int>(size), 0);
+#else
+        ssize_t sent = send(sock, bytes, size, MSG_NOSIGNAL);
+#endif
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+inline bool receiveAll(target_socket_t sock, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        int received = recv(sock, bytes, static_cast<int>(size), 0);
+#else
+        ssize_t received = recv(sock, bytes, size, 0);
+#endif
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+/**
+ * Send one frame with a single send() call, so a frame never goes out as two TCP segments
+ * because of the header/payload split.
+ *
+ * @param sock Connected socket.
+ * @param type TargetMessageType of the frame.
+ * @param sequence Frame sequence number.
+ * @param timestamp_us Timestamp to put in the header.
+ * @param waypoints Waypoints to carry, may be null when count is 0.
+ * @param count Number of waypoints (at most TARGET_PROTOCOL_MAX_WAYPOINTS).
+ * @param buffer Scratch buffer reused between calls.
+ * @return True if the whole frame was written.
+ */
+inline bool sendTargetFrame(target_socket_t sock, uint8_t type, uint32_t sequence, uint64_t timestamp_us,
+                            const TargetWaypoint* waypoints, uint32_t count, std::vector<char>& buffer) {
+    buffer.resize(target_frame_size(count));
+    TargetFrameHeader header;
+    target_frame_init(&header, type, sequence, timestamp_us, count);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (count > 0) std::memcpy(buffer.data() + sizeof(header), waypoints, count * sizeof(TargetWaypoint));
+    return sendAll(sock, buffer.data(), buffer.size());
+}
+
+/**
+ * Read exactly one frame.
+ *
+ * @param sock Connected socket.
+ * @param header Output frame header.
+ * @param waypoints Output waypoints, resized to header.count.
+ * @return 1 on success, 0 if the peer closed the connection, -1 if the stream is corrupt.
+ */
+inline int receiveTargetFrame(target_socket_t sock, TargetFrameHeader& header, std::vector<TargetWaypoint>& waypoints) {
+    if (!receiveAll(sock, &header, sizeof(header))) return 0;
+    if (!target_frame_valid(&header)) return -1;
+
+    waypoints.resize(header.count);
+    if (header.count > 0 && !receiveAll(sock, waypoints.data(), header.count * sizeof(TargetWaypoint))) return 0;
+    return 1;
+}
+
+#endif //DRONE_NAVIGATION_TARGET_CONNECTION_HPP
@@ -0,0 +1,77 @@
+#ifndef DRONE_NAVIGATION_TARGET_PROTOCOL_H
+#define DRONE_NAVIGATION_TARGET_PROTOCOL_H
+
+/*
+ * Binary target-streaming protocol between TargetSender and the simulation
+ * (DroneTargetReceiver.cs, TargetReceiver).
+ *
+ * One persistent TCP connection carries length-prefixed frames in both
+ * directions. A frame is a TargetFrameHeader followed by `count` waypoints.
+ * `length` counts the bytes after the length field itself, so a reader needs
+ * only the first 4 bytes to know how much to read. The receiver answers every
+ * frame with an ACK that echoes the sequence number and timestamp, which gives
+ * the sender its round-trip time. All fields are little-endian.
+ *
+ * A sender that loses its connection before the ACK arrives reconnects and sends
+ * the frame again, so the receiver acknowledges but does not apply a frame that
+ * repeats the sequence number of the last frame it applied. Senders start every
+ * session at a random sequence number, which keeps a new session's first frame
+ * apart from the previous session's last one.
+ *
+ * This header is C-compatible; DroneTargetReceiver.cs mirrors the layout.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TARGET_PROTOCOL_MAGIC 0x5444u          /* "DT" */
+#define TARGET_PROTOCOL_VERSION 1u
+#define TARGET_PROTOCOL_DEFAULT_PORT 11000
+#define TARGET_PROTOCOL_MAX_WAYPOINTS 4096u
+
+typedef enum {
+    TARGET_MSG_WAYPOINTS = 1,   /* Append the waypoints to the target queue */
+    TARGET_MSG_REPLACE = 2,     /* Replace the target queue with the waypoints */
+    TARGET_MSG_HOME = 3,        /* Clear the queue and return to the start position */
+    TARGET_MSG_ACK = 4          /* Receiver -> sender, echoes sequence and timestamp */
+} TargetMessageType;
+
+typedef struct {
+    uint32_t length;            /* Bytes after this field: rest of the header and the waypoints */
+    uint16_t magic;
+    uint8_t version;
+    uint8_t type;               /* TargetMessageType */
+    uint32_t sequence;          /* Incremented by the sender for every frame */
+    uint32_t count;             /* Waypoints following the header */
+    uint64_t timestamp_us;      /* Sender monotonic clock at send time */
+} TargetFrameHeader;
+
+typedef struct {
+    float x, y, z;
+} TargetWaypoint;
+
+/* Size of a whole frame with `count` waypoints */
+static inline size_t target_frame_size(uint32_t count) {
+    return sizeof(TargetFrameHeader) + (size_t) count * sizeof(TargetWaypoint);
+}
+
+static inline void target_frame_init(TargetFrameHeader* header, uint8_t type, uint32_t sequence,
+                                     uint64_t timestamp_us, uint32_t count) {
+    header->length = (uint32_t) (target_frame_size(count) - sizeof(header->length));
+    header->magic = TARGET_PROTOCOL_MAGIC;
+    header->version = TARGET_PROTOCOL_VERSION;
+    header->type = type;
+    header->sequence = sequence;
+    header->count = count;
+    header->timestamp_us = timestamp_us;
+}
+
+/* Returns 1 if the header is well-formed, 0 if the stream is corrupt or incompatible */
+static inline int target_frame_valid(const TargetFrameHeader* header) {
+    return header->magic == TARGET_PROTOCOL_MAGIC &&
+           header->version == TARGET_PROTOCOL_VERSION &&
+           header->count <= TARGET_PROTOCOL_MAX_WAYPOINTS &&
+           header->length == target_frame_size(header->count) - sizeof(header->length);
+}
+
+#endif /* DRONE_NAVIGATION_TARGET_PROTOCOL_H */
@@ -0,0 +1,170 @@
+#ifndef DRONE_NAVIGATION_OCCUPANCY_MAP_HPP
+#define DRONE_NAVIGATION_OCCUPANCY_MAP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include <opencv2/core.hpp>
+
+// Pinhole intrinsics in pixels of the depth image
+struct CameraIntrinsics {
+    float fx;
+    float fy;
+    float cx;
+    float cy;
+
+    /**
+     * Intrinsics of an ideal camera with square pixels and the principal point in the center.
+     *
+     * @param image_size Size of the depth image.
+     * @param horizontal_fov_deg Horizontal field of view in degrees.
+     * @return Camera intrinsics.
+     */
+    static CameraIntrinsics fromFieldOfView(const cv::Size& image_size, float horizontal_fov_deg);
+};
+
+// Camera pose in the map frame: p_map = rotation * p_camera + translation.
+// The camera frame follows OpenCV: x right, y down, z forward.
+struct CameraPose {
+    Eigen::Matrix3f rotation = Eigen::Matrix3f::Identity();
+    Eigen::Vector3f translation = Eigen::Vector3f::Zero();
+};
+
+struct OccupancyMapConfig {
+    float voxel_size = 0.2f;            // Voxel edge [m]
+    float max_range = 20.0f;            // Longer depths only clear free space up to this range [m]
+    int pixel_stride = 8;               // One ray every `pixel_stride` pixels in both directions
+    float log_odds_hit = 0.85f;         // Update of the voxel a ray ends in
+    float log_odds_miss = -0.4f;        // Update of the voxels a ray passes through
+    float log_odds_min = -2.0f;         // Clamping keeps the map responsive to changes
+    float log_odds_max = 3.5f;
+    float occupied_threshold = 0.0f;    // Voxels above are occupied, below free (0 = p 0.5)
+    float window_radius = 30.0f;        // Blocks farther than this from the camera are dropped [m]
+    int num_threads = 0;                // Update stripes, 0 = cv::getNumThreads()
+};
+
+enum class VoxelState {
+    UNKNOWN,
+    FREE,
+    OCCUPIED
+};
+
+// Cost and size of one integrateDepth() call
+struct MapUpdateStats {
+    int rays = 0;                // Rays cast
+    int hits = 0;                // Rays that ended on a surface within range
+    int voxel_updates = 0;       // Voxels updated (each voxel at most once per frame)
+    size_t blocks = 0;           // Blocks allocated after the update
+    long long mcs = 0;           // Wall time of the update
+};
+
+/**
+ * Sparse probabilistic occupancy grid built incrementally from depth images.
+ *
+ * Voxels are grouped into 8x8x8 blocks allocated on first use and stored in hash maps,
+ * sharded by block so that updates can be applied in parallel without locks. Every frame
+ * casts a ray per down-sampled depth pixel: voxels along the ray are updated as free,
+ * the voxel at the measured depth as occupied (hits win over misses within a frame).
+ * Only blocks within `window_radius` of the last camera position are kept, which bounds
+ * memory to the local neighbourhood of the drone.
+ *
+ * Queries are not synchronised with integrateDepth(), call them from the same thread.
+ */
+class OccupancyMap {
+public:
+    explicit OccupancyMap(const OccupancyMapConfig& config = {});
+
+    /**
+     * Integrate one depth image.
+     *
+     * @param depth Metric depth along the optical axis (CV_32F, meters), 0 or NaN = no data.
+     * @param intrinsics Intrinsics of the depth image.
+     * @param pose Camera pose in the map frame, also re-centers the local window.
+     * @return Update statistics.
+     */
+    MapUpdateStats integrateDepth(const cv::Mat& depth, const CameraIntrinsics& intrinsics, const CameraPose& pose);
+
+    /**
+     * Move the local window and drop the blocks that left it.
+     *
+     * @param center New window center in the map frame.
+     */
+    void setWindowCenter(const Eigen::Vector3f& center);
+
+    /**
+     * State of the voxel containing a point.
+     *
+     * @param point Point in the map frame.
+     * @return UNKNOWN if never observed, FREE or OCCUPIED otherwise.
+     */
+    [[nodiscard]] VoxelState query(const Eigen::Vector3f& point) const;
+
+    /**
+     * Check a straight segment against the map by walking every voxel it crosses.
+     *
+     * @param from Segment start in the map frame.
+     * @param to Segment end in the map frame.
+     * @param unknown_is_occupied Treat unobserved voxels as obstacles (conservative planning).
+     * @param hit Optional output, center of the first blocking voxel.
+     * @return True if the segment crosses a blocking voxel.
+     */
+    bool segmentCollides(const Eigen::Vector3f& from, const Eigen::Vector3f& to,
+                         bool unknown_is_occupied = false, Eigen::Vector3f* hit = nullptr) const;
+
+    void clear();
+    [[nodiscard]] size_t blockCount() const;
+    [[nodiscard]] size_t memoryBytes() const;
+    [[nodiscard]] const OccupancyMapConfig& config() const { return config_; }
+
+    static constexpr int BLOCK_SIZE = 8;
+    static constexpr int BLOCK_VOXELS = BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE;
+
+private:
+    struct Block {
+        float log_odds[BLOCK_VOXELS];
+        uint32_t stamp[BLOCK_VOXELS];   // (frame << 1) | hit of the last update, 0 = never observed
+    };
+
+    // Voxel update produced by ray casting: block key and voxel index inside the block
+    struct VoxelUpdate {
+        uint64_t block_key;
+        uint32_t index;
+    };
+
+    struct StripeBuffers {
+        std::vector<std::vector<VoxelUpdate>> hits;   // Per shard
+        std::vector<std::vector<VoxelUpdate>> misses;
+        std::vector<VoxelUpdate> miss_cache;           // Recently queued free voxels
+        int rays = 0;
+        int hit_count = 0;
+    };
+
+    using Shard = std::unordered_map<uint64_t, std::unique_ptr<Block>>;
+
+    [[nodiscard]] const Block* findBlock(uint64_t key) const;
+    [[nodiscard]] bool insideWindow(const Eigen::Vector3i& block) const;
+    [[nodiscard]] VoxelState voxelState(const Eigen::Vector3i& voxel) const;
+    int applyUpdates(int shard);
+
+    OccupancyMapConfig config_;
+    std::vector<Shard> shards_;
+    std::vector<StripeBuffers> stripes_;   // Reused between frames
+    Eigen::Vector3i window_center_ = Eigen::Vector3i::Zero();
+    int window_blocks_;
+    uint32_t frame_ = 0;
+};
+
+/**
+ * Convert relative inverse depth (e.g. the filtered MiDaS map, larger = closer) to metric
+ * depth as scale / value. The scale depends on the model and scene and has to be calibrated.
+ *
+ * @param inverse_depth Inverse depth (CV_32F).
+ * @param scale Scale of the conversion [m * value].
+ * @param min_value Smaller values are treated as no data (depth 0).
+ * @return Metric depth (CV_32F).
+ */
+cv::Mat inverseDepthToMetric(const cv::Mat& inverse_depth, float scale, float min_value = 1.0f);
+
+#endif //DRONE_NAVIGATION_OCCUPANCY_MAP_HPP
@@ -0,0 +1,142 @@
+#ifndef DRONE_NAVIGATION_AVOIDANCE_PLANNER_HPP
+#define DRONE_NAVIGATION_AVOIDANCE_PLANNER_HPP
+
+#include <random>
+#include <vector>
+#include <Eigen/Dense>
+#include <opencv2/core.hpp>
+#include "drone_dynamics.hpp"
+#include "occupancy_map.hpp"
+
+// Obstacle in the map frame, extrapolated at constant velocity over the planning horizon
+struct PlannerObstacle {
+    Eigen::Vector3f position = Eigen::Vector3f::Zero();   // Center [m]
+    Eigen::Vector3f velocity = Eigen::Vector3f::Zero();   // [m/s]
+    float radius = 0.5f;                                  // Bounding sphere [m]
+};
+
+struct AvoidancePlannerConfig {
+    // Drone (DroneDynamicsDLL parameters)
+    float thrust = 100.0f;
+    float mass = 1.0f;
+    float drag = 0.1f;
+    float kp = 4.0f;
+    float kd = 4.0f;
+    float drone_radius = 0.3f;
+
+    // Rollouts: every candidate is a flight direction; the PD target is kept `lookahead` ahead of
+    // the drone in that direction, which makes it settle at `cruise_speed`
+    float cruise_speed = 3.0f;                      // [m/s]
+    float horizon = 2.0f;                           // Rollout length [s]
+    float rollout_dt = 0.1f;                        // One SimulateStep per collision check [s]
+    float max_yaw_deg = 80.0f;                      // Candidate directions around the goal direction
+    float max_pitch_deg = 20.0f;
+    Eigen::Vector3f up = Eigen::Vector3f::UnitY();  // Map frame up axis
+    float min_height = 0.5f;                        // Lowest height of the drone center along `up` [m]
+
+    // Cost: remaining distance to the goal + clearance penalty + direction change
+    float safety_margin = 1.0f;                     // Clearance below this is penalised [m]
+    float clearance_weight = 4.0f;
+    float smoothness_weight = 1.0f;
+
+    // Compute budget per plan() call; the candidates are ranked so that stopping early still
+    // leaves the most promising directions evaluated
+    long long budget_mcs = 2000;
+    int max_candidates = 256;                       // Structured fan first, random directions after it
+    int max_obstacles = 64;                         // Closest obstacles kept by setObstacles()
+    int waypoint_count = 4;                         // Waypoints along the chosen rollout
+    unsigned seed = 1;
+};
+
+struct PlannerResult {
+    Vector3 target{};                       // PD target to command now
+    std::vector<Vector3> waypoints;         // Along the chosen rollout, evenly spaced over the horizon
+    bool collision_free = false;            // False: no safe candidate, `target` is the least bad one
+    bool braking = false;                   // Chosen candidate stops the drone
+    float cost = 0.0f;
+    float min_clearance = 0.0f;             // Over the chosen rollout [m]
+    int evaluated = 0;                      // Candidates rolled out
+    bool budget_exhausted = false;          // Stopped before all candidates were evaluated
+    long long mcs = 0;                      // Wall time of the call
+};
+
+/**
+ * Sampling planner for reactive obstacle avoidance at control rate. Every plan() call rolls out
+ * candidate flight directions with the drone model of DroneDynamicsDLL (SimulateStep) against the
+ * obstacles extrapolated at constant velocity, and returns the first target of the cheapest
+ * collision-free rollout. Candidates are evaluated in order of priority (previous choice, goal
+ * direction, braking, a fan of directions spreading out from the goal direction, then random
+ * directions) until the time budget is spent, so the result improves with the time available
+ * but is always valid. All buffers are allocated at construction; plan() does not allocate.
+ */
+class AvoidancePlanner {
+public:
+    explicit AvoidancePlanner(const AvoidancePlannerConfig& config = {});
+
+    /**
+     * Replace the obstacle set. Only the `max_obstacles` closest to `origin` are kept.
+     *
+     * @param obstacles Obstacles in the map frame.
+     * @param origin Current drone position.
+     */
+    void setObstacles(const std::vector<PlannerObstacle>& obstacles, const Eigen::Vector3f& origin);
+
+    /**
+     * Plan one control cycle.
+     *
+     * @param state Current drone state.
+     * @param goal Position to make progress towards.
+     * @param result Chosen target, waypoints and statistics (buffers are reused).
+     */
+    void plan(const DroneState& state, const Eigen::Vector3f& goal, PlannerResult& result);
+
+    // Forget the previous choice (e.g. after a new goal)
+    void reset() { has_previous = false; }
+
+    [[nodiscard]] const AvoidancePlannerConfig& config() const { return config_; }
+
+private:
+    struct Candidate {
+        Eigen::Vector3f direction;   // Unit flight direction, zero = brake
+        float cost;
+        float min_clearance;
+        float collision_time;        // Into the rollout [s], max() if it does not collide
+        bool collides;
+    };
+
+    // Roll out one candidate; stops at the first collision
+    void evaluate(const DroneState& state, const Eigen::Vector3f& goal, Candidate& candidate) const;
+
+    // Direction rotated by yaw around `up` and pitched towards `up`
+    [[nodiscard]] Eigen::Vector3f rotated(const Eigen::Vector3f& forward, float yaw_deg, float pitch_deg) const;
+
+    AvoidancePlannerConfig config_;
+    std::vector<PlannerObstacle> obstacles_;
+    std::vector<Candidate> candidates_;
+    std::vector<Eigen::Vector2f> fan_;       // Yaw/pitch offsets [deg] ordered by distance from the goal
+    std::mt19937 rng_;
+    Eigen::Vector3f previous_direction = Eigen::Vector3f::Zero();
+    bool has_previous = false;
+    float lookahead;
+    int rollout_steps;
+};
+
+/**
+ * Place a tracked obstacle (see TrackedObstacle) in the map frame. The centroid is back-projected
+ * at the given range, the box gives the radius and the image velocity the velocity across the
+ * optical axis, after removing the image motion the drone's own velocity causes at that range.
+ *
+ * @param center Cluster centroid [px].
+ * @param pixel_velocity Tracker velocity [px/s].
+ * @param bbox Cluster bounding box [px].
+ * @param range Distance along the optical axis [m], e.g. from a calibrated depth scale or TTC.
+ * @param intrinsics Camera intrinsics.
+ * @param pose Camera pose in the map frame.
+ * @param drone_velocity Drone velocity in the map frame [m/s].
+ * @return Obstacle in the map frame.
+ */
+PlannerObstacle obstacleFromTrack(const cv::Point2f& center, const cv::Point2f& pixel_velocity, const cv::Rect& bbox,
+                                  float range, const CameraIntrinsics& intrinsics, const CameraPose& pose,
+                                  const Eigen::Vector3f& drone_velocity);
+
+#endif //DRONE_NAVIGATION_AVOIDANCE_PLANNER_HPP
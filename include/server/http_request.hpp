@@ -0,0 +1,67 @@
+#ifndef DRONE_NAVIGATION_HTTP_REQUEST_HPP
+#define DRONE_NAVIGATION_HTTP_REQUEST_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum HttpParseStatus {
+    HTTP_INCOMPLETE,        // Need more bytes
+    HTTP_COMPLETE,          // Headers and body are in the buffer
+    HTTP_BAD_REQUEST,       // Malformed request line or headers
+    HTTP_TOO_LARGE,         // Headers or body exceed the limits
+    HTTP_LENGTH_REQUIRED    // Body without Content-Length (chunked uploads are not supported)
+};
+
+// Request head parsed in place; views point into the connection buffer
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    size_t header_bytes = 0;       // Request line and headers including the blank line, 0 = not parsed yet
+    size_t content_length = 0;
+    bool keep_alive = true;        // HTTP/1.1 default, "Connection: close" or HTTP/1.0 turn it off
+    bool expect_continue = false;  // Client waits for "100 Continue" before sending the body
+
+    // Header value by case-insensitive name, empty if missing
+    [[nodiscard]] std::string_view header(std::string_view name) const;
+
+    void clear();
+};
+
+/**
+ * Parse an HTTP/1.x request from the start of a buffer. Can be called again on the same
+ * buffer as more bytes arrive; once the head is parsed, header_bytes stays set and only
+ * the body length is checked.
+ *
+ * @param data Received bytes.
+ * @param size Number of received bytes.
+ * @param max_body_bytes Largest accepted Content-Length.
+ * @param request Parsed request head.
+ * @return Parse status; on HTTP_COMPLETE the body is data[header_bytes, header_bytes + content_length).
+ */
+HttpParseStatus parseHttpRequest(const char* data, size_t size, size_t max_body_bytes, HttpRequest& request);
+
+// One part of a multipart/form-data body; views point into the body
+struct MultipartPart {
+    std::string_view name;
+    std::string_view filename;
+    std::string_view content_type;
+    std::string_view data;
+};
+
+/**
+ * Split a multipart/form-data body into its parts.
+ *
+ * @param body Request body.
+ * @param content_type Value of the Content-Type header, carries the boundary.
+ * @param parts Output parts, cleared first.
+ * @return false if the content type is not multipart or the body is malformed.
+ */
+bool parseMultipart(std::string_view body, std::string_view content_type, std::vector<MultipartPart>& parts);
+
+// Part by form field name, nullptr if missing
+const MultipartPart* findPart(const std::vector<MultipartPart>& parts, std::string_view name);
+
+#endif //DRONE_NAVIGATION_HTTP_REQUEST_HPP
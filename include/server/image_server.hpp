@@ -0,0 +1,158 @@
+#ifndef DRONE_NAVIGATION_IMAGE_SERVER_HPP
+#define DRONE_NAVIGATION_IMAGE_SERVER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "http_request.hpp"
+#include "video_processor.hpp"
+
+struct ImageServerConfig {
+    std::string host = "127.0.0.1";             // Address to bind, "0.0.0.0" for all interfaces
+    int port = 20000;                           // Port PostCameraView.cs posts to
+    int max_connections = 64;
+    size_t max_request_bytes = 16 * 1024 * 1024;
+    size_t max_pending_frames = 4;              // Frames queued for the pipeline, more are answered with 503
+    std::string record_dir;                     // Save every received JPEG here, empty = no recording
+    size_t max_pending_records = 256;           // JPEGs queued for the disk, more are dropped
+    bool verbose = false;                       // Log every response
+};
+
+// Counters since start(), safe to read from any thread
+struct ImageServerStats {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> frames_processed{0};
+    std::atomic<uint64_t> frames_rejected{0};   // 503 because the pipeline queue was full
+    std::atomic<uint64_t> decode_errors{0};
+    std::atomic<uint64_t> bad_requests{0};
+    std::atomic<uint64_t> frames_recorded{0};
+    std::atomic<uint64_t> records_dropped{0};
+    std::atomic<uint64_t> pipeline_mcs{0};      // Decode and processFrame() time summed over all frames
+};
+
+/**
+ * HTTP front end of the vision pipeline for the Unity simulation. Accepts the
+ * multipart JPEG posts of PostCameraView.cs and answers each with the normalized
+ * bounding box of the most urgent tracked obstacle as JSON ({"x","y","w","h"}).
+ * GET /metrics returns the pipeline metrics in Prometheus text format, other GETs a health summary.
+ *
+ * One poll() loop serves all connections with non-blocking sockets and keep-alive.
+ * Frames are decoded and processed in order on a pipeline thread into reused buffers;
+ * recording runs on its own thread so disk writes never delay a response.
+ */
+class ImageServer {
+public:
+    explicit ImageServer(const ImageServerConfig& config);
+    ~ImageServer();
+
+    ImageServer(const ImageServer&) = delete;
+    ImageServer& operator=(const ImageServer&) = delete;
+
+    /**
+     * Bind the port and start the pipeline and recording threads.
+     *
+     * @return false if the port or the recording directory could not be opened.
+     */
+    bool start();
+
+    // Serve requests until stop() is called
+    void run();
+
+    // Make run() return; safe to call from other threads and signal handlers
+    void stop();
+
+    [[nodiscard]] const ImageServerStats& stats() const { return counters; }
+
+private:
+    // Connection state owned by the I/O loop
+    struct Connection {
+        int fd = -1;
+        uint64_t generation = 0;             // Distinguishes reused slots for late pipeline results
+        std::vector<char> input;             // Received bytes, reused across keep-alive requests
+        size_t input_size = 0;
+        std::string output;                  // Response bytes not yet sent
+        size_t output_offset = 0;
+        HttpRequest request;
+        bool continue_sent = false;
+        bool waiting = false;                // Request handed to the pipeline, no reads until answered
+        bool close_after_write = false;
+        bool peer_closed = false;            // Client shut down its side, close once the replies are written
+    };
+
+    // A decoded request waiting for the pipeline
+    struct FrameJob {
+        size_t connection = 0;
+        uint64_t generation = 0;
+        std::vector<uchar> jpeg;             // From the buffer pool
+        bool restart = false;
+        bool keep_alive = true;
+        long long received_mcs = 0;
+    };
+
+    struct FrameResponse {
+        size_t connection = 0;
+        uint64_t generation = 0;
+        std::string body;
+        int status = 200;
+        bool keep_alive = true;
+    };
+
+    void acceptConnections();
+    void readConnection(size_t index);
+    void writeConnection(size_t index);
+    void closeConnection(size_t index);
+    // Close a connection whose client has shut down once nothing is left to answer
+    void closeIfDone(size_t index);
+    void handleRequest(size_t index);
+    // Content type defaults to JSON for 200 and plain text otherwise
+    void queueResponse(size_t index, int status, const std::string& body, bool keep_alive,
+                       const char* content_type = nullptr);
+    void deliverResponses();
+
+    void pipelineLoop();
+    void recordLoop();
+    void joinWorkers();
+
+    std::vector<uchar> acquireBuffer();
+    void releaseBuffer(std::vector<uchar>&& buffer);
+
+    ImageServerConfig config;
+    ImageServerStats counters;
+
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1};              // Wakes poll() for stop() and finished frames
+    std::atomic<bool> running{false};
+    std::vector<Connection> connections;
+    uint64_t next_generation = 1;
+    std::vector<MultipartPart> parts;         // Scratch for the multipart parser
+
+    std::mutex job_mutex;
+    std::condition_variable job_ready;
+    std::deque<FrameJob> jobs;
+    std::deque<FrameResponse> responses;      // Guarded by job_mutex
+    std::thread pipeline_thread;
+
+    std::mutex record_mutex;
+    std::condition_variable record_ready;
+    std::deque<std::vector<uchar>> records;
+    std::thread record_thread;
+    uint64_t next_record_index = 1;
+
+    std::mutex pool_mutex;
+    std::vector<std::vector<uchar>> buffer_pool;
+};
+
+/**
+ * Obstacle the drone has to react to first: the closest one (highest filtered depth),
+ * larger clusters first when equally close.
+ *
+ * @param result Per-frame pipeline results.
+ * @return Index into result.obstacles, -1 if there are none.
+ */
+int mostUrgentObstacle(const FrameResult& result);
+
+#endif //DRONE_NAVIGATION_IMAGE_SERVER_HPP
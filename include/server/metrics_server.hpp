@@ -0,0 +1,49 @@
+#ifndef DRONE_NAVIGATION_METRICS_SERVER_HPP
+#define DRONE_NAVIGATION_METRICS_SERVER_HPP
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * Minimal HTTP endpoint serving the process metrics (pipelineMetrics()) in Prometheus
+ * text format at GET /metrics. Scrapes are rare, so one I/O thread answers one request
+ * per connection and closes it; the pipeline threads are never involved. Sockets are
+ * non-blocking and every connection gets one second in total, so a stalled scraper
+ * cannot hold up the others for longer.
+ */
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * Bind the port and start serving.
+     *
+     * @param host Address to bind, "0.0.0.0" for all interfaces.
+     * @param port TCP port, 0 = any free port (see port()).
+     * @return false if the port could not be opened.
+     */
+    bool start(const std::string& host, int port);
+
+    // Stop serving and join the thread
+    void stop();
+
+    // Bound port, 0 before start()
+    [[nodiscard]] int port() const { return bound_port; }
+
+private:
+    void serveLoop();
+    void serveConnection(int fd);
+
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1};   // Wakes poll() for stop()
+    int bound_port = 0;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+
+#endif //DRONE_NAVIGATION_METRICS_SERVER_HPP
@@ -0,0 +1,77 @@
+#ifndef DRONE_NAVIGATION_CLOSED_LOOP_SIM_HPP
+#define DRONE_NAVIGATION_CLOSED_LOOP_SIM_HPP
+
+#include <string>
+#include "scene_renderer.hpp"
+#include "avoidance_planner.hpp"
+
+struct ClosedLoopConfig {
+    // Scene
+    unsigned seed = 1;
+    int num_boxes = 40;
+    float corridor_length = 120.0f;     // The goal is at the end of the corridor [m]
+    float corridor_width = 20.0f;
+
+    // Camera, looking along the corridor
+    cv::Size image_size{320, 240};
+    float fov_deg = 90.0f;
+    float camera_rate = 30.0f;          // Frames per simulated second
+
+    // Drone (DroneDynamicsDLL parameters) and flight
+    float thrust = 100.0f;
+    float mass = 1.0f;
+    float drag = 0.1f;
+    float kp = 4.0f;
+    float kd = 4.0f;
+    int physics_substeps = 4;           // RK4 substeps per camera frame
+    float cruise_speed = 3.0f;          // Sets how far ahead of the drone the target is placed [m/s]
+    float altitude = 2.0f;
+    float drone_radius = 0.3f;
+    float max_duration = 120.0f;        // Simulated seconds before giving up
+
+    // Avoidance
+    float threat_depth = 200.0f;        // Cluster depth (filtered map, 0-255, larger = closer) that triggers avoidance
+    int threat_min_points = 6;
+    float avoid_offset = 4.0f;          // Lateral target shift while avoiding [m]
+    int avoid_hold_frames = 15;         // Keep avoiding this many frames after the last threat
+    bool use_planner = false;           // AvoidancePlanner rollouts instead of the lateral shift above
+    long long planner_budget_mcs = 2000;
+
+    bool ground_truth_depth = false;    // Use rendered depth instead of the depth model
+    std::string record_path;            // Annotated camera video, empty = no recording
+};
+
+struct ClosedLoopReport {
+    int frames = 0;
+    float sim_time = 0.0f;              // Simulated seconds
+    long long wall_mcs = 0;
+    float real_time_factor = 0.0f;      // Simulated time / wall time
+    double mean_render_ms = 0.0;
+    double mean_pipeline_ms = 0.0;
+    int collision_frames = 0;           // Frames with the drone inside an obstacle
+    float min_clearance = 0.0f;         // Closest distance between the drone and a surface [m]
+    float distance_flown = 0.0f;
+    bool reached_goal = false;
+
+    // AvoidancePlanner, per camera frame
+    double mean_planner_mcs = 0.0;
+    long long max_planner_mcs = 0;
+    double mean_candidates = 0.0;
+    int budget_exhausted_frames = 0;
+    int unsafe_frames = 0;              // No collision-free candidate
+};
+
+/**
+ * Fly the drone (SimulateSubsteps from DroneDynamicsDLL) through a procedural scene:
+ * every camera frame is rendered on the CPU, run through processFrame(), and the
+ * tracked obstacles steer the next target command. Runs as fast as the CPU allows.
+ * With `use_planner` the tracked obstacles are placed in the world at the range of the rendered
+ * depth inside their box (standing in for a calibrated depth scale) and AvoidancePlanner chooses
+ * the target.
+ *
+ * @param config Scene, drone, camera and controller settings.
+ * @return Flight statistics.
+ */
+ClosedLoopReport runClosedLoop(const ClosedLoopConfig& config);
+
+#endif //DRONE_NAVIGATION_CLOSED_LOOP_SIM_HPP
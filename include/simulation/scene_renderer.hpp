@@ -0,0 +1,74 @@
+#ifndef DRONE_NAVIGATION_SCENE_RENDERER_HPP
+#define DRONE_NAVIGATION_SCENE_RENDERER_HPP
+
+#include <vector>
+#include <Eigen/Dense>
+#include <opencv2/opencv.hpp>
+#include "occupancy_map.hpp"
+
+// Axis-aligned box obstacle, faces are textured with a checker pattern
+struct SceneBox {
+    Eigen::Vector3f min;
+    Eigen::Vector3f max;
+    cv::Vec3b color;
+};
+
+// Infinite plane with a two-colour checker texture (ground, walls)
+struct ScenePlane {
+    Eigen::Vector3f point;
+    Eigen::Vector3f normal;
+    cv::Vec3b color_a;
+    cv::Vec3b color_b;
+    float checker_size;
+};
+
+/**
+ * Procedural obstacle scene in world coordinates: y up, the flight corridor along +z.
+ */
+struct Scene {
+    std::vector<SceneBox> boxes;
+    std::vector<ScenePlane> planes;
+    cv::Vec3b sky{235, 206, 135};
+
+    /**
+     * Random boxes in a corridor over a checkered ground plane, with a wall behind the goal.
+     *
+     * @param seed Random seed, the same seed gives the same scene.
+     * @param num_boxes Number of box obstacles.
+     * @param length Corridor length along +z [m].
+     * @param width Corridor width along x [m].
+     * @return Generated scene.
+     */
+    static Scene procedural(unsigned seed, int num_boxes, float length, float width = 20.0f);
+
+    /**
+     * Distance from a point to the closest surface (ground truth for collision checks).
+     *
+     * @param point Point in world coordinates.
+     * @return Distance [m], negative inside a box.
+     */
+    [[nodiscard]] float distanceTo(const Eigen::Vector3f& point) const;
+};
+
+/**
+ * Ray-cast the scene on the CPU, rows are rendered in parallel.
+ *
+ * @param scene Scene to render.
+ * @param intrinsics Camera intrinsics in pixels of the output image.
+ * @param pose Camera pose in world coordinates (OpenCV camera frame: x right, y down, z forward).
+ * @param image Output colour image, must be allocated as CV_8UC3; its size is the render resolution.
+ * @param depth Optional output depth along the optical axis (CV_32F, meters, 0 = sky).
+ */
+void renderScene(const Scene& scene, const CameraIntrinsics& intrinsics, const CameraPose& pose,
+                 cv::Mat& image, cv::Mat* depth = nullptr);
+
+/**
+ * Convert metric depth to the colour-mapped relative inverse depth that depth_estimation()
+ * produces, so rendered depth can stand in for the depth model.
+ *
+ * @param depth Metric depth (CV_32F), 0 = no data.
+ * @return Colour-mapped depth (CV_8UC3, COLORMAP_INFERNO, brighter = closer).
+ */
+cv::Mat inverseDepthColormap(const cv::Mat& depth);
+
+#endif //DRONE_NAVIGATION_SCENE_RENDERER_HPP
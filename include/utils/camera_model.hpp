@@ -0,0 +1,89 @@
+#ifndef DRONE_NAVIGATION_CAMERA_MODEL_HPP
+#define DRONE_NAVIGATION_CAMERA_MODEL_HPP
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Pinhole intrinsics and lens distortion in OpenCV's model
+struct CameraCalibration {
+    cv::Matx33d camera_matrix = cv::Matx33d::eye();
+    std::vector<double> distortion;   // k1, k2, p1, p2[, k3[, k4, k5, k6]], empty = ideal pinhole
+    cv::Size image_size;              // Resolution the calibration was made at
+
+    [[nodiscard]] bool empty() const { return distortion.empty(); }
+};
+
+/**
+ * Load a calibration written by OpenCV's calibration tools (cv::FileStorage YAML/XML with
+ * camera_matrix, distortion_coefficients, image_width and image_height).
+ *
+ * @param path Calibration file.
+ * @param calibration Loaded calibration, unchanged on failure.
+ * @return false if the file is missing or incomplete.
+ */
+bool loadCameraCalibration(const std::string& path, CameraCalibration& calibration);
+
+/**
+ * Select the calibration used by every pipeline's CameraModel. Pipelines pick it up on
+ * their next frame.
+ *
+ * @param calibration Calibration, empty = ideal pinhole camera.
+ */
+void setCameraCalibration(const CameraCalibration& calibration);
+
+CameraCalibration getCameraCalibration();
+
+/**
+ * Maps single points between the distorted camera image and an ideal pinhole image with the
+ * same intrinsics. Undistortion uses a table of undistorted positions sampled every `lut_step`
+ * pixels of the frame and interpolated bilinearly, so the cost is per point, not per pixel.
+ * Distortion evaluates the lens model directly. Without a calibration both are the identity.
+ */
+class CameraModel {
+public:
+    explicit CameraModel(int lut_step = 8);
+
+    /**
+     * Use the calibration selected by setCameraCalibration() for frames of the given size.
+     * The table is rebuilt only when the calibration or the frame size changed.
+     *
+     * @param frame_size Size of the frames to be mapped; the intrinsics are scaled to it.
+     */
+    void update(const cv::Size& frame_size);
+
+    /**
+     * Use a calibration for frames of the given size.
+     *
+     * @param calibration Calibration, empty = identity mapping.
+     * @param frame_size Size of the frames to be mapped; the intrinsics are scaled to it.
+     */
+    void configure(const CameraCalibration& calibration, const cv::Size& frame_size);
+
+    [[nodiscard]] bool enabled() const { return !lut.empty(); }
+
+    // Table memory in bytes
+    [[nodiscard]] size_t lutBytes() const { return lut.total() * lut.elemSize(); }
+
+    /**
+     * @param point Position in the camera image (pixels).
+     * @return Position in the undistorted image (pixels).
+     */
+    [[nodiscard]] cv::Point2f undistort(const cv::Point2f& point) const;
+
+    /**
+     * @param point Position in the undistorted image (pixels).
+     * @return Position in the camera image (pixels), e.g. to draw on or sample the frame.
+     */
+    [[nodiscard]] cv::Point2f distort(const cv::Point2f& point) const;
+
+private:
+    int step;
+    int generation = -1;              // Calibration generation the table was built for
+    CameraCalibration calibration;
+    cv::Size frame_size;
+    cv::Matx33d camera_matrix;        // Scaled to frame_size
+    cv::Mat lut;                      // CV_32FC2, undistorted position of every step-th pixel
+};
+
+#endif //DRONE_NAVIGATION_CAMERA_MODEL_HPP
@@ -0,0 +1,91 @@
+#ifndef DRONE_NAVIGATION_FRAME_PYRAMID_HPP
+#define DRONE_NAVIGATION_FRAME_PYRAMID_HPP
+
+#include <deque>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * Derived images of the current frame, shared by all pipeline stages. Every view is
+ * computed at most once per frame, on first use, into buffers that keep their
+ * allocation from frame to frame:
+ *   - gray(region): grayscale, converted only inside the requested regions
+ *   - grayPyramid(): grayscale pyramid in the layout of cv::calcOpticalFlowPyrLK
+ *   - resized(region, size): colour region resized for a model input (INTER_LINEAR, like blobFromImage)
+ * Views stay valid until the next update(); the frame must not change before its views are built.
+ */
+class FramePyramid {
+public:
+    /**
+     * @param levels Pyramid levels above the full-resolution gray image.
+     * @param window Optical flow window the pyramid is padded for.
+     */
+    explicit FramePyramid(int levels = 3, cv::Size window = cv::Size(21, 21));
+
+    /**
+     * Start a new frame; all views are invalidated but keep their buffers.
+     *
+     * @param frame BGR frame (CV_8UC3), referenced, not copied.
+     */
+    void update(const cv::Mat& frame);
+
+    [[nodiscard]] const cv::Mat& frame() const { return color; }
+
+    /**
+     * Grayscale view of a frame region.
+     *
+     * @param region Region in frame coordinates.
+     * @return View into the frame-sized gray buffer.
+     */
+    cv::Mat gray(const cv::Rect& region);
+
+    // Grayscale view of the whole frame
+    cv::Mat gray() { return gray(cv::Rect(cv::Point(0, 0), color.size())); }
+
+    /**
+     * Grayscale pyramid of the whole frame, level 0 is full resolution. Can be passed
+     * directly to cv::calcOpticalFlowPyrLK with the same window and level count.
+     *
+     * @return Pyramid levels (with border padding, see cv::buildOpticalFlowPyramid).
+     */
+    const std::vector<cv::Mat>& grayPyramid();
+
+    /**
+     * Colour frame region resized to a fixed size, e.g. the depth model input.
+     *
+     * @param region Region in frame coordinates.
+     * @param size Output size.
+     * @return Resized BGR image, cached for the frame.
+     */
+    const cv::Mat& resized(const cv::Rect& region, const cv::Size& size);
+
+    [[nodiscard]] int levels() const { return max_level; }
+    [[nodiscard]] cv::Size window() const { return flow_window; }
+
+    // Frames seen since construction
+    [[nodiscard]] uint64_t frameCount() const { return frame_count; }
+
+    // Conversions and resizes actually computed, for checking the reuse
+    [[nodiscard]] uint64_t computeCount() const { return computed; }
+
+private:
+    struct ResizedView {
+        cv::Rect region;
+        cv::Size size;
+        cv::Mat image;
+        bool valid = false;
+    };
+
+    cv::Mat color;
+    cv::Mat gray_buffer;                    // Frame-sized, converted region by region
+    std::vector<cv::Rect> gray_regions;     // Regions converted this frame
+    std::vector<cv::Mat> pyramid;
+    bool pyramid_valid = false;
+    std::deque<ResizedView> resized_views;   // Deque: returned references survive new views
+    int max_level;
+    cv::Size flow_window;
+    uint64_t frame_count = 0;
+    uint64_t computed = 0;
+};
+
+#endif //DRONE_NAVIGATION_FRAME_PYRAMID_HPP
@@ -0,0 +1,89 @@
+#ifndef DRONE_NAVIGATION_THREAD_LAYOUT_HPP
+#define DRONE_NAVIGATION_THREAD_LAYOUT_HPP
+
+#include <string>
+#include <vector>
+
+// Kinds of threads that get their own cores
+enum class ThreadRole {
+    DEPTH,      // Depth inference: engine threads and OpenCV's parallel_for_ pool
+    PIPELINE,   // Thread running processFrame() (features, clustering, tracking)
+    IO          // Capture, network and recording threads
+};
+
+/**
+ * Cores assigned to each thread role; an empty set leaves the role unpinned.
+ * Text form: "depth=0-3;pipeline=4,5;io=6-7".
+ */
+struct ThreadLayout {
+    std::vector<int> depth;
+    std::vector<int> pipeline;
+    std::vector<int> io;
+
+    [[nodiscard]] const std::vector<int>& cores(ThreadRole role) const;
+    [[nodiscard]] bool empty() const { return depth.empty() && pipeline.empty() && io.empty(); }
+};
+
+// Parse / format core lists such as "0-3,6"; parsing returns false on malformed lists
+bool parseCoreList(const std::string& text, std::vector<int>& cores);
+std::string formatCoreList(const std::vector<int>& cores);
+
+/**
+ * Parse a layout in text form. Roles may be omitted, "auto" is the empty layout.
+ *
+ * @param text Layout such as "depth=0-3;pipeline=4,5;io=6-7".
+ * @param layout Parsed layout.
+ * @return false on unknown roles or malformed core lists.
+ */
+bool parseThreadLayout(const std::string& text, ThreadLayout& layout);
+std::string formatThreadLayout(const ThreadLayout& layout);
+
+/**
+ * Install the layout for all threads. OpenCV's thread pool is resized to the depth cores
+ * and restarted pinned to them (worker threads inherit the affinity of the thread that
+ * starts them, which holds for OpenCV's default pthreads backend). Threads move to their
+ * role's cores on their next enterThreadRole() or ThreadRoleScope. Call it before the
+ * depth engines are loaded; setDepthEngineConfig() reloads them.
+ *
+ * @param layout Core sets per role.
+ */
+void setThreadLayout(const ThreadLayout& layout);
+
+ThreadLayout getThreadLayout();
+
+/**
+ * Pin the calling thread to the cores of a role for the rest of its life.
+ *
+ * @param role Role of the calling thread.
+ */
+void enterThreadRole(ThreadRole role);
+
+/**
+ * Pin the calling thread to the cores of a role for a scope, e.g. the depth stage of the
+ * pipeline thread. Threads started inside the scope inherit the cores. The previous cores
+ * are restored at the end; a role without cores costs nothing.
+ */
+class ThreadRoleScope {
+public:
+    explicit ThreadRoleScope(ThreadRole role);
+    ~ThreadRoleScope();
+
+    ThreadRoleScope(const ThreadRoleScope&) = delete;
+    ThreadRoleScope& operator=(const ThreadRoleScope&) = delete;
+
+private:
+    int previous_role;
+};
+
+/**
+ * Pin the calling thread to a core set.
+ *
+ * @param cores Cores, empty = all cores available to the process.
+ * @return false if pinning is not supported or the cores are not available.
+ */
+bool pinCurrentThread(const std::vector<int>& cores);
+
+// Cores available to the process at startup
+const std::vector<int>& processCores();
+
+#endif //DRONE_NAVIGATION_THREAD_LAYOUT_HPP
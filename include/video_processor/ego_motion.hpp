@@ -0,0 +1,82 @@
+#ifndef DRONE_NAVIGATION_EGO_MOTION_HPP
+#define DRONE_NAVIGATION_EGO_MOTION_HPP
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Global image motion models; a homography also covers the perspective of rotations around the camera center
+enum class EgoMotionModel {
+    AFFINE,        // 3-point minimal sample
+    HOMOGRAPHY     // 4-point minimal sample
+};
+
+// Ego-motion estimation; disabled = tracks are not compensated for camera motion
+struct EgoMotionSettings {
+    bool enabled = false;
+    EgoMotionModel model = EgoMotionModel::AFFINE;
+    int max_distance = 64;          // Hamming distance of an accepted BRIEF match (of 256 bits)
+    float ratio = 0.8f;             // The best match must be closer than this share of the second best
+    float search_radius = 96.0f;    // Largest image motion of a feature between two frames [px]
+    float ransac_threshold = 2.0f;  // Reprojection error of an inlier [px]
+    int ransac_iterations = 512;    // Hypotheses, spread over the OpenCV worker threads
+    int min_inliers = 15;           // Fewer inliers = no estimate
+};
+
+// Camera motion between two frames, in undistorted frame coordinates
+struct EgoMotion {
+    bool valid = false;
+    cv::Matx33f transform = cv::Matx33f::eye();   // Previous frame to current frame
+    int matches = 0;                               // Descriptor matches passing the ratio test
+    int inliers = 0;                               // Matches consistent with `transform`
+
+    // Position of a previous-frame point in the current frame
+    [[nodiscard]] cv::Point2f apply(const cv::Point2f& point) const;
+
+    // Derivative of apply() at a point, maps velocities and covariances
+    [[nodiscard]] cv::Matx22f jacobian(const cv::Point2f& point) const;
+};
+
+/**
+ * Frame-to-frame camera motion from the BRIEF descriptors the feature stage computes. Every
+ * feature is matched against the previous frame's features within the search radius, and a
+ * global affine transform or homography is fitted to the matches with RANSAC. Hypotheses are
+ * evaluated in fixed batches on the OpenCV thread pool, each batch with its own seeded random
+ * generator, so the estimate does not depend on the number of threads. The best hypothesis is
+ * refined by least squares on its inliers.
+ */
+class EgoMotionEstimator {
+public:
+    /**
+     * Estimate the motion from the previous call's features to these, then keep these as the reference.
+     *
+     * @param points Feature positions in undistorted frame coordinates.
+     * @param descriptors BRIEF descriptors, one row per point.
+     * @param settings Estimation settings.
+     * @param motion Estimated motion; invalid without a reference or with too few inliers.
+     */
+    void update(const std::vector<cv::Point2f>& points, const cv::Mat& descriptors,
+                const EgoMotionSettings& settings, EgoMotion& motion);
+
+    // Forget the reference frame, e.g. when the source changes
+    void reset();
+
+private:
+    // Match the current features to the reference; fills `from` and `to`
+    void match(const std::vector<cv::Point2f>& points, const cv::Mat& descriptors, const EgoMotionSettings& settings);
+
+    // Reference features bucketed into cells of the search radius
+    void buildGrid(float cell_size);
+
+    std::vector<cv::Point2f> reference_points;
+    cv::Mat reference_descriptors;
+    std::vector<int> cell_offsets;      // Start of each cell in cell_points, one past the end for the last
+    std::vector<int> cell_points;       // Reference indices sorted by cell
+    cv::Point2f grid_origin;
+    cv::Size grid_size;
+    float grid_cell = 0.0f;
+
+    std::vector<int> matched;           // Per current point: reference index or -1
+    std::vector<cv::Point2f> from, to;  // Matched pairs
+};
+
+#endif //DRONE_NAVIGATION_EGO_MOTION_HPP
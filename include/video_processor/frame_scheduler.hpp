@@ -0,0 +1,79 @@
+#ifndef DRONE_NAVIGATION_FRAME_SCHEDULER_HPP
+#define DRONE_NAVIGATION_FRAME_SCHEDULER_HPP
+
+#include <iostream>
+#include <vector>
+
+// Pipeline stages timed for every frame
+enum PipelineStage {
+    STAGE_DEPTH,       // Depth inference and post-processing
+    STAGE_FEATURES,    // FAST, BRIEF and NMS
+    STAGE_CLUSTERING,  // Depth filter, kNN and DBSCAN
+    STAGE_TRACKING,    // Kalman predict/update
+    STAGE_DISPLAY,     // Drawing and showing the annotated frame
+    STAGE_COUNT
+};
+
+const char* stageName(PipelineStage stage);
+
+// Time spent in each stage of one frame
+struct StageTimings {
+    long long mcs[STAGE_COUNT] = {};
+
+    [[nodiscard]] long long total() const;
+};
+
+// Quality knobs of the pipeline, adjusted at runtime by the scheduler
+struct QualitySettings {
+    int fast_threshold = 10;          // FAST detector threshold (OpenCV default)
+    int max_keypoints = 0;            // Keep only the strongest N keypoints, 0 = unlimited
+    int depth_refresh_interval = 1;   // Run depth inference every N frames
+    bool display = true;              // Show the annotated frame
+};
+
+/**
+ * Frame-budget scheduler. Measures every stage against a target frame period and
+ * degrades the pipeline quality when over budget, restoring it when there is headroom.
+ * Each decision is logged with the frame index.
+ */
+class FrameScheduler {
+public:
+    /**
+     * @param target_period_ms Frame budget, usually 1000 / camera fps.
+     * @param log Stream to log the quality decisions to.
+     */
+    explicit FrameScheduler(double target_period_ms, std::ostream& log = std::cout);
+
+    /**
+     * Account a finished frame and adjust the quality settings for the next one.
+     *
+     * @param frame_index Index of the finished frame.
+     * @param timings Stage timings of the finished frame.
+     * @param quality Settings to adjust in place.
+     */
+    void update(int frame_index, const StageTimings& timings, QualitySettings& quality);
+
+private:
+    enum Action { LOWER_KEYPOINT_BUDGET, RAISE_FAST_THRESHOLD, SKIP_DEPTH_REFRESH, DROP_DISPLAY };
+
+    // Applied degradation with the value it replaced, undone in LIFO order
+    struct Decision {
+        Action action;
+        int previous_value;
+    };
+
+    bool degrade(PipelineStage stage, QualitySettings& quality, Decision& decision) const;
+    void restore(const Decision& decision, QualitySettings& quality) const;
+    void logDecision(int frame_index, const char* reason, const Decision& decision,
+                     const QualitySettings& quality) const;
+
+    double target_mcs;
+    double stage_ema[STAGE_COUNT] = {};
+    double frame_ema = 0.0;
+    int cooldown = 0;          // Frames to wait before the next decision
+    int headroom_frames = 0;   // Consecutive frames well under budget
+    std::vector<Decision> decisions;
+    std::ostream& log;
+};
+
+#endif //DRONE_NAVIGATION_FRAME_SCHEDULER_HPP
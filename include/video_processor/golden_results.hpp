@@ -0,0 +1,93 @@
+#ifndef DRONE_NAVIGATION_GOLDEN_RESULTS_HPP
+#define DRONE_NAVIGATION_GOLDEN_RESULTS_HPP
+
+#include <string>
+#include <vector>
+#include "video_processor.hpp"
+
+// Latency percentiles of one stage over a run [mcs]
+struct LatencyPercentiles {
+    long long p50 = 0;
+    long long p90 = 0;
+    long long p99 = 0;
+    long long max = 0;
+};
+
+// Per-stage latency of a run; the entry at STAGE_COUNT is the whole frame
+struct LatencySummary {
+    LatencyPercentiles stages[STAGE_COUNT + 1];
+};
+
+// Recorded pipeline output of one video
+struct GoldenRun {
+    std::string video;
+    std::vector<FrameResult> frames;
+    LatencySummary latency;
+};
+
+// How far a run may drift from its golden results before a frame counts as drifted
+struct GoldenTolerances {
+    float keypoint_ratio = 0.05f;     // Relative difference of the keypoint counts
+    float depth = 2.0f;               // Median depth difference, in filtered depth units
+    float centroid_px = 3.0f;         // Centroid distance of matched obstacles
+    float velocity = 10.0f;           // Velocity difference of matched obstacles [px/s]
+    int obstacle_count = 0;           // Difference in the number of obstacles
+    float drifted_frames = 0.0f;      // Fraction of drifted frames that still passes
+};
+
+// Drift of a run against its golden results
+struct GoldenComparison {
+    int frames = 0;                   // Frames present in both runs
+    int missing_frames = 0;           // Frames present in only one of the runs
+    int drifted_frames = 0;
+    int first_drifted_frame = -1;
+    int unmatched_obstacles = 0;      // Obstacles without a counterpart within the centroid tolerance
+    double mean_centroid_error = 0.0; // Over matched obstacles [px]
+    double max_centroid_error = 0.0;
+    double max_depth_error = 0.0;
+    double max_keypoint_error = 0.0;  // Relative
+    std::vector<std::string> details; // Reasons for the first drifted frames
+
+    [[nodiscard]] bool passed(const GoldenTolerances& tolerances) const;
+};
+
+/**
+ * Compute per-stage and whole-frame latency percentiles from the frame timings.
+ *
+ * @param results Per-frame results of a run.
+ * @return Latency percentiles.
+ */
+LatencySummary summarizeLatency(const std::vector<FrameResult>& results);
+
+/**
+ * Write a run as a compact text golden file: latency percentiles, then one line per
+ * frame followed by one line per obstacle.
+ *
+ * @param path Output file.
+ * @param run Run to record.
+ * @return true on success.
+ */
+bool writeGoldenFile(const std::string& path, const GoldenRun& run);
+
+/**
+ * Read a golden file written by writeGoldenFile().
+ *
+ * @param path Golden file.
+ * @param run Output run.
+ * @return true on success, false if the file is missing or malformed.
+ */
+bool readGoldenFile(const std::string& path, GoldenRun& run);
+
+/**
+ * Compare a run frame by frame with its golden results. Obstacles are matched by
+ * nearest centroid, so cluster order and IDs may change between runs.
+ *
+ * @param golden Recorded results.
+ * @param results Results of the current run.
+ * @param tolerances Allowed drift per frame.
+ * @return Drift statistics.
+ */
+GoldenComparison compareWithGolden(const GoldenRun& golden, const std::vector<FrameResult>& results,
+                                   const GoldenTolerances& tolerances);
+
+#endif //DRONE_NAVIGATION_GOLDEN_RESULTS_HPP
@@ -0,0 +1,71 @@
+#ifndef DRONE_NAVIGATION_MOTION_GATE_HPP
+#define DRONE_NAVIGATION_MOTION_GATE_HPP
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "frame_pyramid.hpp"
+
+// Motion gating of the pipeline; disabled = every frame is processed in full
+struct MotionGateSettings {
+    bool enabled = false;
+    int tile_size = 64;             // Change detection tiles [px]
+    int pyramid_level = 2;          // Pyramid level the tiles are compared on (1/4 resolution)
+    float threshold = 6.0f;         // Mean absolute gray difference of a changed tile
+    float full_fraction = 0.5f;     // Changed share above which the whole frame is reprocessed (camera motion)
+    int refresh_interval = 30;      // Full refresh every N frames
+};
+
+/**
+ * Block-wise change detector. Tiles are compared by their mean absolute difference on a
+ * downsampled gray level against the last image they were processed with, so slow changes
+ * add up until they cross the threshold. Changed tiles are grown by one tile to cover
+ * features straddling tile borders.
+ */
+class MotionGate {
+public:
+    /**
+     * Mark the changed tiles of a frame.
+     *
+     * @param pyramid Images of the current frame.
+     * @param frame_index Index of the frame, for the periodic full refresh.
+     * @param settings Gate settings.
+     */
+    void update(FramePyramid& pyramid, int frame_index, const MotionGateSettings& settings);
+
+    // Treat the current frame as fully changed, e.g. after the ROIs or quality settings changed
+    void forceFull();
+
+    [[nodiscard]] bool full() const { return full_frame; }
+    [[nodiscard]] bool anyChanged() const { return full_frame || changed_tiles > 0; }
+
+    // Share of the frame marked as changed, 1 for a full frame
+    [[nodiscard]] float changedFraction() const;
+
+    // Whether an area in frame coordinates overlaps a changed tile
+    [[nodiscard]] bool changed(const cv::Rect& area) const;
+    [[nodiscard]] bool changed(const cv::Point2f& point) const;
+
+    /**
+     * Changed tiles inside a region, merged into rectangles row by row.
+     *
+     * @param region Region in frame coordinates.
+     * @return Changed areas in frame coordinates, clipped to the region.
+     */
+    [[nodiscard]] std::vector<cv::Rect> changedRects(const cv::Rect& region) const;
+
+private:
+    // Tiles covering an area, in tile coordinates
+    [[nodiscard]] cv::Rect tileRange(const cv::Rect& area) const;
+
+    cv::Mat reference;        // Level image each tile was last processed with
+    cv::Mat current;          // Level image of the current frame, owned by the pyramid
+    cv::Mat tiles;           // CV_8U per tile, non-zero = changed
+    cv::Mat diff;
+    cv::Size frame_size;
+    int tile_size = 64;
+    int level = 0;
+    int changed_tiles = 0;
+    bool full_frame = true;
+};
+
+#endif //DRONE_NAVIGATION_MOTION_GATE_HPP
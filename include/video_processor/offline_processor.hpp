@@ -0,0 +1,49 @@
+#ifndef DRONE_NAVIGATION_OFFLINE_PROCESSOR_HPP
+#define DRONE_NAVIGATION_OFFLINE_PROCESSOR_HPP
+
+#include <string>
+#include <vector>
+#include "video_processor.hpp"
+
+// Options of the chunk-parallel offline mode
+struct ChunkedProcessingOptions {
+    int num_workers = 0;     // Worker threads, 0 = hardware concurrency
+    int chunk_frames = 0;    // Frames per chunk, 0 = split evenly between workers
+    int warmup_frames = 15;  // Frames replayed before each chunk to warm up the trackers
+};
+
+// Contiguous frame range [begin, end) processed by one worker
+struct VideoChunk {
+    int begin;
+    int end;
+    std::string output_path;          // Temporary annotated video of the chunk
+    std::vector<FrameResult> results;
+    std::vector<FrameResult> warmup_results;   // Replayed frames before `begin`, to link the track IDs
+    bool ok = false;
+};
+
+/**
+ * Split a video into frame ranges for chunked processing.
+ *
+ * @param total_frames Number of frames in the video.
+ * @param chunk_frames Number of frames per chunk.
+ * @return Chunks covering [0, total_frames) in order.
+ */
+std::vector<VideoChunk> splitIntoChunks(int total_frames, int chunk_frames);
+
+/**
+ * Process a recorded video offline, splitting it into chunks processed in parallel.
+ * Each worker opens its own decoder and pipeline context, set up like a live run; before
+ * its first frame it replays `warmup_frames` preceding frames so tracker states match a
+ * sequential run. Track IDs are renumbered across chunks: a track that follows the same
+ * obstacle as a track of the previous chunk during the replayed frames keeps its ID.
+ * Annotated chunks are stitched into a single output video and per-frame results are
+ * written to a CSV file, both in frame order.
+ *
+ * @param video_path Path to the input video.
+ * @param options Chunking options.
+ * @return 0 on success, non-zero on failure.
+ */
+int processVideoChunked(const std::string& video_path, const ChunkedProcessingOptions& options = {});
+
+#endif //DRONE_NAVIGATION_OFFLINE_PROCESSOR_HPP
@@ -0,0 +1,99 @@
+#ifndef DRONE_NAVIGATION_PIPELINE_METRICS_HPP
+#define DRONE_NAVIGATION_PIPELINE_METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "frame_scheduler.hpp"
+
+struct FrameResult;
+
+// Monotonic event count
+class MetricCounter {
+public:
+    void add(uint64_t count = 1) { value.fetch_add(count, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// Last observed value
+class MetricGauge {
+public:
+    void set(double new_value) { value.store(new_value, std::memory_order_relaxed); }
+    [[nodiscard]] double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value{0.0};
+};
+
+/**
+ * Latency histogram with fixed buckets from 0.5 ms to 1 s. Observations are a bucket search
+ * and three relaxed atomic adds; readers may see a bucket updated before the sum.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 13;   // Upper bounds below, the last bucket is unbounded
+
+    // Upper bound of bucket i < BUCKETS - 1 [mcs]
+    static long long bound(int bucket);
+
+    void observe(long long mcs);
+
+    [[nodiscard]] uint64_t bucketCount(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t sumMcs() const { return sum.load(std::memory_order_relaxed); }
+
+    // Observations over all buckets
+    [[nodiscard]] uint64_t count() const;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS] = {};   // Not cumulative
+    std::atomic<uint64_t> sum{0};
+};
+
+/**
+ * Process-wide pipeline health metrics. The pipeline threads only update atomics; exporters
+ * (MetricsServer, MetricsPublisher) read them from their own threads.
+ */
+struct PipelineMetrics {
+    MetricCounter frames_in;          // Frames read from the source or received
+    MetricCounter frames_out;         // Frames processed
+    MetricCounter frames_dropped;     // Frames lost before processing (source gaps, full queues)
+    MetricCounter depth_inferences;   // Depth model runs, one per refreshed region
+
+    MetricGauge frame_queue;          // Frames waiting for the pipeline
+    MetricGauge record_queue;         // Frames waiting to be written to disk
+
+    // Last processed frame
+    MetricGauge keypoints;
+    MetricGauge filtered_keypoints;
+    MetricGauge clusters;
+    MetricGauge tracks;
+    MetricGauge changed_fraction;
+
+    LatencyHistogram stage_latency[STAGE_COUNT];
+    LatencyHistogram frame_latency;   // All stages of processFrame()
+    LatencyHistogram depth_latency;   // Depth model per region, pre- and post-processing included
+
+    /**
+     * Count a processed frame and observe its stage timings.
+     *
+     * @param result Per-frame pipeline results.
+     * @param track_count Active trackers after the frame.
+     */
+    void recordFrame(const FrameResult& result, size_t track_count);
+};
+
+// Metrics of this process
+PipelineMetrics& pipelineMetrics();
+
+/**
+ * Prometheus text exposition (format 0.0.4) of the metrics, names prefixed with "drone_navigation_".
+ *
+ * @param metrics Metrics to export.
+ * @return Exposition text.
+ */
+std::string formatPrometheus(const PipelineMetrics& metrics);
+
+#endif //DRONE_NAVIGATION_PIPELINE_METRICS_HPP
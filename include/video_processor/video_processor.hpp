@@ -8,15 +8,181 @@
 #include <vector>
 #include <algorithm>
 #include <unordered_map>
+#include <functional>
 #include <fstream>
 #include "depth_estimation.hpp"
 #include "kalman.hpp"
 #include "feature_detector.hpp"
 #include "time_meas.hpp"
 #include "path_utils.hpp"
+#include "frame_scheduler.hpp"
+#include "frame_source.hpp"
+#include "thread_layout.hpp"
+#include "motion_gate.hpp"
+#include "camera_model.hpp"
+#include "ego_motion.hpp"
+#include "pipeline_metrics.hpp"
 
+// Configuration defines shared by the live and offline pipelines
+#define USE_EKF 1                    // 0=Kalman,               1=EKF
+
+#if USE_EKF
+typedef ExtendedKalmanFilter Filter;
+#else
+typedef KalmanFilter Filter;
+#endif
+
+// Filter of one obstacle, kept across frames while clusters are associated with it
+struct Track {
+    Filter filter;
+    int misses = 0;   // Consecutive frames without an associated cluster
+};
+
+// Cluster-to-track association
+struct TrackingSettings {
+    float gate = 24.0f;                // Largest distance of a cluster from a predicted track position [px]
+    float uncompensated_gate = 96.0f;  // Gate when camera motion is not compensated (no ego-motion estimate)
+    int max_misses = 5;                // Tracks without a cluster for longer are dropped
+};
+
+// Obstacle cluster tracked in a single frame
+struct TrackedObstacle {
+    int id;                 // Track ID, kept while the obstacle is tracked
+    cv::Point2f center;     // Cluster centroid in undistorted frame coordinates
+    cv::Point2f velocity;   // Filter velocity estimate [px/s]
+    int point_count;        // Number of keypoints in the cluster
+    float depth_median;     // Filtered depth statistics over the cluster keypoints
+    float depth_min;
+    float depth_max;
+    cv::Rect bbox;          // Bounding box of the cluster keypoints in undistorted frame coordinates
+    cv::Matx22f covariance; // Spread of the cluster keypoints [px^2]
+};
+
+// Per-frame output of the processing pipeline
+struct FrameResult {
+    int frame_index = 0;
+    int keypoint_count = 0;           // Keypoints after NMS
+    int filtered_keypoint_count = 0;  // Keypoints that passed the depth filter
+    float median_depth = 0.0f;
+    float changed_fraction = 1.0f;    // Share of the frame the motion gate reprocessed, 1 = full frame
+    EgoMotion ego_motion;             // Camera motion since the previous frame, invalid = not estimated
+    std::vector<TrackedObstacle> obstacles;
+    StageTimings timings;
+};
+
+// Stage results of the last frame, reused by the motion gate for static tiles
+struct StageCache {
+    bool valid = false;
+    std::vector<cv::Rect> regions;
+    int fast_threshold = 0;
+    int max_keypoints = 0;
+    std::vector<std::vector<cv::KeyPoint>> region_keypoints;   // Region coordinates
+    float median_depth = 0.0f;
+    int filtered_keypoint_count = 0;
+    std::vector<bool> stale_depth;   // Per region: changed since its last depth inference
+};
+
+// State owned by one pipeline instance. Detectors and trackers are not
+// thread-safe, so every worker thread needs its own context.
+struct PipelineContext {
+    cv::Ptr<cv::FastFeatureDetector> fast;
+    cv::Ptr<cv::xfeatures2d::BriefDescriptorExtractor> brief;
+    cv::Ptr<cv::CLAHE> clahe;
+    std::unordered_map<int, Track> trackers;   // By track ID
+    int next_track_id = 0;
+    TrackingSettings tracking;
+    QualitySettings quality;
+
+    // Regions of interest in frame coordinates, empty = full frame
+    std::vector<cv::Rect> rois;
+    bool roi_follow = false;   // Move each ROI with the obstacle closest to its center
+
+    // Depth of a frame region in the format of depth_estimation() (colour-mapped inverse depth).
+    // Empty = run the depth model; simulations plug rendered depth in here.
+    std::function<cv::Mat(const cv::Mat& region_image, const cv::Rect& region)> depth_source;
+
+    // Depth maps of the last processed frame, filled only inside `depth_regions`
+    cv::Mat depth_map;
+    cv::Mat depth_filtered;
+    std::vector<cv::Rect> depth_regions;
+
+    // Clusters of the last processed frame; kept to reuse their buffers and for static frames
+    ClusterSet clusters;
+
+    // Images derived from the current frame, shared by all stages
+    FramePyramid pyramid;
+
+    // Lens undistortion of keypoints, updated from setCameraCalibration() every frame
+    CameraModel camera;
+
+    // Skip the stages for static tiles and frames, see MotionGate
+    MotionGateSettings motion;
+    MotionGate motion_gate;
+    StageCache cache;
+
+    // Camera motion from frame to frame, compensated in the track states, see EgoMotionEstimator
+    EgoMotionSettings ego_motion;
+    EgoMotionEstimator ego_estimator;
+
+    PipelineContext();
+};
+
+/**
+ * Apply the pipeline options compiled into video_processor.cpp (ROI following, motion gating,
+ * ego-motion) to a fresh context, so that live and offline runs process frames the same way.
+ *
+ * @param context Context to set up.
+ * @param rois Regions of interest, empty = full frame.
+ */
+void configurePipeline(PipelineContext& context, const std::vector<cv::Rect>& rois = {});
+
+/**
+ * Run depth estimation, feature detection, clustering and tracking on one frame.
+ * Depth inference, FAST, NMS, clustering and the depth median run only inside the
+ * context's ROIs. The context's quality settings decide the FAST threshold, the keypoint
+ * budget and how often the depth map is refreshed. With motion gating enabled, depth and
+ * features are recomputed only where the frame changed and clustering is skipped for static
+ * frames; tracking always runs. Clusters are associated with the tracks predicted nearest to
+ * them within a gate; with ego-motion enabled, the tracks are first moved with the camera
+ * motion estimated from the BRIEF descriptors, which keeps the gate tight.
+ *
+ * @param context Pipeline state carried between frames.
+ * @param frame Input frame, read only; a borrowed source buffer can be passed directly.
+ * @param result Per-frame results, frame_index must be set by the caller.
+ */
+void analyzeFrame(PipelineContext& context, const cv::Mat& frame, FrameResult& result);
+
+/**
+ * Draw the clusters, tracks and ROIs of the last analyzed frame.
+ *
+ * @param context Pipeline state after analyzeFrame().
+ * @param result Results of that frame.
+ * @param frame Image of that frame to annotate.
+ */
+void drawFrameResult(const PipelineContext& context, const FrameResult& result, cv::Mat& frame);
+
+/**
+ * analyzeFrame() followed by drawFrameResult() on the same image.
+ *
+ * @param context Pipeline state carried between frames.
+ * @param frame Input frame, annotated in place.
+ * @param result Per-frame results, frame_index must be set by the caller.
+ */
+void processFrame(PipelineContext& context, cv::Mat& frame, FrameResult& result);
+
+/**
+ * Let the user select regions of interest on the first frame, then process the video.
+ *
+ * @param video_path Video file, image directory or source URI (see openFrameSource()).
+ */
 void selectROI(std::string &video_path);
-void processVideo(std::string &video_path);
-void mouseCallback(int event, int x, int y, int, void* userdata);
+
+/**
+ * Process a frame source, restricting all stages to the given regions of interest.
+ *
+ * @param video_path Video file, image directory or source URI (see openFrameSource()).
+ * @param rois Regions of interest, empty = full frame.
+ */
+void processVideo(std::string &video_path, const std::vector<cv::Rect>& rois = {});
 
 #endif //DRONE_NAVIGATION_VIDEO_PROCESSOR_HPP
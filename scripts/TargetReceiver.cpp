@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "target_connection.hpp"
+
+// Native stand-in for DroneTargetReceiver.cs: accepts TargetSender connections, acknowledges
+// every frame and reports throughput and sender-to-receiver latency.
+//   ./bin/target_receiver [--port=11000] [--once] [--verbose]
+// Latency uses the sender timestamps, so it is only meaningful with both ends on one host.
+// --once exits after the first sender disconnects.
+
+struct ReceiveWindow {
+    uint64_t frames = 0;
+    uint64_t waypoints = 0;
+    std::vector<double> latency_us;
+
+    void print(const char* label, double seconds) {
+        double mean = 0.0, worst = 0.0;
+        for (double value : latency_us) {
+            mean += value;
+            worst = std::max(worst, value);
+        }
+        if (!latency_us.empty()) mean /= static_cast<double>(latency_us.size());
+
+        std::cout << label << frames / seconds << " msgs/s, " << waypoints / seconds << " waypoints/s, latency [us] mean "
+                  << mean << ", max " << worst << std::endl;
+    }
+
+    void reset() {
+        frames = 0;
+        waypoints = 0;
+        latency_us.clear();
+    }
+};
+
+// Sequence number of the last applied frame, kept across connections to drop retransmissions
+struct AppliedSequence {
+    bool valid = false;
+    uint32_t last = 0;
+};
+
+// Serves one sender until it disconnects, returns false if the stream was corrupt
+static bool serveClient(target_socket_t client, bool verbose, AppliedSequence& applied) {
+    TargetFrameHeader header;
+    std::vector<TargetWaypoint> waypoints;
+    std::vector<char> buffer;
+    ReceiveWindow window, total;
+    uint32_t expected_sequence = 0, gaps = 0, retransmissions = 0;
+
+    auto session_start = std::chrono::steady_clock::now();
+    auto window_start = session_start;
+
+    int status;
+    while ((status = receiveTargetFrame(client, header, waypoints)) == 1) {
+        auto latency = static_cast<double>(targetClockMicros() - header.timestamp_us);
+        if (total.frames > 0 && header.sequence != expected_sequence) gaps++;
+        expected_sequence = header.sequence + 1;
+
+        // Acknowledge first so that the sender's RTT does not include our bookkeeping
+        if (!sendTargetFrame(client, TARGET_MSG_ACK, header.sequence, header.timestamp_us, nullptr, 0, buffer)) break;
+
+        // The sender reconnected and resent a frame whose ACK it did not get
+        if (applied.valid && header.sequence == applied.last) {
+            retransmissions++;
+            continue;
+        }
+        applied.valid = true;
+        applied.last = header.sequence;
+
+        for (ReceiveWindow* stats : {&window, &total}) {
+            stats->frames++;
+            stats->waypoints += header.count;
+            stats->latency_us.push_back(latency);
+        }
+
+        if (verbose) {
+            std::cout << "#" << header.sequence << " type " << static_cast<int>(header.type) << ", " << header.count
+                      << " waypoints";
+            if (header.count > 0) {
+                std::cout << ", first (" << waypoints[0].x << ", " << waypoints[0].y << ", " << waypoints[0].z << ")";
+            }
+            std::cout << std::endl;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - window_start).count();
+        if (elapsed >= 1.0) {
+            window.print("", elapsed);
+            window.reset();
+            window_start = now;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - session_start).count();
+    std::cout << "Sender disconnected after " << total.frames << " frames, " << gaps << " sequence gaps, "
+              << retransmissions << " retransmissions dropped" << std::endl;
+    if (total.frames > 0) total.print("Session: ", std::max(seconds, 1e-9));
+
+    if (status < 0) {
+        std::cerr << "Error: Invalid frame header, closing the connection." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int port = TARGET_PROTOCOL_DEFAULT_PORT;
+    bool once = false, verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (hasOption("--port=")) port = std::stoi(value("--port="));
+            else if (arg == "--once") once = true;
+            else if (arg == "--verbose") verbose = true;
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    if (!targetSocketStartup()) {
+        std::cerr << "WSAStartup failed." << std::endl;
+        return -1;
+    }
+
+    target_socket_t listener = listenTarget(port);
+    if (listener == TARGET_INVALID_SOCKET) {
+        std::cerr << "Error: Could not listen on port " << port << std::endl;
+        targetSocketCleanup();
+        return -1;
+    }
+    std::cout << "Listening for target data on port " << port << std::endl;
+
+    int status = 0;
+    AppliedSequence applied;
+    while (true) {
+        target_socket_t client = accept(listener, nullptr, nullptr);
+        if (client == TARGET_INVALID_SOCKET) {
+            std::cerr << "Error: accept() failed." << std::endl;
+            status = -1;
+            break;
+        }
+        setTargetNoDelay(client);
+
+        bool ok = serveClient(client, verbose, applied);
+        closeTargetSocket(client);
+        if (once) {
+            status = ok ? 0 : -1;
+            break;
+        }
+    }
+
+    closeTargetSocket(listener);
+    targetSocketCleanup();
+    return status;
+}
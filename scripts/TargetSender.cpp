@@ -1,102 +1,260 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
-#include <cstring>
-#ifdef _WIN32
-    #include <winsock2.h>
-    #pragma comment(lib, "ws2_32.lib")
-    typedef int socklen_t;
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-#endif
-
-int main() {
-#ifdef _WIN32
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2,2), &wsaData) != 0) {
-        std::cerr << "WSAStartup failed." << std::endl;
-        return -1;
+#include <thread>
+#include <vector>
+#include "target_connection.hpp"
+
+// Sends targets to the simulation over one persistent connection (target_protocol.h).
+//   ./bin/target_sender [--host=127.0.0.1] [--port=11000]
+//       Interactive: "x,y,z" appends a target, "home" returns to the start position.
+//   ./bin/target_sender --stream=trajectory.txt [--rate=Hz] [--batch=N] [--repeat=N] [--replace]
+//       Streams a trajectory file (one "x,y,z" per line, '#' comments) in frames of N waypoints,
+//       at the given frame rate (0 = as fast as possible), and reports round-trip latency.
+
+struct AckStatistics {
+    std::mutex mutex;
+    std::vector<double> rtt_us;
+    std::atomic<uint32_t> acked{0};
+};
+
+static bool parseWaypoint(const std::string& text, TargetWaypoint& waypoint) {
+    std::string line = text;
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream iss(line);
+    return static_cast<bool>(iss >> waypoint.x >> waypoint.y >> waypoint.z);
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static bool loadTrajectory(const std::string& path, std::vector<TargetWaypoint>& waypoints) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open trajectory file " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        TargetWaypoint waypoint{};
+        if (!parseWaypoint(line, waypoint)) {
+            std::cerr << "Error: Invalid trajectory line: " << line << std::endl;
+            return false;
+        }
+        waypoints.push_back(waypoint);
+    }
+    return true;
+}
+
+// Reads ACKs until the connection closes and records the round-trip time of each frame
+static void readAcks(target_socket_t sock, AckStatistics& statistics) {
+    TargetFrameHeader header;
+    std::vector<TargetWaypoint> unused;
+    while (receiveTargetFrame(sock, header, unused) == 1) {
+        if (header.type != TARGET_MSG_ACK) continue;
+        double rtt = static_cast<double>(targetClockMicros() - header.timestamp_us);
+        {
+            std::lock_guard<std::mutex> lock(statistics.mutex);
+            statistics.rtt_us.push_back(rtt);
+        }
+        statistics.acked++;
+    }
+}
+
+static double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    auto index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<long>(index), values.end());
+    return values[index];
+}
+
+static int streamTrajectory(target_socket_t sock, const std::vector<TargetWaypoint>& trajectory,
+                            double rate, int batch, int repeat, bool replace) {
+    AckStatistics statistics;
+    std::thread ack_reader(readAcks, sock, std::ref(statistics));
+
+    std::vector<char> buffer;
+    uint32_t sequence = randomTargetSequence();
+    uint32_t frames_sent = 0;
+    size_t waypoints_sent = 0;
+    bool ok = true;
+
+    const auto period = std::chrono::duration<double>(rate > 0.0 ? 1.0 / rate : 0.0);
+    auto start = std::chrono::steady_clock::now();
+    auto next_send = start;
+
+    for (int pass = 0; pass < repeat && ok; ++pass) {
+        for (size_t offset = 0; offset < trajectory.size(); offset += static_cast<size_t>(batch)) {
+            auto count = static_cast<uint32_t>(std::min(static_cast<size_t>(batch), trajectory.size() - offset));
+            uint8_t type = (replace && frames_sent == 0) ? TARGET_MSG_REPLACE : TARGET_MSG_WAYPOINTS;
+
+            if (rate > 0.0) {
+                std::this_thread::sleep_until(next_send);
+                next_send += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            }
+            if (!sendTargetFrame(sock, type, sequence, targetClockMicros(), &trajectory[offset], count, buffer)) {
+                std::cerr << "Error: Connection lost after " << frames_sent << " frames." << std::endl;
+                ok = false;
+                break;
+            }
+            sequence++;
+            frames_sent++;
+            waypoints_sent += count;
+        }
+    }
+    double send_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Give the receiver a moment to acknowledge the tail of the stream
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (statistics.acked < frames_sent && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    shutdown(sock, 2);
+    ack_reader.join();
+
+    std::vector<double> rtt;
+    {
+        std::lock_guard<std::mutex> lock(statistics.mutex);
+        rtt = statistics.rtt_us;
     }
-#endif
+    double mean = 0.0;
+    for (double value : rtt) mean += value;
+    if (!rtt.empty()) mean /= static_cast<double>(rtt.size());
 
-    const char* serverIP = "127.0.0.1";
-    const int port = 11000;
-    
+    std::cout << "Sent " << frames_sent << " frames (" << waypoints_sent << " waypoints) in " << send_seconds << " s: "
+              << frames_sent / std::max(send_seconds, 1e-9) << " msgs/s, "
+              << waypoints_sent / std::max(send_seconds, 1e-9) << " waypoints/s" << std::endl;
+    std::cout << "Acknowledged " << rtt.size() << " frames, RTT [us] mean " << mean
+              << ", p50 " << percentile(rtt, 0.5) << ", p99 " << percentile(rtt, 0.99)
+              << ", max " << percentile(rtt, 1.0) << std::endl;
+    return ok && rtt.size() == frames_sent ? 0 : -1;
+}
+
+static void interactive(const std::string& host, int port) {
     std::cout << "Enter target coordinates as \"x,y,z\" or type \"home\" to return to starting position." << std::endl;
     std::cout << "Type \"quit\" to exit." << std::endl;
-    
+
+    target_socket_t sock = TARGET_INVALID_SOCKET;
+    std::vector<char> buffer;
+    std::vector<TargetWaypoint> unused;
+    uint32_t sequence = randomTargetSequence();
+
     std::string input;
     while (true) {
         std::cout << "> ";
-        std::getline(std::cin, input);
-        
-        if (input == "quit") {
-            break;
-        }
-        
-        std::istringstream iss(input);
-        std::string trimmed;
-        iss >> trimmed;
+        if (!std::getline(std::cin, input)) break;
+
+        // The whole line, so "1, 2, 3" and "1 2 3" parse like "1,2,3"
+        std::string trimmed = trim(input);
+        if (trimmed == "quit") break;
         if (trimmed.empty())
             continue;
-            
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) {
-            std::cerr << "Error creating socket." << std::endl;
+
+        TargetWaypoint waypoint{};
+        uint8_t type = TARGET_MSG_WAYPOINTS;
+        uint32_t count = 1;
+        if (trimmed == "home") {
+            type = TARGET_MSG_HOME;
+            count = 0;
+        } else if (!parseWaypoint(trimmed, waypoint)) {
+            std::cerr << "Invalid input format. Please enter coordinates as x,y,z or the command \"home\"." << std::endl;
             continue;
         }
-        
-        struct sockaddr_in serverAddr;
-        serverAddr.sin_family = AF_INET;
-        serverAddr.sin_port = htons(port);
-        serverAddr.sin_addr.s_addr = inet_addr(serverIP);
-        
-        if (connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+
+        // The connection is kept open between commands and re-established if the simulation restarted.
+        // A retry keeps the sequence number, so the receiver drops the frame if only the ACK was lost.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (sock == TARGET_INVALID_SOCKET) {
+                sock = connectTarget(host, port);
+                if (sock == TARGET_INVALID_SOCKET) break;
+            }
+
+            TargetFrameHeader ack;
+            uint64_t sent_at = targetClockMicros();
+            if (sendTargetFrame(sock, type, sequence, sent_at, &waypoint, count, buffer) &&
+                receiveTargetFrame(sock, ack, unused) == 1) {
+                std::cout << "Sent: " << trimmed << " (#" << sequence << ", RTT "
+                          << targetClockMicros() - sent_at << " us)" << std::endl;
+                sequence++;
+                break;
+            }
+            closeTargetSocket(sock);
+            sock = TARGET_INVALID_SOCKET;
+        }
+        if (sock == TARGET_INVALID_SOCKET) {
             std::cerr << "Error connecting to server." << std::endl;
-#ifdef _WIN32
-            closesocket(sock);
-#else
-            close(sock);
-#endif
-            continue;
         }
-        
+    }
 
-        std::string message;
-        if (trimmed == "home") {
-            message = "home";
-        } else {
-            if (std::count(trimmed.begin(), trimmed.end(), ',') < 2) {
-                std::cerr << "Invalid input format. Please enter coordinates as x,y,z or the command \"home\"." << std::endl;
-#ifdef _WIN32
-                closesocket(sock);
-#else
-                close(sock);
-#endif
-                continue;
-            }
-            message = trimmed;
+    if (sock != TARGET_INVALID_SOCKET) closeTargetSocket(sock);
+}
+
+int main(int argc, char** argv) {
+    std::string host = "127.0.0.1";
+    int port = TARGET_PROTOCOL_DEFAULT_PORT;
+    std::string trajectory_path;
+    double rate = 0.0;
+    int batch = 1, repeat = 1;
+    bool replace = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (hasOption("--host=")) host = value("--host=");
+            else if (hasOption("--port=")) port = std::stoi(value("--port="));
+            else if (hasOption("--stream=")) trajectory_path = value("--stream=");
+            else if (hasOption("--rate=")) rate = std::stod(value("--rate="));
+            else if (hasOption("--batch=")) batch = std::stoi(value("--batch="));
+            else if (hasOption("--repeat=")) repeat = std::stoi(value("--repeat="));
+            else if (arg == "--replace") replace = true;
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        if (batch < 1 || batch > static_cast<int>(TARGET_PROTOCOL_MAX_WAYPOINTS) || repeat < 1) ok = false;
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
         }
-        
-        int bytesSent = send(sock, message.c_str(), message.size(), 0);
-        if (bytesSent < 0) {
-            std::cerr << "Error sending data." << std::endl;
+    }
+
+    if (!targetSocketStartup()) {
+        std::cerr << "WSAStartup failed." << std::endl;
+        return -1;
+    }
+
+    int status = 0;
+    if (trajectory_path.empty()) {
+        interactive(host, port);
+    } else {
+        std::vector<TargetWaypoint> trajectory;
+        target_socket_t sock = TARGET_INVALID_SOCKET;
+        if (!loadTrajectory(trajectory_path, trajectory) || trajectory.empty()) {
+            status = -1;
+        } else if ((sock = connectTarget(host, port)) == TARGET_INVALID_SOCKET) {
+            std::cerr << "Error connecting to server." << std::endl;
+            status = -1;
         } else {
-            std::cout << "Sent: " << message << std::endl;
+            status = streamTrajectory(sock, trajectory, rate, batch, repeat, replace);
+            closeTargetSocket(sock);
         }
-        
-#ifdef _WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
     }
 
-#ifdef _WIN32
-    WSACleanup();
-#endif
-    return 0;
+    targetSocketCleanup();
+    return status;
 }
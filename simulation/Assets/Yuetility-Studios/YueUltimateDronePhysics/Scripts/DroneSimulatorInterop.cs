@@ -21,6 +21,23 @@ public class DroneSimulatorInterop : MonoBehaviour
         public Vector3Interop vel;
     }
 
+    [StructLayout(LayoutKind.Sequential)]
+    public struct IntegrationStatsInterop
+    {
+        public int acceptedSteps;
+        public int rejectedSteps;
+        public int derivativeEvaluations;
+        public float minStep;
+        public float maxStep;
+    }
+
+    public enum IntegrationMode
+    {
+        SingleStep,     // One RK4 step of dt per FixedUpdate
+        Substeps,       // `substeps` fixed RK4 steps covering dt
+        Adaptive        // Dormand-Prince RK45 with `integrationTolerance`
+    }
+
 #if UNITY_STANDALONE_OSX || UNITY_EDITOR_OSX
     const string DLL_NAME = "DroneDynamicsDLL";
 #elif UNITY_STANDALONE_WIN
@@ -41,6 +58,52 @@ public class DroneSimulatorInterop : MonoBehaviour
         float kd,
         out DroneStateInterop newState);
 
+    // Advances a state by `duration` seconds with `substeps` fixed RK4 steps in one call.
+    [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SimulateSubsteps(
+        ref DroneStateInterop currentState,
+        ref Vector3Interop target,
+        float duration,
+        int substeps,
+        float thrust,
+        float mass,
+        float drag,
+        float kp,
+        float kd,
+        out DroneStateInterop newState,
+        out IntegrationStatsInterop stats);
+
+    // Advances a state by `duration` seconds with adaptive RK45 steps in one call.
+    // initialStep = 0 picks the first step automatically. Returns 0 if the step limit was hit.
+    [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int SimulateAdaptive(
+        ref DroneStateInterop currentState,
+        ref Vector3Interop target,
+        float duration,
+        float tolerance,
+        float initialStep,
+        float thrust,
+        float mass,
+        float drag,
+        float kp,
+        float kd,
+        out DroneStateInterop newState,
+        out IntegrationStatsInterop stats);
+
+    // Advances a whole swarm by one RK4 step in one call. Buffers are struct-of-arrays
+    // with `count` elements; positions and velocities are updated in place.
+    // numThreads = 0 uses all cores for large swarms.
+    [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SimulateSwarmStep(
+        int count,
+        float[] posX, float[] posY, float[] posZ,
+        float[] velX, float[] velY, float[] velZ,
+        float[] targetX, float[] targetY, float[] targetZ,
+        float[] thrust, float[] mass, float[] drag,
+        float[] kp, float[] kd,
+        float dt,
+        int numThreads);
+
     [Header("DLL Simulation & Controller Parameters")]
     public float thrust = 100f;    // Maximum thrust [N] passed to the DLL.
     public float mass = 1f;        // Drone mass [kg].
@@ -49,6 +112,12 @@ public class DroneSimulatorInterop : MonoBehaviour
     public float kd = 2f;          // Damping factor for the DLL simulation.
     public float dt = 0.02f;       // Simulation timestep [seconds].
 
+    [Header("DLL Integration")]
+    public IntegrationMode integrationMode = IntegrationMode.SingleStep;
+    public int substeps = 8;                    // Used by IntegrationMode.Substeps.
+    public float integrationTolerance = 1e-5f;  // Used by IntegrationMode.Adaptive.
+    public IntegrationStatsInterop lastStats;   // Statistics of the last multi-step call.
+
     [Header("Autopilot Force Parameters")]
     public float acceleration = 10f;    // Correction acceleration used to drive error correction.
     public float dampingFactor = 2f;    // Damping factor used with the Rigidbody’s velocity.
@@ -116,7 +185,23 @@ public class DroneSimulatorInterop : MonoBehaviour
         }
 
         DroneStateInterop simulatedState;
-        SimulateStep(ref currentState, ref target, dt, thrust, mass, drag, kp, kd, out simulatedState);
+        switch (integrationMode)
+        {
+            case IntegrationMode.Substeps:
+                SimulateSubsteps(ref currentState, ref target, dt, substeps, thrust, mass, drag, kp, kd,
+                                 out simulatedState, out lastStats);
+                break;
+            case IntegrationMode.Adaptive:
+                if (SimulateAdaptive(ref currentState, ref target, dt, integrationTolerance, lastStats.maxStep,
+                                     thrust, mass, drag, kp, kd, out simulatedState, out lastStats) == 0)
+                {
+                    Debug.LogWarning("Adaptive integration hit its step limit.");
+                }
+                break;
+            default:
+                SimulateStep(ref currentState, ref target, dt, thrust, mass, drag, kp, kd, out simulatedState);
+                break;
+        }
         currentState = simulatedState;
 
         Vector3 desiredPos = new Vector3(simulatedState.pos.x, simulatedState.pos.y, simulatedState.pos.z);
@@ -142,43 +227,28 @@ public class DroneSimulatorInterop : MonoBehaviour
         }
     }
 
-    public void AddTargetFromMessage(string message)
+    // Appends a target to the queue and cancels a pending return to home.
+    // Not logged, streamed trajectories add targets at control rate.
+    public void AddTarget(Vector3Interop newTarget)
     {
-        if (string.IsNullOrEmpty(message))
-            return;
+        targets.Add(newTarget);
+        returningToHome = false;
+    }
 
-        string trimmed = message.Trim();
-        if (trimmed.ToLower() == "home")
-        {
-            targets.Clear();
-            currentTargetIndex = 0;
-            returningToHome = true;
-            Debug.Log("Received 'home' command. Returning to starting position.");
-        }
-        else
-        {
-            char[] separators = new char[] { ',', ';', ' ' };
-            string[] tokens = trimmed.Split(separators, System.StringSplitOptions.RemoveEmptyEntries);
-            if (tokens.Length >= 3)
-            {
-                if (float.TryParse(tokens[0], out float x) &&
-                    float.TryParse(tokens[1], out float y) &&
-                    float.TryParse(tokens[2], out float z))
-                {
-                    Vector3Interop newTarget = new Vector3Interop { x = x, y = y, z = z };
-                    targets.Add(newTarget);
-                    returningToHome = false;
-                    Debug.Log("Added new target: " + newTarget.ToString());
-                }
-                else
-                {
-                    Debug.LogWarning("Unable to parse target coordinates from message: " + message);
-                }
-            }
-            else
-            {
-                Debug.LogWarning("Invalid target format received: " + message);
-            }
-        }
+    // Replaces the whole target queue, used by streamed trajectories.
+    public void ReplaceTargets(IList<Vector3Interop> newTargets)
+    {
+        targets.Clear();
+        targets.AddRange(newTargets);
+        currentTargetIndex = 0;
+        returningToHome = false;
+    }
+
+    public void ReturnHome()
+    {
+        targets.Clear();
+        currentTargetIndex = 0;
+        returningToHome = true;
+        Debug.Log("Received 'home' command. Returning to starting position.");
     }
 }
@@ -1,23 +1,50 @@
 using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Net;
 using System.Net.Sockets;
-using System.Text;
 using System.Threading;
 using UnityEngine;
 
+// Receives targets from TargetSender over a persistent TCP connection.
+// Wire format (little-endian) mirrors include/ipc/target_protocol.h: a 24-byte header
+// followed by `count` waypoints of three floats. Every frame is answered with an ACK; a frame
+// that repeats the sequence number of the last applied one is a sender retry after a lost ACK
+// and is acknowledged without being applied again.
 public class DroneTargetReceiver : MonoBehaviour
 {
+    const ushort ProtocolMagic = 0x5444;
+    const byte ProtocolVersion = 1;
+    const int HeaderSize = 24;
+    const int WaypointSize = 12;
+    const int MaxWaypoints = 4096;
+
+    const byte MsgWaypoints = 1;
+    const byte MsgReplace = 2;
+    const byte MsgHome = 3;
+    const byte MsgAck = 4;
+
     [Tooltip("Port to listen for incoming target messages.")]
     public int port = 11000;
 
     public DroneSimulatorInterop simulation;
 
+    private struct TargetCommand
+    {
+        public byte type;
+        public DroneSimulatorInterop.Vector3Interop[] waypoints;
+    }
+
     private TcpListener listener;
     private Thread listenerThread;
     private volatile bool running = false;
+    private volatile TcpClient activeClient;
 
-    private Queue<string> receivedMessages = new Queue<string>();
+    // Listener thread only, kept across connections because retries arrive on a new one
+    private bool hasAppliedSequence = false;
+    private uint appliedSequence;
+
+    private Queue<TargetCommand> receivedCommands = new Queue<TargetCommand>();
     private readonly object queueLock = new object();
 
     void Start()
@@ -38,10 +65,13 @@ public class DroneTargetReceiver : MonoBehaviour
     void OnDestroy()
     {
         running = false;
+        // Closing the sockets unblocks AcceptTcpClient() and Read() in the listener thread
         if (listener != null)
             listener.Stop();
+        if (activeClient != null)
+            activeClient.Close();
         if (listenerThread != null && listenerThread.IsAlive)
-            listenerThread.Abort();
+            listenerThread.Join(500);
     }
 
     private void ListenForTargets()
@@ -52,51 +82,133 @@ public class DroneTargetReceiver : MonoBehaviour
             listener.Start();
             while (running)
             {
-                if (listener.Pending())
+                // Blocks until a sender connects, one sender is served at a time
+                using (TcpClient client = listener.AcceptTcpClient())
                 {
-                    using (TcpClient client = listener.AcceptTcpClient())
-                    using (NetworkStream stream = client.GetStream())
-                    {
-                        byte[] buffer = new byte[1024];
-                        int bytesRead = stream.Read(buffer, 0, buffer.Length);
-                        if (bytesRead > 0)
-                        {
-                            string message = Encoding.UTF8.GetString(buffer, 0, bytesRead);
-                            Debug.Log("DroneTargetReceiver: Received message: " + message);
-                            lock (queueLock)
-                            {
-                                receivedMessages.Enqueue(message);
-                            }
-                        }
-                    }
+                    client.NoDelay = true;
+                    activeClient = client;
+                    ServeClient(client.GetStream());
+                    activeClient = null;
                 }
-                Thread.Sleep(10); // Prevent busy waiting.
             }
         }
         catch (SocketException ex)
         {
-            Debug.LogError("DroneTargetReceiver: SocketException: " + ex);
+            if (running)
+                Debug.LogError("DroneTargetReceiver: SocketException: " + ex);
         }
         catch (Exception ex)
         {
-            Debug.LogError("DroneTargetReceiver: Exception: " + ex);
+            if (running)
+                Debug.LogError("DroneTargetReceiver: Exception: " + ex);
+        }
+    }
+
+    private void ServeClient(NetworkStream stream)
+    {
+        byte[] header = new byte[HeaderSize];
+        byte[] payload = new byte[MaxWaypoints * WaypointSize];
+        byte[] ack = new byte[HeaderSize];
+
+        try
+        {
+            while (running && ReadExactly(stream, header, HeaderSize))
+            {
+                uint length = BitConverter.ToUInt32(header, 0);
+                ushort magic = BitConverter.ToUInt16(header, 4);
+                byte version = header[6];
+                byte type = header[7];
+                uint sequence = BitConverter.ToUInt32(header, 8);
+                uint count = BitConverter.ToUInt32(header, 12);
+
+                if (magic != ProtocolMagic || version != ProtocolVersion || count > MaxWaypoints ||
+                    length != HeaderSize - 4 + count * WaypointSize)
+                {
+                    Debug.LogError("DroneTargetReceiver: Invalid frame header, closing the connection.");
+                    return;
+                }
+
+                int payloadSize = (int)count * WaypointSize;
+                if (!ReadExactly(stream, payload, payloadSize))
+                    return;
+
+                var waypoints = new DroneSimulatorInterop.Vector3Interop[count];
+                for (int i = 0; i < count; i++)
+                {
+                    int offset = i * WaypointSize;
+                    waypoints[i] = new DroneSimulatorInterop.Vector3Interop
+                    {
+                        x = BitConverter.ToSingle(payload, offset),
+                        y = BitConverter.ToSingle(payload, offset + 4),
+                        z = BitConverter.ToSingle(payload, offset + 8)
+                    };
+                }
+
+                if (!hasAppliedSequence || sequence != appliedSequence)
+                {
+                    lock (queueLock)
+                    {
+                        receivedCommands.Enqueue(new TargetCommand { type = type, waypoints = waypoints });
+                    }
+                    hasAppliedSequence = true;
+                    appliedSequence = sequence;
+                }
+
+                // ACK: same sequence number (bytes 8-11) and timestamp (16-23), no waypoints
+                Buffer.BlockCopy(header, 0, ack, 0, HeaderSize);
+                BitConverter.GetBytes((uint)(HeaderSize - 4)).CopyTo(ack, 0);
+                ack[7] = MsgAck;
+                BitConverter.GetBytes(0u).CopyTo(ack, 12);
+                stream.Write(ack, 0, HeaderSize);
+            }
+        }
+        catch (IOException)
+        {
+            // Sender disconnected
+        }
+    }
+
+    private static bool ReadExactly(NetworkStream stream, byte[] buffer, int size)
+    {
+        int received = 0;
+        while (received < size)
+        {
+            int bytesRead = stream.Read(buffer, received, size - received);
+            if (bytesRead <= 0)
+                return false;
+            received += bytesRead;
         }
+        return true;
     }
 
     void Update()
     {
         lock (queueLock)
         {
-            while (receivedMessages.Count > 0)
+            while (receivedCommands.Count > 0)
             {
-                string msg = receivedMessages.Dequeue();
-                ProcessMessage(msg);
+                ProcessCommand(receivedCommands.Dequeue());
             }
         }
     }
 
-    private void ProcessMessage(string message)
+    private void ProcessCommand(TargetCommand command)
     {
-        simulation.AddTargetFromMessage(message);
+        switch (command.type)
+        {
+            case MsgWaypoints:
+                foreach (var waypoint in command.waypoints)
+                    simulation.AddTarget(waypoint);
+                break;
+            case MsgReplace:
+                simulation.ReplaceTargets(command.waypoints);
+                break;
+            case MsgHome:
+                simulation.ReturnHome();
+                break;
+            default:
+                Debug.LogWarning($"DroneTargetReceiver: Unknown message type {command.type}.");
+                break;
+        }
     }
 }
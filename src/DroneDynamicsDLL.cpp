@@ -1,21 +1,9 @@
-#ifdef _WIN32
-  #define DLL_EXPORT extern "C" __declspec(dllexport)
-#else
-  #define DLL_EXPORT extern "C"
-#endif
+#include "drone_dynamics.hpp"
 
 #include <cmath>
-
-struct Vector3 {
-    float x;
-    float y;
-    float z;
-};
-
-struct DroneState {
-    Vector3 pos;  // Position in meters.
-    Vector3 vel;  // Velocity in m/s.
-};
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 // Helper functions for Vector3 math
 inline Vector3 add(const Vector3 &a, const Vector3 &b) {
@@ -88,19 +76,7 @@ DroneState computeDerivatives(const DroneState &state, const Vector3 &target,
 }
 
 //-------------------------
-// Exposed function: SimulateStep
-// Uses RK4 integration to update the drone state over one time step dt.
-// Inputs:
-//   currentState - pointer to current DroneState (position and velocity)
-//   target       - pointer to the target position vector
-//   dt           - time step (seconds)
-//   thrust       - maximum thrust [N] (from physicsConfig.thrust)
-//   mass         - mass [kg] (from physicsConfig.mass)
-//   drag         - linear drag (from physicsConfig.drag)
-//   kp           - proportional gain (e.g., for position control or altitude hold)
-//   kd           - derivative gain (e.g., for position control or altitude hold)
-// Output:
-//   newState - pointer where the updated DroneState will be stored.
+// Exposed function: SimulateStep (see drone_dynamics.hpp)
 DLL_EXPORT void SimulateStep(DroneState* currentState, const Vector3* target, float dt,
                              float thrust, float mass, float drag, float kp, float kd,
                              DroneState* newState)
@@ -138,3 +114,252 @@ DLL_EXPORT void SimulateStep(DroneState* currentState, const Vector3* target, fl
     newState->pos = add(s.pos, incPos);
     newState->vel = add(s.vel, incVel);
 }
+
+//-------------------------
+// Exposed function: SimulateSubsteps (see drone_dynamics.hpp)
+DLL_EXPORT void SimulateSubsteps(DroneState* currentState, const Vector3* target, float duration, int substeps,
+                                 float thrust, float mass, float drag, float kp, float kd,
+                                 DroneState* newState, IntegrationStats* stats)
+{
+    substeps = std::max(1, substeps);
+    float dt = duration / static_cast<float>(substeps);
+
+    DroneState s = *currentState;
+    for (int i = 0; i < substeps; ++i) {
+        DroneState next;
+        SimulateStep(&s, target, dt, thrust, mass, drag, kp, kd, &next);
+        s = next;
+    }
+    *newState = s;
+
+    if (stats) {
+        stats->acceptedSteps = substeps;
+        stats->rejectedSteps = 0;
+        stats->derivativeEvaluations = 4 * substeps;
+        stats->minStep = dt;
+        stats->maxStep = dt;
+    }
+}
+
+//-------------------------
+// Dormand-Prince RK45 tableau (5th order solution, embedded 4th order error estimate).
+// The dynamics are autonomous, so the node coefficients c_i are not needed.
+static const float DP_A[7][6] = {
+    {},
+    {1.0f / 5.0f},
+    {3.0f / 40.0f, 9.0f / 40.0f},
+    {44.0f / 45.0f, -56.0f / 15.0f, 32.0f / 9.0f},
+    {19372.0f / 6561.0f, -25360.0f / 2187.0f, 64448.0f / 6561.0f, -212.0f / 729.0f},
+    {9017.0f / 3168.0f, -355.0f / 33.0f, 46732.0f / 5247.0f, 49.0f / 176.0f, -5103.0f / 18656.0f},
+    {35.0f / 384.0f, 0.0f, 500.0f / 1113.0f, 125.0f / 192.0f, -2187.0f / 6784.0f, 11.0f / 84.0f},
+};
+// Difference between the 5th and 4th order weights.
+static const float DP_E[7] = {71.0f / 57600.0f, 0.0f, -71.0f / 16695.0f, 71.0f / 1920.0f,
+                              -17253.0f / 339200.0f, 22.0f / 525.0f, -1.0f / 40.0f};
+
+static constexpr int ADAPTIVE_MAX_STEPS = 100000;
+
+// Helper to compute base + h * sum(weights[j] * k[j]) over the first n stages.
+inline DroneState addScaledStages(const DroneState &base, const DroneState *k, const float *weights,
+                                  int n, float h) {
+    DroneState sum = multiplyState(k[0], weights[0]);
+    for (int j = 1; j < n; ++j) {
+        sum = addState(sum, multiplyState(k[j], weights[j]));
+    }
+    return addState(base, multiplyState(sum, h));
+}
+
+// Largest component of the error relative to tolerance * (1 + |value|).
+inline float scaledErrorNorm(const DroneState &error, const DroneState &y, const DroneState &yNew, float tolerance) {
+    const float e[6] = {error.pos.x, error.pos.y, error.pos.z, error.vel.x, error.vel.y, error.vel.z};
+    const float a[6] = {y.pos.x, y.pos.y, y.pos.z, y.vel.x, y.vel.y, y.vel.z};
+    const float b[6] = {yNew.pos.x, yNew.pos.y, yNew.pos.z, yNew.vel.x, yNew.vel.y, yNew.vel.z};
+
+    float norm = 0.0f;
+    for (int i = 0; i < 6; ++i) {
+        float scale = tolerance * (1.0f + std::max(std::fabs(a[i]), std::fabs(b[i])));
+        norm = std::max(norm, std::fabs(e[i]) / scale);
+    }
+    return norm;
+}
+
+//-------------------------
+// Exposed function: SimulateAdaptive (see drone_dynamics.hpp)
+DLL_EXPORT int SimulateAdaptive(DroneState* currentState, const Vector3* target, float duration,
+                                float tolerance, float initialStep,
+                                float thrust, float mass, float drag, float kp, float kd,
+                                DroneState* newState, IntegrationStats* stats)
+{
+    IntegrationStats local{0, 0, 0, duration, 0.0f};
+    DroneState y = *currentState;
+
+    // Time is tracked in double so that many small steps still land exactly on `duration`.
+    double t = 0.0;
+    double h = initialStep > 0.0f ? initialStep : std::min(duration, 0.01f);
+    const double minStep = duration * 1e-7;
+
+    DroneState k[7];
+    k[0] = computeDerivatives(y, *target, kp, kd, drag, mass, thrust);   // Reused from the previous step (FSAL)
+    local.derivativeEvaluations = 1;
+
+    int status = 1;
+    while (duration - t > minStep) {
+        if (local.acceptedSteps + local.rejectedSteps >= ADAPTIVE_MAX_STEPS) {
+            status = 0;
+            break;
+        }
+        h = std::min(h, static_cast<double>(duration) - t);
+        auto hf = static_cast<float>(h);
+
+        for (int stage = 1; stage < 6; ++stage) {
+            DroneState s = addScaledStages(y, k, DP_A[stage], stage, hf);
+            k[stage] = computeDerivatives(s, *target, kp, kd, drag, mass, thrust);
+        }
+        DroneState yNew = addScaledStages(y, k, DP_A[6], 6, hf);
+        k[6] = computeDerivatives(yNew, *target, kp, kd, drag, mass, thrust);
+        local.derivativeEvaluations += 6;
+
+        DroneState zero{{0, 0, 0}, {0, 0, 0}};
+        DroneState error = addScaledStages(zero, k, DP_E, 7, hf);
+        float err = scaledErrorNorm(error, y, yNew, tolerance);
+
+        bool accept = err <= 1.0f || h <= minStep;
+        if (accept) {
+            t += h;
+            y = yNew;
+            k[0] = k[6];
+            local.acceptedSteps++;
+            local.minStep = std::min(local.minStep, hf);
+            local.maxStep = std::max(local.maxStep, hf);
+        } else {
+            local.rejectedSteps++;
+        }
+
+        // Standard step-size controller with safety factor, never grow right after a rejection.
+        double factor = err > 0.0f ? 0.9 * std::pow(static_cast<double>(err), -0.2) : 5.0;
+        factor = std::clamp(factor, 0.2, accept ? 5.0 : 1.0);
+        h = std::max(h * factor, minStep);
+    }
+
+    *newState = y;
+    if (stats) *stats = local;
+    return status;
+}
+
+//-------------------------
+// Swarm stepping on struct-of-arrays buffers.
+// The per-drone math mirrors computeDerivatives() and SimulateStep() operation by
+// operation (the thrust clamp becomes a select), so results match the scalar path
+// bit for bit as long as floating-point contraction is off. Written on plain
+// scalars so the compiler can vectorize the loop across drones.
+
+// Derivative of the velocity (acceleration) for one drone, see computeDerivatives().
+static inline void swarmAcceleration(float px, float py, float pz, float vx, float vy, float vz,
+                                     float tx, float ty, float tz,
+                                     float kp, float kd, float drag, float mass, float thrust,
+                                     float &ax, float &ay, float &az) {
+    float damping = kd + drag;
+    float cx = (tx - px) * kp - vx * damping;
+    float cy = (ty - py) * kp - vy * damping;
+    float cz = (tz - pz) * kp - vz * damping;
+
+    float forceMag = std::sqrt(cx * cx + cy * cy + cz * cz);
+    bool clamp = forceMag > thrust && forceMag > 0;
+    cx = clamp ? (cx / forceMag) * thrust : cx;
+    cy = clamp ? (cy / forceMag) * thrust : cy;
+    cz = clamp ? (cz / forceMag) * thrust : cz;
+
+    ax = cx / mass;
+    ay = cy / mass;
+    az = cz / mass;
+}
+
+static void swarmStepRange(int begin, int end,
+                           float* __restrict posX, float* __restrict posY, float* __restrict posZ,
+                           float* __restrict velX, float* __restrict velY, float* __restrict velZ,
+                           const float* __restrict targetX, const float* __restrict targetY,
+                           const float* __restrict targetZ,
+                           const float* __restrict thrust, const float* __restrict mass,
+                           const float* __restrict drag, const float* __restrict kp,
+                           const float* __restrict kd, float dt) {
+    for (int i = begin; i < end; ++i) {
+        const float px = posX[i], py = posY[i], pz = posZ[i];
+        const float vx = velX[i], vy = velY[i], vz = velZ[i];
+        const float tx = targetX[i], ty = targetY[i], tz = targetZ[i];
+        const float T = thrust[i], m = mass[i], d = drag[i], p = kp[i], k = kd[i];
+
+        float ax, ay, az;
+
+        // k1
+        swarmAcceleration(px, py, pz, vx, vy, vz, tx, ty, tz, p, k, d, m, T, ax, ay, az);
+        float k1px = vx * dt, k1py = vy * dt, k1pz = vz * dt;
+        float k1vx = ax * dt, k1vy = ay * dt, k1vz = az * dt;
+
+        // k2
+        float sx = px + k1px * 0.5f, sy = py + k1py * 0.5f, sz = pz + k1pz * 0.5f;
+        float ux = vx + k1vx * 0.5f, uy = vy + k1vy * 0.5f, uz = vz + k1vz * 0.5f;
+        swarmAcceleration(sx, sy, sz, ux, uy, uz, tx, ty, tz, p, k, d, m, T, ax, ay, az);
+        float k2px = ux * dt, k2py = uy * dt, k2pz = uz * dt;
+        float k2vx = ax * dt, k2vy = ay * dt, k2vz = az * dt;
+
+        // k3
+        sx = px + k2px * 0.5f; sy = py + k2py * 0.5f; sz = pz + k2pz * 0.5f;
+        ux = vx + k2vx * 0.5f; uy = vy + k2vy * 0.5f; uz = vz + k2vz * 0.5f;
+        swarmAcceleration(sx, sy, sz, ux, uy, uz, tx, ty, tz, p, k, d, m, T, ax, ay, az);
+        float k3px = ux * dt, k3py = uy * dt, k3pz = uz * dt;
+        float k3vx = ax * dt, k3vy = ay * dt, k3vz = az * dt;
+
+        // k4
+        sx = px + k3px; sy = py + k3py; sz = pz + k3pz;
+        ux = vx + k3vx; uy = vy + k3vy; uz = vz + k3vz;
+        swarmAcceleration(sx, sy, sz, ux, uy, uz, tx, ty, tz, p, k, d, m, T, ax, ay, az);
+        float k4px = ux * dt, k4py = uy * dt, k4pz = uz * dt;
+        float k4vx = ax * dt, k4vy = ay * dt, k4vz = az * dt;
+
+        const float sixth = 1.0f / 6.0f;
+        posX[i] = px + ((k1px + k2px * 2.0f) + (k3px * 2.0f + k4px)) * sixth;
+        posY[i] = py + ((k1py + k2py * 2.0f) + (k3py * 2.0f + k4py)) * sixth;
+        posZ[i] = pz + ((k1pz + k2pz * 2.0f) + (k3pz * 2.0f + k4pz)) * sixth;
+        velX[i] = vx + ((k1vx + k2vx * 2.0f) + (k3vx * 2.0f + k4vx)) * sixth;
+        velY[i] = vy + ((k1vy + k2vy * 2.0f) + (k3vy * 2.0f + k4vy)) * sixth;
+        velZ[i] = vz + ((k1vz + k2vz * 2.0f) + (k3vz * 2.0f + k4vz)) * sixth;
+    }
+}
+
+// Below this many drones per thread, spawning threads costs more than it saves.
+static constexpr int SWARM_MIN_DRONES_PER_THREAD = 16384;
+
+DLL_EXPORT void SimulateSwarmStep(int count,
+                                  float* posX, float* posY, float* posZ,
+                                  float* velX, float* velY, float* velZ,
+                                  const float* targetX, const float* targetY, const float* targetZ,
+                                  const float* thrust, const float* mass, const float* drag,
+                                  const float* kp, const float* kd,
+                                  float dt, int numThreads)
+{
+    if (count <= 0) return;
+
+    int maxThreads = numThreads > 0 ? numThreads
+                                    : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int threads = std::min(maxThreads, std::max(1, count / SWARM_MIN_DRONES_PER_THREAD));
+
+    if (threads == 1) {
+        swarmStepRange(0, count, posX, posY, posZ, velX, velY, velZ, targetX, targetY, targetZ,
+                       thrust, mass, drag, kp, kd, dt);
+        return;
+    }
+
+    // Every thread gets a contiguous block, the caller takes the last one.
+    int block = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (int t = 0; t < threads - 1; ++t) {
+        int begin = t * block;
+        int end = std::min(count, begin + block);
+        workers.emplace_back(swarmStepRange, begin, end, posX, posY, posZ, velX, velY, velZ,
+                             targetX, targetY, targetZ, thrust, mass, drag, kp, kd, dt);
+    }
+    swarmStepRange((threads - 1) * block, count, posX, posY, posZ, velX, velY, velZ,
+                   targetX, targetY, targetZ, thrust, mass, drag, kp, kd, dt);
+    for (auto& worker : workers) worker.join();
+}
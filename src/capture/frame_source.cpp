@@ -0,0 +1,185 @@
+#include "frame_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+static int64_t monotonicNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BorrowedFrame::BorrowedFrame(BorrowedFrame&& other) noexcept {
+    *this = std::move(other);
+}
+
+BorrowedFrame& BorrowedFrame::operator=(BorrowedFrame&& other) noexcept {
+    if (this != &other) {
+        release();
+        image = std::move(other.image);
+        sequence = other.sequence;
+        timestamp_ns = other.timestamp_ns;
+        source = other.source;
+        token = other.token;
+        other.image = cv::Mat();
+        other.source = nullptr;
+        other.token = -1;
+    }
+    return *this;
+}
+
+void BorrowedFrame::release() {
+    image = cv::Mat();
+    if (source) {
+        FrameSource* owner = source;
+        source = nullptr;
+        owner->recycle(token);
+    }
+    token = -1;
+}
+
+void FrameSource::lend(BorrowedFrame& frame, const cv::Mat& image, int token, uint64_t sequence,
+                       int64_t timestamp_ns) {
+    frame.release();
+    frame.image = image;
+    frame.sequence = sequence;
+    frame.timestamp_ns = timestamp_ns;
+    frame.source = this;
+    frame.token = token;
+}
+
+int FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < in_use.size(); ++i) {
+        if (!in_use[i]) {
+            in_use[i] = 1;
+            return static_cast<int>(i);
+        }
+    }
+    buffers.emplace_back();
+    in_use.push_back(1);
+    return static_cast<int>(buffers.size() - 1);
+}
+
+void FramePool::release(int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    in_use[index] = 0;
+}
+
+// ------ cv::VideoCapture ------
+
+VideoCaptureSource::VideoCaptureSource(const std::string& path) : capture(path), live(false) {}
+
+VideoCaptureSource::VideoCaptureSource(int device) : capture(device), live(true) {}
+
+bool VideoCaptureSource::read(BorrowedFrame& frame) {
+    frame.release();
+
+    // The decoder writes into the pool buffer, which keeps its allocation between frames
+    int index = pool.acquire();
+    cv::Mat& buffer = pool.buffer(index);
+    if (!capture.read(buffer) || buffer.empty()) {
+        pool.release(index);
+        return false;
+    }
+
+    int64_t timestamp_ns = live ? monotonicNanoseconds()
+                                : static_cast<int64_t>(capture.get(cv::CAP_PROP_POS_MSEC) * 1e6);
+    lend(frame, buffer, index, next_sequence++, timestamp_ns);
+    return true;
+}
+
+double VideoCaptureSource::fps() const {
+    return const_cast<cv::VideoCapture&>(capture).get(cv::CAP_PROP_FPS);
+}
+
+cv::Size VideoCaptureSource::frameSize() const {
+    auto& video = const_cast<cv::VideoCapture&>(capture);
+    return {static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH)), static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT))};
+}
+
+// ------ Image directory ------
+
+ImageDirectorySource::ImageDirectorySource(const std::string& directory, double fps) : frame_rate(fps) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" ||
+            extension == ".tif" || extension == ".tiff") {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    if (!files.empty()) {
+        first_size = cv::imread(files.front(), cv::IMREAD_COLOR).size();
+    }
+}
+
+bool ImageDirectorySource::read(BorrowedFrame& frame) {
+    frame.release();
+
+    while (next_file < files.size()) {
+        uint64_t sequence = next_file;
+        std::ifstream file(files[next_file++], std::ios::binary);
+        std::vector<uchar> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        // imdecode with a destination reuses the pool buffer instead of allocating a new image
+        int index = pool.acquire();
+        cv::Mat& buffer = pool.buffer(index);
+        cv::imdecode(encoded, cv::IMREAD_COLOR, &buffer);
+        if (buffer.empty()) {
+            std::cerr << "Error: Could not decode " << files[sequence] << std::endl;
+            pool.release(index);
+            continue;
+        }
+
+        auto timestamp_ns = static_cast<int64_t>(static_cast<double>(sequence) * 1e9 / frame_rate);
+        lend(frame, buffer, index, sequence, timestamp_ns);
+        return true;
+    }
+    return false;
+}
+
+// ------ Factory ------
+
+std::unique_ptr<FrameSource> openFrameSource(const std::string& uri) {
+    std::unique_ptr<FrameSource> source;
+
+    if (uri.rfind("shm:", 0) == 0) {
+        std::string name = uri.substr(4);
+        source = std::make_unique<SharedMemorySource>(name.empty() ? FRAME_SHM_DEFAULT_NAME : name);
+    } else if (uri.rfind("camera:", 0) == 0) {
+        int device = 0;
+        try {
+            device = std::stoi(uri.substr(7));
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid camera index in " << uri << std::endl;
+            return nullptr;
+        }
+#ifdef __linux__
+        source = std::make_unique<V4L2Source>("/dev/video" + std::to_string(device));
+#else
+        source = std::make_unique<VideoCaptureSource>(device);
+#endif
+    } else if (uri.rfind("v4l2:", 0) == 0 || uri.rfind("/dev/video", 0) == 0) {
+#ifdef __linux__
+        source = std::make_unique<V4L2Source>(uri.rfind("v4l2:", 0) == 0 ? uri.substr(5) : uri);
+#else
+        std::cerr << "Error: V4L2 cameras are only supported on Linux." << std::endl;
+        return nullptr;
+#endif
+    } else if (std::filesystem::is_directory(uri)) {
+        source = std::make_unique<ImageDirectorySource>(uri);
+    } else {
+        source = std::make_unique<VideoCaptureSource>(uri);
+    }
+
+    if (!source->isOpened()) {
+        std::cerr << "Error: Could not open frame source " << uri << std::endl;
+        return nullptr;
+    }
+    return source;
+}
@@ -0,0 +1,199 @@
+#include "frame_source.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static uint64_t loadAcquire(const uint64_t& value) {
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(value)).load(std::memory_order_acquire);
+}
+
+// How often read() looks for a restarted producer while it waits for a frame
+static const std::chrono::milliseconds RESTART_CHECK_INTERVAL(100);
+
+static size_t headerSize() {
+    return (sizeof(FrameShmHeader) + FRAME_SHM_ALIGNMENT - 1) / FRAME_SHM_ALIGNMENT * FRAME_SHM_ALIGNMENT;
+}
+
+// Map the ring if the producer has finished setting it up; `inode` identifies the object
+static FrameShmHeader* mapRing(const std::string& name, size_t& size, uint64_t& inode) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(FrameShmHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    inode = static_cast<uint64_t>(st.st_ino);
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return nullptr;
+
+    auto* header = static_cast<FrameShmHeader*>(memory);
+    uint32_t magic = std::atomic_ref<uint32_t>(header->magic).load(std::memory_order_acquire);
+    if (magic != FRAME_SHM_MAGIC || header->version != FRAME_SHM_VERSION || header->capacity == 0 ||
+        (header->pixel_format != FRAME_SHM_BGR24 && header->pixel_format != FRAME_SHM_RGB24) ||
+        header->stride < header->width * 3 ||
+        header->slot_size < sizeof(FrameSlotHeader) + static_cast<size_t>(header->stride) * header->height ||
+        size < headerSize() + static_cast<size_t>(header->slot_size) * header->capacity) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    return header;
+}
+
+SharedMemorySource::SharedMemorySource(const std::string& name, int timeout_ms, bool latest_only)
+        : name(name), timeout_ms(timeout_ms), latest_only(latest_only) {
+    // The producer may start after the pipeline
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    size_t ring_size = 0;
+    uint64_t ring_inode = 0;
+    FrameShmHeader* ring;
+    while (!(ring = mapRing(name, ring_size, ring_inode)) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (ring) attach(ring, ring_size, ring_inode);
+}
+
+void SharedMemorySource::attach(FrameShmHeader* ring, size_t ring_size, uint64_t ring_inode) {
+    header = ring;
+    size = ring_size;
+    inode = ring_inode;
+    slots = reinterpret_cast<uint8_t*>(header) + headerSize();
+    released.assign(header->capacity, 0);
+
+    // Start at the oldest frame the producer still holds for us
+    next_index = loadAcquire(header->read_index);
+}
+
+bool SharedMemorySource::remapIfRestarted() {
+    {
+        // Lent slots point into the current mapping; look again once they are back
+        std::lock_guard<std::mutex> lock(release_mutex);
+        if (lent > 0) return false;
+    }
+
+    // A restarted producer unlinks the old object and creates a new one under the same name
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    bool same = fstat(fd, &st) < 0 || static_cast<uint64_t>(st.st_ino) == inode;
+    close(fd);
+    if (same) return false;
+
+    size_t ring_size = 0;
+    uint64_t ring_inode = 0;
+    FrameShmHeader* ring = mapRing(name, ring_size, ring_inode);
+    if (!ring) return false;    // Not set up yet, try again on the next check
+
+    std::lock_guard<std::mutex> lock(release_mutex);
+    munmap(header, size);
+    attach(ring, ring_size, ring_inode);
+    return true;
+}
+
+SharedMemorySource::~SharedMemorySource() {
+    if (header) munmap(header, size);
+}
+
+cv::Size SharedMemorySource::frameSize() const {
+    if (!header) return {};
+    return {static_cast<int>(header->width), static_cast<int>(header->height)};
+}
+
+uint64_t SharedMemorySource::producerDrops() const {
+    if (!header) return 0;
+    return std::atomic_ref<uint64_t>(header->dropped).load(std::memory_order_relaxed);
+}
+
+bool SharedMemorySource::read(BorrowedFrame& frame) {
+    frame.release();
+    if (!header) return false;
+
+    // Poll for the next frame; the producer publishes at camera rate, so a short sleep costs
+    // well under a millisecond of latency
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = now + std::chrono::milliseconds(timeout_ms);
+    auto restart_check = now + RESTART_CHECK_INTERVAL;
+    uint64_t write_index;
+    while ((write_index = loadAcquire(header->write_index)) <= next_index) {
+        now = std::chrono::steady_clock::now();
+        if (now >= restart_check) {
+            // A restarted producer never publishes into the old ring again
+            restart_check = now + RESTART_CHECK_INTERVAL;
+            if (remapIfRestarted()) deadline = now + std::chrono::milliseconds(timeout_ms);
+        }
+        if (now >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    uint64_t index;
+    uint64_t stale_begin = 0, stale_end = 0;
+    {
+        std::lock_guard<std::mutex> lock(release_mutex);
+        if (latest_only && write_index - next_index > 1) {
+            stale_begin = next_index;
+            stale_end = write_index - 1;
+            skipped += stale_end - stale_begin;
+        }
+        index = std::max(next_index, stale_end);
+        next_index = index + 1;
+    }
+    for (uint64_t stale = stale_begin; stale < stale_end; ++stale) {
+        releaseSlot(stale % header->capacity);
+    }
+
+    auto slot = static_cast<int>(index % header->capacity);
+    auto* slot_header = reinterpret_cast<FrameSlotHeader*>(slots + static_cast<size_t>(slot) * header->slot_size);
+    cv::Mat view(static_cast<int>(header->height), static_cast<int>(header->width), CV_8UC3, slot_header + 1,
+                 header->stride);
+
+    if (header->pixel_format == FRAME_SHM_BGR24) {
+        // Zero copy: the slot goes back to the producer when the frame is released
+        {
+            std::lock_guard<std::mutex> lock(release_mutex);
+            lent++;
+        }
+        lend(frame, view, slot, slot_header->sequence, slot_header->timestamp_ns);
+        return true;
+    }
+
+    int buffer_index = pool.acquire();
+    cv::Mat& converted = pool.buffer(buffer_index);
+    cv::cvtColor(view, converted, cv::COLOR_RGB2BGR);
+    uint64_t sequence = slot_header->sequence;
+    int64_t timestamp_ns = slot_header->timestamp_ns;
+    releaseSlot(slot);
+    // Pool buffers get negative tokens, so recycle() does not depend on the ring still being mapped
+    lend(frame, converted, -1 - buffer_index, sequence, timestamp_ns);
+    return true;
+}
+
+void SharedMemorySource::recycle(int token) {
+    if (token >= 0) {
+        releaseSlot(static_cast<uint64_t>(token));
+        std::lock_guard<std::mutex> lock(release_mutex);
+        lent--;
+    } else {
+        pool.release(-1 - token);
+    }
+}
+
+void SharedMemorySource::releaseSlot(uint64_t slot) {
+    std::lock_guard<std::mutex> lock(release_mutex);
+    released[slot] = 1;
+
+    // Slots can be released out of order; the producer only sees the released prefix
+    uint64_t read_index = header->read_index;
+    while (read_index < next_index && released[read_index % header->capacity]) {
+        released[read_index % header->capacity] = 0;
+        read_index++;
+    }
+    std::atomic_ref<uint64_t>(header->read_index).store(read_index, std::memory_order_release);
+}
@@ -0,0 +1,211 @@
+#ifdef __linux__
+#include "frame_source.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+// Driver buffers; in BGR24 mode the pipeline may hold all but one of them
+static constexpr unsigned V4L2_BUFFER_COUNT = 4;
+
+// read() fails if the camera delivers nothing for this long
+static constexpr int V4L2_TIMEOUT_MS = 2000;
+
+static int xioctl(int fd, unsigned long request, void* argument) {
+    int result;
+    do {
+        result = ioctl(fd, request, argument);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+V4L2Source::V4L2Source(const std::string& device, cv::Size requested_size, double fps) {
+    fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open " << device << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    v4l2_capability capability{};
+    if (xioctl(fd, VIDIOC_QUERYCAP, &capability) < 0 || !(capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+        !(capability.capabilities & V4L2_CAP_STREAMING)) {
+        std::cerr << "Error: " << device << " is not a streaming capture device." << std::endl;
+        close();
+        return;
+    }
+
+    // Prefer formats that need no conversion: BGR24 is lent as is, YUYV and MJPEG are converted
+    v4l2_format format{};
+    bool format_set = false;
+    for (uint32_t candidate : {V4L2_PIX_FMT_BGR24, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_MJPEG}) {
+        format = {};
+        format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        format.fmt.pix.width = static_cast<uint32_t>(requested_size.width);
+        format.fmt.pix.height = static_cast<uint32_t>(requested_size.height);
+        format.fmt.pix.pixelformat = candidate;
+        format.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(fd, VIDIOC_S_FMT, &format) == 0 && format.fmt.pix.pixelformat == candidate) {
+            format_set = true;
+            break;
+        }
+    }
+    if (!format_set) {
+        std::cerr << "Error: " << device << " supports none of BGR24, YUYV and MJPEG." << std::endl;
+        close();
+        return;
+    }
+    pixel_format = format.fmt.pix.pixelformat;
+    size = cv::Size(static_cast<int>(format.fmt.pix.width), static_cast<int>(format.fmt.pix.height));
+    bytes_per_line = format.fmt.pix.bytesperline;
+
+    if (fps > 0.0) {
+        v4l2_streamparm parameters{};
+        parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parameters.parm.capture.timeperframe.numerator = 1000;
+        parameters.parm.capture.timeperframe.denominator = static_cast<uint32_t>(fps * 1000.0);
+        xioctl(fd, VIDIOC_S_PARM, &parameters);
+    }
+    v4l2_streamparm parameters{};
+    parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_G_PARM, &parameters) == 0 && parameters.parm.capture.timeperframe.numerator > 0) {
+        frame_rate = static_cast<double>(parameters.parm.capture.timeperframe.denominator) /
+                     parameters.parm.capture.timeperframe.numerator;
+    }
+
+    v4l2_requestbuffers request{};
+    request.count = V4L2_BUFFER_COUNT;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &request) < 0 || request.count < 2) {
+        std::cerr << "Error: " << device << " has no memory-mapped buffers." << std::endl;
+        close();
+        return;
+    }
+
+    buffers.resize(request.count);
+    for (uint32_t i = 0; i < request.count; ++i) {
+        v4l2_buffer buffer{};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = i;
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buffer) < 0) {
+            close();
+            return;
+        }
+
+        // Writable: the pipeline annotates lent BGR24 frames in place
+        void* data = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buffer.m.offset);
+        if (data == MAP_FAILED) {
+            std::cerr << "Error: Could not map the buffers of " << device << std::endl;
+            close();
+            return;
+        }
+        buffers[i] = {data, buffer.length};
+        if (xioctl(fd, VIDIOC_QBUF, &buffer) < 0) {
+            close();
+            return;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "Error: Could not start streaming on " << device << std::endl;
+        close();
+    }
+}
+
+V4L2Source::~V4L2Source() {
+    close();
+}
+
+void V4L2Source::close() {
+    if (fd < 0) return;
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(fd, VIDIOC_STREAMOFF, &type);
+    for (auto& buffer : buffers) {
+        if (buffer.data) munmap(buffer.data, buffer.length);
+    }
+    buffers.clear();
+    ::close(fd);
+    fd = -1;
+}
+
+bool V4L2Source::read(BorrowedFrame& frame) {
+    frame.release();
+    if (fd < 0) return false;
+
+    v4l2_buffer buffer{};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    while (true) {
+        int result;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            result = xioctl(fd, VIDIOC_DQBUF, &buffer);
+        }
+        if (result == 0) break;
+        if (errno != EAGAIN) {
+            std::cerr << "Error: VIDIOC_DQBUF failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        pollfd poll_fd{fd, POLLIN, 0};
+        if (poll(&poll_fd, 1, V4L2_TIMEOUT_MS) <= 0) {
+            std::cerr << "Error: No frame from the camera within " << V4L2_TIMEOUT_MS << " ms." << std::endl;
+            return false;
+        }
+    }
+
+    // Driver timestamps are CLOCK_MONOTONIC (V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC on all current drivers)
+    int64_t timestamp_ns = static_cast<int64_t>(buffer.timestamp.tv_sec) * 1000000000LL +
+                           static_cast<int64_t>(buffer.timestamp.tv_usec) * 1000LL;
+    void* data = buffers[buffer.index].data;
+
+    if (pixel_format == V4L2_PIX_FMT_BGR24) {
+        // Zero copy: the driver buffer is queued again when the frame is released
+        cv::Mat image(size, CV_8UC3, data, bytes_per_line);
+        lend(frame, image, static_cast<int>(buffer.index), buffer.sequence, timestamp_ns);
+        return true;
+    }
+
+    int index = pool.acquire();
+    cv::Mat& converted = pool.buffer(index);
+    if (pixel_format == V4L2_PIX_FMT_YUYV) {
+        cv::cvtColor(cv::Mat(size, CV_8UC2, data, bytes_per_line), converted, cv::COLOR_YUV2BGR_YUYV);
+    } else {
+        cv::imdecode(cv::Mat(1, static_cast<int>(buffer.bytesused), CV_8UC1, data), cv::IMREAD_COLOR, &converted);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        xioctl(fd, VIDIOC_QBUF, &buffer);
+    }
+    if (converted.empty()) {
+        pool.release(index);
+        std::cerr << "Error: Could not decode the camera frame." << std::endl;
+        return false;
+    }
+    lend(frame, converted, index, buffer.sequence, timestamp_ns);
+    return true;
+}
+
+void V4L2Source::recycle(int token) {
+    if (pixel_format != V4L2_PIX_FMT_BGR24) {
+        pool.release(token);
+        return;
+    }
+
+    v4l2_buffer buffer{};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = static_cast<uint32_t>(token);
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (fd >= 0) xioctl(fd, VIDIOC_QBUF, &buffer);
+}
+
+#endif
@@ -1,61 +1,282 @@
 #include "depth_estimation.hpp"
 #include "path_utils.hpp"
+#include "frame_source.hpp"
+#include "thread_layout.hpp"
+#include <mutex>
 
 
-cv::Mat depth_estimation(cv::Mat frame) {
-    cv::Mat input;
-    cv::resize(frame, input, cv::Size(256, 256));
-
-    cv::Mat blob = cv::dnn::blobFromImage(input, 1.0 / 255.0, cv::Size(256, 256), cv::Scalar(0, 0, 0), true, false);
-
-    // Load the MiDaS model
-    static cv::dnn::Net net;
-
-    if (net.empty()) {
-        try {
-            // Try to load MiDaS small model
-            // Download this file from: https://github.com/isl-org/MiDaS/releases/download/v2_1/model-small.onnx
-            // and put in models directory.
-            fs::path cwd = fs::current_path();
-            std::string cwd_name = cwd.filename().string();
-            std::string project_cwd = "drove_navigation";
-
-            std::string model_path;
-            if (cwd_name == project_cwd) {
-                model_path = "./models/model-small.onnx";
-            } else {
-                model_path = "../models/model-small.onnx";
+// Engine selection shared by all threads
+static std::mutex depth_config_mutex;
+static DepthEngineConfig depth_config;
+static int depth_config_generation = 0;
+
+void setDepthEngineConfig(const DepthEngineConfig& config) {
+    std::lock_guard<std::mutex> lock(depth_config_mutex);
+    depth_config = config;
+    depth_config_generation++;
+}
+
+static DepthEngineConfig getDepthEngineConfig(int& generation) {
+    std::lock_guard<std::mutex> lock(depth_config_mutex);
+    generation = depth_config_generation;
+    return depth_config;
+}
+
+DepthEngineConfig getDepthEngineConfig() {
+    std::lock_guard<std::mutex> lock(depth_config_mutex);
+    return depth_config;
+}
+
+cv::Mat runDepthModel(InferenceEngine& engine, const ModelDescriptor& model, const cv::Mat& frame) {
+    cv::Mat blob = preprocessDepthInput(frame, model);
+    cv::Mat output = engine.infer(blob);
+    return extractDepth(output, model).clone();
+}
+
+// Engines of the current configuration, shared by all threads. Engines are not thread-safe, so
+// every inference leases one, and a new engine is only loaded when all of them are leased: the
+// pool holds as many engines as inferences ran at the same time (the whole-region pass and the
+// tiles, or one per offline worker), not one per worker thread that ever ran a tile.
+struct DepthEnginePool {
+    std::mutex mutex;
+    int generation = -1;
+    DepthEngineConfig config;
+    bool failed = false;            // The configured engine could not be loaded, not retried
+    std::vector<std::unique_ptr<InferenceEngine>> idle;
+};
+
+static DepthEnginePool engine_pool;
+
+// Engine leased from the pool for one inference, returned on destruction
+class DepthEngineLease {
+public:
+    DepthEngineLease() {
+        int current_generation;
+        DepthEngineConfig current_config = getDepthEngineConfig(current_generation);
+        {
+            std::lock_guard<std::mutex> lock(engine_pool.mutex);
+            // Generations only grow; a caller that read an older configuration takes the pool's
+            if (engine_pool.generation < current_generation) {
+                engine_pool.idle.clear();
+                engine_pool.generation = current_generation;
+                engine_pool.config = current_config;
+                engine_pool.failed = false;
+            }
+            generation = engine_pool.generation;
+            config = engine_pool.config;
+            if (engine_pool.failed) return;
+            if (!engine_pool.idle.empty()) {
+                engine = std::move(engine_pool.idle.back());
+                engine_pool.idle.pop_back();
             }
+        }
+        model = &getModelDescriptor(config.model);
+        if (engine) return;
+
+        // Loaded outside the lock, other threads keep running their inferences meanwhile.
+        // Engine threads start on the depth cores and, unless configured, use all of them.
+        ThreadRoleScope depth_scope(ThreadRole::DEPTH);
+        DepthEngineConfig engine_config = config;
+        if (engine_config.num_threads == 0) {
+            engine_config.num_threads = static_cast<int>(getThreadLayout().depth.size());
+        }
+        engine = createInferenceEngine(engine_config);
+        if (!engine) {
+            std::lock_guard<std::mutex> lock(engine_pool.mutex);
+            if (engine_pool.generation == generation) engine_pool.failed = true;
+        }
+    }
+
+    ~DepthEngineLease() {
+        if (!engine) return;
+        std::lock_guard<std::mutex> lock(engine_pool.mutex);
+        // Engines of a previous configuration are dropped
+        if (engine_pool.generation == generation) engine_pool.idle.push_back(std::move(engine));
+    }
+
+    DepthEngineLease(const DepthEngineLease&) = delete;
+    DepthEngineLease& operator=(const DepthEngineLease&) = delete;
+
+    [[nodiscard]] InferenceEngine* get() const { return engine.get(); }
+
+    // Depth tiles per side of the configuration the engine was loaded for
+    [[nodiscard]] int tiles() const { return config.tiles; }
+
+    const ModelDescriptor* model = nullptr;
+
+private:
+    std::unique_ptr<InferenceEngine> engine;
+    int generation = -1;
+    DepthEngineConfig config;
+};
+
+// Inference on a model-sized input; the blob is reused, and the output must be consumed while the engine is leased
+static cv::Mat inferResized(InferenceEngine& engine, const ModelDescriptor& model, const cv::Mat& resized) {
+    thread_local cv::Mat blob;
+    preprocessResizedInput(resized, model, blob);
+    cv::Mat output = engine.infer(blob);
+    return extractDepth(output, model);
+}
+
+cv::Mat depth_estimation(cv::Mat frame) {
+    DepthEngineLease engine;
+    if (!engine.get()) {
+        // Return original frame if model can't be loaded
+        return frame;
+    }
+
+    thread_local cv::Mat resized;
+    cv::resize(frame, resized, engine.model->input_size, 0, 0, cv::INTER_LINEAR);
+    return colorizeDepth(inferResized(*engine.get(), *engine.model, resized), frame.size());
+}
+
+// Whole region plus tiles, each job on a worker thread with an engine leased from the pool
+static cv::Mat tiledDepth(FramePyramid& pyramid, const cv::Rect& region, const ModelDescriptor& model,
+                          int tiles_per_side) {
+    std::vector<cv::Rect> tiles = depthTiles(region.size(), tiles_per_side);
+
+    // The pyramid is not thread-safe, the inputs are resized before the parallel part
+    std::vector<const cv::Mat*> inputs;
+    inputs.push_back(&pyramid.resized(region, model.input_size));
+    for (const auto& tile : tiles) inputs.push_back(&pyramid.resized(tile + region.tl(), model.input_size));
+
+    std::vector<cv::Mat> outputs(inputs.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(inputs.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            DepthEngineLease engine;
+            // Copied, the engine may reuse its output buffer once it is back in the pool
+            if (engine.get()) outputs[i] = inferResized(*engine.get(), *engine.model, *inputs[i]).clone();
+        }
+    }, static_cast<double>(inputs.size()));
 
-            net = cv::dnn::readNetFromONNX(model_path);
-            // Download DINO-v2 from https://github.com/fabio-sim/Depth-Anything-ONNX/releases
-//            net = cv::dnn::readNetFromONNX("../models/depth_anything_v2_vits.onnx");
+    for (const auto& output : outputs) {
+        if (output.empty()) return output;
+    }
 
-//            std::cout << "Model loaded successfully!" << std::endl;
-        } catch (const cv::Exception& e) {
-            std::cerr << "Error loading model: " << e.what() << std::endl;
-            // Return original frame if model can't be loaded
-            return frame;
+    // Keep the tile resolution, but never more than the region's
+    double scale_x = static_cast<double>(outputs[1].cols) / tiles[0].width;
+    double scale_y = static_cast<double>(outputs[1].rows) / tiles[0].height;
+    cv::Size output_size(std::min(region.width, cvRound(region.width * scale_x)),
+                         std::min(region.height, cvRound(region.height * scale_y)));
+    std::vector<cv::Mat> tile_depths(outputs.begin() + 1, outputs.end());
+    return blendDepthTiles(outputs[0], tiles, tile_depths, region.size(), output_size);
+}
+
+cv::Mat depth_estimation(FramePyramid& pyramid, const cv::Rect& region) {
+    const ModelDescriptor* model;
+    int tiles_per_side;
+    {
+        DepthEngineLease engine;
+        if (!engine.get()) return pyramid.frame()(region);
+        model = engine.model;
+        tiles_per_side = engine.tiles();
+        if (tiles_per_side <= 1) {
+            const cv::Mat& resized = pyramid.resized(region, model->input_size);
+            return colorizeDepth(inferResized(*engine.get(), *model, resized), region.size());
         }
     }
 
-    net.setInput(blob);
-    cv::Mat output = net.forward();
+    // The engine is back in the pool, one of the tile jobs picks it up
+    cv::Mat blended = tiledDepth(pyramid, region, *model, tiles_per_side);
+    if (blended.empty()) return pyramid.frame()(region);
+    return colorizeDepth(blended, region.size());
+}
+
+// Overlap of neighbouring depth tiles, as a fraction of the tile size
+static const float DEPTH_TILE_OVERLAP = 0.25f;
 
-    // Post-processing
-    // Convert the output to a displayable depth map
-    cv::Mat depth_map;
-    cv::Mat resized_output;
+// Tile offsets and length along one axis; the last tile ends at the region border
+static std::vector<int> tileOffsets(int length, int tiles, int& tile_length) {
+    tile_length = static_cast<int>(std::ceil(length / (tiles - (tiles - 1) * DEPTH_TILE_OVERLAP)));
+    tile_length = std::min(length, tile_length);
+    std::vector<int> offsets(tiles, 0);
+    for (int i = 1; i < tiles; ++i) offsets[i] = cvRound(static_cast<double>(i) * (length - tile_length) / (tiles - 1));
+    return offsets;
+}
+
+std::vector<cv::Rect> depthTiles(const cv::Size& size, int tiles_per_side) {
+    tiles_per_side = std::max(1, tiles_per_side);
+    int tile_width, tile_height;
+    std::vector<int> xs = tileOffsets(size.width, tiles_per_side, tile_width);
+    std::vector<int> ys = tileOffsets(size.height, tiles_per_side, tile_height);
+
+    std::vector<cv::Rect> tiles;
+    for (int y : ys) {
+        for (int x : xs) tiles.emplace_back(x, y, tile_width, tile_height);
+    }
+    return tiles;
+}
 
-    // Resize output to input frame dimensions
-    auto* output_data = (float*)output.data;
-    cv::Mat result(output.size[1], output.size[2], CV_32F, output_data);
+// Feathering weights along one axis: ramps over the overlap at edges inside the region, 1 elsewhere
+static std::vector<float> featherWeights(int begin, int end, int length, float ramp) {
+    std::vector<float> weights(end - begin);
+    for (int i = begin; i < end; ++i) {
+        float weight = 1.0f;
+        if (begin > 0) weight = std::min(weight, (static_cast<float>(i - begin) + 0.5f) / ramp);
+        if (end < length) weight = std::min(weight, (static_cast<float>(end - i) - 0.5f) / ramp);
+        weights[i - begin] = weight;
+    }
+    return weights;
+}
+
+cv::Mat blendDepthTiles(const cv::Mat& coarse, const std::vector<cv::Rect>& tiles,
+                        const std::vector<cv::Mat>& tile_depths, const cv::Size& region_size,
+                        const cv::Size& output_size) {
+    cv::Mat reference;
+    cv::resize(coarse, reference, output_size, 0, 0, cv::INTER_LINEAR);
+    double scale_x = static_cast<double>(output_size.width) / region_size.width;
+    double scale_y = static_cast<double>(output_size.height) / region_size.height;
+
+    cv::Mat sum = cv::Mat::zeros(output_size, CV_32F);
+    cv::Mat weight_sum = cv::Mat::zeros(output_size, CV_32F);
+    cv::Mat tile_depth, weights;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        int x0 = cvRound(tiles[i].x * scale_x), x1 = cvRound(tiles[i].br().x * scale_x);
+        int y0 = cvRound(tiles[i].y * scale_y), y1 = cvRound(tiles[i].br().y * scale_y);
+        cv::Rect area(x0, y0, x1 - x0, y1 - y0);
+        if (area.empty()) continue;
+        cv::resize(tile_depths[i], tile_depth, area.size(), 0, 0, cv::INTER_LINEAR);
+
+        // Least-squares scale and shift onto the whole-region depth
+        cv::Mat target = reference(area);
+        cv::Scalar tile_mean, tile_std, target_mean, target_std;
+        cv::meanStdDev(tile_depth, tile_mean, tile_std);
+        cv::meanStdDev(target, target_mean, target_std);
+        double covariance = cv::mean(tile_depth.mul(target))[0] - tile_mean[0] * target_mean[0];
+        double variance = tile_std[0] * tile_std[0];
+        double scale = variance > 1e-12 ? covariance / variance : 0.0;
+        if (scale <= 0.0) scale = 1.0;   // Flat or inverted tile: match the means only
+        double shift = target_mean[0] - scale * tile_mean[0];
+        tile_depth.convertTo(tile_depth, CV_32F, scale, shift);
+
+        float ramp_x = std::max(1.0f, DEPTH_TILE_OVERLAP * static_cast<float>(area.width));
+        float ramp_y = std::max(1.0f, DEPTH_TILE_OVERLAP * static_cast<float>(area.height));
+        std::vector<float> weights_x = featherWeights(x0, x1, output_size.width, ramp_x);
+        std::vector<float> weights_y = featherWeights(y0, y1, output_size.height, ramp_y);
+        weights.create(area.size(), CV_32F);
+        for (int y = 0; y < area.height; ++y) {
+            auto* row = weights.ptr<float>(y);
+            for (int x = 0; x < area.width; ++x) row[x] = weights_y[y] * weights_x[x];
+        }
+
+        cv::Mat sum_view = sum(area), weight_view = weight_sum(area);
+        sum_view += tile_depth.mul(weights);
+        weight_view += weights;
+    }
+
+    cv::Mat blended;
+    cv::divide(sum, cv::max(weight_sum, 1e-6f), blended);
+    return blended;
+}
 
+cv::Mat colorizeDepth(const cv::Mat& raw_depth, const cv::Size& frame_size) {
     // Normalize the depth map for better visualization
-    cv::normalize(result, result, 0, 1, cv::NORM_MINMAX);
+    cv::Mat normalized;
+    cv::normalize(raw_depth, normalized, 0, 1, cv::NORM_MINMAX);
 
     // Resize to original frame size
-    cv::resize(result, depth_map, cv::Size(frame.cols, frame.rows));
+    cv::Mat depth_map;
+    cv::resize(normalized, depth_map, frame_size);
 
     // Convert to 8-bit for display and apply colormap
     depth_map.convertTo(depth_map, CV_8UC1, 255);
@@ -65,6 +286,21 @@ cv::Mat depth_estimation(cv::Mat frame) {
     return colored_depth_map;
 }
 
+void filterDepthMap(const cv::Mat& colored_depth, cv::CLAHE& clahe, cv::Mat& filtered) {
+    // Convert to grayscale
+    cv::Mat depth_map_gray;
+    cv::cvtColor(colored_depth, depth_map_gray, cv::COLOR_BGR2GRAY);
+
+    cv::Mat depth_enhanced;
+    clahe.apply(depth_map_gray, depth_enhanced);
+
+    // Apply bilateral filtering to reduce noise while preserving edges
+    cv::Mat depth_smoothed;
+    cv::bilateralFilter(depth_enhanced, depth_smoothed, 9, 75, 75);
+
+    depth_smoothed.convertTo(filtered, CV_32F);
+}
+
 cv::Mat contour_frame(const cv::Mat& frame) {
     cv::Mat gray, blur, canny;
     cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);            // Convert to grayscale
@@ -75,10 +311,11 @@ cv::Mat contour_frame(const cv::Mat& frame) {
 
 int test_depth_estimation(std::string &image_path, bool enable_camera) {
     if (enable_camera) {
-        cv::Mat video_from_facecam;
-        cv::VideoCapture cap(0);
+        // Frames are borrowed from the camera's buffers, no copy before inference
+        std::unique_ptr<FrameSource> camera = openFrameSource("camera:0");
+        BorrowedFrame video_from_facecam;
 
-        if (!cap.isOpened()) {
+        if (!camera) {
             std::cout << "Could not open video stream!" << std::endl;
             return -1;
         }
@@ -91,13 +328,12 @@ int test_depth_estimation(std::string &image_path, bool enable_camera) {
         while (char(cv::waitKey(1)) != 'q') {
             auto start_time = get_current_time_fenced();
 
-            cap >> video_from_facecam;
-            if (video_from_facecam.empty()) {
+            if (!camera->read(video_from_facecam)) {
                 break;
             }
 
             auto depth_start_time = get_current_time_fenced();
-            cv::Mat depth_map = depth_estimation(video_from_facecam);
+            cv::Mat depth_map = depth_estimation(video_from_facecam.image);
             auto depth_end_time = get_current_time_fenced();
 
             // Measure depth estimation time
@@ -113,7 +349,7 @@ int test_depth_estimation(std::string &image_path, bool enable_camera) {
             imshow("Depth Estimation", depth_map);
         }
 
-        cap.release();
+        video_from_facecam.release();
 
         // Compute average depth time
         if (!depth_times_ms.empty()) {
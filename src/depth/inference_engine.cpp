@@ -0,0 +1,149 @@
+#include "inference_engine.hpp"
+#include "path_utils.hpp"
+#include <iostream>
+
+// Download the models into the models directory:
+//  - MiDaS small:  https://github.com/isl-org/MiDaS/releases/download/v2_1/model-small.onnx
+//  - MiDaS hybrid: dpt_hybrid_384.onnx exported from https://github.com/isl-org/MiDaS (v3)
+//  - Depth-Anything v2: https://github.com/fabio-sim/Depth-Anything-ONNX/releases
+static const ModelDescriptor model_descriptors[] = {
+        {"midas_small", "model-small.onnx", cv::Size(256, 256),
+                cv::Scalar(0.485, 0.456, 0.406), cv::Scalar(0.229, 0.224, 0.225), true, OutputLayout::NHW},
+        {"midas_hybrid", "dpt_hybrid_384.onnx", cv::Size(384, 384),
+                cv::Scalar(0.5, 0.5, 0.5), cv::Scalar(0.5, 0.5, 0.5), true, OutputLayout::NHW},
+        {"depth_anything_v2", "depth_anything_v2_vits.onnx", cv::Size(518, 518),
+                cv::Scalar(0.485, 0.456, 0.406), cv::Scalar(0.229, 0.224, 0.225), true, OutputLayout::NHW},
+};
+
+const ModelDescriptor& getModelDescriptor(DepthModel model) {
+    return model_descriptors[static_cast<int>(model)];
+}
+
+// ------- OpenCV DNN engine -------
+
+class OpenCvDnnEngine : public InferenceEngine {
+public:
+    OpenCvDnnEngine(const std::string& model_path, int dnn_backend, int dnn_target) {
+        net = cv::dnn::readNetFromONNX(model_path);
+        net.setPreferableBackend(dnn_backend);
+        net.setPreferableTarget(dnn_target);
+    }
+
+    [[nodiscard]] const char* name() const override { return "opencv-dnn"; }
+
+    cv::Mat infer(const cv::Mat& blob) override {
+        net.setInput(blob);
+        return net.forward();
+    }
+
+private:
+    cv::dnn::Net net;
+};
+
+std::unique_ptr<InferenceEngine> createInferenceEngine(const DepthEngineConfig& config) {
+    const ModelDescriptor& model = getModelDescriptor(config.model);
+    std::string model_path = getContentPath(model.file, "models");
+
+    try {
+        switch (config.backend) {
+            case InferenceBackend::OPENCV_DNN:
+                return std::make_unique<OpenCvDnnEngine>(model_path, config.dnn_backend, config.dnn_target);
+            case InferenceBackend::ONNX_RUNTIME:
+#ifdef WITH_ONNXRUNTIME
+                return createOnnxRuntimeEngine(model_path, config.num_threads);
+#else
+                std::cerr << "Error: Built without ONNX Runtime (WITH_ONNXRUNTIME=OFF)." << std::endl;
+                return nullptr;
+#endif
+            case InferenceBackend::OPENVINO:
+#ifdef WITH_OPENVINO
+                return createOpenVinoEngine(model_path, config.num_threads);
+#else
+                std::cerr << "Error: Built without OpenVINO (WITH_OPENVINO=OFF)." << std::endl;
+                return nullptr;
+#endif
+        }
+    } catch (const std::exception& e) {
+        // cv::Exception, Ort::Exception and ov::Exception all derive from std::exception
+        std::cerr << "Error loading model " << model_path << ": " << e.what() << std::endl;
+    }
+    return nullptr;
+}
+
+cv::Mat preprocessDepthInput(const cv::Mat& frame, const ModelDescriptor& model) {
+    cv::Mat resized = frame;
+    if (frame.size() != model.input_size) cv::resize(frame, resized, model.input_size, 0, 0, cv::INTER_LINEAR);
+
+    cv::Mat blob;
+    preprocessResizedInput(resized, model, blob);
+    return blob;
+}
+
+void preprocessResizedInput(const cv::Mat& resized, const ModelDescriptor& model, cv::Mat& blob) {
+    CV_Assert(resized.type() == CV_8UC3 && resized.size() == model.input_size);
+    int sizes[] = {1, 3, resized.rows, resized.cols};
+    blob.create(4, sizes, CV_32F);
+
+    // Scaling to [0, 1], the channel swap and the per-channel normalization in one pass
+    int channel[3];
+    float scale[3], offset[3];
+    for (int c = 0; c < 3; ++c) {
+        channel[c] = model.swap_rb ? 2 - c : c;
+        scale[c] = static_cast<float>(1.0 / (255.0 * model.std[c]));
+        offset[c] = static_cast<float>(-model.mean[c] / model.std[c]);
+    }
+
+    for (int y = 0; y < resized.rows; ++y) {
+        const uchar* pixel = resized.ptr<uchar>(y);
+        float* plane0 = blob.ptr<float>(0, 0, y);
+        float* plane1 = blob.ptr<float>(0, 1, y);
+        float* plane2 = blob.ptr<float>(0, 2, y);
+        for (int x = 0; x < resized.cols; ++x, pixel += 3) {
+            plane0[x] = static_cast<float>(pixel[channel[0]]) * scale[0] + offset[0];
+            plane1[x] = static_cast<float>(pixel[channel[1]]) * scale[1] + offset[1];
+            plane2[x] = static_cast<float>(pixel[channel[2]]) * scale[2] + offset[2];
+        }
+    }
+}
+
+cv::Mat extractDepth(const cv::Mat& output, const ModelDescriptor& model) {
+    int rows = model.output_layout == OutputLayout::NHW ? output.size[1] : output.size[2];
+    int cols = model.output_layout == OutputLayout::NHW ? output.size[2] : output.size[3];
+    return {rows, cols, CV_32F, const_cast<uchar*>(output.ptr())};
+}
+
+bool parseInferenceBackend(const std::string& name, InferenceBackend& backend) {
+    if (name == "opencv") backend = InferenceBackend::OPENCV_DNN;
+    else if (name == "onnxruntime") backend = InferenceBackend::ONNX_RUNTIME;
+    else if (name == "openvino") backend = InferenceBackend::OPENVINO;
+    else return false;
+    return true;
+}
+
+bool parseDepthModel(const std::string& name, DepthModel& model) {
+    for (int i = 0; i < static_cast<int>(std::size(model_descriptors)); ++i) {
+        if (name == model_descriptors[i].name) {
+            model = static_cast<DepthModel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseDnnTarget(const std::string& name, int& dnn_target) {
+    if (name == "cpu") dnn_target = cv::dnn::DNN_TARGET_CPU;
+    else if (name == "opencl") dnn_target = cv::dnn::DNN_TARGET_OPENCL;
+    else if (name == "opencl_fp16") dnn_target = cv::dnn::DNN_TARGET_OPENCL_FP16;
+    else if (name == "cuda") dnn_target = cv::dnn::DNN_TARGET_CUDA;
+    else return false;
+    return true;
+}
+
+bool parseDnnBackend(const std::string& name, int& dnn_backend) {
+    if (name == "default") dnn_backend = cv::dnn::DNN_BACKEND_DEFAULT;
+    else if (name == "opencv") dnn_backend = cv::dnn::DNN_BACKEND_OPENCV;
+    else if (name == "inference_engine") dnn_backend = cv::dnn::DNN_BACKEND_INFERENCE_ENGINE;
+    else if (name == "cuda") dnn_backend = cv::dnn::DNN_BACKEND_CUDA;
+    else return false;
+    return true;
+}
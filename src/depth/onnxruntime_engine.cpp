@@ -0,0 +1,54 @@
+#ifdef WITH_ONNXRUNTIME
+
+#include "inference_engine.hpp"
+#include <array>
+#include <onnxruntime_cxx_api.h>
+
+// ------- ONNX Runtime CPU engine -------
+
+class OnnxRuntimeEngine : public InferenceEngine {
+public:
+    OnnxRuntimeEngine(const std::string& model_path, int num_threads)
+            : env(ORT_LOGGING_LEVEL_WARNING, "drone_navigation"), session(nullptr) {
+        Ort::SessionOptions options;
+        if (num_threads > 0) options.SetIntraOpNumThreads(num_threads);
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        session = Ort::Session(env, model_path.c_str(), options);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        input_name = session.GetInputNameAllocated(0, allocator).get();
+        output_name = session.GetOutputNameAllocated(0, allocator).get();
+    }
+
+    [[nodiscard]] const char* name() const override { return "onnxruntime-cpu"; }
+
+    cv::Mat infer(const cv::Mat& blob) override {
+        std::array<int64_t, 4> shape{blob.size[0], blob.size[1], blob.size[2], blob.size[3]};
+        Ort::Value input = Ort::Value::CreateTensor<float>(
+                memory_info, const_cast<float*>(blob.ptr<float>()), blob.total(), shape.data(), shape.size());
+
+        const char* input_names[] = {input_name.c_str()};
+        const char* output_names[] = {output_name.c_str()};
+        auto outputs = session.Run(Ort::RunOptions{nullptr}, input_names, &input, 1, output_names, 1);
+
+        std::vector<int64_t> output_shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        std::vector<int> dims(output_shape.begin(), output_shape.end());
+        cv::Mat output(static_cast<int>(dims.size()), dims.data(), CV_32F, outputs[0].GetTensorMutableData<float>());
+
+        // The output tensor is released with `outputs`
+        return output.clone();
+    }
+
+private:
+    Ort::Env env;
+    Ort::Session session;
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    std::string input_name;
+    std::string output_name;
+};
+
+std::unique_ptr<InferenceEngine> createOnnxRuntimeEngine(const std::string& model_path, int num_threads) {
+    return std::make_unique<OnnxRuntimeEngine>(model_path, num_threads);
+}
+
+#endif // WITH_ONNXRUNTIME
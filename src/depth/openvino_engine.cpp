@@ -0,0 +1,46 @@
+#ifdef WITH_OPENVINO
+
+#include "inference_engine.hpp"
+#include <openvino/openvino.hpp>
+
+// ------- OpenVINO CPU engine -------
+
+class OpenVinoEngine : public InferenceEngine {
+public:
+    OpenVinoEngine(const std::string& model_path, int num_threads) {
+        ov::AnyMap config{ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY)};
+        if (num_threads > 0) config.emplace(ov::inference_num_threads(num_threads));
+
+        compiled_model = core.compile_model(model_path, "CPU", config);
+        request = compiled_model.create_infer_request();
+    }
+
+    [[nodiscard]] const char* name() const override { return "openvino-cpu"; }
+
+    cv::Mat infer(const cv::Mat& blob) override {
+        ov::Shape shape{static_cast<size_t>(blob.size[0]), static_cast<size_t>(blob.size[1]),
+                        static_cast<size_t>(blob.size[2]), static_cast<size_t>(blob.size[3])};
+        ov::Tensor input(ov::element::f32, shape, const_cast<float*>(blob.ptr<float>()));
+        request.set_input_tensor(input);
+        request.infer();
+
+        ov::Tensor output_tensor = request.get_output_tensor();
+        ov::Shape output_shape = output_tensor.get_shape();
+        std::vector<int> dims(output_shape.begin(), output_shape.end());
+        cv::Mat output(static_cast<int>(dims.size()), dims.data(), CV_32F, output_tensor.data<float>());
+
+        // The output tensor is reused by the next request
+        return output.clone();
+    }
+
+private:
+    ov::Core core;
+    ov::CompiledModel compiled_model;
+    ov::InferRequest request;
+};
+
+std::unique_ptr<InferenceEngine> createOpenVinoEngine(const std::string& model_path, int num_threads) {
+    return std::make_unique<OpenVinoEngine>(model_path, num_threads);
+}
+
+#endif // WITH_OPENVINO
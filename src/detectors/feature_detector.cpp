@@ -1,7 +1,8 @@
 #include "feature_detector.hpp"
 
 
-void applyNMS(std::vector<cv::KeyPoint>& keypoints, float overlap_threshold) {
+// Keypoints NMS removes: the lower response of every overlapping pair
+static std::vector<bool> suppressedKeypoints(const std::vector<cv::KeyPoint>& keypoints, float overlap_threshold) {
     std::vector<bool> to_remove(keypoints.size(), false);
 
     for (size_t i = 0; i < keypoints.size(); ++i) {
@@ -21,49 +22,167 @@ void applyNMS(std::vector<cv::KeyPoint>& keypoints, float overlap_threshold) {
         }
     }
 
+    return to_remove;
+}
+
+void applyNMS(std::vector<cv::KeyPoint>& keypoints, float overlap_threshold) {
+    std::vector<bool> to_remove = suppressedKeypoints(keypoints, overlap_threshold);
+
     // Remove the marked keypoints
     keypoints.erase(std::remove_if(keypoints.begin(), keypoints.end(),
                                    [&](cv::KeyPoint& kp) { return to_remove[&kp - &keypoints[0]]; }), keypoints.end());
 }
 
-std::vector<std::vector<cv::Point2f>> clusterPoints(const std::vector<cv::Point2f>& points, float eps, int minPts) {
-    std::vector<bool> visited(points.size(), false);
-    std::vector<std::vector<cv::Point2f>> clusters;
+void applyNMS(std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors, float overlap_threshold) {
+    std::vector<bool> to_remove = suppressedKeypoints(keypoints, overlap_threshold);
+
+    // Compact keypoints and descriptor rows in place
+    size_t kept = 0;
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        if (to_remove[i]) continue;
+        if (kept != i) {
+            keypoints[kept] = keypoints[i];
+            descriptors.row(static_cast<int>(i)).copyTo(descriptors.row(static_cast<int>(kept)));
+        }
+        kept++;
+    }
+    keypoints.resize(kept);
+    if (!descriptors.empty()) descriptors = descriptors.rowRange(0, static_cast<int>(kept));
+}
+
+void ClusterSet::clear() {
+    labels.clear();
+    offsets.clear();
+    points.clear();
+    indices.clear();
+    depths.clear();
+    stats.clear();
+}
 
-    auto regionQuery = [&](int idx) {
-        std::vector<int> neighbors;
-        for (size_t i = 0; i < points.size(); ++i) {
-            if (norm(points[idx] - points[i]) <= eps)
-                neighbors.push_back(i);
+void clusterPoints(const std::vector<cv::Point2f>& points, float eps, int minPts, ClusterSet& clusters,
+                   const std::vector<float>& depths) {
+    constexpr int UNVISITED = -2;
+    constexpr int NOISE = -1;
+    const size_t point_count = points.size();
+    const float eps_sq = eps * eps;
+    std::vector<int>& labels = clusters.labels;
+    labels.assign(point_count, UNVISITED);
+
+    std::vector<int> seeds;
+    std::vector<int> neighbors;
+    auto regionQuery = [&](size_t idx, std::vector<int>& out) {
+        out.clear();
+        const cv::Point2f& center = points[idx];
+        for (size_t i = 0; i < point_count; ++i) {
+            float dx = points[i].x - center.x;
+            float dy = points[i].y - center.y;
+            if (dx * dx + dy * dy <= eps_sq) out.push_back(static_cast<int>(i));
         }
-        return neighbors;
     };
 
-    for (size_t i = 0; i < points.size(); ++i) {
-        if (visited[i]) continue;
-        visited[i] = true;
-        auto neighbors = regionQuery(i);
-
-        if (neighbors.size() < minPts) continue;
-
-        std::vector<cv::Point2f> cluster;
-        cluster.push_back(points[i]);
-
-        for (size_t j = 0; j < neighbors.size(); ++j) {
-            int idx = neighbors[j];
-            if (!visited[idx]) {
-                visited[idx] = true;
-                auto new_neighbors = regionQuery(idx);
-                if (new_neighbors.size() >= minPts) {
-                    neighbors.insert(neighbors.end(), new_neighbors.begin(), new_neighbors.end());
-                }
+    int cluster_count = 0;
+    for (size_t i = 0; i < point_count; ++i) {
+        if (labels[i] != UNVISITED) continue;
+        regionQuery(i, seeds);
+        if (seeds.size() < static_cast<size_t>(minPts)) {
+            labels[i] = NOISE;   // May still become a border point of a later cluster
+            continue;
+        }
+
+        int cluster = cluster_count++;
+        labels[i] = cluster;
+        for (size_t j = 0; j < seeds.size(); ++j) {
+            int idx = seeds[j];
+            if (labels[idx] == NOISE) labels[idx] = cluster;
+            if (labels[idx] != UNVISITED) continue;
+
+            labels[idx] = cluster;
+            regionQuery(idx, neighbors);
+            if (neighbors.size() >= static_cast<size_t>(minPts)) {
+                seeds.insert(seeds.end(), neighbors.begin(), neighbors.end());
             }
-            cluster.push_back(points[idx]);
         }
-        clusters.push_back(cluster);
     }
 
-    return clusters;
+    // Group the points by label (counting sort, stable in input order)
+    std::vector<int>& offsets = clusters.offsets;
+    offsets.assign(cluster_count + 1, 0);
+    for (int label : labels) {
+        if (label >= 0) offsets[label + 1]++;
+    }
+    for (int c = 0; c < cluster_count; ++c) offsets[c + 1] += offsets[c];
+
+    bool with_depths = depths.size() == point_count;
+    clusters.points.resize(offsets[cluster_count]);
+    clusters.indices.resize(offsets[cluster_count]);
+    clusters.depths.resize(with_depths ? offsets[cluster_count] : 0);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < point_count; ++i) {
+        if (labels[i] < 0) continue;
+        int slot = cursor[labels[i]]++;
+        clusters.points[slot] = points[i];
+        clusters.indices[slot] = static_cast<int>(i);
+        if (with_depths) clusters.depths[slot] = depths[i];
+    }
+
+    computeClusterStats(clusters);
+}
+
+void computeClusterStats(ClusterSet& clusters) {
+    int cluster_count = clusters.count();
+    bool with_depths = clusters.depths.size() == clusters.points.size();
+    clusters.stats.assign(cluster_count, ClusterStats{});
+
+    for (int c = 0; c < cluster_count; ++c) {
+        int first = clusters.offsets[c];
+        int last = clusters.offsets[c + 1];
+        ClusterStats& stats = clusters.stats[c];
+        stats.point_count = last - first;
+        if (stats.point_count == 0) continue;
+
+        // Sums in double: squared pixel coordinates of a large frame exceed float precision
+        double sum_x = 0, sum_y = 0, sum_xx = 0, sum_yy = 0, sum_xy = 0;
+        float min_x = clusters.points[first].x, max_x = min_x;
+        float min_y = clusters.points[first].y, max_y = min_y;
+        float min_depth = with_depths ? clusters.depths[first] : 0.0f, max_depth = min_depth;
+        for (int k = first; k < last; ++k) {
+            const cv::Point2f& pt = clusters.points[k];
+            sum_x += pt.x;
+            sum_y += pt.y;
+            sum_xx += static_cast<double>(pt.x) * pt.x;
+            sum_yy += static_cast<double>(pt.y) * pt.y;
+            sum_xy += static_cast<double>(pt.x) * pt.y;
+            min_x = std::min(min_x, pt.x);
+            max_x = std::max(max_x, pt.x);
+            min_y = std::min(min_y, pt.y);
+            max_y = std::max(max_y, pt.y);
+            if (with_depths) {
+                min_depth = std::min(min_depth, clusters.depths[k]);
+                max_depth = std::max(max_depth, clusters.depths[k]);
+            }
+        }
+
+        double n = stats.point_count;
+        double mean_x = sum_x / n, mean_y = sum_y / n;
+        double cov_xy = sum_xy / n - mean_x * mean_y;
+        stats.centroid = cv::Point2f(static_cast<float>(mean_x), static_cast<float>(mean_y));
+        stats.covariance = cv::Matx22f(static_cast<float>(std::max(0.0, sum_xx / n - mean_x * mean_x)),
+                                       static_cast<float>(cov_xy), static_cast<float>(cov_xy),
+                                       static_cast<float>(std::max(0.0, sum_yy / n - mean_y * mean_y)));
+        int left = cvFloor(min_x), top = cvFloor(min_y);
+        stats.bbox = cv::Rect(left, top, cvFloor(max_x) - left + 1, cvFloor(max_y) - top + 1);
+
+        if (with_depths) {
+            // The median reorders a scratch copy, the depth slice stays aligned with the points
+            std::vector<float>& scratch = clusters.depth_scratch;
+            scratch.assign(clusters.depths.begin() + first, clusters.depths.begin() + last);
+            auto depth_median = scratch.begin() + stats.point_count / 2;
+            std::nth_element(scratch.begin(), depth_median, scratch.end());
+            stats.depth_median = *depth_median;
+            stats.depth_min = min_depth;
+            stats.depth_max = max_depth;
+        }
+    }
 }
 
 std::vector<float> calculateKnnDistances(const std::vector<cv::Point2f>& points, int k) {
@@ -145,8 +264,9 @@ int test_fast_detector(std::string &image_path) {
     std::cout << "Determined eps for clustering: " << eps << std::endl;
 
     // Perform clustering
-    auto clusters = clusterPoints(points, eps, 3); // minPts = 3
-    std::cout << "Number of clusters: " << clusters.size() << std::endl;
+    ClusterSet clusters;
+    clusterPoints(points, eps, 3, clusters); // minPts = 3
+    std::cout << "Number of clusters: " << clusters.count() << std::endl;
 
     // Draw results
     cv::Mat output_image;
@@ -155,14 +275,14 @@ int test_fast_detector(std::string &image_path) {
     // Assign random colors to clusters
     std::vector<cv::Scalar> colors;
     cv::RNG rng(12345);
-    colors.reserve(clusters.size());
-    for (size_t i = 0; i < clusters.size(); ++i) {
+    colors.reserve(clusters.count());
+    for (int i = 0; i < clusters.count(); ++i) {
         colors.emplace_back(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255));
     }
 
-    for (size_t i = 0; i < clusters.size(); ++i) {
-        for (const auto& pt : clusters[i]) {
-            cv::circle(output_image, pt, 3, colors[i], -1);
+    for (int i = 0; i < clusters.count(); ++i) {
+        for (const cv::Point2f* pt = clusters.begin(i); pt != clusters.end(i); ++pt) {
+            cv::circle(output_image, *pt, 3, colors[i], -1);
         }
     }
 
@@ -0,0 +1,209 @@
+#include "gain_sweep.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+// Configurations simulated together by one SimulateSwarmStep call.
+static constexpr int SWEEP_BATCH_SIZE = 256;
+
+static std::vector<float> rangeValues(const ParameterRange& range) {
+    int steps = std::max(1, range.steps);
+    std::vector<float> values(steps, range.min);
+    for (int i = 1; i < steps; ++i) {
+        values[i] = range.min + (range.max - range.min) * static_cast<float>(i) / static_cast<float>(steps - 1);
+    }
+    return values;
+}
+
+std::vector<GainParameters> buildParameterGrid(const SweepSpace& space) {
+    std::vector<float> kp = rangeValues(space.kp), kd = rangeValues(space.kd), drag = rangeValues(space.drag);
+    std::vector<float> thrust = rangeValues(space.thrust), mass = rangeValues(space.mass);
+
+    std::vector<GainParameters> grid;
+    grid.reserve(kp.size() * kd.size() * drag.size() * thrust.size() * mass.size());
+    for (float p : kp)
+        for (float d : kd)
+            for (float dr : drag)
+                for (float t : thrust)
+                    for (float m : mass)
+                        grid.push_back({p, d, dr, t, m});
+    return grid;
+}
+
+std::vector<GainParameters> sampleParameters(const SweepSpace& space, int samples, unsigned seed) {
+    std::mt19937 generator(seed);
+    auto draw = [&](const ParameterRange& range) {
+        if (range.max <= range.min) return range.min;
+        return std::uniform_real_distribution<float>(range.min, range.max)(generator);
+    };
+
+    std::vector<GainParameters> configurations(std::max(0, samples));
+    for (auto& params : configurations) {
+        params.kp = draw(space.kp);
+        params.kd = draw(space.kd);
+        params.drag = draw(space.drag);
+        params.thrust = draw(space.thrust);
+        params.mass = draw(space.mass);
+    }
+    return configurations;
+}
+
+/**
+ * Fly one batch of configurations through the scenario on the struct-of-arrays
+ * swarm path and accumulate the metrics after every step.
+ */
+static void simulateBatch(const GainParameters* params, int count, const SweepScenario& scenario,
+                          SweepMetrics* metrics) {
+    std::vector<float> px(count, scenario.start.x), py(count, scenario.start.y), pz(count, scenario.start.z);
+    std::vector<float> vx(count, 0.0f), vy(count, 0.0f), vz(count, 0.0f);
+    std::vector<float> prevX(count), prevY(count), prevZ(count);
+    std::vector<float> tx(count), ty(count), tz(count);
+    std::vector<float> thrust(count), mass(count), drag(count), kp(count), kd(count);
+    std::vector<int> lastOutside(count);
+
+    for (int i = 0; i < count; ++i) {
+        thrust[i] = params[i].thrust;
+        mass[i] = params[i].mass;
+        drag[i] = params[i].drag;
+        kp[i] = params[i].kp;
+        kd[i] = params[i].kd;
+        metrics[i] = {params[i], 0.0f, 0.0f, 0.0f, 0.0f, true};
+    }
+
+    const int steps_per_leg = std::max(1, static_cast<int>(std::lround(scenario.leg_duration / scenario.dt)));
+    Vector3 from = scenario.start;
+    for (const Vector3& waypoint : scenario.waypoints) {
+        std::fill(tx.begin(), tx.end(), waypoint.x);
+        std::fill(ty.begin(), ty.end(), waypoint.y);
+        std::fill(tz.begin(), tz.end(), waypoint.z);
+        std::fill(lastOutside.begin(), lastOutside.end(), 0);
+
+        // Overshoot is measured along the direction of the leg
+        float dirX = waypoint.x - from.x, dirY = waypoint.y - from.y, dirZ = waypoint.z - from.z;
+        float legLength = std::sqrt(dirX * dirX + dirY * dirY + dirZ * dirZ);
+        if (legLength > 0.0f) {
+            dirX /= legLength; dirY /= legLength; dirZ /= legLength;
+        }
+
+        for (int step = 0; step < steps_per_leg; ++step) {
+            prevX = px; prevY = py; prevZ = pz;
+            SimulateSwarmStep(count, px.data(), py.data(), pz.data(), vx.data(), vy.data(), vz.data(),
+                              tx.data(), ty.data(), tz.data(),
+                              thrust.data(), mass.data(), drag.data(), kp.data(), kd.data(), scenario.dt, 1);
+
+            for (int i = 0; i < count; ++i) {
+                float dx = px[i] - prevX[i], dy = py[i] - prevY[i], dz = pz[i] - prevZ[i];
+                metrics[i].path_length += std::sqrt(dx * dx + dy * dy + dz * dz);
+
+                float ex = px[i] - waypoint.x, ey = py[i] - waypoint.y, ez = pz[i] - waypoint.z;
+                if (ex * ex + ey * ey + ez * ez > scenario.settle_tolerance * scenario.settle_tolerance) {
+                    lastOutside[i] = step + 1;
+                }
+                if (legLength > 0.0f) {
+                    metrics[i].overshoot = std::max(metrics[i].overshoot, ex * dirX + ey * dirY + ez * dirZ);
+                }
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (lastOutside[i] == steps_per_leg) metrics[i].settled = false;
+            metrics[i].settling_time += static_cast<float>(lastOutside[i]) * scenario.dt;
+        }
+        from = waypoint;
+    }
+
+    const Vector3& last = scenario.waypoints.back();
+    for (int i = 0; i < count; ++i) {
+        float ex = px[i] - last.x, ey = py[i] - last.y, ez = pz[i] - last.z;
+        metrics[i].final_error = std::sqrt(ex * ex + ey * ey + ez * ez);
+    }
+}
+
+std::vector<SweepMetrics> runGainSweep(const std::vector<GainParameters>& configurations,
+                                       const SweepScenario& scenario, int num_threads) {
+    if (scenario.waypoints.empty() || scenario.dt <= 0.0f) {
+        std::cerr << "Error: The sweep scenario needs waypoints and a positive time step." << std::endl;
+        return {};
+    }
+
+    std::vector<SweepMetrics> results(configurations.size());
+    const int count = static_cast<int>(configurations.size());
+    const int batches = (count + SWEEP_BATCH_SIZE - 1) / SWEEP_BATCH_SIZE;
+
+    int threads = num_threads > 0 ? num_threads
+                                  : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::max(1, std::min(threads, batches));
+
+    // Batches are handed out dynamically so a preempted thread does not hold up the rest
+    std::atomic<int> next_batch{0};
+    auto worker = [&]() {
+        for (int batch = next_batch++; batch < batches; batch = next_batch++) {
+            int begin = batch * SWEEP_BATCH_SIZE;
+            int size = std::min(SWEEP_BATCH_SIZE, count - begin);
+            simulateBatch(configurations.data() + begin, size, scenario, results.data() + begin);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (int t = 0; t < threads - 1; ++t) workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers) thread.join();
+
+    return results;
+}
+
+void rankSweepResults(std::vector<SweepMetrics>& results) {
+    std::stable_sort(results.begin(), results.end(), [](const SweepMetrics& a, const SweepMetrics& b) {
+        if (a.settled != b.settled) return a.settled;
+        if (a.settling_time != b.settling_time) return a.settling_time < b.settling_time;
+        if (a.overshoot != b.overshoot) return a.overshoot < b.overshoot;
+        return a.final_error < b.final_error;
+    });
+}
+
+bool writeSweepCsv(const std::string& path, const std::vector<SweepMetrics>& results) {
+    std::ofstream csv(path);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Could not create results file " << path << "." << std::endl;
+        return false;
+    }
+
+    csv << "kp,kd,drag,thrust,mass,settling_time,overshoot,path_length,final_error,settled\n";
+    for (const auto& result : results) {
+        const auto& p = result.params;
+        csv << p.kp << ',' << p.kd << ',' << p.drag << ',' << p.thrust << ',' << p.mass << ','
+            << result.settling_time << ',' << result.overshoot << ',' << result.path_length << ','
+            << result.final_error << ',' << (result.settled ? 1 : 0) << '\n';
+    }
+    return true;
+}
+
+bool loadWaypoints(const std::string& path, std::vector<Vector3>& waypoints) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open waypoint file " << path << "." << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        std::istringstream iss(line);
+        Vector3 waypoint{};
+        if (!(iss >> waypoint.x >> waypoint.y >> waypoint.z)) {
+            std::cerr << "Error: Invalid waypoint \"" << line << "\" in " << path << "." << std::endl;
+            return false;
+        }
+        waypoints.push_back(waypoint);
+    }
+    return true;
+}
@@ -1,5 +1,21 @@
 #include "kalman.hpp"
 
+// Move a [x, y, vx, vy] state with the image (e.g. camera motion): the position to its new place,
+// velocity and covariance through the local jacobian of the image motion
+static void warpState(Eigen::Vector4f& state, Eigen::Matrix4f& P, const cv::Point2f& position,
+                      const cv::Matx22f& jacobian) {
+    Eigen::Matrix2f J;
+    J << jacobian(0, 0), jacobian(0, 1),
+         jacobian(1, 0), jacobian(1, 1);
+    Eigen::Matrix4f G = Eigen::Matrix4f::Zero();
+    G.topLeftCorner<2, 2>() = J;
+    G.bottomRightCorner<2, 2>() = J;
+
+    state.head<2>() << position.x, position.y;
+    state.tail<2>() = J * state.tail<2>();
+    P = G * P * G.transpose();
+}
+
 // ------- Kalman Filter Implementation -------
 
 KalmanFilter::KalmanFilter() : KalmanFilter(0, 0) {}
@@ -33,6 +49,10 @@ void KalmanFilter::update(float x, float y) {
     P = (Eigen::Matrix4f::Identity() - K * H) * P;
 }
 
+void KalmanFilter::warp(const cv::Point2f& position, const cv::Matx22f& jacobian) {
+    warpState(state, P, position, jacobian);
+}
+
 cv::Point2f KalmanFilter::getPredictedPosition() const {
     return {state(0), state(1)};
 }
@@ -73,6 +93,10 @@ void ExtendedKalmanFilter::update(float x, float y) {
     P = (Eigen::Matrix4f::Identity() - K * H) * P;
 }
 
+void ExtendedKalmanFilter::warp(const cv::Point2f& position, const cv::Matx22f& jacobian) {
+    warpState(state, P, position, jacobian);
+}
+
 cv::Point2f ExtendedKalmanFilter::getPredictedPosition() const {
     return {state(0), state(1)};
 }
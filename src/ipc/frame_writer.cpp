@@ -0,0 +1,121 @@
+#include "frame_shm.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct FrameWriter {
+    std::string name;
+    size_t size;
+    FrameShmHeader* header;
+    uint8_t* slots;
+    bool acquired;          // A slot was handed out and not yet published
+};
+
+static uint64_t loadAcquire(const uint64_t& value) {
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(value)).load(std::memory_order_acquire);
+}
+
+static size_t alignUp(size_t value) {
+    return (value + FRAME_SHM_ALIGNMENT - 1) / FRAME_SHM_ALIGNMENT * FRAME_SHM_ALIGNMENT;
+}
+
+static FrameSlotHeader* slotHeader(FrameWriter* writer, uint64_t index) {
+    return reinterpret_cast<FrameSlotHeader*>(writer->slots + (index % writer->header->capacity) *
+                                                              writer->header->slot_size);
+}
+
+extern "C" FrameWriter* frame_writer_open(const char* name, uint32_t width, uint32_t height,
+                                          uint32_t pixel_format, uint32_t capacity) {
+    if (width == 0 || height == 0 || capacity == 0 ||
+        (pixel_format != FRAME_SHM_BGR24 && pixel_format != FRAME_SHM_RGB24)) return nullptr;
+
+    // Start from a fresh object so a consumer of a previous run detects the restart
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return nullptr;
+
+    auto stride = static_cast<uint32_t>(alignUp(static_cast<size_t>(width) * 3));
+    auto slot_size = static_cast<uint32_t>(alignUp(sizeof(FrameSlotHeader) + static_cast<size_t>(stride) * height));
+    size_t header_size = alignUp(sizeof(FrameShmHeader));
+    size_t total_size = header_size + static_cast<size_t>(slot_size) * capacity;
+
+    if (ftruncate(fd, static_cast<off_t>(total_size)) < 0) {
+        close(fd);
+        shm_unlink(name);
+        return nullptr;
+    }
+    void* memory = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name);
+        return nullptr;
+    }
+
+    auto* writer = new FrameWriter{name, total_size, static_cast<FrameShmHeader*>(memory),
+                                   static_cast<uint8_t*>(memory) + header_size, false};
+    FrameShmHeader* header = writer->header;
+    header->version = FRAME_SHM_VERSION;
+    header->capacity = capacity;
+    header->pixel_format = pixel_format;
+    header->width = width;
+    header->height = height;
+    header->stride = stride;
+    header->slot_size = slot_size;
+    std::atomic_ref<uint32_t>(header->magic).store(FRAME_SHM_MAGIC, std::memory_order_release);
+    return writer;
+}
+
+extern "C" void frame_writer_close(FrameWriter* writer) {
+    if (!writer) return;
+    munmap(writer->header, writer->size);
+    shm_unlink(writer->name.c_str());
+    delete writer;
+}
+
+extern "C" uint8_t* frame_writer_acquire(FrameWriter* writer) {
+    FrameShmHeader* header = writer->header;
+    uint64_t write_index = header->write_index;
+
+    // The acquire load pairs with the consumer's release of read_index: its reads of the slot are done
+    if (write_index - loadAcquire(header->read_index) >= header->capacity) {
+        std::atomic_ref<uint64_t>(header->dropped).fetch_add(1, std::memory_order_relaxed);
+        writer->acquired = false;
+        return nullptr;
+    }
+    writer->acquired = true;
+    return reinterpret_cast<uint8_t*>(slotHeader(writer, write_index) + 1);
+}
+
+extern "C" void frame_writer_publish(FrameWriter* writer, int64_t timestamp_ns) {
+    if (!writer->acquired) return;
+    writer->acquired = false;
+
+    FrameShmHeader* header = writer->header;
+    uint64_t write_index = header->write_index;
+    FrameSlotHeader* slot = slotHeader(writer, write_index);
+    slot->sequence = write_index;
+    slot->timestamp_ns = timestamp_ns;
+
+    // Pixels and slot header become visible together with the new write_index
+    std::atomic_ref<uint64_t>(header->write_index).store(write_index + 1, std::memory_order_release);
+}
+
+extern "C" int frame_writer_write(FrameWriter* writer, const uint8_t* pixels, size_t src_stride, int64_t timestamp_ns) {
+    uint8_t* destination = frame_writer_acquire(writer);
+    if (!destination) return 0;
+
+    const FrameShmHeader* header = writer->header;
+    size_t row_bytes = static_cast<size_t>(header->width) * 3;
+    for (uint32_t y = 0; y < header->height; ++y) {
+        std::memcpy(destination + static_cast<size_t>(y) * header->stride, pixels + y * src_stride, row_bytes);
+    }
+    frame_writer_publish(writer, timestamp_ns);
+    return 1;
+}
+
+extern "C" uint32_t frame_writer_stride(const FrameWriter* writer) {
+    return writer->header->stride;
+}
@@ -0,0 +1,141 @@
+#include "metrics_publisher.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "thread_layout.hpp"
+
+static_assert(LatencyHistogram::BUCKETS == METRICS_SHM_HISTOGRAM_BUCKETS, "histogram layout mismatch");
+static_assert(STAGE_COUNT <= METRICS_SHM_MAX_STAGES, "too many stages for the snapshot");
+
+static void copyHistogram(const LatencyHistogram& histogram, MetricsHistogram& out) {
+    out.count = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+        out.buckets[bucket] = histogram.bucketCount(bucket);
+        out.count += out.buckets[bucket];
+    }
+    out.sum_us = histogram.sumMcs();
+}
+
+MetricsPublisher::~MetricsPublisher() {
+    close();
+}
+
+bool MetricsPublisher::open(const std::string& name) {
+    close();
+
+    // Start from a fresh object so stale readers of a previous run detect the restart
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create shared memory " << name << "." << std::endl;
+        return false;
+    }
+
+    size_t total_size = sizeof(MetricsShmHeader);
+    if (ftruncate(fd, static_cast<off_t>(total_size)) < 0) {
+        std::cerr << "Error: Could not resize shared memory " << name << "." << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Could not map shared memory " << name << "." << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills the object: sequence 0 = nothing published yet
+    header = static_cast<MetricsShmHeader*>(memory);
+    shm_name = name;
+    size = total_size;
+    snapshot_count = 0;
+
+    header->version = METRICS_SHM_VERSION;
+    header->snapshot_size = sizeof(MetricsSnapshot);
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS - 1; ++bucket) {
+        header->bucket_bounds_us[bucket] = static_cast<uint64_t>(LatencyHistogram::bound(bucket));
+    }
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        std::strncpy(header->stage_names[stage], stageName(static_cast<PipelineStage>(stage)),
+                     sizeof(header->stage_names[stage]) - 1);
+    }
+    std::atomic_ref<uint32_t>(header->magic).store(METRICS_SHM_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void MetricsPublisher::close() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            stopping = true;
+        }
+        stop_requested.notify_one();
+        thread.join();
+    }
+    stopping = false;
+
+    if (!header) return;
+    munmap(header, size);
+    shm_unlink(shm_name.c_str());
+    header = nullptr;
+}
+
+void MetricsPublisher::publish(const PipelineMetrics& metrics) {
+    if (!header) return;
+
+    std::atomic_ref<uint64_t> sequence(header->sequence);
+    uint64_t next = 2 * (snapshot_count + 1);
+
+    // Mark the snapshot as being written before touching it
+    sequence.store(next - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    MetricsSnapshot& snapshot = header->snapshot;
+    snapshot.snapshot_seq = snapshot_count + 1;
+    snapshot.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    snapshot.frames_in = metrics.frames_in.get();
+    snapshot.frames_out = metrics.frames_out.get();
+    snapshot.frames_dropped = metrics.frames_dropped.get();
+    snapshot.depth_inferences = metrics.depth_inferences.get();
+    snapshot.frame_queue = metrics.frame_queue.get();
+    snapshot.record_queue = metrics.record_queue.get();
+    snapshot.keypoints = metrics.keypoints.get();
+    snapshot.filtered_keypoints = metrics.filtered_keypoints.get();
+    snapshot.clusters = metrics.clusters.get();
+    snapshot.tracks = metrics.tracks.get();
+    snapshot.changed_fraction = metrics.changed_fraction.get();
+    snapshot.stage_count = STAGE_COUNT;
+    copyHistogram(metrics.frame_latency, snapshot.frame_latency);
+    copyHistogram(metrics.depth_latency, snapshot.depth_latency);
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        copyHistogram(metrics.stage_latency[stage], snapshot.stage_latency[stage]);
+    }
+
+    sequence.store(next, std::memory_order_release);
+    snapshot_count++;
+}
+
+void MetricsPublisher::start(int interval_ms) {
+    if (!header || thread.joinable()) return;
+    thread = std::thread(&MetricsPublisher::publishLoop, this, std::max(1, interval_ms));
+}
+
+void MetricsPublisher::publishLoop(int interval_ms) {
+    enterThreadRole(ThreadRole::IO);
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (true) {
+        publish(pipelineMetrics());
+        if (stop_requested.wait_for(lock, std::chrono::milliseconds(interval_ms), [&] { return stopping; })) break;
+    }
+    // Final values for readers that outlive the pipeline
+    publish(pipelineMetrics());
+}
@@ -0,0 +1,93 @@
+#include "metrics_shm.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct MetricsReader {
+    int fd;
+    size_t size;
+    const MetricsShmHeader* header;
+};
+
+// Attempts at a consistent copy before the writer is assumed to have died mid-update; a
+// snapshot is written in well under a microsecond
+static const int MAX_READ_ATTEMPTS = 1000;
+
+static uint64_t loadAcquire(const uint64_t& value) {
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(value)).load(std::memory_order_acquire);
+}
+
+extern "C" MetricsReader* metrics_reader_open(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(MetricsShmHeader)) {
+        close(fd);
+        return nullptr;
+    }
+
+    auto size = static_cast<size_t>(st.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    auto* header = static_cast<const MetricsShmHeader*>(memory);
+    uint32_t magic = std::atomic_ref<uint32_t>(const_cast<uint32_t&>(header->magic)).load(std::memory_order_acquire);
+    if (magic != METRICS_SHM_MAGIC || header->version != METRICS_SHM_VERSION ||
+        header->snapshot_size != sizeof(MetricsSnapshot)) {
+        munmap(memory, size);
+        close(fd);
+        return nullptr;
+    }
+
+    auto* reader = new MetricsReader;
+    reader->fd = fd;
+    reader->size = size;
+    reader->header = header;
+    return reader;
+}
+
+extern "C" void metrics_reader_close(MetricsReader* reader) {
+    if (!reader) return;
+    munmap(const_cast<MetricsShmHeader*>(reader->header), reader->size);
+    close(reader->fd);
+    delete reader;
+}
+
+extern "C" int metrics_reader_read(MetricsReader* reader, MetricsSnapshot* out) {
+    const MetricsShmHeader* header = reader->header;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+        uint64_t before = loadAcquire(header->sequence);
+        if (before == 0) return 0;
+        if (before % 2 != 0) {
+            // Being written
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::memcpy(out, &header->snapshot, sizeof(MetricsSnapshot));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(header->sequence))
+                .load(std::memory_order_relaxed);
+        if (after == before) return 1;
+    }
+    return -1;
+}
+
+extern "C" const char* metrics_reader_stage_name(const MetricsReader* reader, uint32_t stage) {
+    if (stage >= METRICS_SHM_MAX_STAGES) return "";
+    return reader->header->stage_names[stage];
+}
+
+extern "C" uint64_t metrics_reader_bucket_bound(const MetricsReader* reader, uint32_t bucket) {
+    if (bucket >= METRICS_SHM_HISTOGRAM_BUCKETS - 1) return UINT64_MAX;
+    return reader->header->bucket_bounds_us[bucket];
+}
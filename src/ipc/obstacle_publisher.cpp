@@ -0,0 +1,100 @@
+#include "obstacle_publisher.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+ObstaclePublisher::~ObstaclePublisher() {
+    close();
+}
+
+bool ObstaclePublisher::open(const std::string& name, uint32_t capacity) {
+    close();
+    if (capacity == 0) return false;
+
+    // Start from a fresh object so stale readers of a previous run detect the restart
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create shared memory " << name << "." << std::endl;
+        return false;
+    }
+
+    size_t total_size = sizeof(ObstacleShmHeader) + capacity * sizeof(ObstacleSlot);
+    if (ftruncate(fd, static_cast<off_t>(total_size)) < 0) {
+        std::cerr << "Error: Could not resize shared memory " << name << "." << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Could not map shared memory " << name << "." << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills the object, so every slot starts with sequence 0
+    header = static_cast<ObstacleShmHeader*>(memory);
+    slots = reinterpret_cast<ObstacleSlot*>(header + 1);
+    shm_name = name;
+    size = total_size;
+
+    header->version = OBSTACLE_SHM_VERSION;
+    header->capacity = capacity;
+    header->slot_size = sizeof(ObstacleSlot);
+    header->write_index = 0;
+    std::atomic_ref<uint32_t>(header->magic).store(OBSTACLE_SHM_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void ObstaclePublisher::close() {
+    if (!header) return;
+    munmap(header, size);
+    shm_unlink(shm_name.c_str());
+    header = nullptr;
+    slots = nullptr;
+}
+
+void ObstaclePublisher::publish(const FrameResult& result) {
+    if (!header) return;
+
+    uint64_t index = header->write_index;
+    ObstacleSlot& slot = slots[index % header->capacity];
+    std::atomic_ref<uint64_t> sequence(slot.sequence);
+
+    // Mark the slot as being written before touching the frame
+    sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ObstacleFrame& frame = slot.frame;
+    frame.frame_seq = static_cast<uint64_t>(result.frame_index);
+    frame.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    frame.median_depth = result.median_depth;
+
+    size_t count = std::min(result.obstacles.size(), static_cast<size_t>(OBSTACLE_SHM_MAX_OBSTACLES));
+    frame.obstacle_count = static_cast<uint32_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        const TrackedObstacle& obstacle = result.obstacles[i];
+        ObstacleRecord& record = frame.obstacles[i];
+        record.track_id = obstacle.id;
+        record.point_count = obstacle.point_count;
+        record.x = obstacle.center.x;
+        record.y = obstacle.center.y;
+        record.vx = obstacle.velocity.x;
+        record.vy = obstacle.velocity.y;
+        record.depth_median = obstacle.depth_median;
+        record.depth_min = obstacle.depth_min;
+        record.depth_max = obstacle.depth_max;
+        record.reserved = 0.0f;
+    }
+
+    sequence.store(2 * (index + 1), std::memory_order_release);
+    std::atomic_ref<uint64_t>(header->write_index).store(index + 1, std::memory_order_release);
+}
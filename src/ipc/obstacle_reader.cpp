@@ -0,0 +1,170 @@
+#include "obstacle_shm.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// How often a reader without new frames looks for a restarted publisher
+static const std::chrono::milliseconds RESTART_CHECK_INTERVAL(100);
+
+struct ObstacleReader {
+    std::string name;
+    uint64_t inode;         // Identifies the mapped object; a restarted publisher creates a new one
+    size_t size;
+    const ObstacleShmHeader* header;
+    const ObstacleSlot* slots;
+    uint64_t next_index;    // Next frame to read
+    std::chrono::steady_clock::time_point restart_check;
+};
+
+static uint64_t loadAcquire(const uint64_t& value) {
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(value)).load(std::memory_order_acquire);
+}
+
+// Copy frame `index` out of its slot. Fails if the slot does not hold that frame
+// (not yet written, being written, or already overwritten).
+static bool readSlot(const ObstacleReader* reader, uint64_t index, ObstacleFrame* out) {
+    const ObstacleSlot& slot = reader->slots[index % reader->header->capacity];
+    uint64_t expected = 2 * (index + 1);
+
+    uint64_t before = loadAcquire(slot.sequence);
+    if (before != expected) return false;
+
+    std::memcpy(out, &slot.frame, sizeof(ObstacleFrame));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(slot.sequence)).load(std::memory_order_relaxed);
+    return after == expected;
+}
+
+// Map the object if the publisher has finished setting it up; `inode` identifies the object
+static const ObstacleShmHeader* mapRing(const char* name, size_t& size, uint64_t& inode) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(ObstacleShmHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    inode = static_cast<uint64_t>(st.st_ino);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return nullptr;
+
+    auto* header = static_cast<const ObstacleShmHeader*>(memory);
+    uint32_t magic = std::atomic_ref<uint32_t>(const_cast<uint32_t&>(header->magic)).load(std::memory_order_acquire);
+    if (magic != OBSTACLE_SHM_MAGIC || header->version != OBSTACLE_SHM_VERSION ||
+        header->slot_size != sizeof(ObstacleSlot) || header->capacity == 0 ||
+        size < sizeof(ObstacleShmHeader) + header->capacity * sizeof(ObstacleSlot)) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    return header;
+}
+
+static void attach(ObstacleReader* reader, const ObstacleShmHeader* header, size_t size, uint64_t inode) {
+    reader->header = header;
+    reader->size = size;
+    reader->inode = inode;
+    reader->slots = reinterpret_cast<const ObstacleSlot*>(header + 1);
+}
+
+// Follow a publisher that restarted since the object was mapped. Checked at most every
+// RESTART_CHECK_INTERVAL, and only while there are no new frames.
+static bool remapIfRestarted(ObstacleReader* reader) {
+    auto now = std::chrono::steady_clock::now();
+    if (now < reader->restart_check) return false;
+    reader->restart_check = now + RESTART_CHECK_INTERVAL;
+
+    // The publisher unlinks the old object and creates a new one under the same name
+    int fd = shm_open(reader->name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    bool same = fstat(fd, &st) < 0 || static_cast<uint64_t>(st.st_ino) == reader->inode;
+    close(fd);
+    if (same) return false;
+
+    size_t size = 0;
+    uint64_t inode = 0;
+    const ObstacleShmHeader* header = mapRing(reader->name.c_str(), size, inode);
+    if (!header) return false;    // Not set up yet, try again on the next check
+
+    munmap(const_cast<ObstacleShmHeader*>(reader->header), reader->size);
+    attach(reader, header, size, inode);
+    // Every frame of the new run is unread
+    reader->next_index = 0;
+    return true;
+}
+
+extern "C" ObstacleReader* obstacle_reader_open(const char* name) {
+    size_t size = 0;
+    uint64_t inode = 0;
+    const ObstacleShmHeader* header = mapRing(name, size, inode);
+    if (!header) return nullptr;
+
+    auto* reader = new ObstacleReader;
+    reader->name = name;
+    attach(reader, header, size, inode);
+    reader->restart_check = std::chrono::steady_clock::now() + RESTART_CHECK_INTERVAL;
+    // Start with the frames published from now on
+    reader->next_index = loadAcquire(header->write_index);
+    return reader;
+}
+
+extern "C" void obstacle_reader_close(ObstacleReader* reader) {
+    if (!reader) return;
+    munmap(const_cast<ObstacleShmHeader*>(reader->header), reader->size);
+    delete reader;
+}
+
+extern "C" int obstacle_reader_next(ObstacleReader* reader, ObstacleFrame* out, uint64_t* dropped) {
+    uint64_t skipped = 0;
+
+    while (true) {
+        uint64_t write_index = loadAcquire(reader->header->write_index);
+        if (reader->next_index >= write_index) {
+            if (remapIfRestarted(reader)) continue;
+            break;
+        }
+
+        // Skip frames that have already been overwritten
+        uint64_t capacity = reader->header->capacity;
+        if (write_index - reader->next_index > capacity) {
+            uint64_t oldest = write_index - capacity;
+            skipped += oldest - reader->next_index;
+            reader->next_index = oldest;
+        }
+
+        if (readSlot(reader, reader->next_index, out)) {
+            reader->next_index++;
+            if (dropped) *dropped = skipped;
+            return 1;
+        }
+
+        // Lapped by the producer while copying, skip the lost frame
+        skipped++;
+        reader->next_index++;
+    }
+
+    if (dropped) *dropped = skipped;
+    return 0;
+}
+
+extern "C" int obstacle_reader_latest(ObstacleReader* reader, ObstacleFrame* out) {
+    while (true) {
+        uint64_t write_index = loadAcquire(reader->header->write_index);
+        if (reader->next_index >= write_index && remapIfRestarted(reader)) continue;
+        if (write_index == 0) return 0;
+
+        if (readSlot(reader, write_index - 1, out)) {
+            reader->next_index = write_index;
+            return 1;
+        }
+    }
+}
@@ -1,8 +1,65 @@
 #include "video_processor.hpp"
+#include "offline_processor.hpp"
+#include "metrics_server.hpp"
 
+// Usage: drone_navigation [video|image_dir|shm:[/name]|camera:N|v4l2:/dev/videoN] [--offline]
+//                         [--engine=opencv|onnxruntime|openvino]
+//                         [--model=midas_small|midas_hybrid|depth_anything_v2]
+//                         [--dnn-backend=default|opencv|inference_engine|cuda]
+//                         [--dnn-target=cpu|opencl|opencl_fp16|cuda] [--threads=N] [--depth-tiles=N]
+//                         [--thread-layout=depth=0-3;pipeline=4,5;io=6-7] [--metrics-port=N]
+//                         [--calibration=camera.yml]
+// --metrics-port serves Prometheus metrics at http://127.0.0.1:N/metrics
+// --calibration undistorts keypoints and obstacles with an OpenCV camera calibration file
 int main(int argc, char** argv) {
     std::string video_filename = (argc > 1) ? argv[1] : "helicopter.mp4";
-    std::string video_path = getContentPath(video_filename);
+    // Source URIs (shm:, camera:N, v4l2:/dev/videoN) and absolute paths are used as given
+    bool is_source_uri = video_filename.find(':') != std::string::npos || video_filename.rfind('/', 0) == 0;
+    std::string video_path = is_source_uri ? video_filename : getContentPath(video_filename);
+
+    bool offline = false;
+    DepthEngineConfig depth_config;
+    ThreadLayout thread_layout;
+    int metrics_port = 0;
+    CameraCalibration calibration;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (arg == "--offline") offline = true;
+            else if (hasOption("--engine=")) ok = parseInferenceBackend(value("--engine="), depth_config.backend);
+            else if (hasOption("--model=")) ok = parseDepthModel(value("--model="), depth_config.model);
+            else if (hasOption("--dnn-backend=")) ok = parseDnnBackend(value("--dnn-backend="), depth_config.dnn_backend);
+            else if (hasOption("--dnn-target=")) ok = parseDnnTarget(value("--dnn-target="), depth_config.dnn_target);
+            else if (hasOption("--threads=")) depth_config.num_threads = std::stoi(value("--threads="));
+            else if (hasOption("--depth-tiles=")) depth_config.tiles = std::stoi(value("--depth-tiles="));
+            else if (hasOption("--thread-layout=")) ok = parseThreadLayout(value("--thread-layout="), thread_layout);
+            else if (hasOption("--metrics-port=")) metrics_port = std::stoi(value("--metrics-port="));
+            else if (hasOption("--calibration=")) ok = loadCameraCalibration(value("--calibration="), calibration);
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+    setThreadLayout(thread_layout);
+    setDepthEngineConfig(depth_config);
+    setCameraCalibration(calibration);
+
+    MetricsServer metrics_server;
+    if (metrics_port > 0 && !metrics_server.start("127.0.0.1", metrics_port)) return -1;
+
+    // Offline mode: process a recording in parallel chunks without displaying it
+    if (offline) {
+        return processVideoChunked(video_path);
+    }
 
     selectROI(video_path);
 
@@ -0,0 +1,332 @@
+#include "occupancy_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "time_meas.hpp"
+
+// Shards of the block table, updates of different shards run in parallel
+static constexpr int MAP_SHARDS = 64;
+
+// Neighbouring rays cross mostly the same voxels. A small direct-mapped cache of the
+// last free voxels of a stripe drops most duplicates before they are queued.
+static constexpr int MISS_CACHE_SIZE = 4096;
+
+// Block coordinates are packed into 21 bits each
+static uint64_t packBlockKey(const Eigen::Vector3i& block) {
+    return (static_cast<uint64_t>(block.x() & 0x1FFFFF) << 42) |
+           (static_cast<uint64_t>(block.y() & 0x1FFFFF) << 21) |
+           static_cast<uint64_t>(block.z() & 0x1FFFFF);
+}
+
+static int shardOf(uint64_t key) {
+    return static_cast<int>((key * 0x9E3779B97F4A7C15ull) >> 58) % MAP_SHARDS;
+}
+
+// Arithmetic shifts floor negative coordinates as well
+static Eigen::Vector3i blockOf(const Eigen::Vector3i& voxel) {
+    return {voxel.x() >> 3, voxel.y() >> 3, voxel.z() >> 3};
+}
+
+static uint32_t indexInBlock(const Eigen::Vector3i& voxel) {
+    return static_cast<uint32_t>(((voxel.x() & 7) << 6) | ((voxel.y() & 7) << 3) | (voxel.z() & 7));
+}
+
+static Eigen::Vector3i voxelOf(const Eigen::Vector3f& point, float voxel_size) {
+    return {static_cast<int>(std::floor(point.x() / voxel_size)),
+            static_cast<int>(std::floor(point.y() / voxel_size)),
+            static_cast<int>(std::floor(point.z() / voxel_size))};
+}
+
+/**
+ * Visit the voxels crossed by a segment in order (Amanatides & Woo), the end voxel last.
+ * The visitor returns false to stop the walk early.
+ */
+template <class Visitor>
+static void traverseVoxels(const Eigen::Vector3f& from, const Eigen::Vector3f& to, float voxel_size,
+                           Visitor visit) {
+    Eigen::Vector3f start = from / voxel_size;
+    Eigen::Vector3f direction = to / voxel_size - start;
+    Eigen::Vector3i voxel = voxelOf(from, voxel_size);
+    Eigen::Vector3i end = voxelOf(to, voxel_size);
+
+    Eigen::Vector3i step;
+    Eigen::Vector3f t_max, t_delta;
+    for (int a = 0; a < 3; ++a) {
+        if (direction[a] > 0.0f) {
+            step[a] = 1;
+            t_delta[a] = 1.0f / direction[a];
+            t_max[a] = (static_cast<float>(voxel[a] + 1) - start[a]) * t_delta[a];
+        } else if (direction[a] < 0.0f) {
+            step[a] = -1;
+            t_delta[a] = -1.0f / direction[a];
+            t_max[a] = (start[a] - static_cast<float>(voxel[a])) * t_delta[a];
+        } else {
+            step[a] = 0;
+            t_delta[a] = t_max[a] = std::numeric_limits<float>::infinity();
+        }
+    }
+
+    // Plain scalars in the loop, it runs for every voxel of every ray.
+    // Rounding can make the walk miss the end voxel, bound it by the Manhattan distance.
+    int x = voxel.x(), y = voxel.y(), z = voxel.z();
+    const int step_x = step.x(), step_y = step.y(), step_z = step.z();
+    float t_max_x = t_max.x(), t_max_y = t_max.y(), t_max_z = t_max.z();
+    const float t_delta_x = t_delta.x(), t_delta_y = t_delta.y(), t_delta_z = t_delta.z();
+    int remaining = (end - voxel).cwiseAbs().sum();
+    while (remaining-- > 0 && (x != end.x() || y != end.y() || z != end.z())) {
+        if (!visit(Eigen::Vector3i(x, y, z), false)) return;
+        if (t_max_x < t_max_y && t_max_x < t_max_z) {
+            x += step_x;
+            t_max_x += t_delta_x;
+        } else if (t_max_y < t_max_z) {
+            y += step_y;
+            t_max_y += t_delta_y;
+        } else {
+            z += step_z;
+            t_max_z += t_delta_z;
+        }
+    }
+    visit(end, true);
+}
+
+CameraIntrinsics CameraIntrinsics::fromFieldOfView(const cv::Size& image_size, float horizontal_fov_deg) {
+    float f = 0.5f * static_cast<float>(image_size.width) /
+              std::tan(0.5f * horizontal_fov_deg * static_cast<float>(CV_PI) / 180.0f);
+    return {f, f, 0.5f * static_cast<float>(image_size.width), 0.5f * static_cast<float>(image_size.height)};
+}
+
+OccupancyMap::OccupancyMap(const OccupancyMapConfig& config)
+        : config_(config), shards_(MAP_SHARDS) {
+    float block_extent = config_.voxel_size * BLOCK_SIZE;
+    window_blocks_ = std::max(1, static_cast<int>(std::ceil(config_.window_radius / block_extent)));
+}
+
+const OccupancyMap::Block* OccupancyMap::findBlock(uint64_t key) const {
+    const Shard& shard = shards_[shardOf(key)];
+    auto it = shard.find(key);
+    return it == shard.end() ? nullptr : it->second.get();
+}
+
+bool OccupancyMap::insideWindow(const Eigen::Vector3i& block) const {
+    return (block - window_center_).cwiseAbs().maxCoeff() <= window_blocks_;
+}
+
+void OccupancyMap::setWindowCenter(const Eigen::Vector3f& center) {
+    Eigen::Vector3i center_block = blockOf(voxelOf(center, config_.voxel_size));
+    if (center_block == window_center_) return;
+    window_center_ = center_block;
+
+    // Blocks do not store their coordinates, unpack the 21-bit fields with sign extension
+    auto unpack = [](uint64_t key, int shift) {
+        auto value = static_cast<int32_t>((key >> shift) & 0x1FFFFF);
+        return (value << 11) >> 11;
+    };
+    for (auto& shard : shards_) {
+        for (auto it = shard.begin(); it != shard.end();) {
+            Eigen::Vector3i block(unpack(it->first, 42), unpack(it->first, 21), unpack(it->first, 0));
+            it = insideWindow(block) ? std::next(it) : shard.erase(it);
+        }
+    }
+}
+
+int OccupancyMap::applyUpdates(int shard_index) {
+    Shard& shard = shards_[shard_index];
+    const uint32_t hit_stamp = (frame_ << 1) | 1u, miss_stamp = frame_ << 1;
+    int updates = 0;
+
+    // Consecutive updates mostly fall into the same block, skip the hash lookup for those
+    uint64_t cached_key = std::numeric_limits<uint64_t>::max();
+    Block* cached_block = nullptr;
+    auto blockFor = [&](uint64_t key) -> Block& {
+        if (key == cached_key) return *cached_block;
+        auto& block = shard[key];
+        if (!block) {
+            block = std::make_unique<Block>();
+            std::fill(std::begin(block->log_odds), std::end(block->log_odds), 0.0f);
+            std::fill(std::begin(block->stamp), std::end(block->stamp), 0u);
+        }
+        cached_key = key;
+        cached_block = block.get();
+        return *block;
+    };
+
+    // Hits first: a voxel seen as a surface by one ray is not cleared by another in the same frame
+    for (auto& stripe : stripes_) {
+        for (const auto& update : stripe.hits[shard_index]) {
+            Block& block = blockFor(update.block_key);
+            if (block.stamp[update.index] == hit_stamp) continue;
+            block.log_odds[update.index] = std::min(config_.log_odds_max,
+                                                    block.log_odds[update.index] + config_.log_odds_hit);
+            block.stamp[update.index] = hit_stamp;
+            updates++;
+        }
+    }
+    for (auto& stripe : stripes_) {
+        for (const auto& update : stripe.misses[shard_index]) {
+            Block& block = blockFor(update.block_key);
+            if ((block.stamp[update.index] >> 1) == frame_) continue;
+            block.log_odds[update.index] = std::max(config_.log_odds_min,
+                                                    block.log_odds[update.index] + config_.log_odds_miss);
+            block.stamp[update.index] = miss_stamp;
+            updates++;
+        }
+    }
+    return updates;
+}
+
+MapUpdateStats OccupancyMap::integrateDepth(const cv::Mat& depth, const CameraIntrinsics& intrinsics,
+                                            const CameraPose& pose) {
+    MapUpdateStats stats;
+    if (depth.empty() || depth.type() != CV_32F) {
+        std::cerr << "Error: The occupancy map needs a CV_32F depth image." << std::endl;
+        return stats;
+    }
+    auto start_time = get_current_time_fenced();
+
+    frame_++;
+    setWindowCenter(pose.translation);
+
+    const int stride = std::max(1, config_.pixel_stride);
+    const int sample_rows = (depth.rows + stride - 1) / stride;
+    const int num_stripes = std::max(1, std::min(sample_rows,
+                                                 config_.num_threads > 0 ? config_.num_threads : cv::getNumThreads()));
+    if (static_cast<int>(stripes_.size()) != num_stripes) {
+        stripes_.resize(num_stripes);
+        for (auto& stripe : stripes_) {
+            stripe.hits.resize(MAP_SHARDS);
+            stripe.misses.resize(MAP_SHARDS);
+            stripe.miss_cache.resize(MISS_CACHE_SIZE);
+        }
+    }
+
+    // ------ Ray casting: every stripe of sample rows collects its voxel updates per shard ------
+    cv::parallel_for_(cv::Range(0, num_stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            StripeBuffers& stripe = stripes_[s];
+            for (int shard = 0; shard < MAP_SHARDS; ++shard) {
+                stripe.hits[shard].clear();
+                stripe.misses[shard].clear();
+            }
+            std::fill(stripe.miss_cache.begin(), stripe.miss_cache.end(),
+                      VoxelUpdate{std::numeric_limits<uint64_t>::max(), 0});
+            stripe.rays = stripe.hit_count = 0;
+
+            // Rays start at the camera, which is inside the window: only rays ending outside need clipping
+            bool clip = false;
+            auto record = [&](const Eigen::Vector3i& voxel, bool hit) {
+                Eigen::Vector3i block = blockOf(voxel);
+                if (clip && !insideWindow(block)) return true;
+                VoxelUpdate update{packBlockKey(block), indexInBlock(voxel)};
+                if (hit) {
+                    stripe.hits[shardOf(update.block_key)].push_back(update);
+                    return true;
+                }
+
+                size_t slot = ((update.block_key * 0x9E3779B97F4A7C15ull) >> 40 ^ update.index) & (MISS_CACHE_SIZE - 1);
+                VoxelUpdate& cached = stripe.miss_cache[slot];
+                if (cached.block_key == update.block_key && cached.index == update.index) return true;
+                cached = update;
+                stripe.misses[shardOf(update.block_key)].push_back(update);
+                return true;
+            };
+
+            int row_begin = s * sample_rows / num_stripes, row_end = (s + 1) * sample_rows / num_stripes;
+            for (int row = row_begin; row < row_end; ++row) {
+                int v = row * stride;
+                const float* depth_row = depth.ptr<float>(v);
+                for (int u = 0; u < depth.cols; u += stride) {
+                    float d = depth_row[u];
+                    if (!(d > 0.0f)) continue;   // Also skips NaN
+
+                    // Beyond the range only the free space up to the range is known
+                    bool hit = d <= config_.max_range;
+                    d = std::min(d, config_.max_range);
+
+                    Eigen::Vector3f point_camera((static_cast<float>(u) - intrinsics.cx) / intrinsics.fx * d,
+                                                 (static_cast<float>(v) - intrinsics.cy) / intrinsics.fy * d,
+                                                 d);
+                    Eigen::Vector3f end = pose.rotation * point_camera + pose.translation;
+
+                    clip = !insideWindow(blockOf(voxelOf(end, config_.voxel_size)));
+                    traverseVoxels(pose.translation, end, config_.voxel_size,
+                                   [&](const Eigen::Vector3i& voxel, bool last) {
+                                       return record(voxel, last && hit);
+                                   });
+                    stripe.rays++;
+                    if (hit) stripe.hit_count++;
+                }
+            }
+        }
+    }, num_stripes);
+
+    // ------ Log-odds update: shards are disjoint, so they are updated in parallel ------
+    std::vector<int> shard_updates(MAP_SHARDS, 0);
+    cv::parallel_for_(cv::Range(0, MAP_SHARDS), [&](const cv::Range& range) {
+        for (int shard = range.start; shard < range.end; ++shard) {
+            shard_updates[shard] = applyUpdates(shard);
+        }
+    }, num_stripes);
+
+    for (const auto& stripe : stripes_) {
+        stats.rays += stripe.rays;
+        stats.hits += stripe.hit_count;
+    }
+    for (int updates : shard_updates) stats.voxel_updates += updates;
+    stats.blocks = blockCount();
+    stats.mcs = to_mcs(get_current_time_fenced() - start_time);
+    return stats;
+}
+
+VoxelState OccupancyMap::voxelState(const Eigen::Vector3i& voxel) const {
+    const Block* block = findBlock(packBlockKey(blockOf(voxel)));
+    if (!block) return VoxelState::UNKNOWN;
+
+    uint32_t index = indexInBlock(voxel);
+    if (block->stamp[index] == 0) return VoxelState::UNKNOWN;
+    return block->log_odds[index] > config_.occupied_threshold ? VoxelState::OCCUPIED : VoxelState::FREE;
+}
+
+VoxelState OccupancyMap::query(const Eigen::Vector3f& point) const {
+    return voxelState(voxelOf(point, config_.voxel_size));
+}
+
+bool OccupancyMap::segmentCollides(const Eigen::Vector3f& from, const Eigen::Vector3f& to,
+                                   bool unknown_is_occupied, Eigen::Vector3f* hit) const {
+    bool collides = false;
+    traverseVoxels(from, to, config_.voxel_size, [&](const Eigen::Vector3i& voxel, bool) {
+        VoxelState state = voxelState(voxel);
+        if (state == VoxelState::OCCUPIED || (unknown_is_occupied && state == VoxelState::UNKNOWN)) {
+            collides = true;
+            if (hit) *hit = (voxel.cast<float>() + Eigen::Vector3f::Constant(0.5f)) * config_.voxel_size;
+            return false;
+        }
+        return true;
+    });
+    return collides;
+}
+
+void OccupancyMap::clear() {
+    for (auto& shard : shards_) shard.clear();
+}
+
+size_t OccupancyMap::blockCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) count += shard.size();
+    return count;
+}
+
+size_t OccupancyMap::memoryBytes() const {
+    return blockCount() * (sizeof(Block) + sizeof(uint64_t) + sizeof(void*));
+}
+
+cv::Mat inverseDepthToMetric(const cv::Mat& inverse_depth, float scale, float min_value) {
+    cv::Mat inverse;
+    inverse_depth.convertTo(inverse, CV_32F);
+
+    cv::Mat metric;
+    cv::divide(scale, cv::max(inverse, min_value), metric);
+    metric.setTo(0.0f, inverse < min_value);
+    return metric;
+}
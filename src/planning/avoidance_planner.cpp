@@ -0,0 +1,216 @@
+#include "avoidance_planner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Previous choice, goal direction and braking are always evaluated, whatever the budget
+static constexpr int MIN_CANDIDATES = 3;
+
+// Spacing of the structured fan of directions [deg]
+static constexpr float FAN_STEP_DEG = 10.0f;
+
+static Eigen::Vector3f toEigen(const Vector3& v) {
+    return {v.x, v.y, v.z};
+}
+
+static Vector3 toVector3(const Eigen::Vector3f& v) {
+    return {v.x(), v.y(), v.z()};
+}
+
+AvoidancePlanner::AvoidancePlanner(const AvoidancePlannerConfig& config)
+        : config_(config), rng_(config.seed) {
+    config_.max_candidates = std::max(MIN_CANDIDATES, config_.max_candidates);
+    config_.max_obstacles = std::max(1, config_.max_obstacles);
+    config_.waypoint_count = std::max(1, config_.waypoint_count);
+    config_.up.normalize();
+
+    // The PD controller settles where kp * lookahead = (kd + drag) * speed
+    lookahead = config_.cruise_speed * (config_.kd + config_.drag) / config_.kp;
+    rollout_steps = std::max(1, static_cast<int>(std::lround(config_.horizon / config_.rollout_dt)));
+
+    obstacles_.reserve(config_.max_obstacles);
+    candidates_.resize(config_.max_candidates);
+
+    // Yaw/pitch grid, closest to the goal direction first; yaw before pitch at equal distance
+    for (float yaw = -config_.max_yaw_deg; yaw <= config_.max_yaw_deg + 1e-3f; yaw += FAN_STEP_DEG) {
+        for (float pitch = -config_.max_pitch_deg; pitch <= config_.max_pitch_deg + 1e-3f; pitch += FAN_STEP_DEG) {
+            if (std::abs(yaw) < 1e-3f && std::abs(pitch) < 1e-3f) continue;
+            fan_.emplace_back(yaw, pitch);
+        }
+    }
+    std::stable_sort(fan_.begin(), fan_.end(), [](const Eigen::Vector2f& a, const Eigen::Vector2f& b) {
+        float da = a.squaredNorm() + 0.01f * std::abs(a.y()), db = b.squaredNorm() + 0.01f * std::abs(b.y());
+        return da < db;
+    });
+}
+
+void AvoidancePlanner::setObstacles(const std::vector<PlannerObstacle>& obstacles, const Eigen::Vector3f& origin) {
+    auto distance = [&](const PlannerObstacle& obstacle) {
+        return (obstacle.position - origin).norm() - obstacle.radius;
+    };
+
+    // Keep the closest ones without growing the buffer
+    obstacles_.clear();
+    for (const auto& obstacle : obstacles) {
+        if (static_cast<int>(obstacles_.size()) < config_.max_obstacles) {
+            obstacles_.push_back(obstacle);
+            continue;
+        }
+        auto farthest = std::max_element(obstacles_.begin(), obstacles_.end(),
+                                         [&](const PlannerObstacle& a, const PlannerObstacle& b) {
+                                             return distance(a) < distance(b);
+                                         });
+        if (distance(obstacle) < distance(*farthest)) *farthest = obstacle;
+    }
+}
+
+Eigen::Vector3f AvoidancePlanner::rotated(const Eigen::Vector3f& forward, float yaw_deg, float pitch_deg) const {
+    const float to_rad = static_cast<float>(CV_PI) / 180.0f;
+    Eigen::Vector3f direction = Eigen::AngleAxisf(yaw_deg * to_rad, config_.up) * forward;
+
+    // Pitch around the horizontal axis across the direction; vertical flight directions only yaw
+    Eigen::Vector3f side = config_.up.cross(direction);
+    if (side.norm() > 1e-3f) direction = Eigen::AngleAxisf(-pitch_deg * to_rad, side.normalized()) * direction;
+    return direction.normalized();
+}
+
+void AvoidancePlanner::evaluate(const DroneState& state, const Eigen::Vector3f& goal, Candidate& candidate) const {
+    const float dt = config_.rollout_dt;
+    const Eigen::Vector3f carrot = candidate.direction * lookahead;
+
+    DroneState current = state;
+    float min_clearance = std::numeric_limits<float>::max();
+    float penalty = 0.0f;
+    candidate.collides = false;
+    candidate.collision_time = std::numeric_limits<float>::max();
+
+    for (int step = 1; step <= rollout_steps; ++step) {
+        // The target moves with the drone, so the rollout flies the direction at cruise speed;
+        // a zero direction puts the target on the drone, which brakes
+        Vector3 target{current.pos.x + carrot.x(), current.pos.y + carrot.y(), current.pos.z + carrot.z()};
+        DroneState next;
+        SimulateStep(&current, &target, dt, config_.thrust, config_.mass, config_.drag, config_.kp, config_.kd, &next);
+        current = next;
+
+        float t = static_cast<float>(step) * dt;
+        Eigen::Vector3f position = toEigen(current.pos);
+        float clearance = config_.up.dot(position) - config_.min_height;
+        for (const auto& obstacle : obstacles_) {
+            Eigen::Vector3f predicted = obstacle.position + obstacle.velocity * t;
+            clearance = std::min(clearance, (position - predicted).norm() - obstacle.radius - config_.drone_radius);
+        }
+        min_clearance = std::min(min_clearance, clearance);
+
+        if (clearance < 0.0f) {
+            candidate.collides = true;
+            candidate.collision_time = t;
+            break;
+        }
+        if (clearance < config_.safety_margin) {
+            float shortfall = config_.safety_margin - clearance;
+            penalty += config_.clearance_weight * shortfall * shortfall * dt;
+        }
+    }
+
+    float smoothness = has_previous ? config_.smoothness_weight * (candidate.direction - previous_direction).norm()
+                                    : 0.0f;
+    candidate.min_clearance = min_clearance;
+    candidate.cost = (goal - toEigen(current.pos)).norm() + penalty + smoothness;
+}
+
+void AvoidancePlanner::plan(const DroneState& state, const Eigen::Vector3f& goal, PlannerResult& result) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::microseconds(config_.budget_mcs);
+
+    Eigen::Vector3f position = toEigen(state.pos);
+    Eigen::Vector3f forward = goal - position;
+    bool at_goal = forward.norm() < 1e-3f;
+    forward = at_goal ? Eigen::Vector3f::Zero() : Eigen::Vector3f(forward.normalized());
+
+    std::uniform_real_distribution<float> yaw(-config_.max_yaw_deg, config_.max_yaw_deg);
+    std::uniform_real_distribution<float> pitch(-config_.max_pitch_deg, config_.max_pitch_deg);
+    auto direction = [&](int index) -> Eigen::Vector3f {
+        if (index == 0) return has_previous ? previous_direction : forward;
+        if (index == 1) return forward;
+        if (index == 2 || at_goal) return Eigen::Vector3f::Zero();
+        index -= MIN_CANDIDATES;
+        if (index < static_cast<int>(fan_.size())) return rotated(forward, fan_[index].x(), fan_[index].y());
+        return rotated(forward, yaw(rng_), pitch(rng_));
+    };
+
+    int best = -1, safest = 0;
+    result.evaluated = 0;
+    result.budget_exhausted = false;
+    int candidate_count = at_goal ? MIN_CANDIDATES : config_.max_candidates;
+    for (int i = 0; i < candidate_count; ++i) {
+        if (i >= MIN_CANDIDATES && std::chrono::steady_clock::now() >= deadline) {
+            result.budget_exhausted = true;
+            break;
+        }
+
+        Candidate& candidate = candidates_[i];
+        candidate.direction = direction(i);
+        evaluate(state, goal, candidate);
+        result.evaluated++;
+
+        if (!candidate.collides && (best < 0 || candidate.cost < candidates_[best].cost)) best = i;
+        const Candidate& safe = candidates_[safest];
+        if (candidate.collision_time > safe.collision_time ||
+            (candidate.collision_time == safe.collision_time && candidate.min_clearance > safe.min_clearance)) {
+            safest = i;
+        }
+    }
+
+    // Without a safe candidate, fly the one that collides last and least deep
+    const Candidate& chosen = candidates_[best >= 0 ? best : safest];
+    result.collision_free = best >= 0;
+    result.braking = chosen.direction.isZero();
+    result.cost = chosen.cost;
+    result.min_clearance = chosen.min_clearance;
+    result.target = toVector3(position + chosen.direction * lookahead);
+
+    // Waypoints along the chosen rollout
+    result.waypoints.resize(config_.waypoint_count);
+    DroneState current = state;
+    int next_waypoint = 0;
+    for (int step = 1; step <= rollout_steps && next_waypoint < config_.waypoint_count; ++step) {
+        Eigen::Vector3f carrot = chosen.direction * lookahead;
+        Vector3 target{current.pos.x + carrot.x(), current.pos.y + carrot.y(), current.pos.z + carrot.z()};
+        DroneState next;
+        SimulateStep(&current, &target, config_.rollout_dt, config_.thrust, config_.mass, config_.drag,
+                     config_.kp, config_.kd, &next);
+        current = next;
+        if (step * config_.waypoint_count >= (next_waypoint + 1) * rollout_steps) {
+            result.waypoints[next_waypoint++] = current.pos;
+        }
+    }
+
+    previous_direction = chosen.direction;
+    has_previous = true;
+    result.mcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+            .count();
+}
+
+PlannerObstacle obstacleFromTrack(const cv::Point2f& center, const cv::Point2f& pixel_velocity, const cv::Rect& bbox,
+                                  float range, const CameraIntrinsics& intrinsics, const CameraPose& pose,
+                                  const Eigen::Vector3f& drone_velocity) {
+    float offset_x = center.x - intrinsics.cx;
+    float offset_y = center.y - intrinsics.cy;
+    Eigen::Vector3f camera_point(offset_x * range / intrinsics.fx, offset_y * range / intrinsics.fy, range);
+
+    // Image motion u' = (fx * (Wx - Vx) - (u - cx) * (Wz - Vz)) / Z for obstacle velocity W and drone
+    // velocity V in the camera frame. The motion along the optical axis is not observed: Wz = 0.
+    Eigen::Vector3f drone = pose.rotation.transpose() * drone_velocity;
+    Eigen::Vector3f velocity(drone.x() + (pixel_velocity.x * range - offset_x * drone.z()) / intrinsics.fx,
+                             drone.y() + (pixel_velocity.y * range - offset_y * drone.z()) / intrinsics.fy,
+                             0.0f);
+
+    PlannerObstacle obstacle;
+    obstacle.position = pose.rotation * camera_point + pose.translation;
+    obstacle.velocity = pose.rotation * velocity;
+    obstacle.radius = 0.5f * std::max(static_cast<float>(bbox.width) * range / intrinsics.fx,
+                                      static_cast<float>(bbox.height) * range / intrinsics.fy);
+    return obstacle;
+}
@@ -0,0 +1,180 @@
+#include "http_request.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+// Requests with larger heads are rejected
+static constexpr size_t MAX_HEADER_BYTES = 16 * 1024;
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+static bool containsIgnoreCase(std::string_view text, std::string_view token) {
+    if (token.size() > text.size()) return false;
+    for (size_t i = 0; i + token.size() <= text.size(); ++i) {
+        if (equalsIgnoreCase(text.substr(i, token.size()), token)) return true;
+    }
+    return false;
+}
+
+static std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& [key, value] : headers) {
+        if (equalsIgnoreCase(key, name)) return value;
+    }
+    return {};
+}
+
+void HttpRequest::clear() {
+    method = {};
+    target = {};
+    headers.clear();
+    header_bytes = 0;
+    content_length = 0;
+    keep_alive = true;
+    expect_continue = false;
+}
+
+HttpParseStatus parseHttpRequest(const char* data, size_t size, size_t max_body_bytes, HttpRequest& request) {
+    if (request.header_bytes == 0) {
+        std::string_view buffer(data, std::min(size, MAX_HEADER_BYTES));
+        size_t head_end = buffer.find("\r\n\r\n");
+        if (head_end == std::string_view::npos) {
+            return size >= MAX_HEADER_BYTES ? HTTP_TOO_LARGE : HTTP_INCOMPLETE;
+        }
+
+        std::string_view head = buffer.substr(0, head_end + 2);
+        size_t line_end = head.find("\r\n");
+        std::string_view request_line = head.substr(0, line_end);
+
+        // METHOD SP TARGET SP VERSION
+        size_t first_space = request_line.find(' ');
+        size_t second_space = request_line.find(' ', first_space + 1);
+        if (first_space == std::string_view::npos || second_space == std::string_view::npos) return HTTP_BAD_REQUEST;
+        std::string_view version = request_line.substr(second_space + 1);
+        if (version.rfind("HTTP/1.", 0) != 0) return HTTP_BAD_REQUEST;
+
+        request.headers.clear();
+        request.method = request_line.substr(0, first_space);
+        request.target = request_line.substr(first_space + 1, second_space - first_space - 1);
+        request.keep_alive = version != "HTTP/1.0";
+
+        size_t position = line_end + 2;
+        while (position < head.size()) {
+            size_t end = head.find("\r\n", position);
+            std::string_view line = head.substr(position, end - position);
+            position = end + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0) return HTTP_BAD_REQUEST;
+            request.headers.emplace_back(line.substr(0, colon), trim(line.substr(colon + 1)));
+        }
+
+        std::string_view length = request.header("Content-Length");
+        request.content_length = 0;
+        if (!length.empty()) {
+            auto [end, error] = std::from_chars(length.data(), length.data() + length.size(), request.content_length);
+            if (error != std::errc() || end != length.data() + length.size()) return HTTP_BAD_REQUEST;
+        } else if (!request.header("Transfer-Encoding").empty()) {
+            return HTTP_LENGTH_REQUIRED;
+        }
+        if (request.content_length > max_body_bytes) return HTTP_TOO_LARGE;
+
+        std::string_view connection = request.header("Connection");
+        if (containsIgnoreCase(connection, "close")) request.keep_alive = false;
+        if (containsIgnoreCase(connection, "keep-alive")) request.keep_alive = true;
+        request.expect_continue = containsIgnoreCase(request.header("Expect"), "100-continue");
+        request.header_bytes = head_end + 4;
+    }
+
+    return size >= request.header_bytes + request.content_length ? HTTP_COMPLETE : HTTP_INCOMPLETE;
+}
+
+// Value of a `key=value` parameter in a header such as Content-Type or Content-Disposition
+static std::string_view headerParameter(std::string_view header, std::string_view key) {
+    size_t position = 0;
+    while ((position = header.find(';', position)) != std::string_view::npos) {
+        std::string_view parameter = trim(header.substr(position + 1));
+        position++;
+        if (parameter.size() <= key.size() || parameter[key.size()] != '=' ||
+            !equalsIgnoreCase(parameter.substr(0, key.size()), key)) continue;
+
+        std::string_view value = parameter.substr(key.size() + 1);
+        if (!value.empty() && value.front() == '"') {
+            size_t quote = value.find('"', 1);
+            return quote == std::string_view::npos ? std::string_view() : value.substr(1, quote - 1);
+        }
+        return value.substr(0, value.find(';'));
+    }
+    return {};
+}
+
+bool parseMultipart(std::string_view body, std::string_view content_type, std::vector<MultipartPart>& parts) {
+    parts.clear();
+    if (!containsIgnoreCase(content_type, "multipart/form-data")) return false;
+
+    std::string_view boundary = headerParameter(content_type, "boundary");
+    if (boundary.empty()) return false;
+
+    // The first delimiter has no leading CRLF, all later ones do
+    std::string delimiter = "--" + std::string(boundary);
+    if (body.rfind(delimiter, 0) != 0) return false;
+    delimiter.insert(0, "\r\n");
+
+    size_t position = delimiter.size() - 2;
+    while (true) {
+        // "--" after a delimiter closes the body
+        if (body.substr(position, 2) == "--") return true;
+        if (body.substr(position, 2) != "\r\n") return false;
+        position += 2;
+
+        size_t head_end = body.find("\r\n\r\n", position);
+        size_t part_end = body.find(delimiter, position);
+        if (part_end == std::string_view::npos) return false;
+
+        MultipartPart part;
+        if (body.substr(position, 2) == "\r\n") {
+            // Part without headers
+            part.data = body.substr(position + 2, part_end - position - 2);
+        } else {
+            if (head_end == std::string_view::npos || head_end > part_end) return false;
+            std::string_view head = body.substr(position, head_end + 2 - position);
+            size_t line_start = 0;
+            while (line_start < head.size()) {
+                size_t line_end = head.find("\r\n", line_start);
+                std::string_view line = head.substr(line_start, line_end - line_start);
+                line_start = line_end + 2;
+
+                size_t colon = line.find(':');
+                if (colon == std::string_view::npos) continue;
+                std::string_view key = line.substr(0, colon), value = trim(line.substr(colon + 1));
+                if (equalsIgnoreCase(key, "Content-Disposition")) {
+                    part.name = headerParameter(value, "name");
+                    part.filename = headerParameter(value, "filename");
+                } else if (equalsIgnoreCase(key, "Content-Type")) {
+                    part.content_type = value;
+                }
+            }
+            part.data = body.substr(head_end + 4, part_end - head_end - 4);
+        }
+        parts.push_back(part);
+        position = part_end + delimiter.size();
+    }
+}
+
+const MultipartPart* findPart(const std::vector<MultipartPart>& parts, std::string_view name) {
+    for (const auto& part : parts) {
+        if (part.name == name) return &part;
+    }
+    return nullptr;
+}
@@ -0,0 +1,586 @@
+#include "image_server.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // macOS: SIGPIPE is ignored by the caller instead
+#endif
+
+// Connection buffers grow in steps of at least this many bytes
+static constexpr size_t READ_CHUNK_BYTES = 64 * 1024;
+
+// Buffers kept for reuse, enough for the frames in flight plus the recording backlog
+static constexpr size_t MAX_POOLED_BUFFERS = 32;
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static const char* statusText(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Internal Server Error";
+    }
+}
+
+int mostUrgentObstacle(const FrameResult& result) {
+    int urgent = -1;
+    for (int i = 0; i < static_cast<int>(result.obstacles.size()); ++i) {
+        const TrackedObstacle& obstacle = result.obstacles[i];
+        if (urgent < 0 || obstacle.depth_median > result.obstacles[urgent].depth_median ||
+            (obstacle.depth_median == result.obstacles[urgent].depth_median &&
+             obstacle.point_count > result.obstacles[urgent].point_count)) {
+            urgent = i;
+        }
+    }
+    return urgent;
+}
+
+ImageServer::ImageServer(const ImageServerConfig& config) : config(config) {}
+
+ImageServer::~ImageServer() {
+    stop();
+    joinWorkers();
+
+    for (auto& connection : connections) {
+        if (connection.fd >= 0) ::close(connection.fd);
+    }
+    if (listen_fd >= 0) ::close(listen_fd);
+    for (int fd : wake_pipe) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+bool ImageServer::start() {
+    if (!config.record_dir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(config.record_dir, error);
+        if (error) {
+            std::cerr << "Error: Could not create recording directory " << config.record_dir << std::endl;
+            return false;
+        }
+
+        // Continue after the highest existing index instead of probing file names per frame
+        for (const auto& entry : std::filesystem::directory_iterator(config.record_dir)) {
+            unsigned long long index = 0;
+            if (std::sscanf(entry.path().filename().string().c_str(), "image%llu.jpg", &index) == 1) {
+                next_record_index = std::max<uint64_t>(next_record_index, index + 1);
+            }
+        }
+    }
+
+    if (pipe(wake_pipe) != 0 || !setNonBlocking(wake_pipe[0]) || !setNonBlocking(wake_pipe[1])) {
+        std::cerr << "Error: Could not create the wake-up pipe." << std::endl;
+        return false;
+    }
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Error: Could not create the server socket." << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(config.port));
+    if (inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1 ||
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, SOMAXCONN) != 0 || !setNonBlocking(listen_fd)) {
+        std::cerr << "Error: Could not listen on " << config.host << ":" << config.port << std::endl;
+        return false;
+    }
+
+    running = true;
+    pipeline_thread = std::thread(&ImageServer::pipelineLoop, this);
+    if (!config.record_dir.empty()) record_thread = std::thread(&ImageServer::recordLoop, this);
+    return true;
+}
+
+void ImageServer::stop() {
+    running = false;
+    if (wake_pipe[1] >= 0) {
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = write(wake_pipe[1], &byte, 1);
+    }
+}
+
+void ImageServer::run() {
+    enterThreadRole(ThreadRole::IO);
+    std::vector<pollfd> poll_fds;
+    std::vector<size_t> poll_connections;   // Connection slot of every pollfd after the first two
+
+    while (running) {
+        poll_fds.clear();
+        poll_connections.clear();
+
+        size_t open_connections = 0;
+        for (const auto& connection : connections) open_connections += connection.fd >= 0;
+        short accept_events = open_connections < static_cast<size_t>(config.max_connections) ? POLLIN : 0;
+        poll_fds.push_back({listen_fd, accept_events, 0});
+        poll_fds.push_back({wake_pipe[0], POLLIN, 0});
+
+        for (size_t i = 0; i < connections.size(); ++i) {
+            const Connection& connection = connections[i];
+            if (connection.fd < 0) continue;
+            bool output_pending = connection.output_offset < connection.output.size();
+            // A closed peer reports POLLHUP on every poll; only wait for room to write its replies
+            if (connection.peer_closed && !output_pending) continue;
+            short events = 0;
+            if (!connection.waiting && !connection.peer_closed) events |= POLLIN;
+            if (output_pending) events |= POLLOUT;
+            poll_fds.push_back({connection.fd, events, 0});
+            poll_connections.push_back(i);
+        }
+
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: poll() failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        if (poll_fds[1].revents & POLLIN) {
+            char drain[256];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0) {}
+            deliverResponses();
+        }
+        if (poll_fds[0].revents & POLLIN) acceptConnections();
+
+        for (size_t p = 2; p < poll_fds.size(); ++p) {
+            size_t index = poll_connections[p - 2];
+            short revents = poll_fds[p].revents;
+            if (connections[index].fd != poll_fds[p].fd) continue;   // Closed while handling an earlier event
+
+            if (revents & (POLLERR | POLLNVAL)) {
+                closeConnection(index);
+                continue;
+            }
+            if (revents & POLLOUT) writeConnection(index);
+            if (connections[index].fd >= 0 && !connections[index].peer_closed && (revents & (POLLIN | POLLHUP))) {
+                readConnection(index);
+            }
+        }
+    }
+
+    running = false;
+    joinWorkers();
+}
+
+void ImageServer::joinWorkers() {
+    // Taking the locks orders the wake-ups after the waiters' checks of `running`
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+    }
+    job_ready.notify_all();
+    if (pipeline_thread.joinable()) pipeline_thread.join();
+
+    // The recorder stops after the pipeline so that the last frames are still written
+    {
+        std::lock_guard<std::mutex> lock(record_mutex);
+    }
+    record_ready.notify_all();
+    if (record_thread.joinable()) record_thread.join();
+}
+
+void ImageServer::acceptConnections() {
+    size_t open_connections = 0;
+    for (const auto& connection : connections) open_connections += connection.fd >= 0;
+
+    // Connections over the limit wait in the listen backlog
+    while (open_connections < static_cast<size_t>(config.max_connections)) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Error: accept() failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        // Reuse a free slot, its buffers keep their capacity
+        size_t index = connections.size();
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (connections[i].fd < 0) {
+                index = i;
+                break;
+            }
+        }
+        if (index == connections.size()) connections.emplace_back();
+
+        Connection& connection = connections[index];
+        connection.fd = fd;
+        connection.generation = next_generation++;
+        open_connections++;
+    }
+}
+
+void ImageServer::closeConnection(size_t index) {
+    Connection& connection = connections[index];
+    ::close(connection.fd);
+    connection.fd = -1;
+    connection.input_size = 0;
+    connection.output.clear();
+    connection.output_offset = 0;
+    connection.request.clear();
+    connection.continue_sent = false;
+    connection.waiting = false;
+    connection.close_after_write = false;
+    connection.peer_closed = false;
+}
+
+void ImageServer::readConnection(size_t index) {
+    Connection& connection = connections[index];
+    const size_t max_input = config.max_request_bytes + READ_CHUNK_BYTES;
+
+    while (true) {
+        if (connection.input.size() - connection.input_size < READ_CHUNK_BYTES / 4) {
+            if (connection.input.size() >= max_input) break;   // The parser reports the request as too large
+            connection.request.clear();   // The parsed views point into the old buffer, parse again
+            connection.input.resize(std::min(max_input, std::max(connection.input.size() * 2,
+                                                                 connection.input_size + READ_CHUNK_BYTES)));
+        }
+
+        ssize_t received = recv(connection.fd, connection.input.data() + connection.input_size,
+                                connection.input.size() - connection.input_size, 0);
+        if (received == 0) {
+            // A client may shut down its side after the request and still read the reply
+            connection.peer_closed = true;
+            break;
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeConnection(index);
+            return;
+        }
+        connection.input_size += static_cast<size_t>(received);
+    }
+
+    handleRequest(index);
+    closeIfDone(index);
+}
+
+void ImageServer::closeIfDone(size_t index) {
+    Connection& connection = connections[index];
+    if (connection.fd >= 0 && connection.peer_closed && !connection.waiting && connection.output.empty()) {
+        closeConnection(index);
+    }
+}
+
+void ImageServer::handleRequest(size_t index) {
+    Connection& connection = connections[index];
+    if (connection.waiting || connection.input_size == 0) return;
+
+    HttpParseStatus status = parseHttpRequest(connection.input.data(), connection.input_size,
+                                              config.max_request_bytes, connection.request);
+    switch (status) {
+        case HTTP_INCOMPLETE:
+            if (connection.request.header_bytes > 0 && connection.request.expect_continue && !connection.continue_sent) {
+                connection.continue_sent = true;
+                connection.output += "HTTP/1.1 100 Continue\r\n\r\n";
+                writeConnection(index);
+            }
+            return;
+        case HTTP_BAD_REQUEST:
+            counters.bad_requests++;
+            queueResponse(index, 400, "Malformed request", false);
+            return;
+        case HTTP_TOO_LARGE:
+            counters.bad_requests++;
+            queueResponse(index, 413, "Request too large", false);
+            return;
+        case HTTP_LENGTH_REQUIRED:
+            counters.bad_requests++;
+            queueResponse(index, 411, "Content-Length required", false);
+            return;
+        case HTTP_COMPLETE:
+            break;
+    }
+    counters.requests++;
+
+    const HttpRequest& request = connection.request;
+    const size_t request_bytes = request.header_bytes + request.content_length;
+    const bool keep_alive = request.keep_alive;
+    int status_code = 200;
+    std::string message;
+    const char* content_type = nullptr;
+    FrameJob job;
+
+    if (request.method == "GET" && request.target == "/metrics") {
+        status_code = 200;
+        message = formatPrometheus(pipelineMetrics());
+        content_type = "text/plain; version=0.0.4";
+    } else if (request.method == "GET") {
+        // Health check
+        char body[256];
+        std::snprintf(body, sizeof(body),
+                      "{\"requests\": %llu, \"frames\": %llu, \"rejected\": %llu, \"recorded\": %llu}",
+                      static_cast<unsigned long long>(counters.requests.load()),
+                      static_cast<unsigned long long>(counters.frames_processed.load()),
+                      static_cast<unsigned long long>(counters.frames_rejected.load()),
+                      static_cast<unsigned long long>(counters.frames_recorded.load()));
+        message = body;
+    } else if (request.method != "POST") {
+        status_code = 405;
+        message = "Only GET and POST are supported";
+    } else {
+        std::string_view body(connection.input.data() + request.header_bytes, request.content_length);
+        const MultipartPart* file = nullptr;
+        if (!parseMultipart(body, request.header("Content-Type"), parts) || !(file = findPart(parts, "file"))) {
+            status_code = 400;
+            message = "No file in request";
+        } else if (file->data.empty()) {
+            status_code = 400;
+            message = "No selected file";
+        } else {
+            const MultipartPart* restart = findPart(parts, "restart");
+            job.connection = index;
+            job.generation = connection.generation;
+            job.restart = restart && restart->data == "1";
+            job.keep_alive = keep_alive;
+            job.received_mcs = to_mcs(get_current_time_fenced().time_since_epoch());
+            job.jpeg = acquireBuffer();
+            job.jpeg.assign(file->data.begin(), file->data.end());
+        }
+    }
+
+    // The request bytes are consumed; keep what the client already sent of the next one
+    connection.input_size -= request_bytes;
+    std::memmove(connection.input.data(), connection.input.data() + request_bytes, connection.input_size);
+    connection.request.clear();
+    connection.continue_sent = false;
+
+    if (job.jpeg.empty()) {
+        if (status_code != 200) counters.bad_requests++;
+        queueResponse(index, status_code, message, keep_alive, content_type);
+        return;
+    }
+
+    PipelineMetrics& metrics = pipelineMetrics();
+    metrics.frames_in.add();
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        if (jobs.size() < config.max_pending_frames) {
+            jobs.push_back(std::move(job));
+            queued = true;
+        }
+        metrics.frame_queue.set(static_cast<double>(jobs.size()));
+    }
+    if (!queued) {
+        counters.frames_rejected++;
+        metrics.frames_dropped.add();
+        releaseBuffer(std::move(job.jpeg));
+        queueResponse(index, 503, "Pipeline busy", keep_alive);
+        return;
+    }
+    connection.waiting = true;
+    job_ready.notify_one();
+}
+
+void ImageServer::queueResponse(size_t index, int status, const std::string& body, bool keep_alive,
+                                const char* content_type) {
+    Connection& connection = connections[index];
+    if (!content_type) content_type = (status == 200) ? "application/json" : "text/plain";
+
+    char head[256];
+    int head_size = std::snprintf(head, sizeof(head),
+                                  "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+                                  status, statusText(status), content_type, body.size(),
+                                  keep_alive ? "keep-alive" : "close");
+    connection.output.append(head, static_cast<size_t>(head_size));
+    connection.output += body;
+    connection.close_after_write = !keep_alive;
+    writeConnection(index);
+}
+
+void ImageServer::writeConnection(size_t index) {
+    Connection& connection = connections[index];
+    while (connection.output_offset < connection.output.size()) {
+        ssize_t sent = send(connection.fd, connection.output.data() + connection.output_offset,
+                            connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // poll() reports POLLOUT when there is room
+            closeConnection(index);
+            return;
+        }
+        connection.output_offset += static_cast<size_t>(sent);
+    }
+
+    connection.output.clear();
+    connection.output_offset = 0;
+    if (connection.close_after_write) {
+        closeConnection(index);
+    } else {
+        if (!connection.waiting && connection.input_size > 0) handleRequest(index);   // Pipelined request
+        closeIfDone(index);
+    }
+}
+
+void ImageServer::deliverResponses() {
+    std::deque<FrameResponse> ready;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        ready.swap(responses);
+    }
+
+    for (auto& response : ready) {
+        // The client may have disconnected and its slot been reused while the frame was processed
+        if (response.connection >= connections.size()) continue;
+        Connection& connection = connections[response.connection];
+        if (connection.fd < 0 || connection.generation != response.generation) continue;
+
+        connection.waiting = false;
+        if (config.verbose) std::cout << response.body << std::endl;
+        queueResponse(response.connection, response.status, response.body, response.keep_alive);
+    }
+}
+
+void ImageServer::pipelineLoop() {
+    enterThreadRole(ThreadRole::PIPELINE);
+    PipelineContext context;
+    cv::Mat frame;   // Decode target, reallocated only when the image size changes
+    int frame_index = 0;
+
+    while (true) {
+        FrameJob job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_ready.wait(lock, [&] { return !jobs.empty() || !running; });
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            pipelineMetrics().frame_queue.set(static_cast<double>(jobs.size()));
+        }
+
+        auto start_time = get_current_time_fenced();
+        FrameResponse response{job.connection, job.generation, {}, 200, job.keep_alive};
+
+        cv::imdecode(job.jpeg, cv::IMREAD_COLOR, &frame);
+        if (frame.empty()) {
+            counters.decode_errors++;
+            response.status = 400;
+            response.body = "Could not decode image";
+        } else {
+            if (job.restart) {
+                context.trackers.clear();
+                context.ego_estimator.reset();
+            }
+
+            FrameResult result;
+            result.frame_index = frame_index++;
+            processFrame(context, frame, result);
+
+            // Box normalized to the image size, all zeros when nothing is tracked
+            float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f, depth = 0.0f;
+            int id = -1;
+            int urgent = mostUrgentObstacle(result);
+            if (urgent >= 0) {
+                const TrackedObstacle& obstacle = result.obstacles[urgent];
+                x = static_cast<float>(obstacle.bbox.x) / static_cast<float>(frame.cols);
+                y = static_cast<float>(obstacle.bbox.y) / static_cast<float>(frame.rows);
+                w = static_cast<float>(obstacle.bbox.width) / static_cast<float>(frame.cols);
+                h = static_cast<float>(obstacle.bbox.height) / static_cast<float>(frame.rows);
+                depth = obstacle.depth_median;
+                id = obstacle.id;
+            }
+
+            long long latency_mcs = to_mcs(get_current_time_fenced().time_since_epoch()) - job.received_mcs;
+            char body[256];
+            std::snprintf(body, sizeof(body),
+                          "{\"x\": %.4f, \"y\": %.4f, \"w\": %.4f, \"h\": %.4f, \"id\": %d, \"depth\": %.1f, "
+                          "\"obstacles\": %zu, \"frame\": %d, \"latency_ms\": %.2f}",
+                          x, y, w, h, id, depth, result.obstacles.size(), result.frame_index,
+                          static_cast<double>(latency_mcs) / 1000.0);
+            response.body = body;
+            counters.frames_processed++;
+        }
+        counters.pipeline_mcs += static_cast<uint64_t>(to_mcs(get_current_time_fenced() - start_time));
+
+        // Recording gets the encoded bytes as received, no re-encoding
+        if (!config.record_dir.empty()) {
+            std::lock_guard<std::mutex> lock(record_mutex);
+            if (records.size() < config.max_pending_records) {
+                records.push_back(std::move(job.jpeg));
+            } else {
+                counters.records_dropped++;
+            }
+            pipelineMetrics().record_queue.set(static_cast<double>(records.size()));
+        }
+        if (!config.record_dir.empty()) record_ready.notify_one();
+        if (!job.jpeg.empty()) releaseBuffer(std::move(job.jpeg));
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            responses.push_back(std::move(response));
+        }
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = write(wake_pipe[1], &byte, 1);
+    }
+}
+
+void ImageServer::recordLoop() {
+    enterThreadRole(ThreadRole::IO);
+    while (true) {
+        std::vector<uchar> jpeg;
+        {
+            std::unique_lock<std::mutex> lock(record_mutex);
+            record_ready.wait(lock, [&] { return !records.empty() || !running; });
+            // Queued frames are still written after stop()
+            if (records.empty()) return;
+            jpeg = std::move(records.front());
+            records.pop_front();
+            pipelineMetrics().record_queue.set(static_cast<double>(records.size()));
+        }
+
+        char file_name[32];
+        std::snprintf(file_name, sizeof(file_name), "image%06llu.jpg",
+                      static_cast<unsigned long long>(next_record_index++));
+        std::ofstream file(std::filesystem::path(config.record_dir) / file_name, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(jpeg.data()), static_cast<std::streamsize>(jpeg.size()))) {
+            std::cerr << "Error: Could not write " << file_name << std::endl;
+        } else {
+            counters.frames_recorded++;
+        }
+        releaseBuffer(std::move(jpeg));
+    }
+}
+
+std::vector<uchar> ImageServer::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (buffer_pool.empty()) return {};
+    std::vector<uchar> buffer = std::move(buffer_pool.back());
+    buffer_pool.pop_back();
+    return buffer;
+}
+
+void ImageServer::releaseBuffer(std::vector<uchar>&& buffer) {
+    buffer.clear();   // Keeps the capacity
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (buffer_pool.size() < MAX_POOLED_BUFFERS) buffer_pool.push_back(std::move(buffer));
+}
@@ -0,0 +1,170 @@
+#include "metrics_server.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "http_request.hpp"
+#include "pipeline_metrics.hpp"
+#include "thread_layout.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // macOS: SIGPIPE is ignored by the caller instead
+#endif
+
+// Scrape requests have no body; anything larger is not a scrape
+static constexpr size_t MAX_REQUEST_BYTES = 8 * 1024;
+
+// Time a client has to send its request and take the response. Connections are served one at
+// a time, so a stalled or slow scraper delays the others by at most this much.
+static constexpr int CLIENT_TIMEOUT_MS = 1000;
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+// Wait until the socket is ready for `events`; false on timeout or errors
+static bool waitUntil(int fd, short events, Deadline deadline) {
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) return false;
+        pollfd poll_fd = {fd, events, 0};
+        int ready = poll(&poll_fd, 1, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR) continue;
+        return ready > 0;
+    }
+}
+
+static void sendAll(int fd, const std::string& data, Deadline deadline) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitUntil(fd, POLLOUT, deadline)) continue;
+            return;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+}
+
+static void sendResponse(int fd, Deadline deadline, int status, const char* status_text, const char* content_type,
+                         const std::string& body) {
+    char head[256];
+    int head_size = std::snprintf(head, sizeof(head),
+                                  "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                  "Connection: close\r\n\r\n", status, status_text, content_type, body.size());
+    sendAll(fd, std::string(head, static_cast<size_t>(head_size)) + body, deadline);
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& host, int port) {
+    stop();
+    if (pipe(wake_pipe) != 0) {
+        std::cerr << "Error: Could not create the wake-up pipe." << std::endl;
+        return false;
+    }
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Error: Could not create the metrics socket." << std::endl;
+        stop();
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    // A client that resets between poll() and accept() must not block the loop
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    socklen_t address_size = sizeof(address);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 ||
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, 16) != 0 ||
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size) != 0) {
+        std::cerr << "Error: Could not listen on " << host << ":" << port << std::endl;
+        stop();
+        return false;
+    }
+    bound_port = ntohs(address.sin_port);
+
+    running = true;
+    thread = std::thread(&MetricsServer::serveLoop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (wake_pipe[1] >= 0) {
+        char byte = 0;
+        [[maybe_unused]] ssize_t written = write(wake_pipe[1], &byte, 1);
+    }
+    if (thread.joinable()) thread.join();
+
+    if (listen_fd >= 0) ::close(listen_fd);
+    for (int& fd : wake_pipe) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    listen_fd = -1;
+    bound_port = 0;
+}
+
+void MetricsServer::serveLoop() {
+    enterThreadRole(ThreadRole::IO);
+    while (running) {
+        pollfd poll_fds[2] = {{listen_fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+        if (poll(poll_fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: poll() failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (poll_fds[1].revents & POLLIN) break;
+        if (!(poll_fds[0].revents & POLLIN)) continue;
+
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        // Non-blocking, every wait of the connection is bounded by its deadline
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        serveConnection(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsServer::serveConnection(int fd) {
+    Deadline deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+    std::vector<char> input(MAX_REQUEST_BYTES);
+    size_t input_size = 0;
+    HttpRequest request;
+    HttpParseStatus status = HTTP_INCOMPLETE;
+    while (status == HTTP_INCOMPLETE && input_size < input.size()) {
+        if (!waitUntil(fd, POLLIN, deadline)) return;
+        ssize_t received = recv(fd, input.data() + input_size, input.size() - input_size, 0);
+        if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        if (received <= 0) return;
+        input_size += static_cast<size_t>(received);
+        status = parseHttpRequest(input.data(), input_size, 0, request);
+    }
+
+    if (status != HTTP_COMPLETE) {
+        sendResponse(fd, deadline, 400, "Bad Request", "text/plain", "Malformed request");
+    } else if (request.method != "GET") {
+        sendResponse(fd, deadline, 405, "Method Not Allowed", "text/plain", "Only GET is supported");
+    } else if (request.target != "/metrics") {
+        sendResponse(fd, deadline, 404, "Not Found", "text/plain", "Metrics are at /metrics");
+    } else {
+        sendResponse(fd, deadline, 200, "OK", "text/plain; version=0.0.4", formatPrometheus(pipelineMetrics()));
+    }
+}
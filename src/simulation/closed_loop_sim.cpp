@@ -0,0 +1,186 @@
+#include "closed_loop_sim.hpp"
+
+#include "drone_dynamics.hpp"
+#include "video_processor.hpp"
+
+/**
+ * Lateral target offset from the tracked obstacles: close clusters near the image center
+ * push the target to the side away from them. The last decision is held for a few frames
+ * so that the drone does not oscillate when clusters flicker.
+ */
+static float avoidanceOffset(const ClosedLoopConfig& config, const FrameResult& result,
+                             float& held_offset, int& hold_frames) {
+    const float width = static_cast<float>(config.image_size.width);
+    const float center_x = 0.5f * width;
+
+    float weight_sum = 0.0f, weighted_x = 0.0f;
+    for (const auto& obstacle : result.obstacles) {
+        if (obstacle.depth_median < config.threat_depth || obstacle.point_count < config.threat_min_points) continue;
+        if (std::abs(obstacle.center.x - center_x) > 0.3f * width) continue;
+
+        auto weight = static_cast<float>(obstacle.point_count);
+        weighted_x += obstacle.center.x * weight;
+        weight_sum += weight;
+    }
+
+    if (weight_sum > 0.0f) {
+        // Obstacles left of center (image x) are avoided to the right (world +x)
+        float threat_x = weighted_x / weight_sum;
+        if (hold_frames == 0) held_offset = threat_x < center_x ? config.avoid_offset : -config.avoid_offset;
+        hold_frames = config.avoid_hold_frames;
+    } else if (hold_frames > 0) {
+        hold_frames--;
+    }
+    return hold_frames > 0 ? held_offset : 0.0f;
+}
+
+/**
+ * Range of a tracked obstacle from the rendered depth: a low percentile inside its box, so the
+ * obstacle surface wins over the background visible around the keypoints.
+ *
+ * @return Range along the optical axis [m], 0 if the box has no depth.
+ */
+static float obstacleRange(const cv::Mat& depth, const cv::Rect& bbox, std::vector<float>& samples) {
+    cv::Rect box = bbox & cv::Rect(cv::Point(0, 0), depth.size());
+    samples.clear();
+    for (int y = box.y; y < box.y + box.height; ++y) {
+        const float* row = depth.ptr<float>(y);
+        for (int x = box.x; x < box.x + box.width; ++x) {
+            if (row[x] > 0.0f) samples.push_back(row[x]);
+        }
+    }
+    if (samples.empty()) return 0.0f;
+    auto percentile = samples.begin() + samples.size() / 4;
+    std::nth_element(samples.begin(), percentile, samples.end());
+    return *percentile;
+}
+
+ClosedLoopReport runClosedLoop(const ClosedLoopConfig& config) {
+    ClosedLoopReport report;
+    Scene scene = Scene::procedural(config.seed, config.num_boxes, config.corridor_length, config.corridor_width);
+    CameraIntrinsics intrinsics = CameraIntrinsics::fromFieldOfView(config.image_size, config.fov_deg);
+
+    // The camera looks along +z; world y points up, camera y down
+    CameraPose camera_pose;
+    camera_pose.rotation = Eigen::Vector3f(1.0f, -1.0f, 1.0f).asDiagonal();
+
+    cv::Mat frame(config.image_size, CV_8UC3), depth;
+    PipelineContext context;
+    if (config.ground_truth_depth) {
+        context.depth_source = [&depth](const cv::Mat&, const cv::Rect& region) {
+            return inverseDepthColormap(depth(region));
+        };
+    }
+
+    cv::VideoWriter recorder;
+    if (!config.record_path.empty()) {
+        recorder.open(config.record_path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), config.camera_rate,
+                      config.image_size);
+        if (!recorder.isOpened()) {
+            std::cerr << "Error: Could not create output video file." << std::endl;
+        }
+    }
+
+    // The PD controller settles where kp * lookahead = (kd + drag) * speed
+    const float lookahead = config.cruise_speed * (config.kd + config.drag) / config.kp;
+    const float frame_dt = 1.0f / config.camera_rate;
+    const float goal_z = config.corridor_length;
+
+    DroneState state{{0.0f, config.altitude, 0.0f}, {0.0f, 0.0f, 0.0f}};
+    report.min_clearance = scene.distanceTo(Eigen::Vector3f(state.pos.x, state.pos.y, state.pos.z)) -
+                           config.drone_radius;
+    float held_offset = 0.0f;
+    int hold_frames = 0;
+    long long render_mcs = 0, pipeline_mcs = 0;
+
+    AvoidancePlannerConfig planner_config;
+    planner_config.thrust = config.thrust;
+    planner_config.mass = config.mass;
+    planner_config.drag = config.drag;
+    planner_config.kp = config.kp;
+    planner_config.kd = config.kd;
+    planner_config.drone_radius = config.drone_radius;
+    planner_config.cruise_speed = config.cruise_speed;
+    planner_config.budget_mcs = config.planner_budget_mcs;
+    planner_config.seed = config.seed;
+    AvoidancePlanner planner(planner_config);
+    PlannerResult plan;
+    std::vector<PlannerObstacle> planner_obstacles;
+    std::vector<float> range_samples;
+    long long planner_mcs = 0, planner_candidates = 0;
+    const Eigen::Vector3f goal(0.0f, config.altitude, goal_z);
+
+    auto start_time = get_current_time_fenced();
+    while (report.sim_time < config.max_duration) {
+        // ------ Camera ------
+        auto stage_start = get_current_time_fenced();
+        camera_pose.translation = Eigen::Vector3f(state.pos.x, state.pos.y, state.pos.z);
+        renderScene(scene, intrinsics, camera_pose, frame, &depth);
+        auto render_end = get_current_time_fenced();
+        render_mcs += to_mcs(render_end - stage_start);
+
+        // ------ Vision pipeline ------
+        FrameResult result;
+        result.frame_index = report.frames;
+        processFrame(context, frame, result);
+        pipeline_mcs += to_mcs(get_current_time_fenced() - render_end);
+        if (recorder.isOpened()) recorder.write(frame);
+
+        // ------ Target command: ahead along the corridor, shifted sideways around threats ------
+        Vector3 target;
+        if (config.use_planner) {
+            Eigen::Vector3f velocity(state.vel.x, state.vel.y, state.vel.z);
+            planner_obstacles.clear();
+            for (const auto& obstacle : result.obstacles) {
+                if (obstacle.point_count < config.threat_min_points) continue;
+                float range = obstacleRange(depth, obstacle.bbox, range_samples);
+                if (range <= 0.0f) continue;
+                planner_obstacles.push_back(obstacleFromTrack(obstacle.center, obstacle.velocity, obstacle.bbox, range,
+                                                              intrinsics, camera_pose, velocity));
+            }
+            planner.setObstacles(planner_obstacles, camera_pose.translation);
+            planner.plan(state, goal, plan);
+            target = plan.target;
+
+            planner_mcs += plan.mcs;
+            planner_candidates += plan.evaluated;
+            report.max_planner_mcs = std::max(report.max_planner_mcs, plan.mcs);
+            if (plan.budget_exhausted) report.budget_exhausted_frames++;
+            if (!plan.collision_free) report.unsafe_frames++;
+        } else {
+            float offset = avoidanceOffset(config, result, held_offset, hold_frames);
+            float center_pull = std::max(-1.0f, std::min(1.0f, -state.pos.x)) * 0.5f;   // Drift back to the corridor
+            target = Vector3{state.pos.x + (offset != 0.0f ? offset : center_pull), config.altitude,
+                             std::min(goal_z, state.pos.z + lookahead)};
+        }
+
+        // ------ Dynamics ------
+        DroneState next;
+        SimulateSubsteps(&state, &target, frame_dt, config.physics_substeps,
+                         config.thrust, config.mass, config.drag, config.kp, config.kd, &next, nullptr);
+        report.distance_flown += std::sqrt((next.pos.x - state.pos.x) * (next.pos.x - state.pos.x) +
+                                           (next.pos.y - state.pos.y) * (next.pos.y - state.pos.y) +
+                                           (next.pos.z - state.pos.z) * (next.pos.z - state.pos.z));
+        state = next;
+        report.frames++;
+        report.sim_time += frame_dt;
+
+        // ------ Ground truth ------
+        float clearance = scene.distanceTo(Eigen::Vector3f(state.pos.x, state.pos.y, state.pos.z)) - config.drone_radius;
+        report.min_clearance = std::min(report.min_clearance, clearance);
+        if (clearance < 0.0f) report.collision_frames++;
+
+        if (state.pos.z >= goal_z - 1.0f) {
+            report.reached_goal = true;
+            break;
+        }
+    }
+
+    report.wall_mcs = to_mcs(get_current_time_fenced() - start_time);
+    report.real_time_factor = report.sim_time / (static_cast<float>(std::max(1LL, report.wall_mcs)) / 1e6f);
+    report.mean_render_ms = report.frames > 0 ? render_mcs / 1000.0 / report.frames : 0.0;
+    report.mean_pipeline_ms = report.frames > 0 ? pipeline_mcs / 1000.0 / report.frames : 0.0;
+    report.mean_planner_mcs = report.frames > 0 ? static_cast<double>(planner_mcs) / report.frames : 0.0;
+    report.mean_candidates = report.frames > 0 ? static_cast<double>(planner_candidates) / report.frames : 0.0;
+    return report;
+}
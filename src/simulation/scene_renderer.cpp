@@ -0,0 +1,139 @@
+#include "scene_renderer.hpp"
+#include "depth_estimation.hpp"
+
+#include <random>
+
+// Directional light used for Lambert shading
+static const Eigen::Vector3f LIGHT_DIRECTION = Eigen::Vector3f(0.4f, 1.0f, -0.3f).normalized();
+
+Scene Scene::procedural(unsigned seed, int num_boxes, float length, float width) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> x_position(-0.5f * width, 0.5f * width);
+    std::uniform_real_distribution<float> z_position(8.0f, std::max(8.0f, length - 5.0f));
+    std::uniform_real_distribution<float> footprint(1.0f, 3.0f);
+    std::uniform_real_distribution<float> height(2.0f, 8.0f);
+    std::uniform_int_distribution<int> channel(40, 220);
+
+    Scene scene;
+    scene.planes.push_back({{0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {90, 110, 90}, {60, 75, 60}, 1.0f});
+    scene.planes.push_back({{0.0f, 0.0f, length + 10.0f}, {0.0f, 0.0f, -1.0f}, {150, 150, 150}, {90, 90, 90}, 2.0f});
+
+    for (int i = 0; i < num_boxes; ++i) {
+        float x = x_position(generator), z = z_position(generator);
+        float half_x = 0.5f * footprint(generator), half_z = 0.5f * footprint(generator);
+        cv::Vec3b color(static_cast<uchar>(channel(generator)), static_cast<uchar>(channel(generator)),
+                        static_cast<uchar>(channel(generator)));
+        scene.boxes.push_back({{x - half_x, 0.0f, z - half_z}, {x + half_x, height(generator), z + half_z}, color});
+    }
+    return scene;
+}
+
+float Scene::distanceTo(const Eigen::Vector3f& point) const {
+    float distance = std::numeric_limits<float>::max();
+    for (const auto& plane : planes) {
+        distance = std::min(distance, (point - plane.point).dot(plane.normal));
+    }
+    for (const auto& box : boxes) {
+        Eigen::Vector3f outside = (box.min - point).cwiseMax(point - box.max);
+        float box_distance = outside.maxCoeff() > 0.0f ? outside.cwiseMax(0.0f).norm() : outside.maxCoeff();
+        distance = std::min(distance, box_distance);
+    }
+    return distance;
+}
+
+// Two-colour 3D checker; `point` must lie slightly inside the surface to avoid flicker on cell borders
+static bool checkerParity(const Eigen::Vector3f& point, float size) {
+    int cells = static_cast<int>(std::floor(point.x() / size)) + static_cast<int>(std::floor(point.y() / size)) +
+                static_cast<int>(std::floor(point.z() / size));
+    return (cells & 1) != 0;
+}
+
+static cv::Vec3b shade(const cv::Vec3b& color, const Eigen::Vector3f& normal) {
+    float intensity = 0.35f + 0.65f * std::max(0.0f, normal.dot(LIGHT_DIRECTION));
+    return {cv::saturate_cast<uchar>(color[0] * intensity), cv::saturate_cast<uchar>(color[1] * intensity),
+            cv::saturate_cast<uchar>(color[2] * intensity)};
+}
+
+void renderScene(const Scene& scene, const CameraIntrinsics& intrinsics, const CameraPose& pose,
+                 cv::Mat& image, cv::Mat* depth) {
+    if (image.empty() || image.type() != CV_8UC3) {
+        std::cerr << "Error: The render target must be an allocated CV_8UC3 image." << std::endl;
+        return;
+    }
+    if (depth) depth->create(image.size(), CV_32F);
+
+    const Eigen::Vector3f origin = pose.translation;
+
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        for (int v = range.start; v < range.end; ++v) {
+            auto* image_row = image.ptr<cv::Vec3b>(v);
+            float* depth_row = depth ? depth->ptr<float>(v) : nullptr;
+
+            for (int u = 0; u < image.cols; ++u) {
+                // Camera ray with unit z: the hit parameter t is the depth along the optical axis
+                Eigen::Vector3f direction = pose.rotation * Eigen::Vector3f(
+                        (static_cast<float>(u) + 0.5f - intrinsics.cx) / intrinsics.fx,
+                        (static_cast<float>(v) + 0.5f - intrinsics.cy) / intrinsics.fy, 1.0f);
+                Eigen::Vector3f inverse_direction = direction.cwiseInverse();
+
+                float nearest = std::numeric_limits<float>::max();
+                Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+                cv::Vec3b color_a = scene.sky, color_b = scene.sky;
+                float checker_size = 1.0f;
+
+                for (const auto& plane : scene.planes) {
+                    float denominator = direction.dot(plane.normal);
+                    if (denominator >= 0.0f) continue;   // Back side or parallel
+                    float t = (plane.point - origin).dot(plane.normal) / denominator;
+                    if (t > 0.0f && t < nearest) {
+                        nearest = t;
+                        normal = plane.normal;
+                        color_a = plane.color_a;
+                        color_b = plane.color_b;
+                        checker_size = plane.checker_size;
+                    }
+                }
+
+                // Slab test, the entry slab gives the face normal
+                for (const auto& box : scene.boxes) {
+                    Eigen::Vector3f t0 = (box.min - origin).cwiseProduct(inverse_direction);
+                    Eigen::Vector3f t1 = (box.max - origin).cwiseProduct(inverse_direction);
+                    Eigen::Vector3f t_near = t0.cwiseMin(t1), t_far = t0.cwiseMax(t1);
+
+                    int axis;
+                    float t_enter = t_near.maxCoeff(&axis);
+                    float t_exit = t_far.minCoeff();
+                    if (t_enter > t_exit || t_enter <= 0.0f || t_enter >= nearest) continue;
+
+                    nearest = t_enter;
+                    normal = Eigen::Vector3f::Zero();
+                    normal[axis] = direction[axis] > 0.0f ? -1.0f : 1.0f;
+                    color_a = box.color;
+                    color_b = cv::Vec3b(static_cast<uchar>(box.color[0] * 0.6f), static_cast<uchar>(box.color[1] * 0.6f),
+                                        static_cast<uchar>(box.color[2] * 0.6f));
+                    checker_size = 0.5f;
+                }
+
+                if (nearest == std::numeric_limits<float>::max()) {
+                    image_row[u] = scene.sky;
+                    if (depth_row) depth_row[u] = 0.0f;
+                    continue;
+                }
+
+                Eigen::Vector3f hit = origin + direction * nearest - normal * (0.01f * checker_size);
+                image_row[u] = shade(checkerParity(hit, checker_size) ? color_a : color_b, normal);
+                if (depth_row) depth_row[u] = nearest;
+            }
+        }
+    });
+}
+
+cv::Mat inverseDepthColormap(const cv::Mat& depth) {
+    cv::Mat inverse = cv::Mat::zeros(depth.size(), CV_32F);
+    cv::Mat valid = depth > 0.0f;
+    cv::divide(1.0f, depth, inverse);
+    inverse.setTo(0.0f, ~valid);
+
+    // Same post-processing as depth_estimation()
+    return colorizeDepth(inverse, depth.size());
+}
@@ -0,0 +1,140 @@
+#include "camera_model.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+// Calibration shared by all pipelines; every pipeline owns its own table
+static std::mutex calibration_mutex;
+static CameraCalibration camera_calibration;
+static std::atomic<int> calibration_generation{0};
+
+bool loadCameraCalibration(const std::string& path, CameraCalibration& calibration) {
+    cv::FileStorage storage;
+    try {
+        storage.open(path, cv::FileStorage::READ);
+    } catch (const cv::Exception&) {
+    }
+    if (!storage.isOpened()) {
+        std::cerr << "Error: Could not open calibration file " << path << "." << std::endl;
+        return false;
+    }
+
+    cv::Mat camera_matrix, distortion;
+    int width = 0, height = 0;
+    storage["camera_matrix"] >> camera_matrix;
+    storage["distortion_coefficients"] >> distortion;
+    storage["image_width"] >> width;
+    storage["image_height"] >> height;
+
+    size_t coefficients = distortion.total();
+    if (camera_matrix.rows != 3 || camera_matrix.cols != 3 || width <= 0 || height <= 0 ||
+        (coefficients != 4 && coefficients != 5 && coefficients != 8)) {
+        std::cerr << "Error: " << path << " needs camera_matrix (3x3), distortion_coefficients (4, 5 or 8), "
+                  << "image_width and image_height." << std::endl;
+        return false;
+    }
+
+    camera_matrix.convertTo(camera_matrix, CV_64F);
+    distortion.convertTo(distortion, CV_64F);
+    calibration.camera_matrix = cv::Matx33d(camera_matrix.ptr<double>());
+    calibration.distortion.assign(distortion.ptr<double>(), distortion.ptr<double>() + coefficients);
+    calibration.image_size = cv::Size(width, height);
+    return true;
+}
+
+void setCameraCalibration(const CameraCalibration& calibration) {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    camera_calibration = calibration;
+    calibration_generation++;
+}
+
+CameraCalibration getCameraCalibration() {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    return camera_calibration;
+}
+
+CameraModel::CameraModel(int lut_step) : step(std::max(1, lut_step)) {
+}
+
+void CameraModel::update(const cv::Size& size) {
+    int current = calibration_generation;
+    if (current == generation && size == frame_size) return;
+    configure(getCameraCalibration(), size);
+    generation = current;
+}
+
+void CameraModel::configure(const CameraCalibration& new_calibration, const cv::Size& size) {
+    bool unchanged = size == frame_size && new_calibration.distortion == calibration.distortion &&
+                     new_calibration.camera_matrix == calibration.camera_matrix &&
+                     new_calibration.image_size == calibration.image_size;
+    calibration = new_calibration;
+    frame_size = size;
+    if (unchanged) return;
+
+    lut.release();
+    if (calibration.empty() || size.empty()) return;
+
+    // Frames at another resolution than the calibration see the same lens through scaled intrinsics
+    camera_matrix = calibration.camera_matrix;
+    if (!calibration.image_size.empty()) {
+        double scale_x = static_cast<double>(size.width) / calibration.image_size.width;
+        double scale_y = static_cast<double>(size.height) / calibration.image_size.height;
+        for (int col = 0; col < 3; ++col) {
+            camera_matrix(0, col) *= scale_x;
+            camera_matrix(1, col) *= scale_y;
+        }
+    }
+
+    // Nodes every step pixels, the last row and column at or beyond the frame border
+    int cols = std::max(2, (size.width - 2) / step + 2);
+    int rows = std::max(2, (size.height - 2) / step + 2);
+    std::vector<cv::Point2f> grid;
+    grid.reserve(static_cast<size_t>(cols) * rows);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            grid.emplace_back(static_cast<float>(x * step), static_cast<float>(y * step));
+        }
+    }
+
+    // Wide-angle lenses need more iterations than the default five
+    std::vector<cv::Point2f> undistorted;
+    cv::undistortPoints(grid, undistorted, camera_matrix, calibration.distortion, cv::noArray(), camera_matrix,
+                        cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 20, 1e-6));
+    cv::Mat(undistorted).reshape(2, rows).copyTo(lut);
+}
+
+cv::Point2f CameraModel::undistort(const cv::Point2f& point) const {
+    if (lut.empty()) return point;
+
+    float grid_x = std::clamp(point.x, 0.0f, static_cast<float>(frame_size.width - 1)) / static_cast<float>(step);
+    float grid_y = std::clamp(point.y, 0.0f, static_cast<float>(frame_size.height - 1)) / static_cast<float>(step);
+    int x0 = std::min(static_cast<int>(grid_x), lut.cols - 2);
+    int y0 = std::min(static_cast<int>(grid_y), lut.rows - 2);
+    float ax = grid_x - static_cast<float>(x0);
+    float ay = grid_y - static_cast<float>(y0);
+
+    const cv::Vec2f* row0 = lut.ptr<cv::Vec2f>(y0);
+    const cv::Vec2f* row1 = lut.ptr<cv::Vec2f>(y0 + 1);
+    cv::Vec2f top = row0[x0] * (1.0f - ax) + row0[x0 + 1] * ax;
+    cv::Vec2f bottom = row1[x0] * (1.0f - ax) + row1[x0 + 1] * ax;
+    cv::Vec2f mapped = top * (1.0f - ay) + bottom * ay;
+    return {mapped[0], mapped[1]};
+}
+
+cv::Point2f CameraModel::distort(const cv::Point2f& point) const {
+    if (lut.empty()) return point;
+
+    const cv::Matx33d& K = camera_matrix;
+    const std::vector<double>& d = calibration.distortion;
+    double k3 = d.size() > 4 ? d[4] : 0.0;
+    double k4 = d.size() > 7 ? d[5] : 0.0, k5 = d.size() > 7 ? d[6] : 0.0, k6 = d.size() > 7 ? d[7] : 0.0;
+
+    double y = (point.y - K(1, 2)) / K(1, 1);
+    double x = (point.x - K(0, 2) - K(0, 1) * y) / K(0, 0);
+    double r2 = x * x + y * y, r4 = r2 * r2, r6 = r4 * r2;
+    double radial = (1.0 + d[0] * r2 + d[1] * r4 + k3 * r6) / (1.0 + k4 * r2 + k5 * r4 + k6 * r6);
+    double xd = x * radial + 2.0 * d[2] * x * y + d[3] * (r2 + 2.0 * x * x);
+    double yd = y * radial + d[2] * (r2 + 2.0 * y * y) + 2.0 * d[3] * x * y;
+    return {static_cast<float>(K(0, 0) * xd + K(0, 1) * yd + K(0, 2)), static_cast<float>(K(1, 1) * yd + K(1, 2))};
+}
@@ -0,0 +1,54 @@
+#include "frame_pyramid.hpp"
+
+FramePyramid::FramePyramid(int levels, cv::Size window) : max_level(levels), flow_window(window) {}
+
+void FramePyramid::update(const cv::Mat& frame) {
+    color = frame;
+    if (gray_buffer.size() != frame.size()) gray_buffer.create(frame.size(), CV_8UC1);
+    gray_regions.clear();
+    pyramid_valid = false;
+    for (auto& view : resized_views) view.valid = false;
+    frame_count++;
+}
+
+cv::Mat FramePyramid::gray(const cv::Rect& region) {
+    for (const auto& converted : gray_regions) {
+        if ((converted & region) == region) return gray_buffer(region);
+    }
+
+    // Only the requested region is converted, small ROIs do not pay for the whole frame
+    cv::Mat view = gray_buffer(region);
+    cv::cvtColor(color(region), view, cv::COLOR_BGR2GRAY);
+    gray_regions.push_back(region);
+    computed++;
+    return view;
+}
+
+const std::vector<cv::Mat>& FramePyramid::grayPyramid() {
+    if (!pyramid_valid) {
+        // Reuses the level buffers when the frame size is unchanged
+        cv::buildOpticalFlowPyramid(gray(), pyramid, flow_window, max_level, false);
+        pyramid_valid = true;
+        computed++;
+    }
+    return pyramid;
+}
+
+const cv::Mat& FramePyramid::resized(const cv::Rect& region, const cv::Size& size) {
+    ResizedView* free_view = nullptr;
+    for (auto& view : resized_views) {
+        if (view.valid && view.region == region && view.size == size) return view.image;
+        if (!view.valid && !free_view) free_view = &view;
+    }
+    if (!free_view) {
+        resized_views.emplace_back();
+        free_view = &resized_views.back();
+    }
+
+    free_view->region = region;
+    free_view->size = size;
+    cv::resize(color(region), free_view->image, size, 0, 0, cv::INTER_LINEAR);
+    free_view->valid = true;
+    computed++;
+    return free_view->image;
+}
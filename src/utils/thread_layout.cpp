@@ -0,0 +1,203 @@
+#include "thread_layout.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <opencv2/core.hpp>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Role index of threads that never entered a role
+static const int NO_ROLE = -1;
+
+static std::mutex layout_mutex;
+static ThreadLayout thread_layout;
+static std::atomic<int> layout_generation{0};
+
+// Captured at startup, before any thread is pinned
+static std::vector<int> startupCores() {
+    std::vector<int> cores;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int core = 0; core < CPU_SETSIZE; ++core) {
+            if (CPU_ISSET(core, &set)) cores.push_back(core);
+        }
+    }
+#endif
+    if (cores.empty()) {
+        for (int core = 0; core < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++core) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+static const std::vector<int> process_cores = startupCores();
+
+const std::vector<int>& processCores() {
+    return process_cores;
+}
+
+const std::vector<int>& ThreadLayout::cores(ThreadRole role) const {
+    switch (role) {
+        case ThreadRole::DEPTH: return depth;
+        case ThreadRole::PIPELINE: return pipeline;
+        default: return io;
+    }
+}
+
+bool parseCoreList(const std::string& text, std::vector<int>& cores) {
+    cores.clear();
+    std::istringstream items(text);
+    std::string item;
+    try {
+        while (std::getline(items, item, ',')) {
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first || last >= 1024) return false;
+            for (int core = first; core <= last; ++core) cores.push_back(core);
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    std::sort(cores.begin(), cores.end());
+    cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+    return !cores.empty();
+}
+
+std::string formatCoreList(const std::vector<int>& cores) {
+    std::ostringstream text;
+    for (size_t i = 0; i < cores.size();) {
+        size_t end = i;
+        while (end + 1 < cores.size() && cores[end + 1] == cores[end] + 1) end++;
+        if (i > 0) text << ',';
+        text << cores[i];
+        if (end > i) text << '-' << cores[end];
+        i = end + 1;
+    }
+    return text.str();
+}
+
+bool parseThreadLayout(const std::string& text, ThreadLayout& layout) {
+    layout = ThreadLayout();
+    if (text.empty() || text == "auto") return true;
+
+    std::istringstream roles(text);
+    std::string role;
+    while (std::getline(roles, role, ';')) {
+        size_t equals = role.find('=');
+        if (equals == std::string::npos) return false;
+        std::string name = role.substr(0, equals);
+        std::vector<int>* cores = name == "depth" ? &layout.depth
+                                : name == "pipeline" ? &layout.pipeline
+                                : name == "io" ? &layout.io : nullptr;
+        if (!cores || !parseCoreList(role.substr(equals + 1), *cores)) return false;
+    }
+    return true;
+}
+
+std::string formatThreadLayout(const ThreadLayout& layout) {
+    if (layout.empty()) return "auto";
+    std::string text;
+    auto append = [&](const char* name, const std::vector<int>& cores) {
+        if (cores.empty()) return;
+        if (!text.empty()) text += ';';
+        text += std::string(name) + "=" + formatCoreList(cores);
+    };
+    append("depth", layout.depth);
+    append("pipeline", layout.pipeline);
+    append("io", layout.io);
+    return text;
+}
+
+bool pinCurrentThread(const std::vector<int>& cores) {
+    const std::vector<int>& target = cores.empty() ? process_cores : cores;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : target) {
+        if (core < CPU_SETSIZE) CPU_SET(core, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return target == process_cores;
+#endif
+}
+
+// Per-thread copy of the layout and the cores the thread is pinned to
+struct ThreadAffinityState {
+    int generation = -1;
+    ThreadLayout layout;
+    int role = NO_ROLE;
+    std::vector<int> pinned;   // Empty = all process cores
+};
+
+static thread_local ThreadAffinityState affinity_state;
+
+// Move the calling thread to the cores of a role, or to all cores for NO_ROLE
+static void moveToRole(int role) {
+    ThreadAffinityState& state = affinity_state;
+    int generation = layout_generation;
+    if (state.generation != generation) {
+        state.layout = getThreadLayout();
+        state.generation = generation;
+    }
+
+    state.role = role;
+    static const std::vector<int> all_cores;
+    const std::vector<int>& cores = role == NO_ROLE ? all_cores : state.layout.cores(static_cast<ThreadRole>(role));
+    if (cores == state.pinned) return;
+    if (!pinCurrentThread(cores)) {
+        static std::once_flag warning;
+        std::call_once(warning, [&] {
+            std::cerr << "Error: Could not pin a thread to cores " << formatCoreList(cores) << "." << std::endl;
+        });
+        return;
+    }
+    state.pinned = cores;
+}
+
+void setThreadLayout(const ThreadLayout& layout) {
+    std::vector<int> previous_depth;
+    {
+        std::lock_guard<std::mutex> lock(layout_mutex);
+        previous_depth = thread_layout.depth;
+        thread_layout = layout;
+        layout_generation++;
+    }
+    if (layout.depth == previous_depth) return;
+
+    // Restart OpenCV's pool from a thread on the depth cores (all cores if unset), the workers
+    // inherit them. Going through one thread makes the pool stop its old workers.
+    cv::setNumThreads(1);
+    cv::setNumThreads(layout.depth.empty() ? -1 : static_cast<int>(layout.depth.size()));
+    ThreadRoleScope depth_scope(ThreadRole::DEPTH);
+    int threads = cv::getNumThreads();
+    // An empty job is enough to start the workers from here
+    cv::parallel_for_(cv::Range(0, threads), [](const cv::Range&) {}, threads);
+}
+
+ThreadLayout getThreadLayout() {
+    std::lock_guard<std::mutex> lock(layout_mutex);
+    return thread_layout;
+}
+
+void enterThreadRole(ThreadRole role) {
+    moveToRole(static_cast<int>(role));
+}
+
+ThreadRoleScope::ThreadRoleScope(ThreadRole role) : previous_role(affinity_state.role) {
+    moveToRole(static_cast<int>(role));
+}
+
+ThreadRoleScope::~ThreadRoleScope() {
+    moveToRole(previous_role);
+}
@@ -0,0 +1,275 @@
+#include "ego_motion.hpp"
+#include <opencv2/core/hal/hal.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// RANSAC hypotheses per parallel batch; batches are seeded by their index
+static constexpr int HYPOTHESES_PER_BATCH = 32;
+static constexpr uint64 RANSAC_SEED = 0x2545F491;
+
+// Twice the smallest triangle area [px^2] of a usable minimal sample
+static constexpr double MIN_SAMPLE_AREA = 1.0;
+
+cv::Point2f EgoMotion::apply(const cv::Point2f& point) const {
+    const cv::Matx33f& m = transform;
+    float w = m(2, 0) * point.x + m(2, 1) * point.y + m(2, 2);
+    return {(m(0, 0) * point.x + m(0, 1) * point.y + m(0, 2)) / w,
+            (m(1, 0) * point.x + m(1, 1) * point.y + m(1, 2)) / w};
+}
+
+cv::Matx22f EgoMotion::jacobian(const cv::Point2f& point) const {
+    const cv::Matx33f& m = transform;
+    float w = m(2, 0) * point.x + m(2, 1) * point.y + m(2, 2);
+    cv::Point2f mapped = apply(point);
+    return {(m(0, 0) - mapped.x * m(2, 0)) / w, (m(0, 1) - mapped.x * m(2, 1)) / w,
+            (m(1, 0) - mapped.y * m(2, 0)) / w, (m(1, 1) - mapped.y * m(2, 1)) / w};
+}
+
+void EgoMotionEstimator::reset() {
+    reference_points.clear();
+    reference_descriptors.release();
+    cell_offsets.clear();
+    cell_points.clear();
+}
+
+void EgoMotionEstimator::buildGrid(float cell_size) {
+    grid_cell = cell_size;
+    cv::Point2f low(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    cv::Point2f high(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+    for (const auto& point : reference_points) {
+        low = cv::Point2f(std::min(low.x, point.x), std::min(low.y, point.y));
+        high = cv::Point2f(std::max(high.x, point.x), std::max(high.y, point.y));
+    }
+    grid_origin = low;
+    grid_size = cv::Size(static_cast<int>((high.x - low.x) / cell_size) + 1,
+                         static_cast<int>((high.y - low.y) / cell_size) + 1);
+
+    // Counting sort of the reference points by cell
+    auto cellOf = [&](const cv::Point2f& point) {
+        return static_cast<int>((point.y - low.y) / cell_size) * grid_size.width +
+               static_cast<int>((point.x - low.x) / cell_size);
+    };
+    cell_offsets.assign(static_cast<size_t>(grid_size.area()) + 1, 0);
+    for (const auto& point : reference_points) cell_offsets[cellOf(point) + 1]++;
+    for (size_t c = 1; c < cell_offsets.size(); ++c) cell_offsets[c] += cell_offsets[c - 1];
+
+    cell_points.resize(reference_points.size());
+    std::vector<int> fill(cell_offsets.begin(), cell_offsets.end() - 1);
+    for (size_t i = 0; i < reference_points.size(); ++i) {
+        cell_points[fill[cellOf(reference_points[i])]++] = static_cast<int>(i);
+    }
+}
+
+void EgoMotionEstimator::match(const std::vector<cv::Point2f>& points, const cv::Mat& descriptors,
+                               const EgoMotionSettings& settings) {
+    const float radius_sq = settings.search_radius * settings.search_radius;
+    const int bytes = descriptors.cols;
+    matched.assign(points.size(), -1);
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(points.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const cv::Point2f& point = points[i];
+            const uchar* descriptor = descriptors.ptr<uchar>(i);
+            int cell_x = cvFloor((point.x - grid_origin.x) / grid_cell);
+            int cell_y = cvFloor((point.y - grid_origin.y) / grid_cell);
+
+            // The search radius is the cell size: the 3x3 neighbourhood covers it
+            int best = -1;
+            int best_distance = std::numeric_limits<int>::max(), second_distance = std::numeric_limits<int>::max();
+            for (int y = std::max(0, cell_y - 1); y <= std::min(grid_size.height - 1, cell_y + 1); ++y) {
+                for (int x = std::max(0, cell_x - 1); x <= std::min(grid_size.width - 1, cell_x + 1); ++x) {
+                    int cell = y * grid_size.width + x;
+                    for (int c = cell_offsets[cell]; c < cell_offsets[cell + 1]; ++c) {
+                        int j = cell_points[c];
+                        cv::Point2f offset = reference_points[j] - point;
+                        if (offset.dot(offset) > radius_sq) continue;
+
+                        int distance = cv::hal::normHamming(descriptor, reference_descriptors.ptr<uchar>(j), bytes);
+                        if (distance < best_distance) {
+                            second_distance = best_distance;
+                            best_distance = distance;
+                            best = j;
+                        } else if (distance < second_distance) {
+                            second_distance = distance;
+                        }
+                    }
+                }
+            }
+
+            bool distinct = second_distance == std::numeric_limits<int>::max() ||
+                            static_cast<float>(best_distance) < settings.ratio * static_cast<float>(second_distance);
+            if (best >= 0 && best_distance <= settings.max_distance && distinct) matched[i] = best;
+        }
+    });
+
+    from.clear();
+    to.clear();
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (matched[i] < 0) continue;
+        from.push_back(reference_points[matched[i]]);
+        to.push_back(points[i]);
+    }
+}
+
+static double cross(const cv::Point2f& a, const cv::Point2f& b, const cv::Point2f& c) {
+    return static_cast<double>(b.x - a.x) * (c.y - a.y) - static_cast<double>(b.y - a.y) * (c.x - a.x);
+}
+
+// Model through a minimal sample; false for degenerate (near collinear) samples
+static bool fitMinimal(EgoMotionModel model, const cv::Point2f* from, const cv::Point2f* to, cv::Matx33d& fitted) {
+    if (model == EgoMotionModel::AFFINE) {
+        if (std::abs(cross(from[0], from[1], from[2])) < MIN_SAMPLE_AREA) return false;
+        cv::Matx33d rows;
+        cv::Matx<double, 3, 2> targets;
+        for (int k = 0; k < 3; ++k) {
+            rows(k, 0) = from[k].x;
+            rows(k, 1) = from[k].y;
+            rows(k, 2) = 1.0;
+            targets(k, 0) = to[k].x;
+            targets(k, 1) = to[k].y;
+        }
+        cv::Matx<double, 3, 2> params = rows.solve(targets, cv::DECOMP_LU);
+        fitted = cv::Matx33d(params(0, 0), params(1, 0), params(2, 0),
+                             params(0, 1), params(1, 1), params(2, 1),
+                             0.0, 0.0, 1.0);
+        return true;
+    }
+
+    for (int k = 0; k < 4; ++k) {
+        if (std::abs(cross(from[k], from[(k + 1) % 4], from[(k + 2) % 4])) < MIN_SAMPLE_AREA ||
+            std::abs(cross(to[k], to[(k + 1) % 4], to[(k + 2) % 4])) < MIN_SAMPLE_AREA) return false;
+    }
+    cv::Mat homography = cv::getPerspectiveTransform(from, to);
+    if (homography.empty()) return false;
+    fitted = cv::Matx33d(homography.ptr<double>());
+    return std::abs(cv::determinant(fitted)) > 1e-12;
+}
+
+// Matches within the threshold of a model; fills `inliers` when given
+static int countInliers(const cv::Matx33d& model, const std::vector<cv::Point2f>& from,
+                        const std::vector<cv::Point2f>& to, double threshold_sq, std::vector<int>* inliers = nullptr) {
+    if (inliers) inliers->clear();
+    int count = 0;
+    for (size_t i = 0; i < from.size(); ++i) {
+        double x = from[i].x, y = from[i].y;
+        double w = model(2, 0) * x + model(2, 1) * y + model(2, 2);
+        if (w <= 1e-9) continue;
+        double dx = (model(0, 0) * x + model(0, 1) * y + model(0, 2)) / w - to[i].x;
+        double dy = (model(1, 0) * x + model(1, 1) * y + model(1, 2)) / w - to[i].y;
+        if (dx * dx + dy * dy > threshold_sq) continue;
+        count++;
+        if (inliers) inliers->push_back(static_cast<int>(i));
+    }
+    return count;
+}
+
+// Least-squares model through the inliers of a hypothesis
+static bool refine(EgoMotionModel model, const std::vector<cv::Point2f>& from, const std::vector<cv::Point2f>& to,
+                   const std::vector<int>& inliers, cv::Matx33d& refined) {
+    if (model == EgoMotionModel::AFFINE) {
+        // Normal equations shared by both rows of the affine matrix
+        cv::Matx33d normal = cv::Matx33d::zeros();
+        cv::Matx<double, 3, 2> targets = cv::Matx<double, 3, 2>::zeros();
+        for (int i : inliers) {
+            cv::Vec3d row(from[i].x, from[i].y, 1.0);
+            normal += row * row.t();
+            for (int k = 0; k < 3; ++k) {
+                targets(k, 0) += row[k] * to[i].x;
+                targets(k, 1) += row[k] * to[i].y;
+            }
+        }
+        cv::Matx<double, 3, 2> params;
+        if (!cv::solve(normal, targets, params, cv::DECOMP_CHOLESKY)) return false;
+        refined = cv::Matx33d(params(0, 0), params(1, 0), params(2, 0),
+                              params(0, 1), params(1, 1), params(2, 1),
+                              0.0, 0.0, 1.0);
+        return true;
+    }
+
+    std::vector<cv::Point2f> inlier_from, inlier_to;
+    inlier_from.reserve(inliers.size());
+    inlier_to.reserve(inliers.size());
+    for (int i : inliers) {
+        inlier_from.push_back(from[i]);
+        inlier_to.push_back(to[i]);
+    }
+    cv::Mat homography = cv::findHomography(inlier_from, inlier_to, 0);
+    if (homography.empty()) return false;
+    refined = cv::Matx33d(homography.ptr<double>());
+    return true;
+}
+
+void EgoMotionEstimator::update(const std::vector<cv::Point2f>& points, const cv::Mat& descriptors,
+                                const EgoMotionSettings& settings, EgoMotion& motion) {
+    motion = EgoMotion();
+    const int sample_size = settings.model == EgoMotionModel::AFFINE ? 3 : 4;
+    const int min_inliers = std::max(sample_size + 1, settings.min_inliers);
+
+    bool comparable = !reference_points.empty() && !points.empty() &&
+                      descriptors.rows == static_cast<int>(points.size()) && descriptors.type() == CV_8U &&
+                      descriptors.cols == reference_descriptors.cols;
+    if (comparable) {
+        match(points, descriptors, settings);
+        motion.matches = static_cast<int>(from.size());
+    }
+
+    if (motion.matches >= min_inliers) {
+        // Every batch keeps its best hypothesis; the reduction prefers earlier batches on ties
+        const int batches = (std::max(1, settings.ransac_iterations) + HYPOTHESES_PER_BATCH - 1) / HYPOTHESES_PER_BATCH;
+        const double threshold_sq = static_cast<double>(settings.ransac_threshold) * settings.ransac_threshold;
+        std::vector<cv::Matx33d> batch_models(batches, cv::Matx33d::eye());
+        std::vector<int> batch_inliers(batches, 0);
+
+        cv::parallel_for_(cv::Range(0, batches), [&](const cv::Range& range) {
+            cv::Point2f sample_from[4], sample_to[4];
+            for (int b = range.start; b < range.end; ++b) {
+                cv::RNG rng(RANSAC_SEED + static_cast<uint64>(b));
+                for (int h = 0; h < HYPOTHESES_PER_BATCH; ++h) {
+                    int sample[4];
+                    for (int k = 0; k < sample_size; ++k) {
+                        do {
+                            sample[k] = rng.uniform(0, motion.matches);
+                        } while (std::find(sample, sample + k, sample[k]) != sample + k);
+                        sample_from[k] = from[sample[k]];
+                        sample_to[k] = to[sample[k]];
+                    }
+
+                    cv::Matx33d hypothesis;
+                    if (!fitMinimal(settings.model, sample_from, sample_to, hypothesis)) continue;
+                    int count = countInliers(hypothesis, from, to, threshold_sq);
+                    if (count > batch_inliers[b]) {
+                        batch_inliers[b] = count;
+                        batch_models[b] = hypothesis;
+                    }
+                }
+            }
+        });
+
+        int best = static_cast<int>(std::max_element(batch_inliers.begin(), batch_inliers.end()) -
+                                    batch_inliers.begin());
+        cv::Matx33d model = batch_models[best];
+        std::vector<int> inliers;
+        int count = countInliers(model, from, to, threshold_sq, &inliers);
+
+        cv::Matx33d refined;
+        if (count >= min_inliers && refine(settings.model, from, to, inliers, refined)) {
+            int refined_count = countInliers(refined, from, to, threshold_sq);
+            if (refined_count >= count) {
+                model = refined;
+                count = refined_count;
+            }
+        }
+
+        if (count >= min_inliers) {
+            motion.valid = true;
+            motion.transform = model * (1.0 / model(2, 2));
+            motion.inliers = count;
+        }
+    }
+
+    // The current features are the next reference
+    reference_points = points;
+    descriptors.copyTo(reference_descriptors);
+    if (!reference_points.empty()) buildGrid(std::max(1.0f, settings.search_radius));
+}
@@ -0,0 +1,149 @@
+#include "frame_scheduler.hpp"
+#include <algorithm>
+
+// Scheduler tuning
+static constexpr double EMA_ALPHA = 0.2;            // Smoothing of the stage timings
+static constexpr double SPIKE_FACTOR = 1.5;         // A single frame this far over budget degrades at once
+static constexpr double HEADROOM_FACTOR = 0.7;      // Restore only when below 70% of the budget...
+static constexpr int HEADROOM_FRAMES = 30;          // ...for this many consecutive frames
+static constexpr int COOLDOWN_FRAMES = 5;           // Let a decision take effect before the next one
+
+// Quality limits
+static constexpr int FAST_THRESHOLD_STEP = 10;
+static constexpr int FAST_THRESHOLD_MAX = 60;
+static constexpr int KEYPOINT_BUDGET_START = 2000;
+static constexpr int KEYPOINT_BUDGET_MIN = 250;
+static constexpr int DEPTH_REFRESH_INTERVAL_MAX = 4;
+
+
+const char* stageName(PipelineStage stage) {
+    switch (stage) {
+        case STAGE_DEPTH: return "depth";
+        case STAGE_FEATURES: return "features";
+        case STAGE_CLUSTERING: return "clustering";
+        case STAGE_TRACKING: return "tracking";
+        case STAGE_DISPLAY: return "display";
+        default: return "unknown";
+    }
+}
+
+long long StageTimings::total() const {
+    long long sum = 0;
+    for (long long stage_mcs : mcs) sum += stage_mcs;
+    return sum;
+}
+
+FrameScheduler::FrameScheduler(double target_period_ms, std::ostream& log)
+        : target_mcs(target_period_ms * 1000.0), log(log) {}
+
+void FrameScheduler::update(int frame_index, const StageTimings& timings, QualitySettings& quality) {
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        stage_ema[s] += EMA_ALPHA * (static_cast<double>(timings.mcs[s]) - stage_ema[s]);
+    }
+    auto frame_mcs = static_cast<double>(timings.total());
+    frame_ema += EMA_ALPHA * (frame_mcs - frame_ema);
+
+    if (cooldown > 0) {
+        --cooldown;
+        return;
+    }
+
+    bool spike = frame_mcs > SPIKE_FACTOR * target_mcs;
+    if (spike || frame_ema > target_mcs) {
+        headroom_frames = 0;
+
+        // Degrade the knob of the most expensive stage first
+        PipelineStage stages[] = {STAGE_DEPTH, STAGE_FEATURES, STAGE_CLUSTERING, STAGE_DISPLAY};
+        std::sort(std::begin(stages), std::end(stages),
+                  [&](PipelineStage a, PipelineStage b) { return stage_ema[a] > stage_ema[b]; });
+
+        for (PipelineStage stage : stages) {
+            Decision decision{};
+            if (degrade(stage, quality, decision)) {
+                decisions.push_back(decision);
+                logDecision(frame_index, spike ? "frame spike" : "over budget", decision, quality);
+                cooldown = COOLDOWN_FRAMES;
+                break;
+            }
+        }
+        return;
+    }
+
+    if (frame_ema < HEADROOM_FACTOR * target_mcs && !decisions.empty()) {
+        if (++headroom_frames >= HEADROOM_FRAMES) {
+            Decision decision = decisions.back();
+            decisions.pop_back();
+            restore(decision, quality);
+            logDecision(frame_index, "headroom", decision, quality);
+            headroom_frames = 0;
+            cooldown = COOLDOWN_FRAMES;
+        }
+    } else {
+        headroom_frames = 0;
+    }
+}
+
+bool FrameScheduler::degrade(PipelineStage stage, QualitySettings& quality, Decision& decision) const {
+    switch (stage) {
+        case STAGE_DEPTH:
+            if (quality.depth_refresh_interval >= DEPTH_REFRESH_INTERVAL_MAX) return false;
+            decision = {SKIP_DEPTH_REFRESH, quality.depth_refresh_interval};
+            quality.depth_refresh_interval++;
+            return true;
+        case STAGE_FEATURES:
+        case STAGE_CLUSTERING:
+            // Clustering is quadratic in the number of keypoints, so cap them first
+            if (quality.max_keypoints == 0 || quality.max_keypoints > KEYPOINT_BUDGET_MIN) {
+                decision = {LOWER_KEYPOINT_BUDGET, quality.max_keypoints};
+                quality.max_keypoints = quality.max_keypoints == 0
+                                        ? KEYPOINT_BUDGET_START
+                                        : std::max(KEYPOINT_BUDGET_MIN, quality.max_keypoints / 2);
+                return true;
+            }
+            if (quality.fast_threshold < FAST_THRESHOLD_MAX) {
+                decision = {RAISE_FAST_THRESHOLD, quality.fast_threshold};
+                quality.fast_threshold = std::min(FAST_THRESHOLD_MAX, quality.fast_threshold + FAST_THRESHOLD_STEP);
+                return true;
+            }
+            return false;
+        case STAGE_DISPLAY:
+            if (!quality.display) return false;
+            decision = {DROP_DISPLAY, 1};
+            quality.display = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void FrameScheduler::restore(const Decision& decision, QualitySettings& quality) const {
+    switch (decision.action) {
+        case LOWER_KEYPOINT_BUDGET: quality.max_keypoints = decision.previous_value; break;
+        case RAISE_FAST_THRESHOLD: quality.fast_threshold = decision.previous_value; break;
+        case SKIP_DEPTH_REFRESH: quality.depth_refresh_interval = decision.previous_value; break;
+        case DROP_DISPLAY: quality.display = decision.previous_value != 0; break;
+    }
+}
+
+void FrameScheduler::logDecision(int frame_index, const char* reason, const Decision& decision,
+                                 const QualitySettings& quality) const {
+    log << "[scheduler] frame " << frame_index << ": " << reason
+        << " (avg " << frame_ema / 1000.0 << " ms, budget " << target_mcs / 1000.0 << " ms) -> ";
+    switch (decision.action) {
+        case LOWER_KEYPOINT_BUDGET:
+            log << "keypoint budget ";
+            if (quality.max_keypoints > 0) log << quality.max_keypoints;
+            else log << "unlimited";
+            break;
+        case RAISE_FAST_THRESHOLD:
+            log << "FAST threshold " << quality.fast_threshold;
+            break;
+        case SKIP_DEPTH_REFRESH:
+            log << "depth refresh every " << quality.depth_refresh_interval << " frames";
+            break;
+        case DROP_DISPLAY:
+            log << "display " << (quality.display ? "on" : "off");
+            break;
+    }
+    log << std::endl;
+}
@@ -0,0 +1,240 @@
+#include "golden_results.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+static const int GOLDEN_FORMAT_VERSION = 1;
+
+// Frames listed in the comparison details
+static const size_t MAX_DRIFT_DETAILS = 10;
+
+static LatencyPercentiles percentiles(std::vector<long long> values) {
+    LatencyPercentiles result;
+    if (values.empty()) return result;
+    std::sort(values.begin(), values.end());
+    auto at = [&](double p) { return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))]; };
+    result.p50 = at(0.5);
+    result.p90 = at(0.9);
+    result.p99 = at(0.99);
+    result.max = values.back();
+    return result;
+}
+
+LatencySummary summarizeLatency(const std::vector<FrameResult>& results) {
+    LatencySummary summary;
+    std::vector<long long> values(results.size());
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            values[i] = stage == STAGE_COUNT ? results[i].timings.total() : results[i].timings.mcs[stage];
+        }
+        summary.stages[stage] = percentiles(values);
+    }
+    return summary;
+}
+
+static std::string latencyName(int stage) {
+    return stage == STAGE_COUNT ? "frame" : stageName(static_cast<PipelineStage>(stage));
+}
+
+bool writeGoldenFile(const std::string& path, const GoldenRun& run) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not create golden file " << path << "." << std::endl;
+        return false;
+    }
+
+    // Two decimals keep the file small and are far below the tolerances
+    file << std::fixed << std::setprecision(2);
+    file << "golden " << GOLDEN_FORMAT_VERSION << "\n";
+    file << "video " << run.video << "\n";
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        const LatencyPercentiles& latency = run.latency.stages[stage];
+        file << "latency " << latencyName(stage) << ' ' << latency.p50 << ' ' << latency.p90 << ' '
+             << latency.p99 << ' ' << latency.max << "\n";
+    }
+
+    // f frame keypoints filtered_keypoints median_depth obstacles
+    // o id x y vx vy points depth_median depth_min depth_max bbox_x bbox_y bbox_w bbox_h
+    for (const auto& frame : run.frames) {
+        file << "f " << frame.frame_index << ' ' << frame.keypoint_count << ' ' << frame.filtered_keypoint_count
+             << ' ' << frame.median_depth << ' ' << frame.obstacles.size() << "\n";
+        for (const auto& obstacle : frame.obstacles) {
+            file << "o " << obstacle.id << ' ' << obstacle.center.x << ' ' << obstacle.center.y << ' '
+                 << obstacle.velocity.x << ' ' << obstacle.velocity.y << ' ' << obstacle.point_count << ' '
+                 << obstacle.depth_median << ' ' << obstacle.depth_min << ' ' << obstacle.depth_max << ' '
+                 << obstacle.bbox.x << ' ' << obstacle.bbox.y << ' ' << obstacle.bbox.width << ' '
+                 << obstacle.bbox.height << "\n";
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool readGoldenFile(const std::string& path, GoldenRun& run) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    run = GoldenRun();
+    std::string line, tag;
+    int version = 0;
+    size_t expected_obstacles = 0;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        if (!(fields >> tag)) continue;
+
+        bool ok = true;
+        if (tag == "golden") {
+            ok = static_cast<bool>(fields >> version) && version == GOLDEN_FORMAT_VERSION;
+        } else if (tag == "video") {
+            std::getline(fields >> std::ws, run.video);
+        } else if (tag == "latency") {
+            std::string name;
+            LatencyPercentiles latency;
+            ok = static_cast<bool>(fields >> name >> latency.p50 >> latency.p90 >> latency.p99 >> latency.max);
+            for (int stage = 0; ok && stage <= STAGE_COUNT; ++stage) {
+                if (latencyName(stage) == name) run.latency.stages[stage] = latency;
+            }
+        } else if (tag == "f") {
+            ok = run.frames.empty() || run.frames.back().obstacles.size() == expected_obstacles;
+            FrameResult frame;
+            ok = ok && static_cast<bool>(fields >> frame.frame_index >> frame.keypoint_count
+                                                >> frame.filtered_keypoint_count >> frame.median_depth
+                                                >> expected_obstacles);
+            run.frames.push_back(frame);
+        } else if (tag == "o") {
+            TrackedObstacle obstacle{};
+            ok = !run.frames.empty() &&
+                 static_cast<bool>(fields >> obstacle.id >> obstacle.center.x >> obstacle.center.y
+                                          >> obstacle.velocity.x >> obstacle.velocity.y >> obstacle.point_count
+                                          >> obstacle.depth_median >> obstacle.depth_min >> obstacle.depth_max
+                                          >> obstacle.bbox.x >> obstacle.bbox.y >> obstacle.bbox.width
+                                          >> obstacle.bbox.height);
+            if (ok) run.frames.back().obstacles.push_back(obstacle);
+        }
+
+        if (!ok) {
+            std::cerr << "Error: Malformed golden file " << path << ": " << line << std::endl;
+            return false;
+        }
+    }
+
+    if (version != GOLDEN_FORMAT_VERSION ||
+        (!run.frames.empty() && run.frames.back().obstacles.size() != expected_obstacles)) {
+        std::cerr << "Error: Malformed golden file " << path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool GoldenComparison::passed(const GoldenTolerances& tolerances) const {
+    return missing_frames == 0 &&
+           static_cast<float>(drifted_frames) <= tolerances.drifted_frames * static_cast<float>(std::max(1, frames));
+}
+
+// Compare one frame, appending the reasons it drifted
+static void compareFrame(const FrameResult& golden, const FrameResult& actual, const GoldenTolerances& tolerances,
+                         GoldenComparison& comparison, std::vector<std::string>& reasons,
+                         double& centroid_error_sum, int& matched_count) {
+    std::ostringstream reason;
+    reason << std::fixed << std::setprecision(2);
+
+    auto keypointError = [](int expected, int value) {
+        return std::abs(value - expected) / static_cast<double>(std::max(1, expected));
+    };
+    double keypoint_error = std::max(keypointError(golden.keypoint_count, actual.keypoint_count),
+                                     keypointError(golden.filtered_keypoint_count, actual.filtered_keypoint_count));
+    comparison.max_keypoint_error = std::max(comparison.max_keypoint_error, keypoint_error);
+    if (keypoint_error > tolerances.keypoint_ratio) {
+        reason << "keypoints " << golden.keypoint_count << "/" << golden.filtered_keypoint_count << " -> "
+               << actual.keypoint_count << "/" << actual.filtered_keypoint_count;
+        reasons.push_back(reason.str());
+        reason.str("");
+    }
+
+    double depth_error = std::abs(actual.median_depth - golden.median_depth);
+    comparison.max_depth_error = std::max(comparison.max_depth_error, depth_error);
+    if (depth_error > tolerances.depth) {
+        reason << "median depth " << golden.median_depth << " -> " << actual.median_depth;
+        reasons.push_back(reason.str());
+        reason.str("");
+    }
+
+    int count_difference = std::abs(static_cast<int>(actual.obstacles.size()) -
+                                    static_cast<int>(golden.obstacles.size()));
+    if (count_difference > tolerances.obstacle_count) {
+        reason << "obstacles " << golden.obstacles.size() << " -> " << actual.obstacles.size();
+        reasons.push_back(reason.str());
+        reason.str("");
+    }
+
+    // Greedy nearest-centroid matching; the obstacle lists are short
+    std::vector<char> used(actual.obstacles.size(), 0);
+    int unmatched = 0;
+    for (const auto& expected : golden.obstacles) {
+        int best = -1;
+        double best_distance = tolerances.centroid_px;
+        for (size_t j = 0; j < actual.obstacles.size(); ++j) {
+            double distance = cv::norm(actual.obstacles[j].center - expected.center);
+            if (!used[j] && distance <= best_distance) {
+                best = static_cast<int>(j);
+                best_distance = distance;
+            }
+        }
+        if (best < 0) {
+            unmatched++;
+            continue;
+        }
+        used[best] = 1;
+
+        const TrackedObstacle& match = actual.obstacles[best];
+        centroid_error_sum += best_distance;
+        matched_count++;
+        comparison.max_centroid_error = std::max(comparison.max_centroid_error, best_distance);
+
+        double velocity_error = cv::norm(match.velocity - expected.velocity);
+        double obstacle_depth_error = std::abs(match.depth_median - expected.depth_median);
+        comparison.max_depth_error = std::max(comparison.max_depth_error, obstacle_depth_error);
+        if (velocity_error > tolerances.velocity || obstacle_depth_error > tolerances.depth) {
+            reason << "obstacle at (" << expected.center.x << ", " << expected.center.y << ") velocity error "
+                   << velocity_error << " px/s, depth error " << obstacle_depth_error;
+            reasons.push_back(reason.str());
+            reason.str("");
+        }
+    }
+    // A moved obstacle is unmatched on both sides, count it once
+    unmatched = std::max(unmatched, static_cast<int>(std::count(used.begin(), used.end(), 0)));
+    comparison.unmatched_obstacles += unmatched;
+    if (unmatched > tolerances.obstacle_count) {
+        reason << unmatched << " obstacle(s) moved more than " << tolerances.centroid_px << " px";
+        reasons.push_back(reason.str());
+    }
+}
+
+GoldenComparison compareWithGolden(const GoldenRun& golden, const std::vector<FrameResult>& results,
+                                   const GoldenTolerances& tolerances) {
+    GoldenComparison comparison;
+    double centroid_error_sum = 0.0;
+    int matched_count = 0;
+
+    // Frames are matched by index, both runs start at frame 0
+    size_t common = std::min(golden.frames.size(), results.size());
+    comparison.frames = static_cast<int>(common);
+    comparison.missing_frames = static_cast<int>(std::max(golden.frames.size(), results.size()) - common);
+
+    std::vector<std::string> reasons;
+    for (size_t i = 0; i < common; ++i) {
+        reasons.clear();
+        compareFrame(golden.frames[i], results[i], tolerances, comparison, reasons, centroid_error_sum, matched_count);
+        if (reasons.empty()) continue;
+
+        comparison.drifted_frames++;
+        if (comparison.first_drifted_frame < 0) comparison.first_drifted_frame = results[i].frame_index;
+        if (comparison.details.size() < MAX_DRIFT_DETAILS) {
+            std::string detail = "frame " + std::to_string(results[i].frame_index) + ":";
+            for (const auto& reason : reasons) detail += " " + reason + ";";
+            comparison.details.push_back(detail);
+        }
+    }
+
+    if (matched_count > 0) comparison.mean_centroid_error = centroid_error_sum / matched_count;
+    return comparison;
+}
@@ -0,0 +1,118 @@
+#include "motion_gate.hpp"
+
+#include <algorithm>
+
+void MotionGate::update(FramePyramid& pyramid, int frame_index, const MotionGateSettings& settings) {
+    const std::vector<cv::Mat>& levels = pyramid.grayPyramid();
+    level = std::max(0, std::min(settings.pyramid_level, static_cast<int>(levels.size()) - 1));
+    current = levels[level];
+    tile_size = std::max(1, settings.tile_size >> level) << level;   // Whole pixels on the level
+
+    const cv::Size size = pyramid.frame().size();
+    cv::Size grid((size.width + tile_size - 1) / tile_size, (size.height + tile_size - 1) / tile_size);
+    bool reset = size != frame_size || reference.size() != current.size() || tiles.size() != grid;
+    frame_size = size;
+    tiles.create(grid, CV_8U);
+    if (reset || (settings.refresh_interval > 0 && frame_index % settings.refresh_interval == 0)) {
+        forceFull();
+        return;
+    }
+
+    full_frame = false;
+    cv::absdiff(current, reference, diff);
+    int level_tile = tile_size >> level;
+    cv::Rect level_rect(cv::Point(0, 0), diff.size());
+    for (int y = 0; y < grid.height; ++y) {
+        auto* row = tiles.ptr<uchar>(y);
+        for (int x = 0; x < grid.width; ++x) {
+            cv::Rect block = cv::Rect(x * level_tile, y * level_tile, level_tile, level_tile) & level_rect;
+            row[x] = !block.empty() && cv::mean(diff(block))[0] > settings.threshold ? 1 : 0;
+        }
+    }
+
+    // Grow by one tile: features and clusters near a tile border depend on both sides
+    cv::dilate(tiles, tiles, cv::Mat());
+    changed_tiles = cv::countNonZero(tiles);
+    if (static_cast<float>(changed_tiles) > settings.full_fraction * static_cast<float>(tiles.total())) {
+        forceFull();
+        return;
+    }
+
+    // Changed tiles are reprocessed, unchanged ones keep comparing against their old image
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            if (!tiles.at<uchar>(y, x)) continue;
+            cv::Rect block = cv::Rect(x * level_tile, y * level_tile, level_tile, level_tile) & level_rect;
+            current(block).copyTo(reference(block));
+        }
+    }
+}
+
+void MotionGate::forceFull() {
+    full_frame = true;
+    tiles.setTo(1);
+    changed_tiles = static_cast<int>(tiles.total());
+    if (!current.empty()) current.copyTo(reference);
+}
+
+float MotionGate::changedFraction() const {
+    if (full_frame || tiles.empty()) return 1.0f;
+    return static_cast<float>(changed_tiles) / static_cast<float>(tiles.total());
+}
+
+cv::Rect MotionGate::tileRange(const cv::Rect& area) const {
+    cv::Rect range(area.x / tile_size, area.y / tile_size, 0, 0);
+    range.width = (area.br().x + tile_size - 1) / tile_size - range.x;
+    range.height = (area.br().y + tile_size - 1) / tile_size - range.y;
+    return range & cv::Rect(cv::Point(0, 0), tiles.size());
+}
+
+bool MotionGate::changed(const cv::Rect& area) const {
+    if (full_frame) return true;
+    cv::Rect range = tileRange(area);
+    return !range.empty() && cv::countNonZero(tiles(range)) > 0;
+}
+
+bool MotionGate::changed(const cv::Point2f& point) const {
+    if (full_frame) return true;
+    int x = std::max(0, std::min(static_cast<int>(point.x) / tile_size, tiles.cols - 1));
+    int y = std::max(0, std::min(static_cast<int>(point.y) / tile_size, tiles.rows - 1));
+    return tiles.at<uchar>(y, x) != 0;
+}
+
+std::vector<cv::Rect> MotionGate::changedRects(const cv::Rect& region) const {
+    if (full_frame) return {region};
+
+    std::vector<cv::Rect> rects;
+    std::vector<size_t> open;   // Rects ending at the previous tile row
+    cv::Rect range = tileRange(region);
+    for (int y = range.y; y < range.br().y; ++y) {
+        std::vector<size_t> next_open;
+        const auto* row = tiles.ptr<uchar>(y);
+        for (int x = range.x; x < range.br().x;) {
+            if (!row[x]) {
+                x++;
+                continue;
+            }
+            int run_start = x;
+            while (x < range.br().x && row[x]) x++;
+            cv::Rect run(run_start * tile_size, y * tile_size, (x - run_start) * tile_size, tile_size);
+
+            // Extend a rect of the previous row with the same columns, otherwise start a new one
+            auto same_columns = std::find_if(open.begin(), open.end(), [&](size_t index) {
+                return rects[index].x == run.x && rects[index].width == run.width;
+            });
+            if (same_columns != open.end()) {
+                rects[*same_columns].height += tile_size;
+                next_open.push_back(*same_columns);
+            } else {
+                rects.push_back(run);
+                next_open.push_back(rects.size() - 1);
+            }
+        }
+        open = next_open;
+    }
+
+    for (auto& rect : rects) rect &= region;
+    return rects;
+}
@@ -0,0 +1,278 @@
+#include "offline_processor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+// Largest centroid distance of the same obstacle seen by two chunks in their overlap frames [px]
+static constexpr float TRACK_MATCH_DISTANCE = 4.0f;
+
+
+std::vector<VideoChunk> splitIntoChunks(int total_frames, int chunk_frames) {
+    std::vector<VideoChunk> chunks;
+    if (chunk_frames <= 0) return chunks;
+
+    for (int begin = 0; begin < total_frames; begin += chunk_frames) {
+        VideoChunk chunk;
+        chunk.begin = begin;
+        chunk.end = std::min(begin + chunk_frames, total_frames);
+        chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+// Grab frame `frame_index`, so that retrieve() returns it. A seek is only trusted when the
+// grabbed frame's timestamp matches the frame, backends may report the requested position
+// without reaching it; otherwise the frames are grabbed sequentially from the start.
+static bool grabFrame(cv::VideoCapture& video, const std::string& video_path, int frame_index, double fps) {
+    if (frame_index == 0) return video.grab();
+
+    if (fps > 0.0 && video.set(cv::CAP_PROP_POS_FRAMES, frame_index) && video.grab()) {
+        double expected_ms = frame_index * 1000.0 / fps;
+        if (std::abs(video.get(cv::CAP_PROP_POS_MSEC) - expected_ms) < 500.0 / fps) return true;
+    }
+
+    video.open(video_path);
+    for (int i = 0; i <= frame_index; ++i) {
+        if (!video.grab()) return false;
+    }
+    return true;
+}
+
+static void processChunk(const std::string& video_path, VideoChunk& chunk, int warmup_frames,
+                         double fps, const cv::Size& frame_size) {
+    cv::VideoCapture video(video_path);
+    if (!video.isOpened()) {
+        std::cerr << "Error: Could not open video for chunk " << chunk.begin << "." << std::endl;
+        return;
+    }
+
+    int first_frame = std::max(0, chunk.begin - warmup_frames);
+    if (!grabFrame(video, video_path, first_frame, fps)) {
+        std::cerr << "Error: Could not seek to frame " << first_frame << "." << std::endl;
+        return;
+    }
+
+    cv::VideoWriter writer(chunk.output_path, cv::VideoWriter::fourcc('M','J','P','G'), fps, frame_size);
+    if (!writer.isOpened()) {
+        std::cerr << "Error: Could not create chunk file " << chunk.output_path << "." << std::endl;
+        return;
+    }
+
+    // Same pipeline as a live run; track IDs are chunk-local until linkTrackIds()
+    PipelineContext context;
+    configurePipeline(context);
+    chunk.results.reserve(chunk.end - chunk.begin);
+    chunk.warmup_results.clear();
+
+    cv::Mat frame;
+    for (int frame_index = first_frame; frame_index < chunk.end; ++frame_index) {
+        // The first frame was grabbed by the seek
+        bool decoded = frame_index == first_frame ? video.retrieve(frame) : video.read(frame);
+        if (!decoded) break;
+
+        FrameResult result;
+        result.frame_index = frame_index;
+
+        // Warm-up frames only advance the trackers, their tracks are matched to the previous chunk
+        if (frame_index < chunk.begin) {
+            analyzeFrame(context, frame, result);
+            chunk.warmup_results.push_back(std::move(result));
+            continue;
+        }
+
+        processFrame(context, frame, result);
+        writer.write(frame);
+        chunk.results.push_back(std::move(result));
+    }
+
+    // Truncated or damaged files end early, a short chunk must not pass as complete
+    int expected_frames = chunk.end - chunk.begin;
+    if (static_cast<int>(chunk.results.size()) != expected_frames) {
+        std::cerr << "Error: Chunk [" << chunk.begin << ", " << chunk.end << ") ended after "
+                  << chunk.results.size() << " of " << expected_frames << " frames." << std::endl;
+        return;
+    }
+    chunk.ok = true;
+}
+
+// Renumber the chunk-local track IDs into one sequence. A chunk's warm-up frames are the last
+// frames of the previous chunk: a track that follows the same obstacle there keeps the previous
+// chunk's ID, every other track gets a new one. Failed chunks break the chain.
+static void linkTrackIds(std::vector<VideoChunk>& chunks) {
+    int next_id = 0;
+    const VideoChunk* previous = nullptr;
+    for (auto& chunk : chunks) {
+        if (!chunk.ok) {
+            previous = nullptr;
+            continue;
+        }
+
+        std::unordered_map<int, int> ids;   // Chunk-local ID -> final ID
+        if (previous) {
+            // Overlap frames in which a local track and a previous track have the same centroid
+            std::map<std::pair<int, int>, int> votes;
+            for (const auto& warmup : chunk.warmup_results) {
+                int offset = warmup.frame_index - previous->begin;
+                if (offset < 0 || offset >= static_cast<int>(previous->results.size())) continue;
+                const FrameResult& earlier = previous->results[offset];
+                for (const auto& obstacle : warmup.obstacles) {
+                    for (const auto& candidate : earlier.obstacles) {
+                        if (cv::norm(obstacle.center - candidate.center) <= TRACK_MATCH_DISTANCE) {
+                            votes[{obstacle.id, candidate.id}]++;
+                        }
+                    }
+                }
+            }
+
+            // Best supported pairs first, each ID is matched once
+            std::vector<std::tuple<int, int, int>> ranked;   // Negated votes, local ID, previous ID
+            for (const auto& vote : votes) ranked.emplace_back(-vote.second, vote.first.first, vote.first.second);
+            std::sort(ranked.begin(), ranked.end());
+            std::unordered_set<int> taken;
+            for (const auto& pair : ranked) {
+                int local = std::get<1>(pair), matched = std::get<2>(pair);
+                if (ids.count(local) || taken.count(matched)) continue;
+                ids.emplace(local, matched);
+                taken.insert(matched);
+            }
+        }
+
+        // New tracks are numbered in order of appearance, after every ID used so far
+        for (auto& result : chunk.results) {
+            for (auto& obstacle : result.obstacles) {
+                auto id = ids.find(obstacle.id);
+                if (id == ids.end()) id = ids.emplace(obstacle.id, next_id++).first;
+                obstacle.id = id->second;
+            }
+        }
+        previous = &chunk;
+    }
+}
+
+static void writeResultsCsv(const std::string& path, const std::vector<VideoChunk>& chunks) {
+    std::ofstream csv(path);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Could not create results file " << path << "." << std::endl;
+        return;
+    }
+
+    // Obstacles are serialized as "id x y vx vy points" separated by ';'
+    csv << "frame,keypoints,filtered_keypoints,median_depth,obstacles\n";
+    for (const auto& chunk : chunks) {
+        // Failed chunks are missing from the video as well
+        if (!chunk.ok) continue;
+        for (const auto& result : chunk.results) {
+            csv << result.frame_index << ',' << result.keypoint_count << ','
+                << result.filtered_keypoint_count << ',' << result.median_depth << ',';
+            for (size_t i = 0; i < result.obstacles.size(); ++i) {
+                const auto& obstacle = result.obstacles[i];
+                if (i > 0) csv << ';';
+                csv << obstacle.id << ' ' << obstacle.center.x << ' ' << obstacle.center.y << ' '
+                    << obstacle.velocity.x << ' ' << obstacle.velocity.y << ' ' << obstacle.point_count;
+            }
+            csv << '\n';
+        }
+    }
+}
+
+int processVideoChunked(const std::string& video_path, const ChunkedProcessingOptions& options) {
+    cv::VideoCapture video(video_path);
+    if (!video.isOpened()) {
+        std::cerr << "Error: Could not open video." << std::endl;
+        return -1;
+    }
+
+    int frame_width = static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH));
+    int frame_height = static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT));
+    int total_frames = static_cast<int>(video.get(cv::CAP_PROP_FRAME_COUNT));
+    double fps = video.get(cv::CAP_PROP_FPS);
+    video.release();
+
+    if (total_frames <= 0) {
+        std::cerr << "Error: Unknown frame count, offline mode needs a seekable recording." << std::endl;
+        return -1;
+    }
+
+    int num_workers = options.num_workers > 0 ? options.num_workers
+                                              : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int chunk_frames = options.chunk_frames > 0 ? options.chunk_frames
+                                                : (total_frames + num_workers - 1) / num_workers;
+
+    std::string output_video_path = getContentPath("output_", "media/video_results") +
+#if USE_EKF
+            "EKF_offline";
+#else
+            "KF_offline";
+#endif
+
+    auto chunks = splitIntoChunks(total_frames, chunk_frames);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i].output_path = output_video_path + "_chunk" + std::to_string(i) + ".avi";
+    }
+    num_workers = std::min(num_workers, static_cast<int>(chunks.size()));
+
+    std::cout << "Processing " << total_frames << " frames in " << chunks.size() << " chunks on "
+              << num_workers << " workers..." << std::endl;
+
+    // Parallelism comes from the workers, keep OpenCV's own thread pool out of the way
+    int opencv_threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    auto start_time = get_current_time_fenced();
+
+    std::atomic<size_t> next_chunk{0};
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (int w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&]() {
+            for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+                processChunk(video_path, chunks[i], options.warmup_frames, fps,
+                             cv::Size(frame_width, frame_height));
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    cv::setNumThreads(opencv_threads);
+
+    // Stitch the chunk videos back together in order
+    cv::VideoWriter output_video(output_video_path + ".avi", cv::VideoWriter::fourcc('M','J','P','G'),
+                                 fps, cv::Size(frame_width, frame_height));
+    if (!output_video.isOpened()) {
+        std::cerr << "Error: Could not create output video file." << std::endl;
+        return -1;
+    }
+
+    int status = 0;
+    cv::Mat frame;
+    for (const auto& chunk : chunks) {
+        if (!chunk.ok) {
+            std::cerr << "Error: Chunk [" << chunk.begin << ", " << chunk.end << ") failed." << std::endl;
+            std::remove(chunk.output_path.c_str());
+            status = -1;
+            continue;
+        }
+        cv::VideoCapture chunk_video(chunk.output_path);
+        while (chunk_video.read(frame)) {
+            output_video.write(frame);
+        }
+        chunk_video.release();
+        std::remove(chunk.output_path.c_str());
+    }
+    output_video.release();
+
+    linkTrackIds(chunks);
+    writeResultsCsv(output_video_path + ".csv", chunks);
+
+    auto end_time = get_current_time_fenced();
+    std::cout << "Offline processing finished in " << to_ms(end_time - start_time) << " ms" << std::endl;
+    std::cout << "Results saved to " << output_video_path << ".avi/.csv" << std::endl;
+
+    return status;
+}
@@ -0,0 +1,123 @@
+#include "pipeline_metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include "video_processor.hpp"
+
+// Bucket upper bounds [mcs]: 0.5 ms up to a frame at 30 fps in fine steps, then up to 1 s
+static constexpr long long BUCKET_BOUNDS_MCS[LatencyHistogram::BUCKETS - 1] = {
+        500, 1000, 2500, 5000, 10000, 20000, 33333, 50000, 100000, 250000, 500000, 1000000};
+
+long long LatencyHistogram::bound(int bucket) {
+    return BUCKET_BOUNDS_MCS[bucket];
+}
+
+void LatencyHistogram::observe(long long mcs) {
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && mcs > BUCKET_BOUNDS_MCS[bucket]) bucket++;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(static_cast<uint64_t>(std::max(0LL, mcs)), std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) total += bucketCount(bucket);
+    return total;
+}
+
+void PipelineMetrics::recordFrame(const FrameResult& result, size_t track_count) {
+    frames_out.add();
+    keypoints.set(result.keypoint_count);
+    filtered_keypoints.set(result.filtered_keypoint_count);
+    clusters.set(static_cast<double>(result.obstacles.size()));
+    tracks.set(static_cast<double>(track_count));
+    changed_fraction.set(result.changed_fraction);
+
+    // Display is timed by the caller after processFrame()
+    long long total = 0;
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        if (stage == STAGE_DISPLAY) continue;
+        stage_latency[stage].observe(result.timings.mcs[stage]);
+        total += result.timings.mcs[stage];
+    }
+    frame_latency.observe(total);
+}
+
+PipelineMetrics& pipelineMetrics() {
+    static PipelineMetrics metrics;
+    return metrics;
+}
+
+static void appendMetric(std::string& text, const char* name, const char* type, const char* help, double value) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "# HELP drone_navigation_%s %s\n# TYPE drone_navigation_%s %s\n"
+                                      "drone_navigation_%s %.17g\n", name, help, name, type, name, value);
+    text += line;
+}
+
+// Series of one histogram; `labels` is empty or a label list ending with a comma
+static void appendHistogram(std::string& text, const char* name, const std::string& labels,
+                            const LatencyHistogram& histogram) {
+    char line[256];
+    uint64_t cumulative = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+        cumulative += histogram.bucketCount(bucket);
+        if (bucket < LatencyHistogram::BUCKETS - 1) {
+            std::snprintf(line, sizeof(line), "drone_navigation_%s_bucket{%sle=\"%g\"} %llu\n", name,
+                          labels.c_str(), static_cast<double>(LatencyHistogram::bound(bucket)) / 1e6,
+                          static_cast<unsigned long long>(cumulative));
+        } else {
+            std::snprintf(line, sizeof(line), "drone_navigation_%s_bucket{%sle=\"+Inf\"} %llu\n", name,
+                          labels.c_str(), static_cast<unsigned long long>(cumulative));
+        }
+        text += line;
+    }
+
+    // The count is the bucket total, so it is consistent with the buckets even during updates
+    std::string selector = labels.empty() ? "" : "{" + labels.substr(0, labels.size() - 1) + "}";
+    std::snprintf(line, sizeof(line), "drone_navigation_%s_sum%s %.6f\ndrone_navigation_%s_count%s %llu\n", name,
+                  selector.c_str(), static_cast<double>(histogram.sumMcs()) / 1e6, name, selector.c_str(),
+                  static_cast<unsigned long long>(cumulative));
+    text += line;
+}
+
+static void appendHistogramHead(std::string& text, const char* name, const char* help) {
+    text += std::string("# HELP drone_navigation_") + name + " " + help + "\n";
+    text += std::string("# TYPE drone_navigation_") + name + " histogram\n";
+}
+
+std::string formatPrometheus(const PipelineMetrics& metrics) {
+    std::string text;
+    text.reserve(8192);
+
+    appendMetric(text, "frames_in_total", "counter", "Frames read from the source or received.",
+                 static_cast<double>(metrics.frames_in.get()));
+    appendMetric(text, "frames_out_total", "counter", "Frames processed.",
+                 static_cast<double>(metrics.frames_out.get()));
+    appendMetric(text, "frames_dropped_total", "counter", "Frames lost before processing.",
+                 static_cast<double>(metrics.frames_dropped.get()));
+    appendMetric(text, "depth_inferences_total", "counter", "Depth model runs.",
+                 static_cast<double>(metrics.depth_inferences.get()));
+    appendMetric(text, "frame_queue_depth", "gauge", "Frames waiting for the pipeline.", metrics.frame_queue.get());
+    appendMetric(text, "record_queue_depth", "gauge", "Frames waiting to be recorded.", metrics.record_queue.get());
+    appendMetric(text, "keypoints", "gauge", "Keypoints after NMS in the last frame.", metrics.keypoints.get());
+    appendMetric(text, "filtered_keypoints", "gauge", "Keypoints that passed the depth filter in the last frame.",
+                 metrics.filtered_keypoints.get());
+    appendMetric(text, "clusters", "gauge", "Obstacle clusters in the last frame.", metrics.clusters.get());
+    appendMetric(text, "tracks", "gauge", "Active obstacle trackers.", metrics.tracks.get());
+    appendMetric(text, "changed_fraction", "gauge", "Share of the last frame reprocessed by the motion gate.",
+                 metrics.changed_fraction.get());
+
+    appendHistogramHead(text, "stage_latency_seconds", "Pipeline stage latency per frame.");
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        // Stages this process never runs (display in headless runs) would only export zeros
+        if (metrics.stage_latency[stage].count() == 0) continue;
+        std::string labels = std::string("stage=\"") + stageName(static_cast<PipelineStage>(stage)) + "\",";
+        appendHistogram(text, "stage_latency_seconds", labels, metrics.stage_latency[stage]);
+    }
+    appendHistogramHead(text, "frame_latency_seconds", "Processing latency per frame, display excluded.");
+    appendHistogram(text, "frame_latency_seconds", "", metrics.frame_latency);
+    appendHistogramHead(text, "depth_latency_seconds", "Depth model latency per region.");
+    appendHistogram(text, "depth_latency_seconds", "", metrics.depth_latency);
+    return text;
+}
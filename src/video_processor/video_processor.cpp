@@ -1,37 +1,475 @@
 #include "video_processor.hpp"
+#include "obstacle_publisher.hpp"
+#include "occupancy_map.hpp"
+#include "metrics_publisher.hpp"
+#include <tuple>
+#include <unordered_set>
 
 // Configuration defines
-#define USE_EKF 1                    // 0=Kalman,               1=EKF
 #define MEASURE_TIME 1               // 0=No timing,            1=Measure timing
 #define SELECT_ROI 0                 // 0=Use full frame,       1=Select ROI
+#define FOLLOW_ROI 0                 // 0=Fixed ROI,            1=ROI follows the tracked obstacle
 #define SHOW_PREDICTED_POSITION 0    // 0=No predicted cluster, 1=Show predicted cluster
+#define ADAPTIVE_QUALITY 1           // 0=Fixed quality,        1=Degrade quality to meet the frame budget
+#define PUBLISH_OBSTACLES 0          // 0=No publishing,        1=Publish obstacles to shared memory
+#define BUILD_OCCUPANCY_MAP 0        // 0=No map,               1=Integrate the depth maps into a voxel map
+#define MOTION_GATING 1              // 0=Process every frame,  1=Reuse the results of static tiles
+#define PUBLISH_METRICS 1            // 0=No snapshots,         1=Publish health metrics to shared memory
+#define EGO_MOTION 1                 // 0=Uncompensated tracks, 1=Move the tracks with the estimated camera motion
+#define WRITE_OUTPUT_VIDEO 1         // 0=No output video,      1=Write the annotated frames to media/video_results
+
+// The recorded videos have no pose or calibration: the map assumes a static camera
+// with this field of view, and converts the relative MiDaS depth with this scale.
+#define OCCUPANCY_MAP_FOV_DEG 60.0f
+#define OCCUPANCY_MAP_DEPTH_SCALE 500.0f
+
+
+PipelineContext::PipelineContext() {
+    // FAST + BRIEF
+    fast = cv::FastFeatureDetector::create();
+    brief = cv::xfeatures2d::BriefDescriptorExtractor::create();
+
+    // Adaptive histogram equalization to enhance local contrast of the depth map
+    clahe = cv::createCLAHE();
+    clahe->setClipLimit(4.0);  // Controls contrast amplification
+}
 
-#if USE_EKF
-typedef ExtendedKalmanFilter Filter;
-#else
-typedef KalmanFilter Filter;
+// Regions processed this frame: the context's ROIs clipped to the frame, or the full frame.
+// Overlapping ROIs are merged into their bounding box, so no pixel is processed twice.
+static std::vector<cv::Rect> activeRegions(const PipelineContext& context, const cv::Size& frame_size) {
+    cv::Rect frame_rect(cv::Point(0, 0), frame_size);
+    std::vector<cv::Rect> regions;
+    for (const auto& roi : context.rois) {
+        cv::Rect clipped = roi & frame_rect;
+        if (clipped.area() == 0) continue;
+
+        // A merged box can reach further regions, merge until it overlaps none
+        for (size_t i = 0; i < regions.size();) {
+            if ((regions[i] & clipped).area() > 0) {
+                clipped |= regions[i];
+                regions.erase(regions.begin() + static_cast<std::ptrdiff_t>(i));
+                i = 0;
+            } else {
+                ++i;
+            }
+        }
+        regions.push_back(clipped);
+    }
+    if (regions.empty()) regions.push_back(frame_rect);
+    return regions;
+}
+
+// True if `regions` are `previous` moved without changing their sizes
+static bool regionsTranslated(const std::vector<cv::Rect>& regions, const std::vector<cv::Rect>& previous) {
+    if (regions.size() != previous.size()) return false;
+    for (size_t r = 0; r < regions.size(); ++r) {
+        if (regions[r].size() != previous[r].size()) return false;
+    }
+    return true;
+}
+
+// Move the depth of the previous regions along with them, until the next refresh
+static void translateRegionDepth(PipelineContext& context, const std::vector<cv::Rect>& regions) {
+    std::vector<cv::Mat> filtered(regions.size()), colored(regions.size());
+    for (size_t r = 0; r < regions.size(); ++r) {
+        filtered[r] = context.depth_filtered(context.depth_regions[r]).clone();
+        colored[r] = context.depth_map(context.depth_regions[r]).clone();
+    }
+    for (const auto& old_region : context.depth_regions) {
+        context.depth_filtered(old_region).setTo(0);
+        context.depth_map(old_region).setTo(cv::Scalar::all(0));
+    }
+    for (size_t r = 0; r < regions.size(); ++r) {
+        cv::Mat filtered_view = context.depth_filtered(regions[r]);
+        filtered[r].copyTo(filtered_view);
+        cv::Mat colored_view = context.depth_map(regions[r]);
+        colored[r].copyTo(colored_view);
+    }
+    context.depth_regions = regions;
+}
+
+// Margin around changed areas so FAST's circle and BRIEF's patch see the surrounding pixels
+static const int MOTION_GATE_MARGIN = 32;
+
+// FAST with the keypoint budget, BRIEF and NMS on a gray image; one descriptor row per keypoint
+static void detectFeatures(PipelineContext& context, const cv::Mat& gray, int budget,
+                           std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors) {
+    context.fast->detect(gray, keypoints);
+    if (budget > 0) cv::KeyPointsFilter::retainBest(keypoints, budget);
+    context.brief->compute(gray, keypoints, descriptors);
+
+    // Apply NMS to filter out redundant keypoints
+    applyNMS(keypoints, descriptors);
+}
+
+// Greedy nearest-neighbour association of clusters with the predicted tracks, closest pairs first
+static void associateClusters(const std::unordered_map<int, Track>& trackers, const ClusterSet& clusters, float gate,
+                              std::vector<int>& cluster_tracks) {
+    std::vector<std::tuple<float, int, int>> pairs;   // Squared distance, track ID, cluster
+    const float gate_sq = gate * gate;
+    for (const auto& entry : trackers) {
+        cv::Point2f predicted = entry.second.filter.getPredictedPosition();
+        for (int i = 0; i < clusters.count(); ++i) {
+            cv::Point2f offset = clusters.stats[i].centroid - predicted;
+            float distance_sq = offset.dot(offset);
+            if (distance_sq <= gate_sq) pairs.emplace_back(distance_sq, entry.first, i);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    cluster_tracks.assign(clusters.count(), -1);
+    std::unordered_set<int> assigned;
+    for (const auto& pair : pairs) {
+        int id = std::get<1>(pair), cluster = std::get<2>(pair);
+        if (cluster_tracks[cluster] >= 0 || assigned.count(id)) continue;
+        cluster_tracks[cluster] = id;
+        assigned.insert(id);
+    }
+}
+
+// Re-center every ROI on the tracked obstacle closest to its center
+static void followObstacles(PipelineContext& context, const FrameResult& result, const cv::Size& frame_size) {
+    for (auto& roi : context.rois) {
+        cv::Point2f roi_center(roi.x + roi.width * 0.5f, roi.y + roi.height * 0.5f);
+
+        const TrackedObstacle* nearest = nullptr;
+        float nearest_distance = std::numeric_limits<float>::max();
+        cv::Point2f nearest_center;
+        for (const auto& obstacle : result.obstacles) {
+            // ROIs live in the camera image, obstacles in undistorted coordinates
+            cv::Point2f center = context.camera.distort(obstacle.center);
+            if (!roi.contains(center)) continue;
+            float distance = static_cast<float>(cv::norm(center - roi_center));
+            if (distance < nearest_distance) {
+                nearest_distance = distance;
+                nearest = &obstacle;
+                nearest_center = center;
+            }
+        }
+        if (!nearest) continue;
+
+        // Lead the obstacle by one frame
+        cv::Point2f target = nearest_center + nearest->velocity * (1.0f / 30);
+        roi.x = std::max(0, std::min(cvRound(target.x - roi.width * 0.5f), frame_size.width - roi.width));
+        roi.y = std::max(0, std::min(cvRound(target.y - roi.height * 0.5f), frame_size.height - roi.height));
+    }
+}
+
+void analyzeFrame(PipelineContext& context, const cv::Mat& frame, FrameResult& result) {
+    const QualitySettings& quality = context.quality;
+    auto stage_start = get_current_time_fenced();
+    auto endStage = [&](PipelineStage stage) {
+        auto stage_end = get_current_time_fenced();
+        result.timings.mcs[stage] = to_mcs(stage_end - stage_start);
+        stage_start = stage_end;
+    };
+
+    // Only the ROIs are processed; results are mapped back to frame coordinates
+    std::vector<cv::Rect> regions = activeRegions(context, frame.size());
+    int total_area = 0;
+    // Gray, pyramid and model-sized views are derived from the frame once, before it is annotated
+    context.pyramid.update(frame);
+    context.camera.update(frame.size());
+    for (const auto& region : regions) total_area += region.area();
+
+    // ------ Motion gate ------
+    // Counted as part of the depth stage. Anything the cache does not match reprocesses the whole frame.
+    MotionGate& gate = context.motion_gate;
+    StageCache& cache = context.cache;
+    bool gated = context.motion.enabled;
+    if (gated) {
+        gate.update(context.pyramid, result.frame_index, context.motion);
+        if (!cache.valid || cache.regions != regions || cache.fast_threshold != quality.fast_threshold ||
+            cache.max_keypoints != quality.max_keypoints) {
+            gate.forceFull();
+        }
+        result.changed_fraction = gate.changedFraction();
+
+        // Changes between depth refreshes are remembered until the next refresh
+        cache.stale_depth.resize(regions.size(), true);
+        for (size_t r = 0; r < regions.size(); ++r) {
+            if (gate.changed(regions[r])) cache.stale_depth[r] = true;
+        }
+    }
+
+    // ------ Depth estimation ------
+    // Depth maps are frame-sized, only the ROIs are filled in.
+    // The previous depth is reused between refreshes; ROIs that follow an obstacle take their depth along.
+    cv::Mat& depth_filtered = context.depth_filtered;
+    bool depth_resized = depth_filtered.size() != frame.size();
+    bool regions_changed = regions != context.depth_regions;
+    bool depth_refresh = result.frame_index % quality.depth_refresh_interval == 0;
+    if (!depth_resized && !depth_refresh && regions_changed && regionsTranslated(regions, context.depth_regions)) {
+        translateRegionDepth(context, regions);
+    } else if (depth_resized || regions_changed || depth_refresh) {
+        // Runs on the depth cores of the thread layout, if any
+        ThreadRoleScope depth_scope(ThreadRole::DEPTH);
+        if (depth_resized) {
+            depth_filtered = cv::Mat::zeros(frame.size(), CV_32F);
+            context.depth_map = cv::Mat::zeros(frame.size(), CV_8UC3);
+        } else if (regions_changed) {
+            for (const auto& old_region : context.depth_regions) {
+                depth_filtered(old_region).setTo(0);
+                context.depth_map(old_region).setTo(cv::Scalar::all(0));
+            }
+        }
+
+        for (size_t r = 0; r < regions.size(); ++r) {
+            // Static regions keep their depth. The model needs the whole region as context,
+            // so a changed tile refreshes its region rather than the tile alone.
+            const cv::Rect& region = regions[r];
+            if (gated) {
+                if (!depth_resized && !regions_changed && !cache.stale_depth[r]) continue;
+                cache.stale_depth[r] = false;
+            }
+
+            auto depth_start = get_current_time_fenced();
+            cv::Mat region_depth = context.depth_source ? context.depth_source(frame(region), region)
+                                                        : depth_estimation(context.pyramid, region);
+            pipelineMetrics().depth_latency.observe(to_mcs(get_current_time_fenced() - depth_start));
+            pipelineMetrics().depth_inferences.add();
+            cv::Mat region_depth_view = context.depth_map(region);
+            region_depth.copyTo(region_depth_view);
+
+            cv::Mat region_filtered_view = depth_filtered(region);
+            filterDepthMap(region_depth, *context.clahe, region_filtered_view);
+        }
+        context.depth_regions = regions;
+    }
+    endStage(STAGE_DEPTH);
+
+    // ------ Feature detection ------
+    std::vector<std::vector<cv::KeyPoint>> region_keypoints(regions.size());
+    bool full_features = !gated || gate.full();
+    std::vector<cv::Point2f> feature_points;   // Undistorted, for the ego-motion
+    cv::Mat feature_descriptors;
+    context.fast->setThreshold(quality.fast_threshold);
+    for (size_t r = 0; r < regions.size(); ++r) {
+        const cv::Rect& region = regions[r];
+        std::vector<cv::KeyPoint>& keypoints = region_keypoints[r];
+
+        // Split the keypoint budget by ROI area
+        long long budget = 0;
+        if (quality.max_keypoints > 0) {
+            budget = std::max(1LL, static_cast<long long>(quality.max_keypoints) * region.area() / total_area);
+        }
+
+        if (full_features) {
+            cv::Mat descriptors;
+            detectFeatures(context, context.pyramid.gray(region), static_cast<int>(budget), keypoints, descriptors);
+            if (context.ego_motion.enabled) {
+                cv::Point2f offset(static_cast<float>(region.x), static_cast<float>(region.y));
+                for (const auto& kp : keypoints) feature_points.push_back(context.camera.undistort(kp.pt + offset));
+                feature_descriptors.push_back(descriptors);
+            }
+        } else {
+            // Keypoints of static tiles carry over, changed areas are detected again
+            cv::Point2f offset(static_cast<float>(region.x), static_cast<float>(region.y));
+            for (const auto& kp : cache.region_keypoints[r]) {
+                if (!gate.changed(kp.pt + offset)) keypoints.push_back(kp);
+            }
+            for (const auto& area : gate.changedRects(region)) {
+                cv::Rect window = cv::Rect(area.x - MOTION_GATE_MARGIN, area.y - MOTION_GATE_MARGIN,
+                                           area.width + 2 * MOTION_GATE_MARGIN,
+                                           area.height + 2 * MOTION_GATE_MARGIN) & region;
+                int area_budget = budget > 0 ? static_cast<int>(std::max(1LL, budget * area.area() / region.area()))
+                                             : 0;
+                std::vector<cv::KeyPoint> area_keypoints;
+                cv::Mat area_descriptors;
+                detectFeatures(context, context.pyramid.gray(window), area_budget, area_keypoints, area_descriptors);
+
+                cv::Point2f window_offset(static_cast<float>(window.x - region.x),
+                                          static_cast<float>(window.y - region.y));
+                for (auto& kp : area_keypoints) {
+                    kp.pt += window_offset;
+                    if (area.contains(cv::Point(kp.pt + offset))) keypoints.push_back(kp);
+                }
+            }
+        }
+        result.keypoint_count += static_cast<int>(keypoints.size());
+    }
+    endStage(STAGE_FEATURES);
+
+    // A static frame keeps its clusters; DBSCAN is global, so any change reclusters all points
+    ClusterSet& clusters = context.clusters;
+    if (gated && !gate.anyChanged()) {
+        result.median_depth = cache.median_depth;
+        result.filtered_keypoint_count = cache.filtered_keypoint_count;
+    } else {
+        // Filter keypoints based on the median depth of their ROI
+        std::vector<cv::Point2f> points;
+        std::vector<float> point_depths;
+        double median_sum = 0.0;
+        for (size_t r = 0; r < regions.size(); ++r) {
+            const cv::Rect& region = regions[r];
+            cv::Mat region_depth = depth_filtered(region);
+            float median_depth = getMedianDepth(region_depth);
+            median_sum += static_cast<double>(median_depth) * region.area();
+
+            for (auto& kp : region_keypoints[r]) {
+                int x = static_cast<int>(kp.pt.x);
+                int y = static_cast<int>(kp.pt.y);
+
+                if (x < 0 || x >= region_depth.cols || y < 0 || y >= region_depth.rows)
+                    continue;
+
+                // Get depth value from depth map
+                float depth_value = region_depth.at<float>(y, x);
+
+                // Define a depth threshold range (example: 0.5m to 5m depth)
+                // Depth is sampled at the camera image position, clustering works on undistorted positions
+                if (depth_value >= median_depth) {
+                    cv::Point2f offset(static_cast<float>(region.x), static_cast<float>(region.y));
+                    points.push_back(context.camera.undistort(kp.pt + offset));
+                    point_depths.push_back(depth_value);
+                }
+            }
+        }
+        result.median_depth = static_cast<float>(median_sum / total_area);
+        result.filtered_keypoint_count = static_cast<int>(points.size());
+
+        int minPts = 4;   // Rule of thumb: Use 4 for 2D points
+        // kNN distances need more than k points
+        if (points.size() > static_cast<size_t>(minPts)) {
+            std::vector<float> knn_distances = calculateKnnDistances(points);
+            float eps = determineEps(knn_distances);
+
+            clusterPoints(points, eps, minPts, clusters, point_depths);
+        } else {
+            clusters.clear();
+        }
+    }
+    endStage(STAGE_CLUSTERING);
+
+    // ------ Ego-motion ------
+    // Counted as part of the tracking stage. Partially gated frames keep the previous full frame as the
+    // reference: the camera is static for them, the gate reprocesses the full frame as soon as it moves.
+    if (context.ego_motion.enabled && full_features) {
+        context.ego_estimator.update(feature_points, feature_descriptors, context.ego_motion, result.ego_motion);
+    }
+    const EgoMotion& ego = result.ego_motion;
+
+    // ------ Tracking ------
+    // Tracks move with the camera before the prediction, so the gate only has to cover the obstacles' own motion
+    auto& trackers = context.trackers;
+    for (auto& entry : trackers) {
+        Filter& filter = entry.second.filter;
+        if (ego.valid) {
+            cv::Point2f position = filter.getPredictedPosition();
+            filter.warp(ego.apply(position), ego.jacobian(position));
+        }
+        filter.predict(1.0f / 30);
+        entry.second.misses++;
+    }
+
+    bool compensated = ego.valid || !full_features;
+    std::vector<int> cluster_tracks;
+    associateClusters(trackers, clusters,
+                      compensated ? context.tracking.gate : context.tracking.uncompensated_gate, cluster_tracks);
+
+    for (int i = 0; i < clusters.count(); ++i) {
+        const ClusterStats& stats = clusters.stats[i];
+        const cv::Point2f& center = stats.centroid;
+
+        // Clusters outside every gate start a new track
+        int id = cluster_tracks[i];
+        if (id < 0) {
+            id = context.next_track_id++;
+            trackers.emplace(id, Track{Filter(center.x, center.y)});
+        }
+        Track& track = trackers.at(id);
+        track.filter.update(center.x, center.y);
+        track.misses = 0;
+
+        result.obstacles.push_back({id, center,
+                                    cv::Point2f(track.filter.state(2), track.filter.state(3)),
+                                    stats.point_count, stats.depth_median, stats.depth_min, stats.depth_max,
+                                    stats.bbox, stats.covariance});
+    }
+
+    // Tracks that lost their obstacle coast on their prediction for a few frames
+    for (auto it = trackers.begin(); it != trackers.end();) {
+        if (it->second.misses > context.tracking.max_misses) {
+            it = trackers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (context.roi_follow) {
+        followObstacles(context, result, frame.size());
+    }
+
+    if (gated) {
+        cache.valid = true;
+        cache.regions = regions;
+        cache.fast_threshold = quality.fast_threshold;
+        cache.max_keypoints = quality.max_keypoints;
+        cache.region_keypoints = std::move(region_keypoints);
+        cache.median_depth = result.median_depth;
+        cache.filtered_keypoint_count = result.filtered_keypoint_count;
+    }
+    endStage(STAGE_TRACKING);
+    pipelineMetrics().recordFrame(result, context.trackers.size());
+}
+
+void drawFrameResult(const PipelineContext& context, const FrameResult& result, cv::Mat& frame) {
+    // Obstacles are in cluster order, drawn back at their positions in the camera image
+    const ClusterSet& clusters = context.clusters;
+    const CameraModel& camera = context.camera;
+    for (int i = 0; i < clusters.count() && i < static_cast<int>(result.obstacles.size()); ++i) {
+        for (const cv::Point2f* pt = clusters.begin(i); pt != clusters.end(i); ++pt) {
+            circle(frame, camera.distort(*pt), 2, cv::Scalar(255, 0, 0), -1);
+        }
+
+        const TrackedObstacle& obstacle = result.obstacles[i];
+        circle(frame, camera.distort(obstacle.center), 6, cv::Scalar(0, 255, 0), 2);
+#if SHOW_PREDICTED_POSITION
+        auto track = context.trackers.find(obstacle.id);
+        if (track == context.trackers.end()) continue;
+        auto predicted = camera.distort(track->second.filter.getPredictedPosition());
+        circle(frame, predicted, 6, cv::Scalar(0, 0, 255), 2);
+        line(frame, camera.distort(obstacle.center), predicted, cv::Scalar(0, 255, 255), 2);
 #endif
+    }
 
-// FAST + BRIEF
-cv::Ptr<cv::FastFeatureDetector> fast = cv::FastFeatureDetector::create();
-cv::Ptr<cv::xfeatures2d::BriefDescriptorExtractor> brief = cv::xfeatures2d::BriefDescriptorExtractor::create();
+    for (const auto& roi : context.rois) {
+        rectangle(frame, roi, cv::Scalar(255, 255, 0), 2);
+    }
+}
 
-// ROI coordinates
-int x_min = 36000, y_min = 36000, x_max = 0, y_max = 0;
+void processFrame(PipelineContext& context, cv::Mat& frame, FrameResult& result) {
+    analyzeFrame(context, frame, result);
+    drawFrameResult(context, result, frame);
+}
 
+void configurePipeline(PipelineContext& context, const std::vector<cv::Rect>& rois) {
+    context.rois = rois;
+#if FOLLOW_ROI
+    context.roi_follow = true;
+#endif
+#if MOTION_GATING
+    context.motion.enabled = true;
+#endif
+#if EGO_MOTION
+    context.ego_motion.enabled = true;
+#endif
+}
 
-void processVideo(std::string &video_path) {
-    cv::VideoCapture video(video_path);
-    if (!video.isOpened()) {
+void processVideo(std::string &video_path, const std::vector<cv::Rect>& rois) {
+    enterThreadRole(ThreadRole::PIPELINE);
+    std::unique_ptr<FrameSource> source = openFrameSource(video_path);
+    if (!source) {
         std::cerr << "Error: Could not open video." << std::endl;
         return;
     }
 
     // Get video properties for the output video
-    int frame_width = static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH));
-    int frame_height = static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT));
-    double fps = video.get(cv::CAP_PROP_FPS);
+    int frame_width = source->frameSize().width;
+    int frame_height = source->frameSize().height;
+    double fps = source->fps() > 0 ? source->fps() : 30.0;
 
+#if WRITE_OUTPUT_VIDEO
     std::string output_video_path = getContentPath("output_", "media/video_results");
 
     // Create VideoWriter object
@@ -51,6 +489,7 @@ void processVideo(std::string &video_path) {
         std::cerr << "Error: Could not create output video file." << std::endl;
         return;
     }
+#endif
 
     // Create VideoWriter for filtered depth output
 //    cv::VideoWriter depth_grayscale_writer(
@@ -66,182 +505,153 @@ void processVideo(std::string &video_path) {
 //        return;
 //    }
 
-    std::unordered_map<int, Filter> trackers;
-    std::vector<long long> filter_times;
+    PipelineContext context;
+    configurePipeline(context, rois);
+    // Frames are borrowed from the source's buffers, which may belong to a producer or the driver,
+    // and analyzed in place. The overlays go onto a private copy that keeps its allocation across
+    // frames, made only when the frame is written or shown.
+    BorrowedFrame borrowed;
     cv::Mat frame;
     int frame_count = 0;
 
-    while (video.read(frame)) {
-#if MEASURE_TIME
-        auto start_time = get_current_time_fenced();
+#if ADAPTIVE_QUALITY
+    // Frame budget is the source frame period
+    FrameScheduler scheduler(1000.0 / fps);
+    // Files are played back at their frame rate, live sources pace themselves
+    bool pace_playback = !source->isLive();
 #endif
-        // ------ Depth estimation ------
-        cv::Mat depth_map = depth_estimation(frame);
 
-        // Convert to grayscale
-        cv::Mat depth_map_gray;
-        cv::cvtColor(depth_map, depth_map_gray, cv::COLOR_BGR2GRAY);
-
-        // Apply adaptive histogram equalization to enhance local contrast
-        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE();
-        clahe->setClipLimit(4.0);  // Controls contrast amplification
-        cv::Mat depth_enhanced;
-        clahe->apply(depth_map_gray, depth_enhanced);
-
-        // Apply bilateral filtering to reduce noise while preserving edges
-        cv::Mat depth_filtered;
-        cv::bilateralFilter(depth_enhanced, depth_filtered, 9, 75, 75);
-
-//        depth_grayscale_writer.write(depth_filtered);
+#if PUBLISH_OBSTACLES
+    ObstaclePublisher publisher;
+    publisher.open();
+#endif
 
-#if !MEASURE_TIME
-        cv::imshow("Original Depth", depth_map);
-        cv::imshow("Filtered Depth", depth_filtered);
+#if PUBLISH_METRICS
+    MetricsPublisher metrics_publisher;
+    if (metrics_publisher.open()) metrics_publisher.start();
+#endif
+    PipelineMetrics& metrics = pipelineMetrics();
+    uint64_t last_sequence = 0;
+
+#if BUILD_OCCUPANCY_MAP
+    OccupancyMap occupancy_map;
+    CameraIntrinsics intrinsics = CameraIntrinsics::fromFieldOfView(cv::Size(frame_width, frame_height),
+                                                                     OCCUPANCY_MAP_FOV_DEG);
+    CameraPose camera_pose;
 #endif
 
-        if (depth_filtered.type() != CV_32F) {
-            depth_filtered.convertTo(depth_filtered, CV_32F);
+    while (source->read(borrowed)) {
+#if ADAPTIVE_QUALITY
+        auto frame_start = get_current_time_fenced();
+#endif
+        // Gaps in the source's frame numbers are frames it dropped
+        metrics.frames_in.add();
+        if (frame_count > 0 && borrowed.sequence > last_sequence + 1) {
+            metrics.frames_dropped.add(borrowed.sequence - last_sequence - 1);
         }
+        last_sequence = borrowed.sequence;
+#if MEASURE_TIME
+        auto start_time = get_current_time_fenced();
+#endif
+        FrameResult result;
+        result.frame_index = frame_count++;
+        analyzeFrame(context, borrowed.image, result);
 
-        double minVal, maxVal;
-        cv::Point minLoc, maxLoc;
-        minMaxLoc(depth_filtered, &minVal, &maxVal, &minLoc, &maxLoc);
-//        std::cout << "min val: " << minVal << std::endl;
-//        std::cout << "max val: " << maxVal << std::endl;
-
-        // ------ Feature detection ------
-        cv::Mat gray;
-        cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-
-        std::vector<cv::KeyPoint> keypoints;
-        cv::Mat descriptors;
-        fast->detect(gray, keypoints);
-        brief->compute(gray, keypoints, descriptors);
-
-        // Apply NMS to filter out redundant keypoints
-        applyNMS(keypoints);
-
-        float median_depth = getMedianDepth(depth_filtered);
-
-        // Filter keypoints based on depth map
-        std::vector<cv::KeyPoint> filtered_keypoints;
-        for (auto& kp : keypoints) {
-            int x = static_cast<int>(kp.pt.x);
-            int y = static_cast<int>(kp.pt.y);
-
-            if (x < 0 || x >= depth_filtered.cols || y < 0 || y >= depth_filtered.rows)
-                continue;
-
-            // Get depth value from depth map
-            float depth_value = depth_filtered.at<float>(y, x);
-//            std::cout << "`depth_value` at " << x << " and " << y << ": " << depth_value << std::endl;
-
-            // Define a depth threshold range (example: 0.5m to 5m depth)
-            if (depth_value >= median_depth) {
-                filtered_keypoints.push_back(kp);
-            }
+#if ADAPTIVE_QUALITY
+        bool show = context.quality.display;
+#else
+        bool show = true;
+#endif
+        auto draw_start = get_current_time_fenced();
+        if (WRITE_OUTPUT_VIDEO || show) {
+            borrowed.image.copyTo(frame);
+            drawFrameResult(context, result, frame);
         }
+        [[maybe_unused]] long long draw_mcs = to_mcs(get_current_time_fenced() - draw_start);
+        borrowed.release();   // The source can reuse the buffer
 
-        std::vector<cv::Point2f> points;
-        for (auto& kp : filtered_keypoints) points.push_back(kp.pt);
-//        for (auto& kp : keypoints) points.push_back(kp.pt);
-
-        std::vector<float> knn_distances = calculateKnnDistances(points);
-        float eps = determineEps(knn_distances);
-        int minPts = 4;   // Rule of thumb: Use 4 for 2D points
-
-        auto clusters = clusterPoints(points, eps, minPts);
-
-        for (int i = 0; i < clusters.size(); ++i) {
-            cv::Point2f center(0, 0);
-            for (auto& pt : clusters[i]) center += pt;
-            center *= (1.0f / static_cast<double>(clusters[i].size()));
+#if PUBLISH_OBSTACLES
+        publisher.publish(result);
+#endif
 
-            if (trackers.find(i) == trackers.end()) {
-                trackers[i] = decltype(trackers)::mapped_type(center.x, center.y);
-            }
+#if BUILD_OCCUPANCY_MAP
+        MapUpdateStats map_stats = occupancy_map.integrateDepth(
+                inverseDepthToMetric(context.depth_filtered, OCCUPANCY_MAP_DEPTH_SCALE), intrinsics, camera_pose);
+#if MEASURE_TIME
+        std::cout << "Map update: " << map_stats.mcs << " mcs | " << map_stats.voxel_updates << " voxels | "
+                  << map_stats.blocks << " blocks" << std::endl;
+#endif
+#endif
 
-            trackers[i].predict(1.0f / 30);
-            trackers[i].update(center.x, center.y);
+//        depth_grayscale_writer.write(context.depth_filtered);
 
-            for (auto& pt : clusters[i]) {
-                circle(frame, pt, 2, cv::Scalar(255, 0, 0), -1);
-            }
-
-            circle(frame, center, 6, cv::Scalar(0, 255, 0), 2);
-#if SHOW_PREDICTED_POSITION
-            auto predicted = trackers[i].getPredictedPosition();
-            circle(frame, predicted, 6, cv::Scalar(0, 0, 255), 2);
-            line(frame, center, predicted, cv::Scalar(0, 255, 255), 2);
+#if !MEASURE_TIME
+        cv::imshow("Original Depth", context.depth_map);
+        cv::imshow("Filtered Depth", context.depth_filtered);
 #endif
-        }
 
+#if WRITE_OUTPUT_VIDEO
         // Write the frame to the output video
         output_video.write(frame);
+#endif
 
 #if MEASURE_TIME
         auto end_time = get_current_time_fenced();
         long long frame_time = to_mcs(end_time - start_time);
         std::string time_text = "Frame time: " + std::to_string(frame_time) + " mcs";
-        cv::putText(frame, time_text, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
-
-        frame_count++;
+        if (show) {
+            cv::putText(frame, time_text, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.8,
+                        cv::Scalar(255, 255, 255), 2);
+        }
 #endif
 
+#if ADAPTIVE_QUALITY
+        // Drawing counts towards the display, a dropped display leaves only the output video to draw for
+        result.timings.mcs[STAGE_DISPLAY] = draw_mcs;
+        if (show) {
+            auto display_start = get_current_time_fenced();
+            imshow("Tracking", frame);
+            result.timings.mcs[STAGE_DISPLAY] += to_mcs(get_current_time_fenced() - display_start);
+        }
+        metrics.stage_latency[STAGE_DISPLAY].observe(result.timings.mcs[STAGE_DISPLAY]);
+        scheduler.update(result.frame_index, result.timings, context.quality);
+
+        // Wait out the rest of the frame period, as the file would play
+        int delay_ms = 1;
+        if (pace_playback) {
+            delay_ms = std::max(1, static_cast<int>(1000.0 / fps - to_ms(get_current_time_fenced() - frame_start)));
+        }
+        if (cv::waitKey(delay_ms) == 27) break;
+#else
         imshow("Tracking", frame);
         if (cv::waitKey(30) == 27) break;
+#endif
     }
 
-    video.release();
+    borrowed.release();
     cv::destroyAllWindows();
 }
 
-void mouseCallback(int event, int x, int y, int, void* userdata) {
-    auto* framePtr = static_cast<cv::Mat*>(userdata);
-
-    if (event == cv::EVENT_LBUTTONDOWN) {
-        x_min = cv::min(x, x_min);
-        y_min = cv::min(y, y_min);
-        x_max = cv::max(x, x_max);
-        y_max = cv::max(y, y_max);
-
-        rectangle(*framePtr, cv::Point(x_min, y_min), cv::Point(x_max, y_max), cv::Scalar(255, 255, 0), 2);
-        imshow("Video Player", *framePtr);
-    }
-}
-
 void selectROI(std::string &video_path) {
-    cv::VideoCapture video(video_path);
-    if (!video.isOpened()) {
-        std::cerr << "Error: Could not open video." << std::endl;
-        return;
-    }
-
+    std::vector<cv::Rect> rois;
+#if SELECT_ROI
     cv::Mat frame;
-    video.read(frame);
+    {
+        // Live sources are opened twice, the first frame is only used for the selection
+        std::unique_ptr<FrameSource> source = openFrameSource(video_path);
+        BorrowedFrame first;
+        if (!source || !source->read(first)) {
+            std::cerr << "Error: Could not open video." << std::endl;
+            return;
+        }
+        frame = first.image.clone();
+    }
 
-#if SELECT_ROI
-    cv::namedWindow("Video Player");
-    setMouseCallback("Video Player", mouseCallback, &frame);
-    imshow("Video Player", frame);
-    cv::waitKey(0);
-
-    cv::Rect roi(x_min, y_min, x_max - x_min, y_max - y_min);
-    cv::Mat image_roi = frame(roi);
-    imshow("Selected ROI", image_roi);
-    cv::waitKey(500);
-#else
-    // When not selecting ROI, use the entire frame
-    cv::Rect roi(0, 0, frame.cols, frame.rows);
-    cv::Mat image_roi = frame(roi);
+    // Select one or more ROIs: confirm each with SPACE/ENTER, finish with ESC
+    cv::selectROIs("Video Player", frame, rois);
+    cv::destroyWindow("Video Player");
 #endif
+    // Without ROIs the full frame is processed
 
-    cv::Mat gray_roi;
-    cvtColor(image_roi, gray_roi, cv::COLOR_BGR2GRAY);
-    std::vector<cv::KeyPoint> roiKeypoints;
-    cv::Mat roiDescriptors;
-    fast->detect(gray_roi, roiKeypoints);
-    brief->compute(gray_roi, roiKeypoints, roiDescriptors);
-
-    processVideo(video_path);
+    processVideo(video_path, rois);
 }
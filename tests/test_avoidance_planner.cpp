@@ -0,0 +1,107 @@
+#include <iostream>
+#include "avoidance_planner.hpp"
+#include "test_utils.hpp"
+
+// Fly scenarios against the planner: free space, a static obstacle ahead, a crossing obstacle,
+// a blocked corridor and the compute budget; then place a tracked obstacle seen by a moving camera.
+int main() {
+    int failures = 0;
+
+    AvoidancePlannerConfig config;
+    config.budget_mcs = 1000000;   // Deterministic: every candidate is evaluated
+    const DroneState cruising{{0.0f, 2.0f, 0.0f}, {0.0f, 0.0f, 3.0f}};
+    const Eigen::Vector3f goal(0.0f, 2.0f, 50.0f);
+    PlannerResult result;
+
+    // ------ Free space ------
+    AvoidancePlanner planner(config);
+    planner.setObstacles({}, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    planner.plan(cruising, goal, result);
+    check(failures, result.collision_free && !result.braking, "free space is flown");
+    check(failures, std::abs(result.target.x) < 1e-3f && std::abs(result.target.y - 2.0f) < 1e-3f &&
+          result.target.z > 1.0f,
+          "target points at the goal");
+    check(failures, result.evaluated == config.max_candidates && !result.budget_exhausted,
+          "all candidates fit the budget");
+    check(failures, static_cast<int>(result.waypoints.size()) == config.waypoint_count &&
+          result.waypoints.back().z > result.waypoints.front().z, "waypoints follow the rollout");
+
+    // ------ Static obstacle ahead ------
+    PlannerObstacle pillar;
+    pillar.position = Eigen::Vector3f(0.0f, 2.0f, 4.0f);
+    pillar.radius = 0.8f;
+    planner.reset();
+    planner.setObstacles({pillar}, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    planner.plan(cruising, goal, result);
+    check(failures, result.collision_free && result.min_clearance >= 0.0f, "obstacle ahead is avoided");
+    check(failures, std::abs(result.target.x) > 0.1f || std::abs(result.target.y - 2.0f) > 0.1f,
+          "target leaves the straight line");
+
+    // ------ Crossing obstacle, straight ahead only at the time the drone gets there ------
+    PlannerObstacle crossing;
+    crossing.position = Eigen::Vector3f(-3.0f, 2.0f, 3.0f);
+    crossing.velocity = Eigen::Vector3f(3.0f, 0.0f, 0.0f);
+    crossing.radius = 0.5f;
+    planner.reset();
+    planner.setObstacles({crossing}, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    planner.plan(cruising, goal, result);
+    check(failures, result.collision_free, "crossing obstacle is avoided");
+    check(failures, result.target.x < -0.1f || result.braking, "drone passes behind the crossing obstacle");
+
+    // ------ Blocked corridor: a wall across every direction, close enough that only braking is safe ------
+    std::vector<PlannerObstacle> wall;
+    for (float x = -6.0f; x <= 6.0f; x += 0.5f) {
+        for (float y = 0.0f; y <= 5.0f; y += 0.5f) {
+            PlannerObstacle brick;
+            brick.position = Eigen::Vector3f(x, y, 1.8f);
+            brick.radius = 0.4f;
+            wall.push_back(brick);
+        }
+    }
+    AvoidancePlannerConfig wall_config = config;
+    wall_config.max_obstacles = static_cast<int>(wall.size());
+    AvoidancePlanner wall_planner(wall_config);
+    wall_planner.setObstacles(wall, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    wall_planner.plan(cruising, goal, result);
+    check(failures, result.collision_free && result.braking, "blocked corridor brakes");
+
+    // ------ Budget ------
+    AvoidancePlannerConfig tight = config;
+    tight.budget_mcs = 0;
+    AvoidancePlanner tight_planner(tight);
+    tight_planner.setObstacles({pillar}, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    tight_planner.plan(cruising, goal, result);
+    check(failures, result.evaluated == 3 && result.budget_exhausted, "no budget still evaluates the fixed candidates");
+    check(failures, result.collision_free && result.braking, "no budget falls back to braking before the obstacle");
+
+    AvoidancePlannerConfig limited = config;
+    limited.max_obstacles = 2;
+    AvoidancePlanner limited_planner(limited);
+    PlannerObstacle far = pillar;
+    far.position.z() = 40.0f;
+    limited_planner.setObstacles({far, pillar, far, crossing}, Eigen::Vector3f(0.0f, 2.0f, 0.0f));
+    limited_planner.plan(cruising, goal, result);
+    check(failures, result.collision_free &&
+          (std::abs(result.target.x) > 0.1f || std::abs(result.target.y - 2.0f) > 0.1f),
+          "closest obstacles are kept");
+
+    // ------ Tracked obstacle from a camera moving forward at 2 m/s ------
+    // Static point 5 m ahead, 1 m right and 0.5 m down of the camera: it drifts outwards in the image
+    CameraIntrinsics intrinsics{100.0f, 100.0f, 160.0f, 120.0f};
+    CameraPose pose;
+    pose.translation = Eigen::Vector3f(10.0f, 0.0f, 0.0f);
+    Eigen::Vector3f drone_velocity(0.0f, 0.0f, 2.0f);
+    PlannerObstacle tracked = obstacleFromTrack(cv::Point2f(180.0f, 130.0f), cv::Point2f(8.0f, 4.0f),
+                                                cv::Rect(170, 120, 20, 10), 5.0f, intrinsics, pose, drone_velocity);
+    check(failures, (tracked.position - Eigen::Vector3f(11.0f, 0.5f, 5.0f)).norm() < 1e-4f,
+          "centroid is back-projected");
+    check(failures, tracked.velocity.norm() < 1e-4f, "image motion of the camera is removed");
+    check(failures, std::abs(tracked.radius - 0.5f) < 1e-4f, "radius from the box");
+
+    PlannerObstacle mover = obstacleFromTrack(cv::Point2f(160.0f, 120.0f), cv::Point2f(20.0f, 0.0f),
+                                              cv::Rect(150, 110, 20, 20), 5.0f, intrinsics, pose, drone_velocity);
+    check(failures, (mover.velocity - Eigen::Vector3f(1.0f, 0.0f, 0.0f)).norm() < 1e-4f,
+          "own motion of the obstacle remains");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <cstdio>
+#include "camera_model.hpp"
+#include "test_utils.hpp"
+
+// Largest distance between a point and its distorted-then-undistorted image over a grid of the frame
+static float roundTripError(const CameraModel& camera, const cv::Size& frame_size) {
+    float max_error = 0.0f;
+    for (int y = 0; y < frame_size.height; y += 7) {
+        for (int x = 0; x < frame_size.width; x += 7) {
+            cv::Point2f point(static_cast<float>(x) + 0.3f, static_cast<float>(y) + 0.6f);
+            cv::Point2f distorted = camera.distort(point);
+            if (distorted.x < 0 || distorted.y < 0 || distorted.x > static_cast<float>(frame_size.width - 1) ||
+                distorted.y > static_cast<float>(frame_size.height - 1)) continue;
+            max_error = std::max(max_error, static_cast<float>(cv::norm(camera.undistort(distorted) - point)));
+        }
+    }
+    return max_error;
+}
+
+// Write a calibration file, load it and check the table against the lens model, at the
+// calibration resolution and at half resolution.
+int main() {
+    int failures = 0;
+
+    const cv::Size size(1280, 720);
+    const std::string path = "test_camera_model_calibration.yml";
+    {
+        cv::FileStorage storage(path, cv::FileStorage::WRITE);
+        storage << "image_width" << size.width << "image_height" << size.height;
+        storage << "camera_matrix" << cv::Mat(cv::Matx33d(700, 0, 640, 0, 700, 360, 0, 0, 1));
+        storage << "distortion_coefficients" << cv::Mat(cv::Matx<double, 1, 5>(-0.28, 0.08, 0.0005, -0.0008, -0.01));
+    }
+
+    CameraCalibration calibration;
+    check(failures, !loadCameraCalibration("missing_calibration.yml", calibration) && calibration.empty(),
+          "missing file is reported");
+    check(failures, loadCameraCalibration(path, calibration) && calibration.distortion.size() == 5 &&
+          calibration.image_size == size && calibration.camera_matrix(0, 2) == 640, "calibration is loaded");
+    std::remove(path.c_str());
+
+    CameraModel camera;
+    camera.update(size);
+    cv::Point2f corner(10.0f, 10.0f);
+    check(failures, !camera.enabled() && camera.undistort(corner) == corner && camera.distort(corner) == corner,
+          "without a calibration points are unchanged");
+
+    setCameraCalibration(calibration);
+    camera.update(size);
+    check(failures, camera.enabled(), "calibration is picked up on the next frame");
+    check(failures, camera.lutBytes() < static_cast<size_t>(size.area()) / 4,
+          "table is much smaller than a per-pixel remap map");
+    cv::Point2f center(640.0f, 360.0f);
+    check(failures, cv::norm(camera.undistort(center) - center) < 1e-3, "principal point stays in place");
+    cv::Point2f undistorted_corner = camera.undistort(corner);
+    check(failures, undistorted_corner.x < corner.x && undistorted_corner.y < corner.y,
+          "barrel distortion is pushed outwards");
+
+    float error = roundTripError(camera, size);
+    std::cout << "Round trip error: " << error << " px" << std::endl;
+    // Bilinear interpolation over 8 px cells, the error peaks in the corners
+    check(failures, error < 0.1f, "table matches the lens model");
+
+    cv::Size half(size.width / 2, size.height / 2);
+    camera.update(half);
+    check(failures, cv::norm(camera.undistort(center * 0.5f) - center * 0.5f) < 1e-3,
+          "intrinsics are scaled to the frame");
+    check(failures, roundTripError(camera, half) < 0.25f, "table matches the lens model at half resolution");
+
+    setCameraCalibration(CameraCalibration());
+    camera.update(half);
+    check(failures, !camera.enabled(), "clearing the calibration disables the mapping");
+
+    return failures == 0 ? 0 : -1;
+}
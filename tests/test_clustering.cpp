@@ -0,0 +1,72 @@
+#include <iostream>
+#include "feature_detector.hpp"
+#include "test_utils.hpp"
+
+// Two dense blobs, one isolated point and a bridge point within reach of both blobs: check the
+// flat labels, the grouped points and the one-pass statistics.
+int main() {
+    int failures = 0;
+    auto near = [](float a, float b) { return std::abs(a - b) < 1e-3f; };
+
+    std::vector<cv::Point2f> points;
+    std::vector<float> depths;
+    for (int i = 0; i < 9; ++i) {
+        points.emplace_back(100.0f + static_cast<float>(i % 3), 50.0f + static_cast<float>(i / 3));
+        depths.push_back(static_cast<float>(9 - i));
+    }
+    points.emplace_back(400.0f, 400.0f);   // Noise
+    depths.push_back(99.0f);
+    for (int i = 0; i < 4; ++i) {
+        points.emplace_back(110.0f + static_cast<float>(i % 2), 50.0f + static_cast<float>(i / 2));
+        depths.push_back(20.0f);
+    }
+    points.emplace_back(106.0f, 48.0f);    // Border point of both blobs
+    depths.push_back(30.0f);
+
+    ClusterSet clusters;
+    clusterPoints(points, 4.5f, 4, clusters, depths);
+    check(failures, clusters.count() == 2, "two clusters are found");
+    check(failures, clusters.labels.size() == points.size() && clusters.labels[9] == -1, "isolated point is noise");
+    check(failures, clusters.labels[0] == 0 && clusters.labels[10] == 1, "clusters are numbered in input order");
+    check(failures, clusters.labels[14] == 0, "border point joins the first cluster that reaches it");
+
+    int grouped = clusters.count() > 0 ? clusters.offsets.back() : 0;
+    check(failures, grouped == 14 && clusters.points.size() == 14 && clusters.size(0) == 10 && clusters.size(1) == 4,
+          "every clustered point is stored once");
+    bool grouped_by_label = true;
+    for (int c = 0; c < clusters.count(); ++c) {
+        for (int k = clusters.offsets[c]; k < clusters.offsets[c + 1]; ++k) {
+            grouped_by_label &= clusters.labels[clusters.indices[k]] == c &&
+                                clusters.points[k] == points[clusters.indices[k]];
+        }
+    }
+    check(failures, grouped_by_label, "points are grouped by label with their input index");
+    bool depths_aligned = clusters.depths.size() == clusters.points.size();
+    for (size_t k = 0; depths_aligned && k < clusters.depths.size(); ++k) {
+        depths_aligned = clusters.depths[k] == depths[clusters.indices[k]];
+    }
+    check(failures, depths_aligned, "grouped depths stay aligned with their points");
+
+    if (clusters.count() == 2) {
+        const ClusterStats& blob = clusters.stats[1];
+        check(failures, blob.point_count == 4 && near(blob.centroid.x, 110.5f) && near(blob.centroid.y, 50.5f),
+              "centroid is the mean of the points");
+        check(failures, near(blob.covariance(0, 0), 0.25f) && near(blob.covariance(1, 1), 0.25f) &&
+              near(blob.covariance(0, 1), 0.0f), "covariance of a unit square");
+        check(failures, blob.bbox == cv::boundingRect(std::vector<cv::Point2f>(clusters.begin(1), clusters.end(1))),
+              "bounding box matches cv::boundingRect");
+
+        const ClusterStats& first = clusters.stats[0];
+        check(failures, near(first.depth_min, 1.0f) && near(first.depth_max, 30.0f) && near(first.depth_median, 6.0f),
+              "depth statistics over the cluster points");
+        check(failures, first.bbox == cv::Rect(100, 48, 7, 5), "border point widens the box");
+    }
+
+    // Reuse with fewer points and no depths
+    std::vector<cv::Point2f> sparse(points.begin(), points.begin() + 3);
+    clusterPoints(sparse, 4.5f, 4, clusters);
+    check(failures, clusters.count() == 0 && clusters.points.empty() && clusters.stats.empty(),
+          "a reused set is replaced by the new result");
+
+    return failures == 0 ? 0 : -1;
+}
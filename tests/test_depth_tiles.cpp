@@ -0,0 +1,85 @@
+#include <iostream>
+#include "depth_estimation.hpp"
+#include "test_utils.hpp"
+
+static const int WIRE_X = 400;
+
+// Smooth relative inverse depth with a one pixel wide "wire" in front of it
+static cv::Mat syntheticDepth(const cv::Size& size) {
+    cv::Mat depth(size, CV_32F);
+    for (int y = 0; y < size.height; ++y) {
+        for (int x = 0; x < size.width; ++x) {
+            float background = 100.0f + 50.0f * static_cast<float>(x) / static_cast<float>(size.width) +
+                               30.0f * std::sin(static_cast<float>(y) / 60.0f);
+            depth.at<float>(y, x) = background + (x == WIRE_X ? 80.0f : 0.0f);
+        }
+    }
+    return depth;
+}
+
+// Mean height of the wire above the depth 10 px to either side, in a map of the given width
+static double wireContrast(const cv::Mat& depth, int frame_width) {
+    int column = cvRound((WIRE_X + 0.5) * depth.cols / frame_width - 0.5);
+    cv::Mat profile;
+    cv::reduce(depth, profile, 0, cv::REDUCE_AVG);
+    double contrast = 0.0;
+    for (int offset = -1; offset <= 1; ++offset) {
+        double background = 0.5 * (profile.at<float>(column - 10) + profile.at<float>(column + 10));
+        contrast = std::max(contrast, profile.at<float>(column + offset) - background);
+    }
+    return contrast;
+}
+
+// Blend tiles of a known depth map, each with its own scale and shift as a relative depth
+// model would return them, and check the result is seamless and keeps the thin wire.
+int main() {
+    const cv::Size size(960, 540);
+    const cv::Size model_size(256, 256);
+    int failures = 0;
+
+    // ------ Tiling ------
+    std::vector<cv::Rect> tiles = depthTiles(size, 3);
+    cv::Mat coverage = cv::Mat::zeros(size, CV_8U);
+    for (const auto& tile : tiles) coverage(tile).setTo(1);
+    check(failures, tiles.size() == 9 && cv::countNonZero(coverage) == size.area(), "3x3 tiles cover the frame");
+    check(failures, tiles[1].x < tiles[0].br().x && tiles[8].br() == cv::Point(size.width, size.height),
+          "tiles overlap and the last one ends at the border");
+    check(failures, depthTiles(size, 1).front() == cv::Rect(cv::Point(0, 0), size), "one tile is the whole frame");
+
+    // ------ Blending ------
+    cv::Mat truth = syntheticDepth(size);
+    cv::Mat coarse;
+    cv::resize(truth, coarse, model_size, 0, 0, cv::INTER_AREA);
+
+    std::vector<cv::Mat> tile_depths;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        cv::Mat tile_depth;
+        cv::resize(truth(tiles[i]), tile_depth, model_size, 0, 0, cv::INTER_AREA);
+        tile_depth.convertTo(tile_depth, CV_32F, 0.5 + 0.3 * static_cast<double>(i), -20.0 + 7.0 * static_cast<double>(i));
+        tile_depths.push_back(tile_depth);
+    }
+
+    cv::Size output_size(std::min(size.width, size.width * model_size.width / tiles[0].width),
+                         std::min(size.height, size.height * model_size.height / tiles[0].height));
+    cv::Mat blended = blendDepthTiles(coarse, tiles, tile_depths, size, output_size);
+    check(failures, blended.size() == output_size && output_size.width > 2 * model_size.width,
+          "blended map has more than twice the model resolution");
+
+    cv::Mat expected, upsampled;
+    cv::resize(truth, expected, output_size, 0, 0, cv::INTER_AREA);
+    cv::resize(coarse, upsampled, output_size, 0, 0, cv::INTER_LINEAR);
+    double mean_error = cv::norm(blended, expected, cv::NORM_L1) / static_cast<double>(output_size.area());
+    double max_error = cv::norm(blended, expected, cv::NORM_INF);
+    std::cout << "  Mean error: " << mean_error << " | Max error: " << max_error << std::endl;
+    check(failures, mean_error < 0.5 && max_error < 2.0, "scale/shift alignment removes the seams between tiles");
+
+    double expected_contrast = wireContrast(expected, size.width);
+    double blended_contrast = wireContrast(blended, size.width);
+    double coarse_contrast = wireContrast(upsampled, size.width);
+    std::cout << "  Wire contrast: " << blended_contrast << " tiled, " << coarse_contrast << " whole frame, "
+              << expected_contrast << " expected" << std::endl;
+    check(failures, blended_contrast > 0.9 * expected_contrast && coarse_contrast < 0.8 * expected_contrast,
+          "thin obstacle survives in the tiled depth only");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include "ego_motion.hpp"
+#include "kalman.hpp"
+#include "test_utils.hpp"
+
+static const cv::Size FRAME_SIZE(640, 480);
+
+// Random features with random 256-bit descriptors
+static void randomFeatures(cv::RNG& rng, int count, std::vector<cv::Point2f>& points, cv::Mat& descriptors) {
+    points.clear();
+    descriptors.create(count, 32, CV_8U);
+    for (int i = 0; i < count; ++i) {
+        points.emplace_back(rng.uniform(0.0f, static_cast<float>(FRAME_SIZE.width)),
+                            rng.uniform(0.0f, static_cast<float>(FRAME_SIZE.height)));
+        for (int b = 0; b < descriptors.cols; ++b) {
+            descriptors.at<uchar>(i, b) = static_cast<uchar>(rng.uniform(0, 256));
+        }
+    }
+}
+
+// The features of the next frame: most move with the camera and keep their descriptor up to a few flipped bits,
+// the rest are independent (moving obstacles) and end up as outliers
+static void moveFeatures(cv::RNG& rng, const EgoMotion& camera, float outlier_share, std::vector<cv::Point2f>& points,
+                         cv::Mat& descriptors) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (rng.uniform(0.0f, 1.0f) < outlier_share) {
+            points[i] += cv::Point2f(rng.uniform(-40.0f, 40.0f), rng.uniform(-40.0f, 40.0f));
+        } else {
+            points[i] = camera.apply(points[i]);
+        }
+        for (int flip = 0; flip < 4; ++flip) {
+            int bit = rng.uniform(0, descriptors.cols * 8);
+            descriptors.at<uchar>(static_cast<int>(i), bit / 8) ^= static_cast<uchar>(1 << (bit % 8));
+        }
+    }
+}
+
+// Largest distance between two motions over a grid of the frame
+static float transformError(const EgoMotion& a, const EgoMotion& b) {
+    float max_error = 0.0f;
+    for (int y = 0; y <= FRAME_SIZE.height; y += 40) {
+        for (int x = 0; x <= FRAME_SIZE.width; x += 40) {
+            cv::Point2f point(static_cast<float>(x), static_cast<float>(y));
+            max_error = std::max(max_error, static_cast<float>(cv::norm(a.apply(point) - b.apply(point))));
+        }
+    }
+    return max_error;
+}
+
+// Estimate known camera motions between synthetic feature sets, then move a track with one.
+int main() {
+    int failures = 0;
+
+    // Rotation by 3 deg, 2 % zoom and a pan
+    EgoMotion camera;
+    float angle = 3.0f * static_cast<float>(CV_PI) / 180.0f, scale = 1.02f;
+    camera.transform = cv::Matx33f(scale * std::cos(angle), -scale * std::sin(angle), 12.0f,
+                                   scale * std::sin(angle), scale * std::cos(angle), -7.0f,
+                                   0.0f, 0.0f, 1.0f);
+
+    cv::RNG rng(7);
+    std::vector<cv::Point2f> points;
+    cv::Mat descriptors;
+    randomFeatures(rng, 600, points, descriptors);
+
+    EgoMotionSettings settings;
+    settings.enabled = true;
+    EgoMotionEstimator estimator;
+    EgoMotion motion;
+    estimator.update(points, descriptors, settings, motion);
+    check(failures, !motion.valid && motion.matches == 0, "first frame has no reference");
+
+    std::vector<cv::Point2f> reference_points = points;
+    cv::Mat reference_descriptors = descriptors.clone();
+    moveFeatures(rng, camera, 0.3f, points, descriptors);
+    estimator.update(points, descriptors, settings, motion);
+    std::cout << "Affine: " << motion.matches << " matches, " << motion.inliers << " inliers, error "
+              << transformError(motion, camera) << " px" << std::endl;
+    check(failures, motion.valid && motion.inliers > 300 && motion.inliers < motion.matches,
+          "affine motion is estimated");
+    check(failures, transformError(motion, camera) < 0.05f, "affine transform matches the camera motion");
+
+    // Hypotheses are drawn per batch, not per thread
+    int threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+    EgoMotionEstimator single_thread;
+    EgoMotion single;
+    single_thread.update(reference_points, reference_descriptors, settings, single);
+    single_thread.update(points, descriptors, settings, single);
+    cv::setNumThreads(threads);
+    check(failures, single.transform == motion.transform && single.inliers == motion.inliers,
+          "estimate does not depend on the thread count");
+
+    // Perspective of a camera yawing in front of a plane
+    EgoMotion perspective;
+    perspective.transform = cv::Matx33f(1.01f, 0.02f, 9.0f,
+                                        -0.01f, 0.99f, 4.0f,
+                                        4e-5f, -2e-5f, 1.0f);
+    settings.model = EgoMotionModel::HOMOGRAPHY;
+    estimator.reset();
+    randomFeatures(rng, 600, points, descriptors);
+    estimator.update(points, descriptors, settings, motion);
+    moveFeatures(rng, perspective, 0.3f, points, descriptors);
+    estimator.update(points, descriptors, settings, motion);
+    std::cout << "Homography: " << motion.inliers << " inliers, error " << transformError(motion, perspective)
+              << " px" << std::endl;
+    check(failures, motion.valid && transformError(motion, perspective) < 0.05f,
+          "homography matches the camera motion");
+
+    EgoMotion moved;
+    moved.transform = cv::Matx33f(1, 0, 200, 0, 1, 0, 0, 0, 1);
+    moveFeatures(rng, moved, 0.0f, points, descriptors);
+    estimator.update(points, descriptors, settings, motion);
+    check(failures, !motion.valid, "motion beyond the search radius is not estimated");
+
+    settings.model = EgoMotionModel::AFFINE;
+    randomFeatures(rng, 10, points, descriptors);
+    estimator.update(points, descriptors, settings, motion);
+    estimator.update(points, descriptors, settings, motion);
+    check(failures, !motion.valid && motion.matches == 10, "too few features give no estimate");
+
+    // Jacobian against finite differences
+    cv::Point2f probe(500.0f, 100.0f);
+    cv::Matx22f jacobian = perspective.jacobian(probe);
+    cv::Point2f dx = (perspective.apply(probe + cv::Point2f(0.5f, 0.0f)) -
+                      perspective.apply(probe - cv::Point2f(0.5f, 0.0f)));
+    cv::Point2f dy = (perspective.apply(probe + cv::Point2f(0.0f, 0.5f)) -
+                      perspective.apply(probe - cv::Point2f(0.0f, 0.5f)));
+    check(failures, std::abs(jacobian(0, 0) - dx.x) < 1e-3f && std::abs(jacobian(1, 0) - dx.y) < 1e-3f &&
+          std::abs(jacobian(0, 1) - dy.x) < 1e-3f && std::abs(jacobian(1, 1) - dy.y) < 1e-3f,
+          "jacobian is the derivative of the motion");
+
+    // A track moving right, seen by a camera rolling by 90 deg around the track's position
+    ExtendedKalmanFilter filter(100.0f, 50.0f);
+    filter.state(2) = 30.0f;
+    EgoMotion roll;
+    roll.transform = cv::Matx33f(0, -1, 150, 1, 0, -50, 0, 0, 1);
+    cv::Point2f position = filter.getPredictedPosition();
+    filter.warp(roll.apply(position), roll.jacobian(position));
+    check(failures, cv::norm(filter.getPredictedPosition() - cv::Point2f(100.0f, 50.0f)) < 1e-4 &&
+          std::abs(filter.state(2)) < 1e-4f && std::abs(filter.state(3) - 30.0f) < 1e-4f,
+          "track velocity turns with the camera");
+
+    return failures == 0 ? 0 : -1;
+}
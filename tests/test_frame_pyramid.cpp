@@ -0,0 +1,87 @@
+#include <iostream>
+#include "frame_pyramid.hpp"
+#include "inference_engine.hpp"
+#include "test_utils.hpp"
+
+// Gradient frame with some texture, so conversions and resizes produce distinct pixels
+static cv::Mat texturedFrame(const cv::Size& size, int seed) {
+    cv::Mat frame(size, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    return frame;
+}
+
+static bool sameImage(const cv::Mat& a, const cv::Mat& b) {
+    return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+// Build the shared views of two frames and check they match the per-stage conversions they
+// replace, are computed once per frame and keep their buffers from frame to frame.
+int main() {
+    const cv::Size size(640, 480);
+    int failures = 0;
+
+    FramePyramid pyramid(3);
+    cv::Mat frame = texturedFrame(size, 1);
+    pyramid.update(frame);
+
+    // ------ Gray ------
+    cv::Mat expected_gray;
+    cv::cvtColor(frame, expected_gray, cv::COLOR_BGR2GRAY);
+    cv::Rect roi(100, 80, 200, 160);
+    check(failures, sameImage(pyramid.gray(roi), expected_gray(roi)), "ROI gray matches cvtColor of the ROI");
+    check(failures, pyramid.computeCount() == 1, "only the ROI is converted");
+
+    cv::Rect inner(120, 100, 50, 50);
+    pyramid.gray(inner);
+    check(failures, pyramid.computeCount() == 1, "region inside a converted ROI is a view");
+
+    cv::Mat full_gray = pyramid.gray();
+    check(failures, sameImage(full_gray, expected_gray), "full-frame gray matches cvtColor");
+    const uchar* gray_data = full_gray.data;
+
+    // ------ Pyramid ------
+    const std::vector<cv::Mat>& levels = pyramid.grayPyramid();
+    check(failures, levels.size() == 4 && levels[1].size() == cv::Size(320, 240) &&
+          levels[3].size() == cv::Size(80, 60),
+          "pyramid has halving levels");
+    uint64_t computed = pyramid.computeCount();
+    pyramid.grayPyramid();
+    check(failures, pyramid.computeCount() == computed, "pyramid is built once per frame");
+
+    // ------ Model input ------
+    cv::Mat expected_resized;
+    cv::resize(frame, expected_resized, cv::Size(256, 256), 0, 0, cv::INTER_LINEAR);
+    const cv::Mat& resized = pyramid.resized(cv::Rect(cv::Point(0, 0), size), cv::Size(256, 256));
+    check(failures, sameImage(resized, expected_resized), "resized view matches cv::resize");
+    computed = pyramid.computeCount();
+    pyramid.resized(cv::Rect(cv::Point(0, 0), size), cv::Size(256, 256));
+    check(failures, pyramid.computeCount() == computed, "resized view is cached for the frame");
+
+    // Fused preprocessing gives the blob of blobFromImage + per-channel normalization
+    const ModelDescriptor& model = getModelDescriptor(DepthModel::MIDAS_SMALL);
+    cv::Mat reference = cv::dnn::blobFromImage(frame, 1.0 / 255.0, model.input_size, cv::Scalar(0, 0, 0),
+                                               model.swap_rb, false);
+    for (int c = 0; c < 3; ++c) {
+        cv::Mat plane(model.input_size, CV_32F, reference.ptr<float>(0, c));
+        plane.convertTo(plane, CV_32F, 1.0 / model.std[c], -model.mean[c] / model.std[c]);
+    }
+    cv::Mat blob;
+    preprocessResizedInput(resized, model, blob);
+    check(failures, blob.size == reference.size && cv::norm(blob, reference, cv::NORM_INF) < 1e-4,
+          "fused preprocessing matches blobFromImage");
+
+    // ------ Next frame ------
+    cv::Mat next = texturedFrame(size, 2);
+    pyramid.update(next);
+    cv::Mat next_gray;
+    cv::cvtColor(next, next_gray, cv::COLOR_BGR2GRAY);
+    cv::Mat view = pyramid.gray();
+    check(failures, sameImage(view, next_gray), "views are rebuilt for the next frame");
+    check(failures, view.data == gray_data, "gray buffer is reused across frames");
+    const cv::Mat& next_resized = pyramid.resized(cv::Rect(cv::Point(0, 0), size), cv::Size(256, 256));
+    check(failures, &next_resized == &resized && !sameImage(next_resized, expected_resized),
+          "resized buffer is reused across frames");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,71 @@
+#include <sstream>
+#include "frame_scheduler.hpp"
+#include "test_utils.hpp"
+
+static const double BUDGET_MS = 33.0;
+
+// Timings of one frame with the given depth and feature times
+static StageTimings frameTimings(double depth_ms, double features_ms) {
+    StageTimings timings;
+    timings.mcs[STAGE_DEPTH] = static_cast<long long>(depth_ms * 1000.0);
+    timings.mcs[STAGE_FEATURES] = static_cast<long long>(features_ms * 1000.0);
+    timings.mcs[STAGE_CLUSTERING] = 1000;
+    timings.mcs[STAGE_TRACKING] = 500;
+    timings.mcs[STAGE_DISPLAY] = 500;
+    return timings;
+}
+
+static void run(FrameScheduler& scheduler, int& frame_index, int frames, const StageTimings& timings,
+                QualitySettings& quality) {
+    for (int i = 0; i < frames; ++i) scheduler.update(frame_index++, timings, quality);
+}
+
+static bool isDefault(const QualitySettings& quality) {
+    QualitySettings defaults;
+    return quality.fast_threshold == defaults.fast_threshold && quality.max_keypoints == defaults.max_keypoints &&
+           quality.depth_refresh_interval == defaults.depth_refresh_interval && quality.display == defaults.display;
+}
+
+// Feed synthetic stage timings to the scheduler: over budget the knob of the most expensive stage
+// is stepped down, with headroom the decisions are undone until the defaults are back.
+int main() {
+    int failures = 0;
+    std::ostringstream log;
+
+    FrameScheduler scheduler(BUDGET_MS, log);
+    QualitySettings quality;
+    int frame_index = 0;
+
+    run(scheduler, frame_index, 100, frameTimings(10.0, 10.0), quality);
+    check(failures, isDefault(quality) && log.str().empty(), "quality stays at the defaults within budget");
+
+    // Depth dominates: the depth refresh is stretched first
+    run(scheduler, frame_index, 6, frameTimings(40.0, 5.0), quality);
+    check(failures, quality.depth_refresh_interval == 2 && quality.max_keypoints == 0,
+          "depth refresh is skipped first when depth is over budget");
+    run(scheduler, frame_index, 100, frameTimings(40.0, 5.0), quality);
+    check(failures, quality.depth_refresh_interval == 4 && quality.max_keypoints > 0,
+          "other knobs step down once the depth refresh is at its limit");
+    check(failures, log.str().find("over budget") != std::string::npos, "decisions are logged");
+
+    run(scheduler, frame_index, 1000, frameTimings(5.0, 5.0), quality);
+    check(failures, isDefault(quality), "quality steps back up to the defaults with headroom");
+    check(failures, log.str().find("headroom") != std::string::npos, "restores are logged");
+
+    // Features dominate: the keypoint budget goes first, a single spike acts at once
+    FrameScheduler spike_scheduler(BUDGET_MS, log);
+    QualitySettings spike_quality;
+    frame_index = 0;
+    spike_scheduler.update(frame_index++, frameTimings(5.0, 60.0), spike_quality);
+    check(failures, spike_quality.max_keypoints > 0 && spike_quality.depth_refresh_interval == 1,
+          "frame spike lowers the keypoint budget at once");
+    int budget = spike_quality.max_keypoints;
+    run(spike_scheduler, frame_index, 6, frameTimings(5.0, 60.0), spike_quality);
+    check(failures, spike_quality.max_keypoints < budget, "keypoint budget is lowered again after the cooldown");
+
+    // Restoring needs a long stretch of headroom
+    run(spike_scheduler, frame_index, 20, frameTimings(5.0, 5.0), spike_quality);
+    check(failures, spike_quality.max_keypoints > 0, "short headroom keeps the degraded quality");
+
+    return failures == 0 ? 0 : -1;
+}
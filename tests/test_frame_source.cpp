@@ -0,0 +1,140 @@
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include "frame_source.hpp"
+#include "test_utils.hpp"
+
+static const char* TEST_SHM_NAME = "/drone_navigation_frames_test";
+
+// Image whose pixels encode the frame number, so a reader can tell frames apart
+static cv::Mat numberedFrame(const cv::Size& size, int number) {
+    return cv::Mat(size, CV_8UC3, cv::Scalar(number % 256, (number * 7) % 256, 255 - number % 256));
+}
+
+static bool showsNumber(const cv::Mat& image, int number) {
+    cv::Vec3b pixel = image.at<cv::Vec3b>(image.rows / 2, image.cols / 2);
+    return pixel == cv::Vec3b(number % 256, (number * 7) % 256, 255 - number % 256);
+}
+
+// Feed frames through the shared-memory ring and an image directory and check what the
+// sources lend: frame order, zero-copy slots, producer back-pressure and RGB conversion.
+int main() {
+    const cv::Size size(320, 240);
+    int failures = 0;
+
+    // ------ Shared memory, BGR24, every frame ------
+    FrameWriter* writer = frame_writer_open(TEST_SHM_NAME, size.width, size.height, FRAME_SHM_BGR24, 3);
+    check(failures, writer != nullptr, "frame writer opens the ring");
+    if (!writer) return -1;
+
+    SharedMemorySource source(TEST_SHM_NAME, 200, false);
+    check(failures, source.isOpened() && source.frameSize() == size, "shared-memory source maps the ring");
+
+    for (int i = 0; i < 3; ++i) {
+        cv::Mat image = numberedFrame(size, i);
+        frame_writer_write(writer, image.data, image.step, 1000 + i);
+    }
+    cv::Mat extra = numberedFrame(size, 3);
+    check(failures, !frame_writer_write(writer, extra.data, extra.step, 1003),
+          "producer drops a frame when the ring is full");
+
+    BorrowedFrame first, second;
+    bool read_first = source.read(first);
+    bool read_second = source.read(second);
+    check(failures, read_first && read_second && first.sequence == 0 && second.sequence == 1 &&
+          first.timestamp_ns == 1000,
+          "frames arrive in order with their timestamps");
+    check(failures, showsNumber(first.image, 0) && showsNumber(second.image, 1), "frames show the published pixels");
+
+    // Two frames are borrowed and one is unread, so the producer has no free slot
+    check(failures, frame_writer_acquire(writer) == nullptr, "ring stays full while the reader holds frames");
+
+    // Out-of-order release: slot 1 only goes back together with slot 0
+    cv::Mat first_view = first.image;
+    second.release();
+    check(failures, frame_writer_acquire(writer) == nullptr, "out-of-order release holds back the ring");
+    first.release();
+    uint8_t* slot = frame_writer_acquire(writer);
+    check(failures, slot != nullptr, "in-order release frees the slots");
+
+    // The producer's slot and the lent image are the same memory
+    if (slot) {
+        cv::Mat next = numberedFrame(size, 4);
+        for (int y = 0; y < size.height; ++y) {
+            std::memcpy(slot + y * frame_writer_stride(writer), next.ptr(y), size.width * 3);
+        }
+    }
+    check(failures, showsNumber(first_view, 4), "frames are lent from the ring slots without a copy");
+    frame_writer_publish(writer, 1004);
+    check(failures, source.producerDrops() == 3, "producer drops are counted");
+
+    frame_writer_close(writer);
+
+    // ------ Shared memory, latest only ------
+    writer = frame_writer_open(TEST_SHM_NAME, size.width, size.height, FRAME_SHM_BGR24, 4);
+    SharedMemorySource latest(TEST_SHM_NAME, 200, true);
+    for (int i = 0; i < 4; ++i) {
+        cv::Mat image = numberedFrame(size, i);
+        frame_writer_write(writer, image.data, image.step, i);
+    }
+    BorrowedFrame newest;
+    check(failures, latest.read(newest) && newest.sequence == 3 && showsNumber(newest.image, 3),
+          "latest_only reads the newest frame");
+    check(failures, latest.skippedFrames() == 3, "latest_only counts the skipped frames");
+    newest.release();
+    check(failures, !latest.read(newest), "read times out without new frames");
+    frame_writer_close(writer);
+
+    // A restarted producer creates a new ring, here with another frame size
+    const cv::Size restart_size(160, 120);
+    writer = frame_writer_open(TEST_SHM_NAME, restart_size.width, restart_size.height, FRAME_SHM_BGR24, 2);
+    cv::Mat restarted = numberedFrame(restart_size, 7);
+    frame_writer_write(writer, restarted.data, restarted.step, 7);
+    check(failures, latest.read(newest) && newest.sequence == 0 && newest.image.size() == restart_size &&
+          showsNumber(newest.image, 7) && latest.frameSize() == restart_size,
+          "reader follows a restarted producer");
+    newest.release();
+    frame_writer_close(writer);
+
+    // ------ Shared memory, RGB24 ------
+    writer = frame_writer_open(TEST_SHM_NAME, size.width, size.height, FRAME_SHM_RGB24, 2);
+    SharedMemorySource rgb(TEST_SHM_NAME, 200, false);
+    cv::Mat bgr = numberedFrame(size, 42), rgb_image;
+    cv::cvtColor(bgr, rgb_image, cv::COLOR_BGR2RGB);
+    frame_writer_write(writer, rgb_image.data, rgb_image.step, 42);
+    BorrowedFrame converted;
+    check(failures, rgb.read(converted) && showsNumber(converted.image, 42), "RGB24 frames are converted to BGR");
+    check(failures, frame_writer_write(writer, rgb_image.data, rgb_image.step, 43) &&
+          frame_writer_write(writer, rgb_image.data, rgb_image.step, 44),
+          "converted frames give their slot back immediately");
+    converted.release();
+    frame_writer_close(writer);
+
+    // ------ Image directory ------
+    auto directory = std::filesystem::temp_directory_path() / "drone_navigation_frame_source_test";
+    std::filesystem::create_directories(directory);
+    for (int i = 0; i < 3; ++i) {
+        cv::imwrite((directory / ("frame" + std::to_string(i) + ".png")).string(), numberedFrame(size, i * 10));
+    }
+
+    auto images = openFrameSource(directory.string());
+    check(failures, images && images->frameSize() == size, "directory opens as an image sequence");
+    if (images) {
+        BorrowedFrame frame;
+        int count = 0;
+        bool in_order = true;
+        const uchar* previous_data = nullptr;
+        bool reused_buffer = true;
+        while (images->read(frame)) {
+            in_order &= showsNumber(frame.image, count * 10) && frame.sequence == static_cast<uint64_t>(count);
+            if (previous_data) reused_buffer &= frame.image.data == previous_data;
+            previous_data = frame.image.data;
+            count++;
+        }
+        check(failures, count == 3 && in_order, "image files are read in name order");
+        check(failures, reused_buffer, "released pool buffers are reused");
+    }
+    std::filesystem::remove_all(directory);
+
+    return failures == 0 ? 0 : -1;
+}
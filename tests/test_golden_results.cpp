@@ -0,0 +1,72 @@
+#include <iostream>
+#include "golden_results.hpp"
+#include "test_utils.hpp"
+
+// Synthetic run: a few obstacles drifting to the right, timings growing per frame
+static GoldenRun syntheticRun(int frames) {
+    GoldenRun run;
+    run.video = "synthetic.avi";
+    for (int i = 0; i < frames; ++i) {
+        FrameResult result;
+        result.frame_index = i;
+        result.keypoint_count = 500 + i;
+        result.filtered_keypoint_count = 200 + i / 2;
+        result.median_depth = 3.25f;
+        result.timings.mcs[STAGE_DEPTH] = 10000 + 100 * i;
+        result.timings.mcs[STAGE_FEATURES] = 2000;
+        for (int k = 0; k < i % 4; ++k) {
+            cv::Point2f center(100.0f + 80.0f * static_cast<float>(k) + static_cast<float>(i), 200.0f);
+            result.obstacles.push_back({k, center, cv::Point2f(30.0f, -1.0f), 12, 120.5f, 100.0f, 140.0f,
+                                        cv::Rect(cvRound(center.x) - 10, 190, 20, 20)});
+        }
+        run.frames.push_back(result);
+    }
+    run.latency = summarizeLatency(run.frames);
+    return run;
+}
+
+// Record a run, read it back and check the comparison tolerates reordering but catches drift.
+int main() {
+    int failures = 0;
+
+    GoldenRun run = syntheticRun(100);
+    check(failures, run.latency.stages[STAGE_DEPTH].p50 == 14900 && run.latency.stages[STAGE_DEPTH].max == 19900,
+          "latency percentiles per stage");
+    check(failures, run.latency.stages[STAGE_COUNT].p50 == 16900, "whole-frame latency sums the stages");
+
+    std::string path = (fs::temp_directory_path() / "drone_navigation_test.golden").string();
+    GoldenRun golden;
+    check(failures, writeGoldenFile(path, run) && readGoldenFile(path, golden), "golden file round trip");
+    check(failures, golden.video == run.video && golden.frames.size() == run.frames.size() &&
+          golden.frames[7].obstacles.size() == 3 && golden.latency.stages[STAGE_DEPTH].p90 ==
+                                                    run.latency.stages[STAGE_DEPTH].p90,
+          "golden file keeps frames, obstacles and latency");
+
+    GoldenTolerances tolerances;
+    GoldenComparison same = compareWithGolden(golden, run.frames, tolerances);
+    check(failures, same.passed(tolerances) && same.drifted_frames == 0, "identical run passes");
+
+    std::vector<FrameResult> reordered = run.frames;
+    std::reverse(reordered[7].obstacles.begin(), reordered[7].obstacles.end());
+    reordered[11].obstacles[0].center.x += 1.0f;
+    check(failures, compareWithGolden(golden, reordered, tolerances).passed(tolerances),
+          "reordered obstacles and sub-tolerance noise pass");
+
+    std::vector<FrameResult> drifted = run.frames;
+    drifted[5].obstacles[0].center.x += 10.0f;
+    drifted[20].keypoint_count += 100;
+    drifted[30].median_depth += 5.0f;
+    GoldenComparison comparison = compareWithGolden(golden, drifted, tolerances);
+    check(failures, !comparison.passed(tolerances) && comparison.drifted_frames == 3 &&
+          comparison.first_drifted_frame == 5,
+          "moved obstacle, keypoint count and depth drift are caught");
+
+    tolerances.drifted_frames = 0.05f;
+    check(failures, comparison.passed(tolerances), "drifted fraction tolerance");
+
+    drifted.pop_back();
+    check(failures, !compareWithGolden(golden, drifted, tolerances).passed(tolerances), "missing frames fail");
+
+    fs::remove(path);
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+#include "http_request.hpp"
+#include "test_utils.hpp"
+
+// Parse the requests PostCameraView.cs sends to image_server, fed in pieces as they arrive
+// from a socket, plus pipelined and malformed requests.
+int main() {
+    int failures = 0;
+
+    const std::string jpeg("\xFF\xD8\xFF\xE0 not a real jpeg \r\n--almost a boundary\xFF\xD9", 38);
+    const std::string boundary = "aBcD1234";
+    std::string body = "--" + boundary + "\r\n"
+                       "Content-Disposition: form-data; name=\"file\"; filename=\"file.dat\"\r\n"
+                       "Content-Type: application/octet-stream\r\n\r\n" + jpeg + "\r\n"
+                       "--" + boundary + "\r\n"
+                       "Content-Disposition: form-data; name=\"x\"\r\n\r\n0.25\r\n"
+                       "--" + boundary + "\r\n"
+                       "Content-Disposition: form-data; name=\"restart\"\r\n\r\n1\r\n"
+                       "--" + boundary + "--\r\n";
+    std::string request = "POST / HTTP/1.1\r\n"
+                          "Host: localhost:20000\r\n"
+                          "Content-Type: multipart/form-data; boundary=\"" + boundary + "\"\r\n"
+                          "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    // Byte by byte: incomplete until the last byte
+    HttpRequest parsed;
+    HttpParseStatus status = HTTP_INCOMPLETE;
+    size_t complete_at = 0;
+    for (size_t size = 1; size <= request.size() && status == HTTP_INCOMPLETE; ++size) {
+        status = parseHttpRequest(request.data(), size, 1 << 20, parsed);
+        complete_at = size;
+    }
+    check(failures, status == HTTP_COMPLETE && complete_at == request.size(), "complete exactly at the last byte");
+    check(failures, parsed.method == "POST" && parsed.target == "/" && parsed.keep_alive,
+          "request line and keep-alive");
+    check(failures, parsed.content_length == body.size(), "content length");
+    check(failures, parsed.header("content-type").find(boundary) != std::string_view::npos,
+          "case-insensitive header lookup");
+
+    std::vector<MultipartPart> parts;
+    std::string_view parsed_body(request.data() + parsed.header_bytes, parsed.content_length);
+    check(failures, parseMultipart(parsed_body, parsed.header("Content-Type"), parts) && parts.size() == 3,
+          "three parts");
+    const MultipartPart* file = findPart(parts, "file");
+    check(failures, file && file->data == jpeg && file->filename == "file.dat", "binary file part intact");
+    const MultipartPart* x = findPart(parts, "x");
+    check(failures, x && x->data == "0.25", "form field");
+    const MultipartPart* restart = findPart(parts, "restart");
+    check(failures, restart && restart->data == "1", "restart field");
+    check(failures, !findPart(parts, "missing"), "missing field");
+
+    // Two pipelined requests in one buffer
+    std::string pipelined = "GET / HTTP/1.1\r\nConnection: close\r\n\r\n" + request;
+    parsed.clear();
+    status = parseHttpRequest(pipelined.data(), pipelined.size(), 1 << 20, parsed);
+    check(failures, status == HTTP_COMPLETE && parsed.method == "GET" && !parsed.keep_alive &&
+          parsed.content_length == 0,
+          "first pipelined request");
+    size_t consumed = parsed.header_bytes + parsed.content_length;
+    parsed.clear();
+    status = parseHttpRequest(pipelined.data() + consumed, pipelined.size() - consumed, 1 << 20, parsed);
+    check(failures, status == HTTP_COMPLETE && parsed.method == "POST", "second pipelined request");
+
+    // Errors
+    parsed.clear();
+    check(failures, parseHttpRequest(request.data(), request.size(), 16, parsed) == HTTP_TOO_LARGE,
+          "body over the limit");
+    std::string chunked = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    parsed.clear();
+    check(failures, parseHttpRequest(chunked.data(), chunked.size(), 1 << 20, parsed) == HTTP_LENGTH_REQUIRED,
+          "chunked upload rejected");
+    std::string garbage = "hello\r\n\r\n";
+    parsed.clear();
+    check(failures, parseHttpRequest(garbage.data(), garbage.size(), 1 << 20, parsed) == HTTP_BAD_REQUEST,
+          "malformed request line");
+    std::string expect = "POST / HTTP/1.1\r\nContent-Length: 10\r\nExpect: 100-continue\r\n\r\n";
+    parsed.clear();
+    check(failures, parseHttpRequest(expect.data(), expect.size(), 1 << 20, parsed) == HTTP_INCOMPLETE &&
+          parsed.expect_continue && parsed.header_bytes == expect.size(), "expect 100-continue");
+    check(failures, !parseMultipart(parsed_body, "multipart/form-data; boundary=other", parts), "wrong boundary");
+
+    std::cout << (failures == 0 ? "All checks passed" : "Some checks failed") << std::endl;
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,89 @@
+#include <cmath>
+#include <iostream>
+#include "drone_dynamics.hpp"
+#include "time_meas.hpp"
+
+struct IntegratorCase {
+    const char* label;
+    float thrust, mass, drag, kp, kd;
+};
+
+static float stateError(const DroneState& a, const DroneState& b) {
+    float dx = a.pos.x - b.pos.x, dy = a.pos.y - b.pos.y, dz = a.pos.z - b.pos.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Compare single-step, substepped and adaptive integration against a fine RK4 reference.
+int main() {
+    const float duration = 2.0f;
+    const float frame_dt = 0.02f;
+    const int frames = static_cast<int>(duration / frame_dt);
+    const DroneState start{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+    const Vector3 target{20.0f, 5.0f, -10.0f};
+
+    const IntegratorCase cases[] = {
+            {"smooth (kp=10, kd=2)", 100.0f, 1.0f, 0.1f, 10.0f, 2.0f},
+            {"stiff (kp=2000, kd=90)", 100.0f, 1.0f, 0.1f, 2000.0f, 90.0f},
+    };
+
+    int failures = 0;
+    for (const auto& c : cases) {
+        DroneState reference;
+        SimulateSubsteps(const_cast<DroneState*>(&start), &target, duration, 4000,
+                         c.thrust, c.mass, c.drag, c.kp, c.kd, &reference, nullptr);
+
+        // One RK4 step per frame, one interop call each
+        DroneState single = start;
+        for (int i = 0; i < frames; ++i) {
+            DroneState next;
+            SimulateStep(&single, &target, frame_dt, c.thrust, c.mass, c.drag, c.kp, c.kd, &next);
+            single = next;
+        }
+
+        // Eight substeps per frame, one call each
+        DroneState substepped = start;
+        IntegrationStats substep_stats{};
+        int substep_evaluations = 0;
+        auto start_time = get_current_time_fenced();
+        for (int i = 0; i < frames; ++i) {
+            DroneState next;
+            SimulateSubsteps(&substepped, &target, frame_dt, 8, c.thrust, c.mass, c.drag, c.kp, c.kd,
+                             &next, &substep_stats);
+            substepped = next;
+            substep_evaluations += substep_stats.derivativeEvaluations;
+        }
+        auto substep_time = to_mcs(get_current_time_fenced() - start_time);
+
+        // Adaptive steps, one call per frame, carrying the step size over
+        DroneState adaptive = start;
+        IntegrationStats adaptive_stats{};
+        int adaptive_evaluations = 0, rejected = 0;
+        start_time = get_current_time_fenced();
+        for (int i = 0; i < frames; ++i) {
+            DroneState next;
+            if (!SimulateAdaptive(&adaptive, &target, frame_dt, 1e-5f, adaptive_stats.maxStep,
+                                  c.thrust, c.mass, c.drag, c.kp, c.kd, &next, &adaptive_stats)) {
+                std::cerr << "Adaptive integration hit the step limit!" << std::endl;
+                failures++;
+            }
+            adaptive = next;
+            adaptive_evaluations += adaptive_stats.derivativeEvaluations;
+            rejected += adaptive_stats.rejectedSteps;
+        }
+        auto adaptive_time = to_mcs(get_current_time_fenced() - start_time);
+
+        float single_error = stateError(single, reference);
+        float substep_error = stateError(substepped, reference);
+        float adaptive_error = stateError(adaptive, reference);
+        if (!std::isfinite(adaptive_error) || adaptive_error > 0.05f) failures++;
+
+        std::cout << c.label << std::endl;
+        std::cout << "  Single step: error " << single_error << " m | evaluations " << 4 * frames << std::endl;
+        std::cout << "  Substeps x8: error " << substep_error << " m | evaluations " << substep_evaluations
+                  << " | " << substep_time << " mcs" << std::endl;
+        std::cout << "  Adaptive:    error " << adaptive_error << " m | evaluations " << adaptive_evaluations
+                  << " | rejected " << rejected << " | " << adaptive_time << " mcs" << std::endl;
+    }
+
+    return failures == 0 ? 0 : -1;
+}
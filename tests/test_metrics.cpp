@@ -0,0 +1,180 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "video_processor.hpp"
+#include "metrics_publisher.hpp"
+#include "metrics_server.hpp"
+#include "test_utils.hpp"
+
+// Connected socket to the metrics endpoint, -1 on failure
+static int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send one request to the metrics endpoint and return the whole response, empty on failure
+static std::string httpGet(int port, const std::string& target) {
+    int fd = connectTo(port);
+    if (fd < 0) return {};
+
+    std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, static_cast<size_t>(received));
+    close(fd);
+    return response;
+}
+
+static FrameResult sampleFrame() {
+    FrameResult result;
+    result.keypoint_count = 120;
+    result.filtered_keypoint_count = 60;
+    result.changed_fraction = 0.25f;
+    result.obstacles.resize(3);
+    result.timings.mcs[STAGE_DEPTH] = 20000;
+    result.timings.mcs[STAGE_FEATURES] = 3000;
+    result.timings.mcs[STAGE_CLUSTERING] = 800;
+    result.timings.mcs[STAGE_TRACKING] = 200;
+    result.timings.mcs[STAGE_DISPLAY] = 5000;
+    return result;
+}
+
+// Record frames, then read the metrics back through the Prometheus text, the shared-memory
+// snapshot and the HTTP endpoint.
+int main() {
+    int failures = 0;
+
+    // ------ Histogram ------
+    LatencyHistogram histogram;
+    histogram.observe(400);
+    histogram.observe(1000);
+    histogram.observe(2000000);
+    check(failures, histogram.bucketCount(0) == 1 && histogram.bucketCount(1) == 1, "bucket bounds are inclusive");
+    check(failures, histogram.bucketCount(LatencyHistogram::BUCKETS - 1) == 1,
+          "slow observations go to the open bucket");
+    check(failures, histogram.sumMcs() == 2001400, "sum adds up the observations");
+
+    // ------ Frames ------
+    PipelineMetrics metrics;
+    FrameResult result = sampleFrame();
+    metrics.recordFrame(result, 4);
+    metrics.recordFrame(result, 4);
+    check(failures, metrics.frames_out.get() == 2, "processed frames are counted");
+    check(failures, metrics.keypoints.get() == 120 && metrics.clusters.get() == 3 && metrics.tracks.get() == 4 &&
+          metrics.changed_fraction.get() == 0.25, "per-frame gauges hold the last frame");
+    check(failures, metrics.stage_latency[STAGE_DEPTH].bucketCount(5) == 2, "depth stage lands in the 20 ms bucket");
+    uint64_t display_count = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+        display_count += metrics.stage_latency[STAGE_DISPLAY].bucketCount(bucket);
+    }
+    check(failures, display_count == 0, "display is left to the caller");
+    check(failures, metrics.frame_latency.sumMcs() == 2 * 24000, "frame latency excludes display");
+
+    // ------ Prometheus text ------
+    std::string text = formatPrometheus(metrics);
+    check(failures,
+          text.find("# TYPE drone_navigation_frames_out_total counter\ndrone_navigation_frames_out_total 2\n") !=
+          std::string::npos, "counters are exported with their type");
+    check(failures, text.find("drone_navigation_stage_latency_seconds_bucket{stage=\"depth\",le=\"0.02\"} 2\n") !=
+          std::string::npos, "histogram buckets are cumulative with stage labels");
+    check(failures, text.find("drone_navigation_stage_latency_seconds_bucket{stage=\"depth\",le=\"0.01\"} 0\n") !=
+          std::string::npos, "buckets below the observations are empty");
+    check(failures, text.find("drone_navigation_frame_latency_seconds_count 2\n") != std::string::npos &&
+          text.find("drone_navigation_frame_latency_seconds_sum 0.048000\n") != std::string::npos,
+          "histogram sum and count are exported");
+    check(failures, text.find("stage=\"display\"") == std::string::npos, "stages without observations are skipped");
+
+    // ------ Shared-memory snapshot ------
+    pipelineMetrics().recordFrame(result, 4);
+    pipelineMetrics().frames_in.add(3);
+    const char* shm_name = "/drone_navigation_metrics_test";
+    MetricsPublisher publisher;
+    check(failures, publisher.open(shm_name), "publisher creates the shared memory");
+    MetricsReader* reader = metrics_reader_open(shm_name);
+    check(failures, reader != nullptr, "reader maps the shared memory");
+    if (reader) {
+        MetricsSnapshot snapshot{};
+        check(failures, metrics_reader_read(reader, &snapshot) == 0, "nothing to read before the first snapshot");
+        publisher.publish(pipelineMetrics());
+        check(failures, metrics_reader_read(reader, &snapshot) == 1 && snapshot.snapshot_seq == 1,
+              "snapshot is read back");
+        check(failures, snapshot.frames_in == 3 && snapshot.frames_out == 1 && snapshot.keypoints == 120,
+              "snapshot holds the counters and gauges");
+        check(failures, snapshot.stage_count == STAGE_COUNT && snapshot.stage_latency[STAGE_DEPTH].count == 1 &&
+              snapshot.stage_latency[STAGE_DEPTH].buckets[5] == 1, "snapshot holds the stage histograms");
+        check(failures, std::string(metrics_reader_stage_name(reader, STAGE_DEPTH)) == "depth" &&
+              metrics_reader_bucket_bound(reader, 0) == 500, "stage names and bucket bounds are published");
+
+        // A writer that dies while publishing leaves an odd sequence behind
+        int fd = shm_open(shm_name, O_RDWR, 0);
+        void* memory = fd >= 0 ? mmap(nullptr, sizeof(MetricsShmHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                               : MAP_FAILED;
+        if (fd >= 0) close(fd);
+        if (memory != MAP_FAILED) {
+            auto* header = static_cast<MetricsShmHeader*>(memory);
+            uint64_t sequence = header->sequence;
+            header->sequence = sequence + 1;
+            check(failures, metrics_reader_read(reader, &snapshot) == -1, "reader gives up on an unfinished snapshot");
+            header->sequence = sequence;
+            munmap(memory, sizeof(MetricsShmHeader));
+        }
+
+        publisher.start(10);
+        pipelineMetrics().frames_in.add();
+        usleep(100 * 1000);
+        check(failures, metrics_reader_read(reader, &snapshot) == 1 && snapshot.frames_in == 4 &&
+              snapshot.snapshot_seq > 1,
+              "publishing thread refreshes the snapshot");
+        metrics_reader_close(reader);
+    }
+    publisher.close();
+
+    // ------ HTTP endpoint ------
+    MetricsServer server;
+    check(failures, server.start("127.0.0.1", 0) && server.port() > 0, "metrics server binds a free port");
+    std::string response = httpGet(server.port(), "/metrics");
+    check(failures, response.rfind("HTTP/1.1 200 OK", 0) == 0 &&
+          response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos,
+          "GET /metrics answers with the Prometheus content type");
+    check(failures, response.find("drone_navigation_frames_in_total 4\n") != std::string::npos,
+          "scrape has the live values");
+    check(failures, httpGet(server.port(), "/").rfind("HTTP/1.1 404", 0) == 0, "other paths are not found");
+
+    // A client trickling its request for 3 s only delays the next scrape by the client timeout
+    int slow = connectTo(server.port());
+    std::thread trickle([slow] {
+        std::string request = "GET /metrics HTTP/1.1\r\n";
+        for (char byte : request) {
+            if (send(slow, &byte, 1, MSG_NOSIGNAL) <= 0) break;
+            usleep(150 * 1000);
+        }
+    });
+    usleep(50 * 1000);
+    auto scrape_start = std::chrono::steady_clock::now();
+    response = httpGet(server.port(), "/metrics");
+    auto scrape_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - scrape_start).count();
+    check(failures, slow >= 0 && response.rfind("HTTP/1.1 200 OK", 0) == 0 && scrape_ms < 2000,
+          "slow client does not block the endpoint");
+    trickle.join();
+    if (slow >= 0) close(slow);
+    server.stop();
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include "motion_gate.hpp"
+#include "test_utils.hpp"
+
+// Random texture, so any replaced area differs strongly from the reference
+static cv::Mat texturedFrame(const cv::Size& size, int seed) {
+    cv::Mat frame(size, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    return frame;
+}
+
+// Feed a static scene, a local change, a slow drift and a global change through the gate and
+// check which tiles and frames it marks for reprocessing.
+int main() {
+    const cv::Size size(640, 480);
+    int failures = 0;
+
+    MotionGateSettings settings;
+    settings.enabled = true;
+    settings.refresh_interval = 100;
+
+    FramePyramid pyramid;
+    MotionGate gate;
+    int frame_index = 1;
+    auto feed = [&](const cv::Mat& frame) {
+        pyramid.update(frame);
+        gate.update(pyramid, frame_index++, settings);
+    };
+
+    // ------ Static scene ------
+    cv::Mat frame = texturedFrame(size, 1);
+    feed(frame);
+    check(failures, gate.full() && gate.changedFraction() == 1.0f, "first frame is processed in full");
+
+    cv::Mat same = frame.clone();
+    feed(same);
+    check(failures, !gate.full() && !gate.anyChanged() && gate.changedFraction() == 0.0f,
+          "static frame has no changed tiles");
+    check(failures, gate.changedRects(cv::Rect(cv::Point(0, 0), size)).empty(), "static frame has no changed areas");
+
+    // ------ Local change ------
+    cv::Rect patch(300, 200, 40, 40);
+    cv::Mat local = frame.clone();
+    texturedFrame(patch.size(), 2).copyTo(local(patch));
+    feed(local);
+    check(failures, !gate.full() && gate.anyChanged(), "local change is not a full frame");
+    check(failures, gate.changed(patch) && gate.changed(cv::Point2f(320, 220)), "changed patch is marked");
+    check(failures, !gate.changed(cv::Rect(0, 0, 64, 64)) && !gate.changed(cv::Point2f(600, 440)),
+          "distant tiles stay unchanged");
+    check(failures, gate.changedFraction() > 0.0f && gate.changedFraction() < 0.2f, "changed share is small");
+
+    std::vector<cv::Rect> areas = gate.changedRects(cv::Rect(cv::Point(0, 0), size));
+    bool covered = true;
+    for (int y = patch.y; y < patch.br().y; ++y) {
+        for (int x = patch.x; x < patch.br().x; ++x) {
+            bool inside = false;
+            for (const auto& area : areas) inside = inside || area.contains(cv::Point(x, y));
+            covered = covered && inside;
+        }
+    }
+    check(failures, covered, "changed areas cover the patch");
+    check(failures, areas.size() == 1, "adjacent changed tiles merge into one area");
+
+    cv::Rect roi(0, 0, 320, 240);
+    std::vector<cv::Rect> roi_areas = gate.changedRects(roi);
+    check(failures, !roi_areas.empty() && (roi_areas.front() & roi) == roi_areas.front(),
+          "areas are clipped to the region");
+
+    cv::Mat local_again = local.clone();
+    feed(local_again);
+    check(failures, !gate.anyChanged(), "processed change becomes the new reference");
+
+    // ------ Slow drift ------
+    cv::Rect drift_area(0, 0, 128, 128);
+    cv::Mat drifting = local.clone();
+    int detected_step = -1;
+    for (int step = 0; step < 5 && detected_step < 0; ++step) {
+        drifting(drift_area) += cv::Scalar::all(2);
+        cv::Mat step_frame = drifting.clone();
+        feed(step_frame);
+        if (gate.changed(drift_area)) detected_step = step;
+    }
+    check(failures, detected_step != 0, "small difference stays below the threshold");
+    check(failures, detected_step > 0 && !gate.full(), "slow drift adds up until it is detected");
+
+    // ------ Full frames ------
+    cv::Mat global = texturedFrame(size, 3);
+    feed(global);
+    check(failures, gate.full(), "change over most of the frame reprocesses it in full");
+
+    cv::Mat still = global.clone();
+    frame_index = settings.refresh_interval;
+    feed(still);
+    check(failures, gate.full(), "periodic refresh is a full frame");
+
+    cv::Mat smaller = texturedFrame(cv::Size(320, 240), 3);
+    feed(smaller);
+    check(failures, gate.full(), "frame size change is a full frame");
+
+    gate.forceFull();
+    check(failures, gate.full() && gate.changed(cv::Point2f(0, 0)), "forced full frame marks every tile");
+
+    return failures == 0 ? 0 : -1;
+}
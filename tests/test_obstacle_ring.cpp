@@ -0,0 +1,99 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "obstacle_publisher.hpp"
+#include "obstacle_shm.h"
+#include "test_utils.hpp"
+
+static const char* TEST_SHM_NAME = "/drone_navigation_obstacles_test";
+
+// Frame with `count` obstacles whose fields encode the frame index
+static FrameResult numberedResult(int frame_index, int count) {
+    FrameResult result;
+    result.frame_index = frame_index;
+    result.median_depth = static_cast<float>(frame_index) * 0.5f;
+    for (int i = 0; i < count; ++i) {
+        TrackedObstacle obstacle{};
+        obstacle.id = frame_index * 100 + i;
+        obstacle.center = cv::Point2f(static_cast<float>(i), static_cast<float>(frame_index));
+        obstacle.velocity = cv::Point2f(1.0f, -1.0f);
+        obstacle.point_count = 10 + i;
+        obstacle.depth_median = 0.5f;
+        obstacle.depth_min = 0.25f;
+        obstacle.depth_max = 0.75f;
+        result.obstacles.push_back(obstacle);
+    }
+    return result;
+}
+
+// Publish frames through the shared-memory obstacle ring and check what a reader sees:
+// record contents, frame order, the obstacle limit and frames dropped by a slow reader.
+int main() {
+    int failures = 0;
+    const uint32_t capacity = 4;
+
+    ObstaclePublisher publisher;
+    check(failures, publisher.open(TEST_SHM_NAME, capacity), "publisher creates the ring");
+    if (!publisher.isOpen()) return -1;
+
+    ObstacleReader* reader = obstacle_reader_open(TEST_SHM_NAME);
+    check(failures, reader != nullptr, "reader maps the ring");
+    if (!reader) return -1;
+
+    ObstacleFrame frame;
+    uint64_t dropped = 0;
+    check(failures, !obstacle_reader_next(reader, &frame, &dropped) && !obstacle_reader_latest(reader, &frame),
+          "empty ring has no frame");
+
+    publisher.publish(numberedResult(0, 2));
+    publisher.publish(numberedResult(1, 1));
+    bool read_first = obstacle_reader_next(reader, &frame, &dropped);
+    check(failures, read_first && frame.frame_seq == 0 && frame.median_depth == 0.0f && frame.obstacle_count == 2 &&
+          dropped == 0,
+          "first frame is read");
+    const ObstacleRecord& record = frame.obstacles[1];
+    check(failures, record.track_id == 1 && record.point_count == 11 && record.x == 1.0f && record.y == 0.0f &&
+          record.vx == 1.0f && record.vy == -1.0f && record.depth_min == 0.25f && record.depth_max == 0.75f,
+          "records carry the obstacle fields");
+    check(failures, obstacle_reader_next(reader, &frame, &dropped) && frame.frame_seq == 1 &&
+          frame.obstacle_count == 1 && frame.median_depth == 0.5f,
+          "frames arrive in order");
+    check(failures, !obstacle_reader_next(reader, &frame, &dropped), "no frame until the next publish");
+
+    publisher.publish(numberedResult(2, OBSTACLE_SHM_MAX_OBSTACLES + 5));
+    check(failures, obstacle_reader_next(reader, &frame, &dropped) &&
+          frame.obstacle_count == OBSTACLE_SHM_MAX_OBSTACLES,
+          "obstacles beyond the slot limit are cut off");
+
+    // The reader falls behind by more than the ring holds
+    for (int i = 3; i < 3 + static_cast<int>(capacity) + 2; ++i) publisher.publish(numberedResult(i, 0));
+    check(failures, obstacle_reader_next(reader, &frame, &dropped) && frame.frame_seq == 5 && dropped == 2,
+          "slow reader skips the overwritten frames");
+
+    publisher.publish(numberedResult(9, 0));
+    publisher.publish(numberedResult(10, 0));
+    check(failures, obstacle_reader_latest(reader, &frame) && frame.frame_seq == 10, "latest frame is read");
+    check(failures, !obstacle_reader_next(reader, &frame, &dropped), "latest read moves the reader to the end");
+
+    // A restarted pipeline recreates the ring under the same name
+    publisher.close();
+    ObstaclePublisher restarted;
+    check(failures, restarted.open(TEST_SHM_NAME, capacity), "restarted publisher creates a new ring");
+    restarted.publish(numberedResult(0, 3));
+    restarted.publish(numberedResult(1, 0));
+    bool followed = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!(followed = obstacle_reader_next(reader, &frame, &dropped)) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    check(failures, followed && frame.frame_seq == 0 && frame.obstacle_count == 3 && dropped == 0,
+          "reader follows a restarted publisher from its first frame");
+    check(failures, obstacle_reader_next(reader, &frame, &dropped) && frame.frame_seq == 1,
+          "frames of the new run arrive in order");
+
+    obstacle_reader_close(reader);
+    restarted.close();
+    check(failures, obstacle_reader_open(TEST_SHM_NAME) == nullptr, "closing the publisher removes the ring");
+
+    return failures == 0 ? 0 : -1;
+}
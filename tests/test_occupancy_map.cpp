@@ -0,0 +1,59 @@
+#include <cmath>
+#include <iostream>
+#include "occupancy_map.hpp"
+#include "test_utils.hpp"
+
+// Synthetic depth of a wall at `wall` meters with a box at `box` meters in the image center.
+static cv::Mat syntheticDepth(const cv::Size& size, float wall, float box) {
+    cv::Mat depth(size.height, size.width, CV_32F, cv::Scalar(wall));
+    for (int v = size.height * 3 / 8; v < size.height * 5 / 8; ++v) {
+        for (int u = size.width * 3 / 8; u < size.width * 5 / 8; ++u) {
+            depth.at<float>(v, u) = box;
+        }
+    }
+    return depth;
+}
+
+// Build a map while flying towards a wall with a box in front of it, then query it.
+int main(int argc, char** argv) {
+    const int num_frames = (argc > 1) ? std::stoi(argv[1]) : 30;
+    const cv::Size image_size(640, 480);
+
+    OccupancyMapConfig config;
+    OccupancyMap map(config);
+    CameraIntrinsics intrinsics = CameraIntrinsics::fromFieldOfView(image_size, 90.0f);
+
+    // The camera moves forward, so the depths shrink by the distance flown
+    CameraPose pose;
+    long long total_mcs = 0, max_mcs = 0;
+    MapUpdateStats stats;
+    for (int i = 0; i < num_frames; ++i) {
+        pose.translation = Eigen::Vector3f(0.0f, 0.0f, 0.05f * static_cast<float>(i));
+        float flown = pose.translation.z();
+        stats = map.integrateDepth(syntheticDepth(image_size, 12.0f - flown, 6.0f - flown), intrinsics, pose);
+        total_mcs += stats.mcs;
+        max_mcs = std::max(max_mcs, stats.mcs);
+    }
+
+    std::cout << "Frames: " << num_frames << " | Rays per frame: " << stats.rays
+              << " | Voxel updates per frame: " << stats.voxel_updates << std::endl;
+    std::cout << "Update time: mean " << total_mcs / num_frames << " mcs | max " << max_mcs << " mcs" << std::endl;
+    std::cout << "Blocks: " << map.blockCount() << " | Memory: " << map.memoryBytes() / 1024 << " KiB" << std::endl;
+
+    int failures = 0;
+
+    Eigen::Vector3f hit;
+    check(failures, !map.segmentCollides({0, 0, 0}, {0, 0, 5}), "free space in front of the box");
+    check(failures, map.segmentCollides({0, 0, 0}, {0, 0, 8}, false, &hit) && std::abs(hit.z() - 6.0f) < 0.5f,
+          "segment through the box hits it at 6 m");
+    check(failures, map.segmentCollides({-3, 0, 0}, {-3, 0, 14}), "segment beside the box hits the wall");
+    check(failures, map.query({0, 0, 20}) == VoxelState::UNKNOWN, "space behind the wall is unknown");
+    check(failures, !map.segmentCollides({-3, 0, 4}, {-3, 0, 9}, true),
+          "observed free space is free when unknown blocks");
+
+    // Flying far away drops every block outside the local window
+    map.setWindowCenter({0.0f, 0.0f, 200.0f});
+    check(failures, map.blockCount() == 0, "sliding window drops distant blocks");
+
+    return failures == 0 ? 0 : -1;
+}
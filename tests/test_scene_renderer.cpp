@@ -0,0 +1,58 @@
+#include <cmath>
+#include <iostream>
+#include "scene_renderer.hpp"
+#include "test_utils.hpp"
+
+static const cv::Size IMAGE_SIZE(160, 120);
+
+// 100 px focal length: pixel (u, v) sees the ray ((u + 0.5 - 80) / 100, (v + 0.5 - 60) / 100, 1)
+static const CameraIntrinsics INTRINSICS{100.0f, 100.0f, 80.0f, 60.0f};
+
+static bool closeTo(float value, float expected) {
+    return std::abs(value - expected) < 1e-3f;
+}
+
+// Render a 2 m box 9 m in front of the camera with a wall at 20 m and check the depth along the optical axis.
+int main() {
+    int failures = 0;
+
+    Scene scene;
+    scene.boxes.push_back({{-1.0f, -1.0f, 9.0f}, {1.0f, 1.0f, 11.0f}, {200, 80, 40}});
+    cv::Mat image(IMAGE_SIZE, CV_8UC3), depth;
+    CameraPose pose;
+
+    renderScene(scene, INTRINSICS, pose, image, &depth);
+    check(failures, depth.size() == IMAGE_SIZE && depth.type() == CV_32F, "depth has the image size");
+    check(failures, closeTo(depth.at<float>(60, 80), 9.0f), "box front face is at 9 m in the center");
+    // Half a meter off the axis, still on the front face: depth is along the axis, not the ray length
+    check(failures, closeTo(depth.at<float>(60, 85), 9.0f) && closeTo(depth.at<float>(55, 80), 9.0f),
+          "depth is the distance along the optical axis");
+    check(failures, depth.at<float>(0, 0) == 0.0f && image.at<cv::Vec3b>(0, 0) == scene.sky,
+          "rays missing the scene see the sky at depth 0");
+    // The box edges project 100 / 9 = 11.1 px from the center
+    check(failures, closeTo(depth.at<float>(60, 89), 9.0f) && depth.at<float>(60, 92) == 0.0f,
+          "box edge is where the projection puts it");
+    check(failures, image.at<cv::Vec3b>(60, 80) != scene.sky, "box is drawn");
+
+    scene.planes.push_back({{0.0f, 0.0f, 20.0f}, {0.0f, 0.0f, -1.0f}, {150, 150, 150}, {90, 90, 90}, 2.0f});
+    renderScene(scene, INTRINSICS, pose, image, &depth);
+    check(failures, closeTo(depth.at<float>(0, 0), 20.0f) && closeTo(depth.at<float>(60, 80), 9.0f),
+          "wall behind the box is at 20 m");
+
+    pose.translation = Eigen::Vector3f(0.0f, 0.0f, 4.0f);
+    renderScene(scene, INTRINSICS, pose, image, &depth);
+    check(failures, closeTo(depth.at<float>(60, 80), 5.0f) && closeTo(depth.at<float>(0, 0), 16.0f),
+          "depths shrink by the distance flown");
+
+    // Looking back along -z (180 deg around y) from behind the box
+    pose.translation = Eigen::Vector3f(0.0f, 0.0f, 14.0f);
+    pose.rotation = Eigen::AngleAxisf(static_cast<float>(CV_PI), Eigen::Vector3f::UnitY()).toRotationMatrix();
+    renderScene(scene, INTRINSICS, pose, image, &depth);
+    check(failures, closeTo(depth.at<float>(60, 80), 3.0f), "back face is at 3 m from behind");
+
+    check(failures, closeTo(scene.distanceTo(Eigen::Vector3f(0.0f, 0.0f, 0.0f)), 9.0f) &&
+          closeTo(scene.distanceTo(Eigen::Vector3f(0.0f, 0.0f, 10.0f)), -1.0f),
+          "distance to the scene matches the box");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "drone_dynamics.hpp"
+#include "time_meas.hpp"
+
+// Compare SimulateSwarmStep with per-drone SimulateStep calls and measure throughput.
+int main(int argc, char** argv) {
+    const int count = (argc > 1) ? std::stoi(argv[1]) : 4096;
+    const int num_steps = 500;
+    const float dt = 0.02f;
+
+    std::default_random_engine generator(42);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> gain(1.0f, 40.0f);
+    std::uniform_real_distribution<float> unit(0.05f, 1.0f);
+
+    std::vector<float> px(count), py(count), pz(count), vx(count, 0.0f), vy(count, 0.0f), vz(count, 0.0f);
+    std::vector<float> tx(count), ty(count), tz(count);
+    std::vector<float> thrust(count), mass(count), drag(count), kp(count), kd(count);
+    std::vector<DroneState> states(count);
+    std::vector<Vector3> targets(count);
+
+    for (int i = 0; i < count; ++i) {
+        px[i] = position(generator); py[i] = position(generator); pz[i] = position(generator);
+        tx[i] = position(generator); ty[i] = position(generator); tz[i] = position(generator);
+        thrust[i] = 10.0f + gain(generator) * 5.0f;
+        mass[i] = 0.5f + unit(generator) * 2.0f;
+        drag[i] = unit(generator);
+        kp[i] = gain(generator);
+        kd[i] = gain(generator) * 0.2f;
+
+        states[i] = {{px[i], py[i], pz[i]}, {0.0f, 0.0f, 0.0f}};
+        targets[i] = {tx[i], ty[i], tz[i]};
+    }
+
+    // Scalar path: one call per drone, as DroneSimulatorInterop does today
+    auto start_time = get_current_time_fenced();
+    for (int step = 0; step < num_steps; ++step) {
+        for (int i = 0; i < count; ++i) {
+            DroneState next;
+            SimulateStep(&states[i], &targets[i], dt, thrust[i], mass[i], drag[i], kp[i], kd[i], &next);
+            states[i] = next;
+        }
+    }
+    auto scalar_time = to_mcs(get_current_time_fenced() - start_time);
+
+    // Batched path
+    start_time = get_current_time_fenced();
+    for (int step = 0; step < num_steps; ++step) {
+        SimulateSwarmStep(count, px.data(), py.data(), pz.data(), vx.data(), vy.data(), vz.data(),
+                          tx.data(), ty.data(), tz.data(),
+                          thrust.data(), mass.data(), drag.data(), kp.data(), kd.data(), dt, 0);
+    }
+    auto swarm_time = to_mcs(get_current_time_fenced() - start_time);
+
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        if (states[i].pos.x != px[i] || states[i].pos.y != py[i] || states[i].pos.z != pz[i] ||
+            states[i].vel.x != vx[i] || states[i].vel.y != vy[i] || states[i].vel.z != vz[i]) {
+            mismatches++;
+        }
+    }
+
+    double drone_steps = static_cast<double>(count) * num_steps;
+    std::cout << "Drones: " << count << " | Steps: " << num_steps << std::endl;
+    std::cout << "Scalar: " << scalar_time << " mcs | " << drone_steps / scalar_time << " M drone-steps/s" << std::endl;
+    std::cout << "Swarm:  " << swarm_time << " mcs | " << drone_steps / swarm_time << " M drone-steps/s" << std::endl;
+    std::cout << "Mismatching drones: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : -1;
+}
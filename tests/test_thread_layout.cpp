@@ -0,0 +1,52 @@
+#include <iostream>
+#include "thread_layout.hpp"
+#include "test_utils.hpp"
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Parse and format layouts, then move the calling thread between role core sets.
+int main() {
+    int failures = 0;
+
+    // ------ Text form ------
+    std::vector<int> cores;
+    check(failures, parseCoreList("0-3,6,5", cores) && cores == std::vector<int>({0, 1, 2, 3, 5, 6}),
+          "core lists parse");
+    check(failures, formatCoreList(cores) == "0-3,5-6", "core lists format as ranges");
+    check(failures, !parseCoreList("3-1", cores) && !parseCoreList("a", cores) && !parseCoreList("", cores),
+          "malformed core lists are rejected");
+
+    ThreadLayout layout;
+    check(failures, parseThreadLayout("depth=0-3;pipeline=4;io=6-7", layout) && layout.depth.size() == 4 &&
+          layout.pipeline == std::vector<int>({4}) && layout.io == std::vector<int>({6, 7}), "layouts parse");
+    check(failures, formatThreadLayout(layout) == "depth=0-3;pipeline=4;io=6-7", "layouts format back");
+    check(failures, parseThreadLayout("auto", layout) && layout.empty() && formatThreadLayout(layout) == "auto",
+          "auto is the empty layout");
+    check(failures, !parseThreadLayout("gpu=0", layout) && !parseThreadLayout("depth", layout),
+          "unknown roles are rejected");
+
+    // ------ Pinning ------
+    const std::vector<int>& available = processCores();
+    check(failures, !available.empty(), "process cores are known");
+
+    ThreadLayout pinned;
+    pinned.depth = {available.front()};
+    pinned.pipeline = {available.back()};
+    setThreadLayout(pinned);
+    enterThreadRole(ThreadRole::PIPELINE);
+#ifdef __linux__
+    check(failures, sched_getcpu() == available.back(), "pipeline thread runs on its core");
+    {
+        ThreadRoleScope depth_scope(ThreadRole::DEPTH);
+        check(failures, sched_getcpu() == available.front(), "depth scope moves the thread to the depth cores");
+    }
+    check(failures, sched_getcpu() == available.back(), "scope end restores the pipeline cores");
+#endif
+
+    setThreadLayout(ThreadLayout());
+    enterThreadRole(ThreadRole::PIPELINE);
+    check(failures, getThreadLayout().empty(), "layout resets to unpinned");
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,19 @@
+#ifndef DRONE_NAVIGATION_TEST_UTILS_HPP
+#define DRONE_NAVIGATION_TEST_UTILS_HPP
+
+#include <iostream>
+#include <string>
+
+/**
+ * Report one condition of a test program and count it if it does not hold.
+ *
+ * @param failures Failure counter of the test program.
+ * @param condition Checked condition.
+ * @param description What the condition verifies.
+ */
+inline void check(int& failures, bool condition, const std::string& description) {
+    std::cout << (condition ? "[ok]     " : "[FAILED] ") << description << std::endl;
+    if (!condition) failures++;
+}
+
+#endif //DRONE_NAVIGATION_TEST_UTILS_HPP
@@ -0,0 +1,92 @@
+#include <iostream>
+#include "closed_loop_sim.hpp"
+#include "depth_estimation.hpp"
+
+// Headless closed-loop flights through procedural obstacle scenes:
+//   ./bin/closed_loop_sim [--runs=N] [--seed=S] [--boxes=N] [--length=m] [--size=WxH] [--fps=F]
+//                         [--seconds=s] [--speed=m/s] [--gt-depth] [--record=file.avi]
+//                         [--planner] [--planner-budget-us=N]
+// --planner steers with AvoidancePlanner rollouts (N us per frame) instead of the lateral shift rule.
+// Every run uses the next seed. Exits with -1 if any run collides or does not reach the goal,
+// so it can be used as a regression test.
+
+int main(int argc, char** argv) {
+    ClosedLoopConfig config;
+    int runs = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (arg == "--gt-depth") config.ground_truth_depth = true;
+            else if (arg == "--planner") config.use_planner = true;
+            else if (hasOption("--planner-budget-us=")) {
+                config.planner_budget_mcs = std::stoll(value("--planner-budget-us="));
+            }
+            else if (hasOption("--runs=")) runs = std::stoi(value("--runs="));
+            else if (hasOption("--seed=")) config.seed = static_cast<unsigned>(std::stoul(value("--seed=")));
+            else if (hasOption("--boxes=")) config.num_boxes = std::stoi(value("--boxes="));
+            else if (hasOption("--length=")) config.corridor_length = std::stof(value("--length="));
+            else if (hasOption("--fps=")) config.camera_rate = std::stof(value("--fps="));
+            else if (hasOption("--seconds=")) config.max_duration = std::stof(value("--seconds="));
+            else if (hasOption("--speed=")) config.cruise_speed = std::stof(value("--speed="));
+            else if (hasOption("--record=")) config.record_path = value("--record=");
+            else if (hasOption("--size=")) {
+                std::string size = value("--size=");
+                size_t x = size.find('x');
+                config.image_size = cv::Size(std::stoi(size.substr(0, x)), std::stoi(size.substr(x + 1)));
+            }
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << "Depth: " << (config.ground_truth_depth ? "rendered ground truth" :
+                                getModelDescriptor(getDepthEngineConfig().model).name)
+              << " | Camera: " << config.image_size.width << "x" << config.image_size.height
+              << " @ " << config.camera_rate << " Hz | Boxes: " << config.num_boxes << std::endl;
+
+    int failures = 0;
+    double total_sim_time = 0.0, total_wall_s = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        ClosedLoopConfig run_config = config;
+        run_config.seed = config.seed + run;
+        if (runs > 1 && !config.record_path.empty()) {
+            run_config.record_path = std::to_string(run_config.seed) + "_" + config.record_path;
+        }
+
+        ClosedLoopReport report = runClosedLoop(run_config);
+        bool passed = report.reached_goal && report.collision_frames == 0;
+        if (!passed) failures++;
+        total_sim_time += report.sim_time;
+        total_wall_s += static_cast<double>(report.wall_mcs) / 1e6;
+
+        std::cout << "Seed " << run_config.seed << (passed ? " [ok]    " : " [FAILED]")
+                  << " | Goal: " << (report.reached_goal ? "reached" : "not reached")
+                  << " | Collision frames: " << report.collision_frames
+                  << " | Min clearance: " << report.min_clearance << " m"
+                  << " | Flown: " << report.distance_flown << " m in " << report.sim_time << " s"
+                  << " | Render: " << report.mean_render_ms << " ms"
+                  << " | Pipeline: " << report.mean_pipeline_ms << " ms"
+                  << " | Real-time factor: " << report.real_time_factor << "x" << std::endl;
+        if (config.use_planner) {
+            std::cout << "    Planner: " << report.mean_planner_mcs << " us mean, " << report.max_planner_mcs
+                      << " us max | Candidates: " << report.mean_candidates << " per frame | Budget exhausted: "
+                      << report.budget_exhausted_frames << " frames | No safe candidate: " << report.unsafe_frames
+                      << " frames" << std::endl;
+        }
+    }
+
+    std::cout << "Runs: " << runs << " | Failed: " << failures
+              << " | Overall real-time factor: " << total_sim_time / std::max(1e-6, total_wall_s) << "x" << std::endl;
+    return failures == 0 ? 0 : -1;
+}
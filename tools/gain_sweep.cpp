@@ -0,0 +1,99 @@
+#include <iostream>
+#include "gain_sweep.hpp"
+#include "time_meas.hpp"
+
+// Headless controller tuning on DroneDynamicsDLL:
+//   ./bin/gain_sweep [--waypoints=file] [--kp=min:max:steps] [--kd=...] [--drag=...] [--thrust=...]
+//                    [--mass=...] [--samples=N] [--seed=S] [--dt=s] [--leg=s] [--tolerance=m]
+//                    [--threads=N] [--output=gain_sweep.csv] [--top=N]
+// Ranges are a grid unless --samples is given, then every parameter is drawn uniformly
+// from its range (Monte Carlo). A single value ("--kp=20") fixes a parameter.
+
+static bool parseRange(const std::string& text, ParameterRange& range) {
+    try {
+        size_t first = text.find(':');
+        if (first == std::string::npos) {
+            range = {std::stof(text), std::stof(text), 1};
+            return true;
+        }
+        size_t second = text.find(':', first + 1);
+        range.min = std::stof(text.substr(0, first));
+        range.max = std::stof(text.substr(first + 1, second - first - 1));
+        range.steps = (second == std::string::npos) ? 2 : std::stoi(text.substr(second + 1));
+        return range.steps > 0 && range.max >= range.min;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+int main(int argc, char** argv) {
+    SweepSpace space;
+    SweepScenario scenario;
+    scenario.waypoints = {{0.0f, 10.0f, 0.0f}, {20.0f, 10.0f, 0.0f}, {20.0f, 10.0f, 20.0f}, {0.0f, 10.0f, 20.0f}};
+
+    int samples = 0, num_threads = 0, top = 10;
+    unsigned seed = 42;
+    std::string output_path = "gain_sweep.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (hasOption("--waypoints=")) {
+                scenario.waypoints.clear();
+                ok = loadWaypoints(value("--waypoints="), scenario.waypoints) && !scenario.waypoints.empty();
+            }
+            else if (hasOption("--kp=")) ok = parseRange(value("--kp="), space.kp);
+            else if (hasOption("--kd=")) ok = parseRange(value("--kd="), space.kd);
+            else if (hasOption("--drag=")) ok = parseRange(value("--drag="), space.drag);
+            else if (hasOption("--thrust=")) ok = parseRange(value("--thrust="), space.thrust);
+            else if (hasOption("--mass=")) ok = parseRange(value("--mass="), space.mass);
+            else if (hasOption("--samples=")) samples = std::stoi(value("--samples="));
+            else if (hasOption("--seed=")) seed = static_cast<unsigned>(std::stoul(value("--seed=")));
+            else if (hasOption("--dt=")) scenario.dt = std::stof(value("--dt="));
+            else if (hasOption("--leg=")) scenario.leg_duration = std::stof(value("--leg="));
+            else if (hasOption("--tolerance=")) scenario.settle_tolerance = std::stof(value("--tolerance="));
+            else if (hasOption("--threads=")) num_threads = std::stoi(value("--threads="));
+            else if (hasOption("--output=")) output_path = value("--output=");
+            else if (hasOption("--top=")) top = std::stoi(value("--top="));
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<GainParameters> configurations = samples > 0 ? sampleParameters(space, samples, seed)
+                                                             : buildParameterGrid(space);
+
+    auto start_time = get_current_time_fenced();
+    std::vector<SweepMetrics> results = runGainSweep(configurations, scenario, num_threads);
+    auto elapsed_ms = to_ms(get_current_time_fenced() - start_time);
+    if (results.empty()) return -1;
+
+    std::cout << (samples > 0 ? "Monte Carlo: " : "Grid: ") << configurations.size() << " configurations | "
+              << scenario.waypoints.size() << " waypoints | " << elapsed_ms << " ms" << std::endl;
+
+    rankSweepResults(results);
+    if (!writeSweepCsv(output_path, results)) return -1;
+    std::cout << "Results saved to " << output_path << std::endl;
+
+    std::cout << "Best configurations:" << std::endl;
+    for (int i = 0; i < std::min(top, static_cast<int>(results.size())); ++i) {
+        const auto& r = results[i];
+        std::cout << "  kp " << r.params.kp << " | kd " << r.params.kd << " | drag " << r.params.drag
+                  << " | thrust " << r.params.thrust << " | mass " << r.params.mass
+                  << " -> settling " << r.settling_time << " s | overshoot " << r.overshoot
+                  << " m | path " << r.path_length << " m | final error " << r.final_error << " m"
+                  << (r.settled ? "" : " (not settled)") << std::endl;
+    }
+
+    return 0;
+}
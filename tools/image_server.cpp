@@ -0,0 +1,92 @@
+#include <csignal>
+#include "image_server.hpp"
+#include "metrics_publisher.hpp"
+
+// Vision pipeline behind HTTP for the Unity simulation (PostCameraView.cs):
+//   ./bin/image_server [--host=127.0.0.1] [--port=20000] [--record=dir] [--queue=N]
+//                      [--max-connections=N] [--verbose] [--engine=...] [--model=...]
+//                      [--dnn-backend=...] [--dnn-target=...] [--threads=N] [--depth-tiles=N]
+//                      [--thread-layout=...] [--metrics-shm] [--calibration=camera.yml]
+// POST / with a multipart "file" JPEG returns the most urgent obstacle box as JSON,
+// GET / returns the request counters and GET /metrics the pipeline metrics in Prometheus format.
+// --record saves every received JPEG, --metrics-shm also publishes the metrics to shared memory.
+// --calibration reports obstacle boxes in undistorted image coordinates.
+
+static ImageServer* active_server = nullptr;
+
+static void handleSignal(int) {
+    if (active_server) active_server->stop();
+}
+
+int main(int argc, char** argv) {
+    ImageServerConfig config;
+    DepthEngineConfig depth_config;
+    ThreadLayout thread_layout;
+    bool metrics_shm = false;
+    CameraCalibration calibration;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (hasOption("--host=")) config.host = value("--host=");
+            else if (hasOption("--port=")) config.port = std::stoi(value("--port="));
+            else if (hasOption("--record=")) config.record_dir = value("--record=");
+            else if (hasOption("--queue=")) config.max_pending_frames = std::stoul(value("--queue="));
+            else if (hasOption("--max-connections=")) config.max_connections = std::stoi(value("--max-connections="));
+            else if (arg == "--verbose") config.verbose = true;
+            else if (arg == "--metrics-shm") metrics_shm = true;
+            else if (hasOption("--engine=")) ok = parseInferenceBackend(value("--engine="), depth_config.backend);
+            else if (hasOption("--model=")) ok = parseDepthModel(value("--model="), depth_config.model);
+            else if (hasOption("--dnn-backend=")) ok = parseDnnBackend(value("--dnn-backend="), depth_config.dnn_backend);
+            else if (hasOption("--dnn-target=")) ok = parseDnnTarget(value("--dnn-target="), depth_config.dnn_target);
+            else if (hasOption("--threads=")) depth_config.num_threads = std::stoi(value("--threads="));
+            else if (hasOption("--depth-tiles=")) depth_config.tiles = std::stoi(value("--depth-tiles="));
+            else if (hasOption("--thread-layout=")) ok = parseThreadLayout(value("--thread-layout="), thread_layout);
+            else if (hasOption("--calibration=")) ok = loadCameraCalibration(value("--calibration="), calibration);
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+    setThreadLayout(thread_layout);
+    setDepthEngineConfig(depth_config);
+    setCameraCalibration(calibration);
+
+    ImageServer server(config);
+    if (!server.start()) return -1;
+
+    MetricsPublisher metrics_publisher;
+    if (metrics_shm && metrics_publisher.open()) metrics_publisher.start();
+
+    active_server = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "Serving on " << config.host << ":" << config.port
+              << (config.record_dir.empty() ? "" : ", recording to " + config.record_dir) << std::endl;
+
+    server.run();
+    active_server = nullptr;
+
+    const ImageServerStats& stats = server.stats();
+    uint64_t frames = stats.frames_processed;
+    std::cout << "Requests: " << stats.requests << ", frames: " << frames << ", rejected (busy): "
+              << stats.frames_rejected << ", decode errors: " << stats.decode_errors
+              << ", bad requests: " << stats.bad_requests << std::endl;
+    if (frames > 0) {
+        std::cout << "Mean decode + pipeline time: " << stats.pipeline_mcs / 1000.0 / frames << " ms" << std::endl;
+    }
+    if (!config.record_dir.empty()) {
+        std::cout << "Recorded: " << stats.frames_recorded << ", dropped: " << stats.records_dropped << std::endl;
+    }
+    return 0;
+}
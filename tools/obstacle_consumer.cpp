@@ -0,0 +1,55 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <string>
+#include "obstacle_shm.h"
+
+// Print the obstacle records published by a running `drone_navigation`
+// together with the publish-to-read latency.
+// Usage: obstacle_consumer [shm name] [frames, 0 = until interrupted]
+int main(int argc, char** argv) {
+    std::string shm_name = (argc > 1) ? argv[1] : OBSTACLE_SHM_DEFAULT_NAME;
+    long long max_frames = 0;
+    try {
+        if (argc > 2) max_frames = std::stoll(argv[2]);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid frame count: " << argv[2] << std::endl;
+        return -1;
+    }
+
+    ObstacleReader* reader = nullptr;
+    std::cout << "Waiting for " << shm_name << "..." << std::endl;
+    while (!(reader = obstacle_reader_open(shm_name.c_str()))) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    ObstacleFrame frame;
+    uint64_t dropped = 0, total_dropped = 0;
+    for (long long frames = 0; max_frames <= 0 || frames < max_frames; ++frames) {
+        while (!obstacle_reader_next(reader, &frame, &dropped)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        total_dropped += dropped;
+
+        long long now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        std::cout << "Frame: " << frame.frame_seq
+                  << " | Obstacles: " << frame.obstacle_count
+                  << " | Median depth: " << frame.median_depth
+                  << " | Latency: " << (now_ns - frame.timestamp_ns) / 1000.0 << " mcs"
+                  << " | Dropped: " << total_dropped << "\n";
+        for (uint32_t i = 0; i < frame.obstacle_count; ++i) {
+            const ObstacleRecord& o = frame.obstacles[i];
+            std::cout << "  Track " << o.track_id
+                      << " | Position: (" << o.x << ", " << o.y << ")"
+                      << " | Velocity: (" << o.vx << ", " << o.vy << ")"
+                      << " | Depth: " << o.depth_median << " [" << o.depth_min << ", " << o.depth_max << "]"
+                      << " | Points: " << o.point_count << "\n";
+        }
+    }
+
+    obstacle_reader_close(reader);
+    return 0;
+}
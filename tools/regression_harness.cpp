@@ -0,0 +1,231 @@
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+#include "golden_results.hpp"
+
+// Headless accuracy and latency regression runs on recorded videos:
+//   ./bin/regression_harness [video ...] [--record] [--golden-dir=dir] [--frames=N]
+//                            [--keypoint-tol=ratio] [--depth-tol=d] [--centroid-tol=px] [--velocity-tol=px/s]
+//                            [--count-tol=N] [--drift-tol=fraction]
+//                            [--engine=...] [--model=...] [--dnn-backend=...] [--dnn-target=...] [--threads=N]
+//                            [--depth-tiles=N] [--thread-layout=...] [--motion-gating] [--ego-motion]
+// Without arguments every video in media/ is used. --record writes the golden files
+// (media/golden/<video>.golden); otherwise each run is compared with its golden file and the
+// per-stage latency percentiles are printed next to the recorded ones. The pipeline runs at
+// fixed quality, so the output does not depend on timing. Exits with -1 if any video drifts
+// beyond the tolerances or has no golden file. --motion-gating runs with the motion gate, to check
+// its drift against golden files recorded without it. --ego-motion compensates the tracks for camera
+// motion; the number of distinct track IDs shows how stable the identities are.
+
+static bool isVideoFile(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".mp4" || extension == ".avi" || extension == ".mov" || extension == ".mkv";
+}
+
+static std::vector<std::string> findVideos() {
+    std::vector<std::string> videos;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(getContentPath(""), error)) {
+        if (entry.is_regular_file() && isVideoFile(entry.path())) videos.push_back(entry.path().string());
+    }
+    std::sort(videos.begin(), videos.end());
+    return videos;
+}
+
+// Run the pipeline on every frame of a video without display or quality adaptation
+static bool runHeadless(const std::string& video_path, int max_frames, bool motion_gating, bool ego_motion,
+                        std::vector<FrameResult>& results) {
+    std::unique_ptr<FrameSource> source = openFrameSource(video_path);
+    if (!source) return false;
+
+    enterThreadRole(ThreadRole::PIPELINE);
+    PipelineContext context;
+    context.quality.display = false;
+    context.motion.enabled = motion_gating;
+    context.ego_motion.enabled = ego_motion;
+
+    // Nothing is drawn, the borrowed frames are analyzed in place
+    BorrowedFrame borrowed;
+    while ((max_frames <= 0 || static_cast<int>(results.size()) < max_frames) && source->read(borrowed)) {
+        // Load the depth model before the first timed frame
+        if (results.empty()) depth_estimation(borrowed.image);
+
+        FrameResult result;
+        result.frame_index = static_cast<int>(results.size());
+        analyzeFrame(context, borrowed.image, result);
+        borrowed.release();
+        results.push_back(std::move(result));
+    }
+    return !results.empty();
+}
+
+static std::string formatLatency(const LatencyPercentiles& latency) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << latency.p50 / 1000.0 << " / " << latency.p90 / 1000.0
+         << " / " << latency.p99 / 1000.0;
+    return text.str();
+}
+
+static void printLatency(const LatencySummary* golden, const LatencySummary& current) {
+    std::ostringstream table;
+    table << std::left << std::fixed << std::setprecision(1);
+    table << "  " << std::setw(12) << "stage";
+    if (golden) table << std::setw(28) << "golden p50/p90/p99 [ms]";
+    table << std::setw(28) << "current p50/p90/p99 [ms]" << (golden ? "p50 change" : "") << "\n";
+
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        if (stage == STAGE_DISPLAY) continue;   // Headless
+        const char* name = stage == STAGE_COUNT ? "frame" : stageName(static_cast<PipelineStage>(stage));
+        table << "  " << std::setw(12) << name;
+        if (golden) table << std::setw(28) << formatLatency(golden->stages[stage]);
+        table << std::setw(28) << formatLatency(current.stages[stage]);
+        if (golden && golden->stages[stage].p50 > 0) {
+            double change = 100.0 * static_cast<double>(current.stages[stage].p50 - golden->stages[stage].p50) /
+                            static_cast<double>(golden->stages[stage].p50);
+            table << std::showpos << change << "%" << std::noshowpos;
+        }
+        table << "\n";
+    }
+    std::cout << table.str();
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> videos;
+    std::string golden_dir = getContentPath("", "media/golden");
+    bool record = false;
+    int max_frames = 0;
+    GoldenTolerances tolerances;
+    DepthEngineConfig depth_config;
+    ThreadLayout thread_layout;
+    bool motion_gating = false;
+    bool ego_motion = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& option) { return arg.substr(option.size()); };
+        auto hasOption = [&](const std::string& option) { return arg.rfind(option, 0) == 0; };
+
+        bool ok = true;
+        try {
+            if (arg == "--record") record = true;
+            else if (hasOption("--golden-dir=")) golden_dir = value("--golden-dir=");
+            else if (hasOption("--frames=")) max_frames = std::stoi(value("--frames="));
+            else if (hasOption("--keypoint-tol=")) tolerances.keypoint_ratio = std::stof(value("--keypoint-tol="));
+            else if (hasOption("--depth-tol=")) tolerances.depth = std::stof(value("--depth-tol="));
+            else if (hasOption("--centroid-tol=")) tolerances.centroid_px = std::stof(value("--centroid-tol="));
+            else if (hasOption("--velocity-tol=")) tolerances.velocity = std::stof(value("--velocity-tol="));
+            else if (hasOption("--count-tol=")) tolerances.obstacle_count = std::stoi(value("--count-tol="));
+            else if (hasOption("--drift-tol=")) tolerances.drifted_frames = std::stof(value("--drift-tol="));
+            else if (hasOption("--engine=")) ok = parseInferenceBackend(value("--engine="), depth_config.backend);
+            else if (hasOption("--model=")) ok = parseDepthModel(value("--model="), depth_config.model);
+            else if (hasOption("--dnn-backend=")) ok = parseDnnBackend(value("--dnn-backend="), depth_config.dnn_backend);
+            else if (hasOption("--dnn-target=")) ok = parseDnnTarget(value("--dnn-target="), depth_config.dnn_target);
+            else if (hasOption("--threads=")) depth_config.num_threads = std::stoi(value("--threads="));
+            else if (hasOption("--depth-tiles=")) depth_config.tiles = std::stoi(value("--depth-tiles="));
+            else if (arg == "--motion-gating") motion_gating = true;
+            else if (arg == "--ego-motion") ego_motion = true;
+            else if (hasOption("--thread-layout=")) ok = parseThreadLayout(value("--thread-layout="), thread_layout);
+            else if (!hasOption("--")) videos.push_back(fs::exists(arg) ? arg : getContentPath(arg));
+            else ok = false;
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid option: " << arg << std::endl;
+            return -1;
+        }
+    }
+    setThreadLayout(thread_layout);
+    setDepthEngineConfig(depth_config);
+
+    if (videos.empty()) videos = findVideos();
+    if (videos.empty()) {
+        std::cerr << "Error: No videos to process." << std::endl;
+        return -1;
+    }
+    if (record) fs::create_directories(golden_dir);
+
+    int failures = 0;
+    for (const auto& video_path : videos) {
+        std::string video_name = fs::path(video_path).filename().string();
+        std::string golden_path = (fs::path(golden_dir) / (video_name + ".golden")).string();
+
+        GoldenRun run;
+        run.video = video_name;
+        auto start_time = get_current_time_fenced();
+        if (!runHeadless(video_path, max_frames, motion_gating, ego_motion, run.frames)) {
+            std::cerr << "Error: Could not process " << video_path << std::endl;
+            failures++;
+            continue;
+        }
+        double seconds = static_cast<double>(to_ms(get_current_time_fenced() - start_time)) / 1000.0;
+        run.latency = summarizeLatency(run.frames);
+
+        std::cout << video_name << " | Frames: " << run.frames.size() << " | " << run.frames.size() / std::max(seconds, 1e-3)
+                  << " fps";
+        if (motion_gating) {
+            double changed = 0.0;
+            for (const auto& frame : run.frames) changed += frame.changed_fraction;
+            std::cout << " | Changed: " << 100.0 * changed / run.frames.size() << " %";
+        }
+        std::unordered_set<int> track_ids;
+        for (const auto& frame : run.frames) {
+            for (const auto& obstacle : frame.obstacles) track_ids.insert(obstacle.id);
+        }
+        std::cout << " | Tracks: " << track_ids.size();
+        if (ego_motion) {
+            int estimated = 0;
+            long long inliers = 0;
+            for (const auto& frame : run.frames) {
+                if (!frame.ego_motion.valid) continue;
+                estimated++;
+                inliers += frame.ego_motion.inliers;
+            }
+            std::cout << " | Ego-motion: " << 100.0 * estimated / run.frames.size() << " % of frames, "
+                      << (estimated > 0 ? inliers / estimated : 0) << " inliers";
+        }
+        std::cout << std::endl;
+
+        if (record) {
+            if (!writeGoldenFile(golden_path, run)) {
+                failures++;
+                continue;
+            }
+            printLatency(nullptr, run.latency);
+            std::cout << "  Golden results saved to " << golden_path << std::endl;
+            continue;
+        }
+
+        GoldenRun golden;
+        if (!readGoldenFile(golden_path, golden)) {
+            std::cerr << "Error: No golden results for " << video_name << " (" << golden_path
+                      << "), record them with --record." << std::endl;
+            failures++;
+            continue;
+        }
+
+        // A shortened run is compared with the same prefix of the golden run
+        if (max_frames > 0 && static_cast<int>(golden.frames.size()) > max_frames) golden.frames.resize(max_frames);
+
+        GoldenComparison comparison = compareWithGolden(golden, run.frames, tolerances);
+        bool passed = comparison.passed(tolerances);
+        if (!passed) failures++;
+
+        std::cout << (passed ? "  [ok]     " : "  [FAILED] ") << "Drifted frames: " << comparison.drifted_frames
+                  << "/" << comparison.frames << " | Missing frames: " << comparison.missing_frames
+                  << " | Centroid error: mean " << comparison.mean_centroid_error << " px, max "
+                  << comparison.max_centroid_error << " px | Unmatched obstacles: " << comparison.unmatched_obstacles
+                  << " | Max depth error: " << comparison.max_depth_error
+                  << " | Max keypoint error: " << 100.0 * comparison.max_keypoint_error << "%" << std::endl;
+        for (const auto& detail : comparison.details) {
+            std::cout << "    " << detail << std::endl;
+        }
+        printLatency(&golden.latency, run.latency);
+    }
+
+    std::cout << "Videos: " << videos.size() << " | Failed: " << failures << std::endl;
+    return failures == 0 ? 0 : -1;
+}